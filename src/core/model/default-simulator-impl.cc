@@ -22,9 +22,11 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "simulator-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
 #include "assert.h"
 #include "log.h"
 
@@ -53,6 +55,14 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("BatchEvents",
+                   "Run the consecutive events with the same timestamp and "
+                   "context in a batch, without returning to the main loop "
+                   "nor processing the events scheduled by other threads "
+                   "between them.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_batchEvents),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -61,6 +71,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
+  m_batchEvents = true;
   // uids are allocated from 4.
   // uid 0 is "invalid" events
   // uid 1 is "now" events
@@ -145,9 +156,37 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
-  m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
-  next.impl->Unref ();
+  bool profile = SimulatorProfiler::IsEnabled ();
+  uint64_t clock = profile ? SimulatorProfiler::GetClock () : 0;
+  while (true)
+    {
+      m_currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      if (profile)
+        {
+          clock = SimulatorProfiler::RecordEvent (next.impl, clock);
+        }
+      next.impl->Unref ();
+
+      if (!m_batchEvents || m_stop || m_events->IsEmpty ())
+        {
+          break;
+        }
+      // events are ordered by timestamp then uid: the events of the
+      // batch, including those scheduled now by the batch for the same
+      // context, are the next ones in the queue
+      next = m_events->PeekNext ();
+      if (next.key.m_ts != m_currentTs || next.key.m_context != m_currentContext)
+        {
+          break;
+        }
+      m_events->RemoveNext ();
+      m_unscheduledEvents--;
+    }
+  if (profile)
+    {
+      SimulatorProfiler::RecordBatch ();
+    }
 
   ProcessEventsWithContext ();
 }
@@ -196,12 +235,19 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  bool profile = SimulatorProfiler::IsEnabled ();
+  uint64_t start = profile ? SimulatorProfiler::GetClock () : 0;
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
+  if (profile)
+    {
+      SimulatorProfiler::RecordRun (start);
+    }
+
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
   NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
@@ -81,7 +81,10 @@ public:
 private:
   virtual void DoDispose (void);
 
-  /** Process the next event. */
+  /**
+   * Process the next event and, with BatchEvents, the following events
+   * with the same timestamp and context.
+   */
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
@@ -113,6 +116,8 @@ private:
   DestroyEvents m_destroyEvents;
   /** Flag calling for the end of the simulation. */
   bool m_stop;
+  /** The BatchEvents attribute. */
+  bool m_batchEvents;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
 
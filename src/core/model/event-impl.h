@@ -65,6 +65,15 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * \returns The address of the function invoked by this event, or 0
+   * if it is not known.
+   *
+   * Used by the ProfilingSimulatorImpl to tell apart the events which
+   * invoke different functions with the same signature.  The events
+   * bound to a member function only know its address with g++.
+   */
+  virtual const void *GetFunction (void) const;
 
 protected:
   /**
@@ -20,12 +20,9 @@
 #include "object-base.h"
 #include "log.h"
 #include "trace-source-accessor.h"
+#include "traced-callback.h"
 #include "attribute-construction-list.h"
 #include "string.h"
-#include "ns3/core-config.h"
-#ifdef HAVE_STDLIB_H
-#include <cstdlib>
-#endif
 
 /**
  * \file
@@ -112,7 +109,6 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
                   NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
                 }
             }
-          bool found = false;
           if (value != 0)
             {
               // We have a matching attribute value.
@@ -120,52 +116,15 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
                 {
                   NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
                                 info.name<<"\"");
-                  found = true;
                   continue;
                 }
             }              
-          if (!found)
-            {
-              // No matching attribute value so we try to look at the env var.
-#ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
-                {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
-                    {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
-                        {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
-                            {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
-                            }
-                        }
-                      cur = next + 1;
-                    }
-                }
-#endif /* HAVE_GETENV */
-            }
-          if (!found)
-            {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
-            }
+          // No matching attribute value so we use the default value:
+          // the NS_ATTRIBUTE_DEFAULT env var if it sets this attribute,
+          // otherwise the initial value.  The TypeId caches the result.
+          DoSet (info.accessor, info.checker, *tid.GetAttributeDefault (i));
+          NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
+                        info.name <<"\" from default value.");
         }
       tid = tid.GetParent ();
     } while (tid != ObjectBase::GetTypeId ());
@@ -305,7 +264,9 @@ ObjectBase::TraceConnectWithoutContext (std::string name, const CallbackBase &cb
     {
       return false;
     }
+  TracedCallbackProfiler::SetConnectingName (tid.GetName () + "::" + name);
   bool ok = accessor->ConnectWithoutContext (this, cb);
+  TracedCallbackProfiler::SetConnectingName ("");
   return ok;
 }
 bool 
@@ -318,7 +279,9 @@ ObjectBase::TraceConnect (std::string name, std::string context, const CallbackB
     {
       return false;
     }
+  TracedCallbackProfiler::SetConnectingName (tid.GetName () + "::" + name);
   bool ok = accessor->Connect (this, context, cb);
+  TracedCallbackProfiler::SetConnectingName ("");
   return ok;
 }
 bool 
@@ -0,0 +1,644 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "profiling-simulator-impl.h"
+#include "simulator-profiler.h"
+#include "traced-callback.h"
+#include "object-factory.h"
+#include "string.h"
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#ifdef HAVE_DL
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::ProfilingSimulatorImpl.
+ */
+
+namespace ns3 {
+
+// Note: as in the DefaultSimulatorImpl, logging is avoided in the
+// methods called for each event
+NS_LOG_COMPONENT_DEFINE ("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+namespace {
+
+/** The simulator measuring the TracedCallbacks. */
+ProfilingSimulatorImpl *g_profiler = 0;
+
+/** The name of the trace source being connected. */
+std::string g_connectingName;
+
+/**
+ * \returns the names of the trace sources, by TracedCallback
+ */
+std::map<const void *, std::string> &
+GetSourceNames (void)
+{
+  static std::map<const void *, std::string> names;
+  return names;
+}
+
+/**
+ * \param mangled a mangled name
+ * \returns the demangled name
+ */
+std::string
+Demangle (const char *mangled)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      std::string name = demangled;
+      std::free (demangled);
+      return name;
+    }
+#endif
+  return mangled;
+}
+
+/** A line of the flat profile. */
+struct FlatEntry
+{
+  FlatEntry ()
+    : count (0),
+      total (0),
+      self (0),
+      sinks (0)
+  {
+  }
+  uint64_t count;  //!< Number of invocations.
+  uint64_t total;  //!< Total time, in nanoseconds.
+  uint64_t self;   //!< Time excluding the nested frames, in nanoseconds.
+  uint64_t sinks;  //!< Number of sinks invoked.
+};
+
+/**
+ * Order the lines of the flat profile by decreasing self time.
+ * \param a a line
+ * \param b another line
+ * \returns true if \p a took more time than \p b
+ */
+bool
+MoreSelfTime (const std::pair<std::string, FlatEntry> &a,
+              const std::pair<std::string, FlatEntry> &b)
+{
+  return a.second.self > b.second.self;
+}
+
+} // anonymous namespace
+
+bool TracedCallbackProfiler::g_enabled = false;
+
+void
+TracedCallbackProfiler::Enable (bool enabled)
+{
+  g_enabled = enabled;
+}
+
+void
+TracedCallbackProfiler::SetConnectingName (std::string name)
+{
+  g_connectingName = name;
+}
+
+void
+TracedCallbackProfiler::NotifyConnected (const void *source)
+{
+  // the TracedCallback may be at the address of a destroyed one
+  if (g_connectingName.empty ())
+    {
+      GetSourceNames ().erase (source);
+    }
+  else
+    {
+      GetSourceNames ()[source] = g_connectingName;
+    }
+}
+
+std::string
+TracedCallbackProfiler::GetSourceName (const void *source)
+{
+  std::map<const void *, std::string>::const_iterator i = GetSourceNames ().find (source);
+  return i == GetSourceNames ().end () ? "" : i->second;
+}
+
+void
+TracedCallbackProfiler::Enter (const std::type_info &type, const void *source, std::size_t sinks)
+{
+  ProfilingSimulatorImpl::FrameKey key (ProfilingSimulatorImpl::TRACED_CALLBACK, &type, source, 0);
+  ProfilingSimulatorImpl::Frame *frame = g_profiler->Enter (key, SimulatorProfiler::GetClock ());
+  frame->sinks += sinks;
+}
+
+void
+TracedCallbackProfiler::Exit (void)
+{
+  g_profiler->Exit (SimulatorProfiler::GetClock ());
+}
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ProfilingSimulatorImpl> ()
+    .AddAttribute ("Implementation",
+                   "The simulator implementation running the events.",
+                   StringValue ("ns3::DefaultSimulatorImpl"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_implementation),
+                   MakeStringChecker ())
+    .AddAttribute ("FlatProfile",
+                   "The file where the flat profile is written at "
+                   "Simulator::Destroy, none if empty.",
+                   StringValue ("simulator-profile.txt"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_flatProfile),
+                   MakeStringChecker ())
+    .AddAttribute ("FoldedStacks",
+                   "The file where the folded stacks are written at "
+                   "Simulator::Destroy, none if empty.",
+                   StringValue ("simulator-profile.folded"),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_foldedStacks),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+ProfilingSimulatorImpl::FrameKey::FrameKey (FrameKind kind, const std::type_info *type,
+                                            const void *id, uint32_t context)
+  : kind (kind),
+    type (type),
+    id (id),
+    context (context)
+{
+}
+
+bool
+ProfilingSimulatorImpl::FrameKey::operator < (const FrameKey &o) const
+{
+  if (kind != o.kind)
+    {
+      return kind < o.kind;
+    }
+  if (context != o.context)
+    {
+      return context < o.context;
+    }
+  if (id != o.id)
+    {
+      return id < o.id;
+    }
+  return type < o.type;
+}
+
+ProfilingSimulatorImpl::Frame::Frame ()
+  : count (0),
+    time (0),
+    sinks (0)
+{
+}
+
+ProfilingSimulatorImpl::Frame::~Frame ()
+{
+  for (std::map<FrameKey, Frame *>::iterator i = children.begin (); i != children.end (); ++i)
+    {
+      delete i->second;
+    }
+}
+
+ProfilingSimulatorImpl::ProfiledEvent::ProfiledEvent (ProfilingSimulatorImpl *profiler, EventImpl *event)
+  : m_profiler (profiler),
+    m_event (event)
+{
+}
+
+ProfilingSimulatorImpl::ProfiledEvent::~ProfiledEvent ()
+{
+  m_event->Unref ();
+}
+
+void
+ProfilingSimulatorImpl::ProfiledEvent::Notify (void)
+{
+  uint64_t start = SimulatorProfiler::GetClock ();
+  m_profiler->Enter (FrameKey (NODE, 0, 0, m_profiler->GetContext ()), start);
+  m_profiler->Enter (FrameKey (EVENT, &typeid (*m_event), m_event->GetFunction (), 0), start);
+  m_event->Invoke ();
+  uint64_t end = SimulatorProfiler::GetClock ();
+  m_profiler->Exit (end);
+  m_profiler->Exit (end);
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ProfilingSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  ObjectFactory factory;
+  factory.SetTypeId (m_implementation);
+  m_impl = factory.Create<SimulatorImpl> ();
+  g_profiler = this;
+  TracedCallbackProfiler::Enable (true);
+  SimulatorImpl::NotifyConstructionCompleted ();
+}
+
+void
+ProfilingSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (g_profiler == this)
+    {
+      TracedCallbackProfiler::Enable (false);
+      g_profiler = 0;
+    }
+  m_impl->Dispose ();
+  m_impl = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+ProfilingSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Destroy ();
+  Write ();
+}
+
+EventImpl *
+ProfilingSimulatorImpl::Wrap (EventImpl *event)
+{
+  return new ProfiledEvent (this, event);
+}
+
+ProfilingSimulatorImpl::Frame *
+ProfilingSimulatorImpl::Enter (FrameKey key, uint64_t start)
+{
+  Frame *parent = m_stack.empty () ? &m_root : m_stack.back ().frame;
+  std::map<FrameKey, Frame *>::iterator i = parent->children.find (key);
+  if (i == parent->children.end ())
+    {
+      i = parent->children.insert (std::make_pair (key, new Frame ())).first;
+      i->second->name = GetName (key);
+    }
+  ActiveFrame active;
+  active.frame = i->second;
+  active.start = start;
+  m_stack.push_back (active);
+  return active.frame;
+}
+
+void
+ProfilingSimulatorImpl::Exit (uint64_t end)
+{
+  NS_ASSERT (!m_stack.empty ());
+  ActiveFrame active = m_stack.back ();
+  m_stack.pop_back ();
+  active.frame->count++;
+  active.frame->time += end - active.start;
+}
+
+std::string
+ProfilingSimulatorImpl::GetNodeName (uint32_t context)
+{
+  std::ostringstream oss;
+  if (context == 0xffffffff)
+    {
+      oss << "main";
+    }
+  else
+    {
+      oss << "node " << context;
+    }
+  return oss.str ();
+}
+
+std::string
+ProfilingSimulatorImpl::GetName (const FrameKey &key)
+{
+  if (key.kind == NODE)
+    {
+      return GetNodeName (key.context);
+    }
+  if (key.kind == TRACED_CALLBACK)
+    {
+      std::string source = TracedCallbackProfiler::GetSourceName (key.id);
+      if (!source.empty ())
+        {
+          return source;
+        }
+    }
+#ifdef HAVE_DL
+  Dl_info info;
+  if (key.kind == EVENT && key.id != 0 && dladdr (key.id, &info) != 0
+      && info.dli_sname != 0 && info.dli_saddr == key.id)
+    {
+      return Demangle (info.dli_sname);
+    }
+#endif
+  std::string name = Demangle (key.type->name ());
+  // shorten "ns3::MakeEvent<void (A::*)(), A*>(void (A::*)(), A*)::EventMemberImpl0"
+  // into "ns3::MakeEvent<void (A::*)(), A*>", and drop the unused
+  // arguments of the TracedCallbacks
+  if (name.compare (0, 15, "ns3::MakeEvent<") == 0)
+    {
+      uint32_t depth = 0;
+      for (std::string::size_type i = 14; i < name.size (); i++)
+        {
+          if (name[i] == '<')
+            {
+              depth++;
+            }
+          else if (name[i] == '>' && --depth == 0)
+            {
+              name.erase (i + 1);
+              break;
+            }
+        }
+    }
+  std::string::size_type empty;
+  while ((empty = name.find (", ns3::empty")) != std::string::npos)
+    {
+      name.erase (empty, 12);
+    }
+  if (key.kind == EVENT && key.id != 0)
+    {
+      // tell apart the functions of the same signature
+      std::ostringstream oss;
+      oss << name << " [" << key.id << "]";
+      name = oss.str ();
+    }
+  return name;
+}
+
+void
+ProfilingSimulatorImpl::PrintFlatProfile (std::ostream &os) const
+{
+  // the same type may have several type_info objects, one per library,
+  // and a trace source several TracedCallbacks, one per object: the
+  // frames are aggregated by name
+  std::map<std::string, FlatEntry> entries;
+  std::map<uint32_t, FlatEntry> nodes;
+  std::vector<std::pair<const Frame *, std::vector<std::string> > > frames;
+  frames.push_back (std::make_pair (&m_root, std::vector<std::string> ()));
+  while (!frames.empty ())
+    {
+      const Frame *frame = frames.back ().first;
+      std::vector<std::string> path = frames.back ().second;
+      frames.pop_back ();
+      for (std::map<FrameKey, Frame *>::const_iterator i = frame->children.begin ();
+           i != frame->children.end (); ++i)
+        {
+          const Frame *child = i->second;
+          uint64_t nested = 0;
+          for (std::map<FrameKey, Frame *>::const_iterator j = child->children.begin ();
+               j != child->children.end (); ++j)
+            {
+              nested += j->second->time;
+            }
+          if (i->first.kind == NODE)
+            {
+              FlatEntry &node = nodes[i->first.context];
+              node.count += child->count;
+              node.total += child->time;
+              frames.push_back (std::make_pair (child, path));
+              continue;
+            }
+          const std::string &name = child->name;
+          FlatEntry &entry = entries[name];
+          entry.count += child->count;
+          entry.self += child->time - nested;
+          entry.sinks += child->sinks;
+          // the total time of recursive frames is only counted once
+          if (std::find (path.begin (), path.end (), name) == path.end ())
+            {
+              entry.total += child->time;
+            }
+          std::vector<std::string> childPath = path;
+          childPath.push_back (name);
+          frames.push_back (std::make_pair (child, childPath));
+        }
+    }
+
+  std::vector<std::pair<std::string, FlatEntry> > sorted (entries.begin (), entries.end ());
+  std::stable_sort (sorted.begin (), sorted.end (), MoreSelfTime);
+  os << std::setw (14) << "self (ns)" << std::setw (14) << "total (ns)"
+     << std::setw (12) << "calls" << std::setw (10) << "sinks" << "  name" << std::endl;
+  for (std::vector<std::pair<std::string, FlatEntry> >::const_iterator i = sorted.begin ();
+       i != sorted.end (); ++i)
+    {
+      os << std::setw (14) << i->second.self << std::setw (14) << i->second.total
+         << std::setw (12) << i->second.count << std::setw (10);
+      if (i->second.sinks != 0)
+        {
+          os << static_cast<double> (i->second.sinks) / i->second.count;
+        }
+      else
+        {
+          os << "-";
+        }
+      os << "  " << i->first << std::endl;
+    }
+  os << std::endl;
+  os << std::setw (14) << "time (ns)" << std::setw (12) << "events" << "  node" << std::endl;
+  for (std::map<uint32_t, FlatEntry>::const_iterator i = nodes.begin (); i != nodes.end (); ++i)
+    {
+      os << std::setw (14) << i->second.total << std::setw (12) << i->second.count
+         << "  " << GetNodeName (i->first) << std::endl;
+    }
+}
+
+void
+ProfilingSimulatorImpl::PrintFoldedStacks (std::ostream &os, const Frame *frame, std::string stack)
+{
+  for (std::map<FrameKey, Frame *>::const_iterator i = frame->children.begin ();
+       i != frame->children.end (); ++i)
+    {
+      const Frame *child = i->second;
+      std::string childStack = stack.empty () ? child->name : stack + ";" + child->name;
+      uint64_t self = child->time;
+      for (std::map<FrameKey, Frame *>::const_iterator j = child->children.begin ();
+           j != child->children.end (); ++j)
+        {
+          self -= j->second->time;
+        }
+      if (self != 0)
+        {
+          os << childStack << " " << self << std::endl;
+        }
+      PrintFoldedStacks (os, child, childStack);
+    }
+}
+
+void
+ProfilingSimulatorImpl::PrintFoldedStacks (std::ostream &os) const
+{
+  PrintFoldedStacks (os, &m_root, "");
+}
+
+void
+ProfilingSimulatorImpl::Write (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_flatProfile.empty ())
+    {
+      std::ofstream os (m_flatProfile.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << m_flatProfile);
+      PrintFlatProfile (os);
+    }
+  if (!m_foldedStacks.empty ())
+    {
+      std::ofstream os (m_foldedStacks.c_str ());
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << m_foldedStacks);
+      PrintFoldedStacks (os);
+    }
+}
+
+bool
+ProfilingSimulatorImpl::IsFinished (void) const
+{
+  return m_impl->IsFinished ();
+}
+
+void
+ProfilingSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Stop ();
+}
+
+void
+ProfilingSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  m_impl->Stop (delay);
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  return m_impl->Schedule (delay, Wrap (event));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  m_impl->ScheduleWithContext (context, delay, Wrap (event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return m_impl->ScheduleNow (Wrap (event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  return m_impl->ScheduleDestroy (Wrap (event));
+}
+
+void
+ProfilingSimulatorImpl::Remove (const EventId &id)
+{
+  m_impl->Remove (id);
+}
+
+void
+ProfilingSimulatorImpl::Cancel (const EventId &id)
+{
+  m_impl->Cancel (id);
+}
+
+bool
+ProfilingSimulatorImpl::IsExpired (const EventId &id) const
+{
+  return m_impl->IsExpired (id);
+}
+
+void
+ProfilingSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Run ();
+}
+
+Time
+ProfilingSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return m_impl->Now ();
+}
+
+Time
+ProfilingSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  return m_impl->GetDelayLeft (id);
+}
+
+Time
+ProfilingSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return m_impl->GetMaximumSimulationTime ();
+}
+
+void
+ProfilingSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_impl->SetScheduler (schedulerFactory);
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetSystemId (void) const
+{
+  return m_impl->GetSystemId ();
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetContext (void) const
+{
+  return m_impl->GetContext ();
+}
+
+} // namespace ns3
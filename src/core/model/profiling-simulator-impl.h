@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "event-impl.h"
+#include "ptr.h"
+
+#include <map>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <typeinfo>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::ProfilingSimulatorImpl.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A simulator implementation measuring the wall clock time spent
+ * in each event handler, and in each TracedCallback.
+ *
+ * This implementation forwards all the calls to another one, the
+ * DefaultSimulatorImpl by default, and wraps the scheduled events to
+ * measure them.  It is selected with
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::ProfilingSimulatorImpl"));
+ * \endcode
+ *
+ * The time and number of invocations are attributed to the function
+ * of each event, i.e., the function or the member function passed to
+ * Simulator::Schedule, to the context node of the event, and to the
+ * TracedCallbacks invoked from the handler, with the number of sinks
+ * they invoke.  The functions are named after their symbols when the
+ * dynamic linker can tell them (e.g., the functions of the ns-3
+ * libraries), and the TracedCallbacks after the trace sources they were
+ * connected through; otherwise the frames are named after the type of
+ * the event or of the TracedCallback.  At Simulator::Destroy, the
+ * profile is written to two files:
+ *  - FlatProfile: the events and the TracedCallbacks, by decreasing
+ *    self time, i.e., excluding the time of the nested TracedCallbacks,
+ *    and the time spent for each node;
+ *  - FoldedStacks: a line "node;event;tracedcallback;... time" per
+ *    call path, with the self time in nanoseconds, the input of the
+ *    flamegraph.pl script.
+ *
+ * Measuring every event and TracedCallback adds an allocation and
+ * two reads of the clock per event: this implementation is meant to
+ * find the hot spots of a simulation, not to run it fast.  It is not
+ * thread safe: the wrapped implementation must run the events in a
+ * single thread.
+ */
+class ProfilingSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  ProfilingSimulatorImpl ();
+  /** Destructor. */
+  ~ProfilingSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Print the flat profile.
+   * \param os the output stream
+   */
+  void PrintFlatProfile (std::ostream &os) const;
+  /**
+   * Print the folded stacks.
+   * \param os the output stream
+   */
+  void PrintFoldedStacks (std::ostream &os) const;
+
+private:
+  virtual void NotifyConstructionCompleted (void);
+  virtual void DoDispose (void);
+
+  friend class TracedCallbackProfiler;
+
+  /** An event wrapped to be measured. */
+  class ProfiledEvent : public EventImpl
+  {
+  public:
+    /**
+     * \param profiler the simulator measuring the event
+     * \param event the event
+     */
+    ProfiledEvent (ProfilingSimulatorImpl *profiler, EventImpl *event);
+    virtual ~ProfiledEvent ();
+  private:
+    virtual void Notify (void);
+    ProfilingSimulatorImpl *m_profiler; //!< The simulator measuring the event.
+    EventImpl *m_event;                 //!< The event.
+  };
+
+  /** The kind of a frame of the call tree. */
+  enum FrameKind
+  {
+    NODE,             //!< The events of a node.
+    EVENT,            //!< An event handler.
+    TRACED_CALLBACK   //!< The sinks of a TracedCallback.
+  };
+
+  /**
+   * The key of a frame of the call tree: the context of a node, the
+   * type and the function of an event, or the type and the address of
+   * a TracedCallback.
+   */
+  struct FrameKey
+  {
+    /**
+     * \param kind the kind of frame
+     * \param type the type of the event or of the TracedCallback
+     * \param id the function of the event, or the TracedCallback
+     * \param context the context of the node
+     */
+    FrameKey (FrameKind kind, const std::type_info *type, const void *id, uint32_t context);
+    /**
+     * \param o another key
+     * \returns true if this key is before \p o
+     */
+    bool operator < (const FrameKey &o) const;
+    FrameKind kind;               //!< The kind of frame.
+    const std::type_info *type;   //!< The type of the event or of the TracedCallback.
+    const void *id;               //!< The function of the event, or the TracedCallback.
+    uint32_t context;             //!< The context of the node.
+  };
+
+  /** A frame of the call tree. */
+  struct Frame
+  {
+    Frame ();
+    ~Frame ();
+    std::string name;                       //!< The name of the frame.
+    uint64_t count;                         //!< Number of invocations.
+    uint64_t time;                          //!< Total time, in nanoseconds.
+    uint64_t sinks;                         //!< Number of sinks invoked.
+    std::map<FrameKey, Frame *> children;   //!< The nested frames.
+  };
+
+  /** A frame being measured. */
+  struct ActiveFrame
+  {
+    Frame *frame;    //!< The frame.
+    uint64_t start;  //!< The clock when the frame was entered.
+  };
+
+  /**
+   * \param event the event to wrap
+   * \returns the wrapped event
+   */
+  EventImpl *Wrap (EventImpl *event);
+  /**
+   * Enter a frame nested in the current one.
+   * \param key the key of the frame
+   * \param start the clock
+   * \returns the frame
+   */
+  Frame *Enter (FrameKey key, uint64_t start);
+  /**
+   * Leave the current frame.
+   * \param end the clock
+   */
+  void Exit (uint64_t end);
+  /**
+   * The name of a frame: the node, the function of an event, or the
+   * trace source of a TracedCallback.  When the function or the trace
+   * source is not known, the name is the type of the event or of the
+   * TracedCallback, and the address of the function of the event.
+   *
+   * \param key a frame key
+   * \returns the name of the frame
+   */
+  static std::string GetName (const FrameKey &key);
+  /**
+   * \param context a context
+   * \returns the name of the node frames of the context
+   */
+  static std::string GetNodeName (uint32_t context);
+  /**
+   * Print the folded stacks of a frame and its nested frames.
+   * \param os the output stream
+   * \param frame the frame
+   * \param stack the names of the enclosing frames
+   */
+  static void PrintFoldedStacks (std::ostream &os, const Frame *frame, std::string stack);
+  /** Write the profile to the files. */
+  void Write (void) const;
+
+  std::string m_implementation;       //!< The Implementation attribute.
+  std::string m_flatProfile;          //!< The FlatProfile attribute.
+  std::string m_foldedStacks;         //!< The FoldedStacks attribute.
+  Ptr<SimulatorImpl> m_impl;          //!< The wrapped implementation.
+  Frame m_root;                       //!< The root of the call tree.
+  std::vector<ActiveFrame> m_stack;   //!< The frames being measured.
+};
+
+} // namespace ns3
+
+#endif /* PROFILING_SIMULATOR_IMPL_H */
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator-profiler.h"
+#include "event-impl.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <typeinfo>
+#include <algorithm>
+#include <iomanip>
+#ifdef HAVE_RT
+#include <time.h>
+#else
+#include <sys/time.h>
+#endif
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::SimulatorProfiler.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulatorProfiler");
+
+namespace {
+
+/** Order the types of events. */
+struct TypeInfoLess
+{
+  /**
+   * \param a a type
+   * \param b another type
+   * \returns true if \p a is before \p b
+   */
+  bool operator () (const std::type_info *a, const std::type_info *b) const
+  {
+    return a->before (*b);
+  }
+};
+
+/** The handler statistics, by type of event. */
+typedef std::map<const std::type_info *, SimulatorProfiler::HandlerStats, TypeInfoLess> TypeStatsMap;
+
+bool g_enabled = false;     //!< true if the events are profiled.
+uint64_t g_events = 0;      //!< Number of events.
+uint64_t g_batches = 0;     //!< Number of batches.
+uint64_t g_runTime = 0;     //!< Wall clock time in Run, in nanoseconds.
+TypeStatsMap g_types;       //!< The handler statistics.
+
+/**
+ * \param mangled a mangled type name
+ * \returns the demangled name
+ */
+std::string
+Demangle (const char *mangled)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      std::string name = demangled;
+      std::free (demangled);
+      return name;
+    }
+#endif
+  return mangled;
+}
+
+/**
+ * Order the handler statistics by decreasing total time.
+ * \param a a handler
+ * \param b another handler
+ * \returns true if \p a took more time than \p b
+ */
+bool
+MoreTime (const std::pair<std::string, SimulatorProfiler::HandlerStats> &a,
+          const std::pair<std::string, SimulatorProfiler::HandlerStats> &b)
+{
+  return a.second.time > b.second.time;
+}
+
+} // anonymous namespace
+
+SimulatorProfiler::HandlerStats::HandlerStats ()
+  : count (0),
+    time (0)
+{
+}
+
+void
+SimulatorProfiler::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_enabled = true;
+}
+
+void
+SimulatorProfiler::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_enabled = false;
+}
+
+bool
+SimulatorProfiler::IsEnabled (void)
+{
+  return g_enabled;
+}
+
+void
+SimulatorProfiler::Reset (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_events = 0;
+  g_batches = 0;
+  g_runTime = 0;
+  g_types.clear ();
+}
+
+uint64_t
+SimulatorProfiler::GetEvents (void)
+{
+  return g_events;
+}
+
+uint64_t
+SimulatorProfiler::GetBatches (void)
+{
+  return g_batches;
+}
+
+double
+SimulatorProfiler::GetMeanBatchSize (void)
+{
+  return g_batches == 0 ? 0 : static_cast<double> (g_events) / g_batches;
+}
+
+double
+SimulatorProfiler::GetEventsPerSecond (void)
+{
+  return g_runTime == 0 ? 0 : g_events * 1e9 / g_runTime;
+}
+
+SimulatorProfiler::HandlerStatsMap
+SimulatorProfiler::GetHandlerStats (void)
+{
+  // the same type may have several type_info objects, one per library
+  HandlerStatsMap stats;
+  for (TypeStatsMap::const_iterator i = g_types.begin (); i != g_types.end (); ++i)
+    {
+      HandlerStats &handler = stats[Demangle (i->first->name ())];
+      handler.count += i->second.count;
+      handler.time += i->second.time;
+      if (handler.histogram.size () < i->second.histogram.size ())
+        {
+          handler.histogram.resize (i->second.histogram.size (), 0);
+        }
+      for (uint32_t j = 0; j < i->second.histogram.size (); j++)
+        {
+          handler.histogram[j] += i->second.histogram[j];
+        }
+    }
+  return stats;
+}
+
+void
+SimulatorProfiler::Print (std::ostream &os)
+{
+  os << "events " << g_events
+     << ", batches " << g_batches
+     << ", mean batch size " << GetMeanBatchSize ()
+     << ", events/s " << GetEventsPerSecond () << std::endl;
+  HandlerStatsMap stats = GetHandlerStats ();
+  std::vector<std::pair<std::string, HandlerStats> > handlers (stats.begin (), stats.end ());
+  std::stable_sort (handlers.begin (), handlers.end (), MoreTime);
+  for (std::vector<std::pair<std::string, HandlerStats> >::const_iterator i = handlers.begin ();
+       i != handlers.end (); ++i)
+    {
+      const HandlerStats &handler = i->second;
+      os << std::setw (12) << handler.time << " ns "
+         << std::setw (10) << handler.count << " events "
+         << std::setw (10) << handler.time / handler.count << " ns/event  "
+         << i->first << std::endl;
+      os << "  histogram:";
+      for (uint32_t j = 0; j < handler.histogram.size (); j++)
+        {
+          if (handler.histogram[j] != 0)
+            {
+              os << " <" << (static_cast<uint64_t> (1) << j) << "ns:" << handler.histogram[j];
+            }
+        }
+      os << std::endl;
+    }
+}
+
+uint64_t
+SimulatorProfiler::GetClock (void)
+{
+#ifdef HAVE_RT
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t> (ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return static_cast<uint64_t> (tv.tv_sec) * 1000000000 + tv.tv_usec * 1000;
+#endif
+}
+
+uint64_t
+SimulatorProfiler::RecordEvent (const EventImpl *event, uint64_t start)
+{
+  uint64_t end = GetClock ();
+  uint64_t time = end - start;
+  HandlerStats &handler = g_types[&typeid (*event)];
+  handler.count++;
+  handler.time += time;
+  uint32_t bucket = 0;
+  while (time != 0)
+    {
+      time >>= 1;
+      bucket++;
+    }
+  if (handler.histogram.size () <= bucket)
+    {
+      handler.histogram.resize (bucket + 1, 0);
+    }
+  handler.histogram[bucket]++;
+  g_events++;
+  return end;
+}
+
+void
+SimulatorProfiler::RecordBatch (void)
+{
+  g_batches++;
+}
+
+void
+SimulatorProfiler::RecordRun (uint64_t start)
+{
+  g_runTime += GetClock () - start;
+}
+
+} // namespace ns3
@@ -22,6 +22,8 @@
 #define TRACED_CALLBACK_H
 
 #include <list>
+#include <string>
+#include <typeinfo>
 #include "callback.h"
 
 /**
@@ -32,6 +34,81 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup tracing
+ * \brief Measure an invocation of a TracedCallback, for the
+ * ProfilingSimulatorImpl.
+ *
+ * The invocations of the TracedCallbacks with sinks are measured from
+ * the construction to the destruction of this object, when the
+ * ProfilingSimulatorImpl is in use.  The invocations are attributed to
+ * each TracedCallback, named after the trace source it was connected
+ * through by ObjectBase::TraceConnect or
+ * ObjectBase::TraceConnectWithoutContext.
+ */
+class TracedCallbackProfiler
+{
+public:
+  /**
+   * \tparam L \deduced The type of the list of sinks.
+   * \param [in] type The type of the TracedCallback.
+   * \param [in] source The TracedCallback.
+   * \param [in] sinks The sinks invoked.
+   */
+  template <typename L>
+  TracedCallbackProfiler (const std::type_info &type, const void *source, const L &sinks)
+    : m_enabled (g_enabled && !sinks.empty ())
+  {
+    if (m_enabled)
+      {
+        Enter (type, source, sinks.size ());
+      }
+  }
+  ~TracedCallbackProfiler ()
+  {
+    if (m_enabled)
+      {
+        Exit ();
+      }
+  }
+  /**
+   * \param [in] enabled Whether the invocations are measured.
+   */
+  static void Enable (bool enabled);
+  /**
+   * Set the name of the trace source being connected.
+   * \param [in] name The name of the trace source, empty once connected.
+   */
+  static void SetConnectingName (std::string name);
+  /**
+   * Name a TracedCallback after the trace source being connected, if any.
+   * \param [in] source The TracedCallback.
+   */
+  static void NotifyConnected (const void *source);
+  /**
+   * \param [in] source A TracedCallback.
+   * \returns The name of the trace source of the TracedCallback, empty
+   *          if it is not known.
+   */
+  static std::string GetSourceName (const void *source);
+
+private:
+  /**
+   * Start the measure of an invocation.
+   * \param [in] type The type of the TracedCallback.
+   * \param [in] source The TracedCallback.
+   * \param [in] sinks The number of sinks invoked.
+   */
+  static void Enter (const std::type_info &type, const void *source, std::size_t sinks);
+  /** End the measure of an invocation. */
+  static void Exit (void);
+
+  /** Whether the invocations are measured. */
+  static bool g_enabled;
+  /** Whether this invocation is measured. */
+  bool m_enabled;
+};
+
 /**
  * \ingroup tracing
  * \brief Forward calls to a chain of Callback
@@ -267,6 +344,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
   m_callbackList.push_back (cb);
+  TracedCallbackProfiler::NotifyConnected (this);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -321,6 +399,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -334,6 +413,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -347,6 +427,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -360,6 +441,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -373,6 +455,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -386,6 +469,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -399,6 +483,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -412,6 +497,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -425,6 +511,7 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
+  TracedCallbackProfiler profiler (typeid (*this), this, m_callbackList);
   for (typename CallbackList::const_iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
@@ -17,14 +17,20 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/core-config.h"
 #include "log.h"  // NS_ASSERT and NS_LOG
 #include "hash.h"
 #include "type-id.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
+#include "string.h"
+#include "system-mutex.h"
 
 #include <map>
 #include <vector>
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
 #include <sstream>
 #include <iomanip>
 
@@ -51,7 +57,14 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * \brief TypeId information manager
  *
  * Information records are stored in a vector.  Name and hash lookup
- * are performed by maps to the vector index.
+ * are performed by maps to the vector index.  Name lookup hashes the
+ * name and goes through the hash index, verifying the stored name,
+ * so both lookups share a single integer-keyed map.
+ *
+ * Each record also keeps hash indexes of its own attribute and
+ * trace source names, built as they are registered, so the
+ * by-name lookups performed on every Object construction and
+ * Config path resolution do not scan the information vectors.
  *
  * \internal
  * <b>Hash Chaining</b>
@@ -262,6 +275,31 @@ public:
    * \returns \c true if this TypeId should be hidden from the user.
    */
   bool MustHideFromDocumentation (uint16_t uid) const;
+  /**
+   * Find an Attribute by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] info The information record of the Attribute.
+   * \returns \c true if the Attribute was found.
+   */
+  bool LookupAttributeByName (uint16_t uid, std::string name,
+                              struct TypeId::AttributeInformation *info) const;
+  /**
+   * Find a TraceSource by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \returns The TraceSource accessor, or zero if not found.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSourceByName (uint16_t uid,
+                                                          std::string name) const;
+  /**
+   * Get the value used to initialize an Attribute at construction.
+   * \param [in] uid The id.
+   * \param [in] i The attribute index.
+   * \returns The construction-time default of the attribute, owned by
+   *          the cache.
+   */
+  const AttributeValue * GetAttributeDefault (uint16_t uid, uint32_t i) const;
 
 private:
   /**
@@ -285,6 +323,9 @@ private:
    */
   static TypeId::hash_t Hasher (const std::string name);
 
+  /** Type of the per-type attribute and trace source name indexes. */
+  typedef std::multimap<TypeId::hash_t, uint32_t> nameindex_t;
+
   /** The information record about a single type id. */
   struct IidInformation {
     /** The type id name. */
@@ -307,6 +348,14 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** Attribute name hash to index in \c attributes. */
+    nameindex_t attributeIndex;
+    /** TraceSource name hash to index in \c traceSources. */
+    nameindex_t traceSourceIndex;
+    /** \c true if \c attributeDefaults is up to date. */
+    bool attributeDefaultsValid;
+    /** Cached construction-time default for each of \c attributes. */
+    std::vector<Ptr<const AttributeValue> > attributeDefaults;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -317,15 +366,48 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  /**
+   * Find an Attribute in the own attributes of a type.
+   * \param [in] information The information record of the type.
+   * \param [in] hash The hashed Attribute name.
+   * \param [in] name The Attribute name.
+   * \returns The index of the Attribute, or -1 if not found.
+   */
+  static int32_t FindAttribute (const struct IidInformation *information,
+                                TypeId::hash_t hash, const std::string &name);
+  /**
+   * Find a TraceSource in the own trace sources of a type.
+   * \param [in] information The information record of the type.
+   * \param [in] hash The hashed TraceSource name.
+   * \param [in] name The TraceSource name.
+   * \returns The index of the TraceSource, or -1 if not found.
+   */
+  static int32_t FindTraceSource (const struct IidInformation *information,
+                                  TypeId::hash_t hash, const std::string &name);
+  /**
+   * Get the value of an Attribute in the NS_ATTRIBUTE_DEFAULT
+   * environment variable.
+   *
+   * The environment variable is parsed once, on first use.  As when
+   * it was parsed at each object construction, the first value set
+   * for \p fullName which \p checker accepts is used.
+   * \param [in] fullName The full name of the Attribute.
+   * \param [in] checker The checker of the Attribute.
+   * \returns The value of the Attribute, or 0 if the environment
+   *          variable sets no valid value for \p fullName.
+   */
+  static Ptr<const AttributeValue> GetEnvironmentDefault (const std::string &fullName,
+                                                          Ptr<const AttributeChecker> checker);
+  /**
+   * Get the mutex guarding the lazily built attribute defaults, which
+   * objects constructed by concurrent simulation partitions share.
+   * \returns The mutex.
+   */
+  static SystemMutex & GetDefaultsMutex (void);
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
 
-  /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
-  /** The by-name index. */
-  namemap_t m_namemap;
-
   /** Type of the by-hash index. */
   typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
   /** The by-hash index. */
@@ -348,8 +430,10 @@ private:
 TypeId::hash_t
 IidManager::Hasher (const std::string name)
 {
-  static ns3::Hasher hasher ( Create<Hash::Function::Murmur3> () );
-  return hasher.clear ().GetHash32 (name);
+  // A hasher per call: a shared one would not be safe to use from
+  // concurrent simulation partitions.
+  Hash::Function::Murmur3 hasher;
+  return hasher.GetHash32 (name.c_str (), name.size ());
 }
   
 uint16_t
@@ -357,7 +441,7 @@ IidManager::AllocateUid (std::string name)
 {
   NS_LOG_FUNCTION (this << name);
   // Type names are definitive: equal names are equal types
-  NS_ASSERT_MSG (m_namemap.count (name) == 0,
+  NS_ASSERT_MSG (GetUid (name) == 0,
                  "Trying to allocate twice the same uid: " << name);
   
   TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
@@ -413,12 +497,11 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.attributeDefaultsValid = false;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
 
-  // Add to both maps:
-  m_namemap.insert (std::make_pair (name, uid));
   m_hashmap.insert (std::make_pair (hash, uid));
   return uid;
 }
@@ -478,15 +561,19 @@ uint16_t
 IidManager::GetUid (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  namemap_t::const_iterator it = m_namemap.find (name);
-  if (it != m_namemap.end ())
+  TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
+  // The name may be found under its own hash, or chained
+  uint16_t uid = GetUid (hash);
+  if (uid != 0 && m_information[uid-1].name == name)
     {
-      return it->second;
+      return uid;
     }
-  else
+  uid = GetUid (hash | HashChainFlag);
+  if (uid != 0 && m_information[uid-1].name == name)
     {
-      return 0;
+      return uid;
     }
+  return 0;
 }
 uint16_t 
 IidManager::GetUid (TypeId::hash_t hash) const
@@ -570,21 +657,54 @@ IidManager::GetRegistered (uint32_t i) const
   return i + 1;
 }
 
+//static
+int32_t
+IidManager::FindAttribute (const struct IidInformation *information,
+                           TypeId::hash_t hash, const std::string &name)
+{
+  std::pair<nameindex_t::const_iterator, nameindex_t::const_iterator> range =
+    information->attributeIndex.equal_range (hash);
+  for (nameindex_t::const_iterator i = range.first; i != range.second; ++i)
+    {
+      if (information->attributes[i->second].name == name)
+        {
+          return i->second;
+        }
+    }
+  return -1;
+}
+
+//static
+int32_t
+IidManager::FindTraceSource (const struct IidInformation *information,
+                             TypeId::hash_t hash, const std::string &name)
+{
+  std::pair<nameindex_t::const_iterator, nameindex_t::const_iterator> range =
+    information->traceSourceIndex.equal_range (hash);
+  for (nameindex_t::const_iterator i = range.first; i != range.second; ++i)
+    {
+      if (information->traceSources[i->second].name == name)
+        {
+          return i->second;
+        }
+    }
+  return -1;
+}
+
 bool
-IidManager::HasAttribute (uint16_t uid,
-                          std::string name)
+IidManager::LookupAttributeByName (uint16_t uid, std::string name,
+                                   struct TypeId::AttributeInformation *info) const
 {
-  NS_LOG_FUNCTION (this << uid << name);
+  NS_LOG_FUNCTION (this << uid << name << info);
+  TypeId::hash_t hash = Hasher (name);
   struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
+      int32_t i = FindAttribute (information, hash, name);
+      if (i >= 0)
         {
-          if (i->name == name)
-            {
-              return true;
-            }
+          *info = information->attributes[i];
+          return true;
         }
       struct IidInformation *parent = LookupInformation (information->parent);
       if (parent == information)
@@ -598,6 +718,15 @@ IidManager::HasAttribute (uint16_t uid,
   return false;
 }
 
+bool
+IidManager::HasAttribute (uint16_t uid,
+                          std::string name)
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct TypeId::AttributeInformation info;
+  return LookupAttributeByName (uid, name, &info);
+}
+
 void 
 IidManager::AddAttribute (uint16_t uid, 
                           std::string name,
@@ -622,7 +751,10 @@ IidManager::AddAttribute (uint16_t uid,
   info.originalInitialValue = initialValue;
   info.accessor = accessor;
   info.checker = checker;
+  information->attributeIndex.insert (std::make_pair (Hasher (name),
+                                                      information->attributes.size ()));
   information->attributes.push_back (info);
+  information->attributeDefaultsValid = false;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -632,7 +764,9 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
   NS_LOG_FUNCTION (this << uid << i << initialValue);
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
+  CriticalSection cs (GetDefaultsMutex ());
   information->attributes[i].initialValue = initialValue;
+  information->attributeDefaultsValid = false;
 }
 
 
@@ -653,32 +787,127 @@ IidManager::GetAttribute(uint16_t uid, uint32_t i) const
   return information->attributes[i];
 }
 
-bool
-IidManager::HasTraceSource (uint16_t uid,
-                            std::string name)
+//static
+SystemMutex &
+IidManager::GetDefaultsMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+
+//static
+Ptr<const AttributeValue>
+IidManager::GetEnvironmentDefault (const std::string &fullName,
+                                   Ptr<const AttributeChecker> checker)
+{
+  // all the values of each name, in the order of the environment variable
+  static std::map<std::string, std::vector<std::string> > defaults;
+  static bool parsed = false;
+  if (!parsed)
+    {
+      parsed = true;
+#ifdef HAVE_GETENV
+      char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+      if (envVar != 0)
+        {
+          std::string env = std::string (envVar);
+          std::string::size_type cur = 0;
+          std::string::size_type next = 0;
+          while (next != std::string::npos)
+            {
+              next = env.find (";", cur);
+              std::string tmp = std::string (env, cur, next-cur);
+              std::string::size_type equal = tmp.find ("=");
+              if (equal != std::string::npos)
+                {
+                  std::string name = tmp.substr (0, equal);
+                  std::string v = tmp.substr (equal+1, tmp.size () - equal - 1);
+                  defaults[name].push_back (v);
+                }
+              cur = next + 1;
+            }
+        }
+#endif /* HAVE_GETENV */
+    }
+  std::map<std::string, std::vector<std::string> >::const_iterator it = defaults.find (fullName);
+  if (it == defaults.end ())
+    {
+      return 0;
+    }
+  // an invalid value does not hide a later valid one
+  for (std::vector<std::string>::const_iterator v = it->second.begin ();
+       v != it->second.end (); ++v)
+    {
+      Ptr<const AttributeValue> value = checker->CreateValidValue (StringValue (*v));
+      if (value != 0)
+        {
+          return value;
+        }
+    }
+  return 0;
+}
+
+const AttributeValue *
+IidManager::GetAttributeDefault (uint16_t uid, uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << uid << i);
+  struct IidInformation *information = LookupInformation (uid);
+  NS_ASSERT (i < information->attributes.size ());
+  CriticalSection cs (GetDefaultsMutex ());
+  if (!information->attributeDefaultsValid)
+    {
+      information->attributeDefaults.clear ();
+      for (std::vector<struct TypeId::AttributeInformation>::const_iterator j = information->attributes.begin ();
+           j != information->attributes.end (); ++j)
+        {
+          Ptr<const AttributeValue> value = j->initialValue;
+          Ptr<const AttributeValue> v = GetEnvironmentDefault (information->name + "::" + j->name,
+                                                               j->checker);
+          if (v != 0)
+            {
+              NS_LOG_DEBUG ("default of \"" << information->name << "::" <<
+                            j->name << "\" from env var");
+              value = v;
+            }
+          information->attributeDefaults.push_back (value);
+        }
+      information->attributeDefaultsValid = true;
+    }
+  // a Ptr would be unreferenced out of the lock
+  return PeekPointer (information->attributeDefaults[i]);
+}
+
+Ptr<const TraceSourceAccessor>
+IidManager::LookupTraceSourceByName (uint16_t uid, std::string name) const
 {
   NS_LOG_FUNCTION (this << uid << name);
+  TypeId::hash_t hash = Hasher (name);
   struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
-           i != information->traceSources.end (); ++i)
+      int32_t i = FindTraceSource (information, hash, name);
+      if (i >= 0)
         {
-          if (i->name == name)
-            {
-              return true;
-            }
+          return information->traceSources[i].accessor;
         }
       struct IidInformation *parent = LookupInformation (information->parent);
       if (parent == information)
         {
           // top of inheritance tree
-          return false;
+          return 0;
         }
       // check parent
       information = parent;
     }
-  return false;
+  return 0;
+}
+
+bool
+IidManager::HasTraceSource (uint16_t uid,
+                            std::string name)
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  return LookupTraceSourceByName (uid, name) != 0;
 }
 
 void 
@@ -700,6 +929,8 @@ IidManager::AddTraceSource (uint16_t uid,
   source.help = help;
   source.accessor = accessor;
   source.callback = callback;
+  information->traceSourceIndex.insert (std::make_pair (Hasher (name),
+                                                        information->traceSources.size ()));
   information->traceSources.push_back (source);
 }
 uint32_t 
@@ -804,22 +1035,7 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return IidManager::Get ()->LookupAttributeByName (m_tid, name, info);
 }
 
 TypeId 
@@ -977,6 +1193,12 @@ TypeId::GetAttribute(uint32_t i) const
   NS_LOG_FUNCTION (this << i);
   return IidManager::Get ()->GetAttribute(m_tid, i);
 }
+const AttributeValue *
+TypeId::GetAttributeDefault (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  return IidManager::Get ()->GetAttributeDefault (m_tid, i);
+}
 std::string 
 TypeId::GetAttributeFullName (uint32_t i) const
 {
@@ -1030,21 +1252,7 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return IidManager::Get ()->LookupTraceSourceByName (m_tid, name);
 }
 
 uint16_t 
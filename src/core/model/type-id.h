@@ -247,6 +247,24 @@ public:
    * \returns The full name associated to the attribute whose index is \p i.
    */
   std::string GetAttributeFullName (uint32_t i) const;
+  /**
+   * Get the value used to initialize an Attribute at construction time.
+   *
+   * This is the value set for the attribute in the NS_ATTRIBUTE_DEFAULT
+   * environment variable, if any, otherwise the initial value,
+   * as changed by SetAttributeInitialValue().  The result is cached
+   * per TypeId, so construction does not parse values again.
+   *
+   * The value is owned by the cache, and is not reference counted on
+   * return, so that concurrent simulation partitions may construct
+   * objects of the same TypeId.  It remains valid until the next
+   * AddAttribute() or SetAttributeInitialValue() on this TypeId.
+   *
+   * \param [in] i Index into attribute array
+   * \returns The construction-time default of the attribute
+   *          whose index is \p i.
+   */
+  const AttributeValue * GetAttributeDefault (uint32_t i) const;
 
   /**
    * Get the constructor callback.
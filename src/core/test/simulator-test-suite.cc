@@ -23,6 +23,17 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/simulator-profiler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/profiling-simulator-impl.h"
+#include "ns3/traced-callback.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/object.h"
+#include "ns3/string.h"
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +470,227 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  SimulatorBatchTestCase (bool batch);
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t id);
+  bool m_batch;
+  std::vector<uint32_t> m_events;
+  EventId m_removed;
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase (bool batch)
+  : TestCase (batch ? "Check the batches of events with the same timestamp and context" :
+              "Check the events without batches"),
+    m_batch (batch)
+{
+}
+
+void
+SimulatorBatchTestCase::Event (uint32_t id)
+{
+  m_events.push_back (id);
+  if (id == 1)
+    {
+      // runs in the batch, after the events already scheduled
+      Simulator::ScheduleNow (&SimulatorBatchTestCase::Event, this, 4);
+      // removes an event of the batch
+      Simulator::Remove (m_removed);
+    }
+  else if (id == 5)
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::BatchEvents", BooleanValue (m_batch));
+  SimulatorProfiler::Reset ();
+  SimulatorProfiler::Enable ();
+
+  // a batch of events 1, 2, 3 and 4 without the removed event, then a
+  // batch of 5 and 6 stopped by 5, then 7 in another context
+  Simulator::ScheduleWithContext (1, Seconds (1), &SimulatorBatchTestCase::Event, this, 1);
+  Simulator::ScheduleWithContext (1, Seconds (1), &SimulatorBatchTestCase::Event, this, 2);
+  Simulator::ScheduleWithContext (1, Seconds (1), &SimulatorBatchTestCase::Event, this, 3);
+  m_removed = Simulator::Schedule (Seconds (1), &SimulatorBatchTestCase::Event, this, 0);
+  Simulator::ScheduleWithContext (2, Seconds (2), &SimulatorBatchTestCase::Event, this, 5);
+  Simulator::ScheduleWithContext (2, Seconds (2), &SimulatorBatchTestCase::Event, this, 6);
+  Simulator::ScheduleWithContext (3, Seconds (2), &SimulatorBatchTestCase::Event, this, 7);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_events.size (), 5, "Unexpected number of events before Stop");
+  Simulator::Run ();
+  SimulatorProfiler::Disable ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), 7, "Unexpected number of events");
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_events[i], i + 1, "Unexpected event " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (SimulatorProfiler::GetEvents (), 7, "Unexpected number of profiled events");
+  uint64_t batches = m_batch ? 4 : 7;
+  NS_TEST_EXPECT_MSG_EQ (SimulatorProfiler::GetBatches (), batches, "Unexpected number of batches");
+  SimulatorProfiler::HandlerStatsMap stats = SimulatorProfiler::GetHandlerStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 1, "The events should have the same type");
+  NS_TEST_EXPECT_MSG_EQ (stats.begin ()->second.count, 7, "Unexpected number of handler runs");
+  SimulatorProfiler::Reset ();
+
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+/** An object with two trace sources of the same signature. */
+class ProfilingTestObject : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  TracedCallback<uint32_t> m_first;
+  TracedCallback<uint32_t> m_second;
+};
+
+TypeId
+ProfilingTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingTestObject")
+    .SetParent<Object> ()
+    .AddConstructor<ProfilingTestObject> ()
+    .AddTraceSource ("First", "The first trace source",
+                     MakeTraceSourceAccessor (&ProfilingTestObject::m_first),
+                     "ns3::ProfilingTestObject::TracedCallback")
+    .AddTraceSource ("Second", "The second trace source",
+                     MakeTraceSourceAccessor (&ProfilingTestObject::m_second),
+                     "ns3::ProfilingTestObject::TracedCallback")
+  ;
+  return tid;
+}
+
+class ProfilingSimulatorImplTestCase : public TestCase
+{
+public:
+  ProfilingSimulatorImplTestCase ();
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t n);
+  void OtherEvent (uint32_t n);
+  void Sink (uint32_t n);
+  void OtherSink (uint32_t n);
+  TracedCallback<uint32_t> m_trace;
+  Ptr<ProfilingTestObject> m_object;
+  uint32_t m_sinks;
+  uint32_t m_otherSinks;
+};
+
+ProfilingSimulatorImplTestCase::ProfilingSimulatorImplTestCase ()
+  : TestCase ("Check the profile of the ProfilingSimulatorImpl")
+{
+}
+
+void
+ProfilingSimulatorImplTestCase::Event (uint32_t n)
+{
+  m_trace (n);
+}
+
+void
+ProfilingSimulatorImplTestCase::OtherEvent (uint32_t n)
+{
+  m_object->m_first (n);
+  m_object->m_second (n);
+}
+
+void
+ProfilingSimulatorImplTestCase::Sink (uint32_t n)
+{
+  m_sinks++;
+}
+
+void
+ProfilingSimulatorImplTestCase::OtherSink (uint32_t n)
+{
+  m_otherSinks++;
+}
+
+void
+ProfilingSimulatorImplTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::ProfilingSimulatorImpl");
+  factory.Set ("FlatProfile", StringValue (""));
+  factory.Set ("FoldedStacks", StringValue (""));
+  Ptr<ProfilingSimulatorImpl> impl = factory.Create<ProfilingSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  m_sinks = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&ProfilingSimulatorImplTestCase::Sink, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&ProfilingSimulatorImplTestCase::Sink, this));
+  Simulator::ScheduleWithContext (1, Seconds (1), &ProfilingSimulatorImplTestCase::Event, this, 1);
+  Simulator::ScheduleWithContext (1, Seconds (2), &ProfilingSimulatorImplTestCase::Event, this, 2);
+  Simulator::ScheduleWithContext (2, Seconds (3), &ProfilingSimulatorImplTestCase::Event, this, 3);
+  // a member function of the same signature, and trace sources of the
+  // same type, must get their own frames
+  m_otherSinks = 0;
+  m_object = CreateObject<ProfilingTestObject> ();
+  m_object->TraceConnectWithoutContext ("First", MakeCallback (&ProfilingSimulatorImplTestCase::OtherSink, this));
+  m_object->TraceConnectWithoutContext ("Second", MakeCallback (&ProfilingSimulatorImplTestCase::OtherSink, this));
+  Simulator::ScheduleWithContext (2, Seconds (3), &ProfilingSimulatorImplTestCase::OtherEvent, this, 3);
+  EventId cancelled = Simulator::Schedule (Seconds (4), &ProfilingSimulatorImplTestCase::Event, this, 4);
+  Simulator::Cancel (cancelled);
+  NS_TEST_EXPECT_MSG_EQ (cancelled.IsExpired (), true, "The cancelled event should be expired");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sinks, 6, "Unexpected number of sink invocations");
+  NS_TEST_EXPECT_MSG_EQ (m_otherSinks, 2, "Unexpected number of sink invocations");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (4), "Unexpected time after Run");
+
+  std::ostringstream folded;
+  impl->PrintFoldedStacks (folded);
+  std::istringstream lines (folded.str ());
+  std::string line;
+  uint32_t traceLines = 0;
+  bool node1 = false;
+  bool node2 = false;
+  while (std::getline (lines, line))
+    {
+      // node;event;tracedcallback time
+      if (line.find ("TracedCallback") != std::string::npos)
+        {
+          traceLines++;
+        }
+      node1 = node1 || line.compare (0, 7, "node 1;") == 0;
+      node2 = node2 || line.compare (0, 7, "node 2;") == 0;
+    }
+  NS_TEST_EXPECT_MSG_EQ (node1 && node2, true, "Missing node stacks in\n" << folded.str ());
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (traceLines, 2, "Unexpected TracedCallback stacks in\n" << folded.str ());
+
+  std::ostringstream flat;
+  impl->PrintFlatProfile (flat);
+  NS_TEST_EXPECT_MSG_NE (flat.str ().find ("ProfilingSimulatorImplTestCase"), std::string::npos,
+                         "Missing event in\n" << flat.str ());
+  NS_TEST_EXPECT_MSG_NE (flat.str ().find ("TracedCallback<unsigned int"), std::string::npos,
+                         "Missing TracedCallback in\n" << flat.str ());
+  NS_TEST_EXPECT_MSG_NE (flat.str ().find ("ns3::ProfilingTestObject::First"), std::string::npos,
+                         "Missing trace source in\n" << flat.str ());
+  NS_TEST_EXPECT_MSG_NE (flat.str ().find ("ns3::ProfilingTestObject::Second"), std::string::npos,
+                         "Missing trace source in\n" << flat.str ());
+  std::istringstream flatLines (flat.str ());
+  uint32_t eventLines = 0;
+  while (std::getline (flatLines, line))
+    {
+      if (line.find ("ProfilingSimulatorImplTestCase") != std::string::npos)
+        {
+          eventLines++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (eventLines, 2, "Event and OtherEvent not told apart in\n" << flat.str ());
+  m_object = 0;
+
+  Simulator::Destroy ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +707,8 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (true), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (false), TestCase::QUICK);
+    AddTestCase (new ProfilingSimulatorImplTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
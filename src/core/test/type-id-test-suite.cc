@@ -25,6 +25,11 @@
 #include "ns3/type-id.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
+#include "ns3/object.h"
+#include "ns3/integer.h"
+#include "ns3/traced-callback.h"
+#include "ns3/config.h"
+#include "ns3/object-factory.h"
 
 using namespace std;
 
@@ -180,6 +185,17 @@ CollisionTestCase::DoRun (void)
                           "Second and lesser TypeId has HashChainFlag set");
   cout << suite << "collision: second,lesser not chained: OK" << endl;
 
+  // Check that name lookup finds chained and unchained types
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t1Name), t1,
+                         "Lookup of unchained TypeId by name failed");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t2Name), t2,
+                         "Lookup of chained TypeId by name failed");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t3Name), t3,
+                         "Lookup of chained TypeId by name failed");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t4Name), t4,
+                         "Lookup of unchained TypeId by name failed");
+  cout << suite << "collision: lookup by name: OK" << endl;
+
   /** TODO Extra credit:  register three types whose hashes collide
    *
    *  None found in /usr/share/dict/web2
@@ -188,6 +204,108 @@ CollisionTestCase::DoRun (void)
 }
   
   
+//----------------------------
+//
+// Attribute and trace source lookup test
+
+class LookupParent : public Object
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("LookupParent")
+      .SetParent<Object> ()
+      .AddConstructor<LookupParent> ()
+      .AddAttribute ("ParentValue", "An attribute of the parent.",
+                     IntegerValue (1),
+                     MakeIntegerAccessor (&LookupParent::m_parentValue),
+                     MakeIntegerChecker<int32_t> ())
+      .AddTraceSource ("ParentTrace", "A trace source of the parent.",
+                       MakeTraceSourceAccessor (&LookupParent::m_parentTrace),
+                       "ns3::TracedValue::Int32Callback")
+      ;
+    return tid;
+  }
+  int32_t m_parentValue;
+  TracedCallback<int32_t> m_parentTrace;
+};
+
+class LookupChild : public LookupParent
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("LookupChild")
+      .SetParent<LookupParent> ()
+      .AddConstructor<LookupChild> ()
+      .AddAttribute ("ChildValue", "An attribute of the child.",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&LookupChild::m_childValue),
+                     MakeIntegerChecker<int32_t> ())
+      ;
+    return tid;
+  }
+  int32_t m_childValue;
+};
+
+class LookupByNameTestCase : public TestCase
+{
+public:
+  LookupByNameTestCase ();
+  virtual ~LookupByNameTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LookupByNameTestCase::LookupByNameTestCase ()
+  : TestCase ("Check attribute and trace source lookup by name")
+{
+}
+
+LookupByNameTestCase::~LookupByNameTestCase ()
+{
+}
+
+void
+LookupByNameTestCase::DoRun (void)
+{
+  TypeId tid = LookupChild::GetTypeId ();
+  struct TypeId::AttributeInformation info;
+
+  bool found = tid.LookupAttributeByName ("ChildValue", &info);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Own attribute not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "ChildValue", "Wrong attribute found");
+
+  found = tid.LookupAttributeByName ("ParentValue", &info);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Inherited attribute not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "ParentValue", "Wrong attribute found");
+
+  found = tid.LookupAttributeByName ("NoSuchValue", &info);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Unknown attribute found");
+
+  NS_TEST_ASSERT_MSG_NE (tid.LookupTraceSourceByName ("ParentTrace"), 0,
+                         "Inherited trace source not found");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupTraceSourceByName ("NoSuchTrace"), 0,
+                         "Unknown trace source found");
+
+  // The cached construction defaults must follow Config::SetDefault
+  Ptr<LookupChild> a = CreateObject<LookupChild> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_childValue, 2, "Wrong initial value");
+  NS_TEST_ASSERT_MSG_EQ (a->m_parentValue, 1, "Wrong initial value");
+  Config::SetDefault ("LookupChild::ChildValue", IntegerValue (3));
+  Config::SetDefault ("LookupParent::ParentValue", IntegerValue (4));
+  Ptr<LookupChild> b = CreateObject<LookupChild> ();
+  NS_TEST_ASSERT_MSG_EQ (b->m_childValue, 3, "Default value change ignored");
+  NS_TEST_ASSERT_MSG_EQ (b->m_parentValue, 4, "Default value change ignored");
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  factory.Set ("ChildValue", IntegerValue (5));
+  Ptr<LookupChild> c = factory.Create<LookupChild> ();
+  NS_TEST_ASSERT_MSG_EQ (c->m_childValue, 5, "Construction value ignored");
+  Config::Reset ();
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -298,6 +416,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   // as chained.
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
+  AddTestCase (new LookupByNameTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
@@ -22,13 +22,22 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/trace-helper.h"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
 
+// sub-buckets of the log-linear delay histograms of the periodic export,
+// unless the HistogramSubBuckets attribute is set
+#define EXPORT_HISTOGRAM_SUB_BUCKETS 32
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FlowMonitor");
@@ -48,6 +57,23 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (10.0)),
                    MakeTimeAccessor (&FlowMonitor::m_maxPerHopDelay),
                    MakeTimeChecker ())
+    .AddAttribute ("TimingWheel", ("If true, lost packets are found with a timing wheel, in slots of "
+                                   "MaxPerHopDelay / TimingWheelSlots, instead of by a periodic scan of "
+                                   "all the tracked packets.  The work then only depends on the number "
+                                   "of packets which may have expired, and packets are considered lost "
+                                   "at most one slot after MaxPerHopDelay."),
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FlowMonitor::m_useTimingWheel),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimingWheelSlots", ("The number of slots of the timing wheel."),
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FlowMonitor::m_timingWheelSlots),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("TrackedPacketsCapacity", ("The number of packets in flight for which to "
+                                              "allocate room when the monitor is created."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_trackedPacketsCapacity),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("StartTime", ("The time when the monitoring starts."),
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&FlowMonitor::Start),
@@ -68,6 +94,12 @@ FlowMonitor::GetTypeId (void)
                    DoubleValue (0.250),
                    MakeDoubleAccessor (&FlowMonitor::m_flowInterruptionsBinWidth),
                    MakeDoubleChecker <double> ())
+    .AddAttribute ("HistogramSubBuckets", ("If not zero, the histograms are log-linear with this number of "
+                                           "bins per power of two, a power of two, instead of linear.  "
+                                           "Their number of bins is then bounded."),
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlowMonitor::m_histogramSubBuckets),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("FlowInterruptionsMinTime", ("The minimum inter-arrival time that is considered a flow interruption."),
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
@@ -83,11 +115,20 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_timingWheelSlotWidth (0),
+    m_enabled (false),
+    m_histogramSubBuckets (0)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
 
+size_t
+FlowMonitor::TrackedPacketKeyHash::operator() (const TrackedPacketKey &key) const
+{
+  // packet ids of a flow are consecutive
+  return key.first * 2654435761U + key.second;
+}
+
 void
 FlowMonitor::DoDispose (void)
 {
@@ -102,6 +143,30 @@ FlowMonitor::DoDispose (void)
       m_flowProbes[i]->Dispose ();
       m_flowProbes[i] = 0;
     }
+  m_trackedPackets.clear ();
+  m_timingWheel.clear ();
+  if (m_exportStream)
+    {
+      // Disposed before the simulator is destroyed: do not use the
+      // simulator, which may be gone already, and stamp the last
+      // interval with the last time the monitor saw any activity.
+      Ptr<EventImpl> event = m_exportEvent.PeekEventImpl ();
+      if (event != 0)
+        {
+          event->Cancel ();
+        }
+      event = m_exportDestroyEvent.PeekEventImpl ();
+      if (event != 0)
+        {
+          event->Cancel ();
+        }
+      Time last = m_lastExportTime;
+      for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+        {
+          last = std::max (last, std::max (flowI->second.timeLastTxPacket, flowI->second.timeLastRxPacket));
+        }
+      FinishPeriodicExport (last);
+    }
   Object::DoDispose ();
 }
 
@@ -126,6 +191,13 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
+      if (m_histogramSubBuckets > 0)
+        {
+          ref.delayHistogram.SetLogLinear (m_histogramSubBuckets);
+          ref.jitterHistogram.SetLogLinear (m_histogramSubBuckets);
+          ref.packetSizeHistogram.SetLogLinear (m_histogramSubBuckets);
+          ref.flowInterruptionsHistogram.SetLogLinear (m_histogramSubBuckets);
+        }
       return ref;
     }
   else
@@ -143,12 +215,17 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  TrackedPacketKey key (flowId, packetId);
+  TrackedPacket &tracked = m_trackedPackets[key];
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
+  if (!m_timingWheel.empty ())
+    {
+      AddToTimingWheel (key, now + m_maxPerHopDelay);
+    }
 
   probe->AddPacketStats (flowId, packetSize, Seconds (0));
 
@@ -170,7 +247,7 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
+  TrackedPacketKey key (flowId, packetId);
   TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
   if (tracked == m_trackedPackets.end ())
     {
@@ -243,6 +320,10 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     }
   stats.timeLastRxPacket = now;
   stats.timesForwarded += tracked->second.timesForwarded;
+  if (m_exportStream)
+    {
+      GetExportStateForFlow (flowId).delayHistogram.AddValue (delay.GetSeconds ());
+    }
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
@@ -328,11 +409,214 @@ FlowMonitor::PeriodicCheckForLostPackets ()
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+void
+FlowMonitor::AddToTimingWheel (const TrackedPacketKey &key, Time expiration)
+{
+  // the slot which ends at time k * width is slot k % size, and holds
+  // the packets expiring in ((k - 1) * width, k * width]
+  int64_t k = (expiration.GetTimeStep () + m_timingWheelSlotWidth - 1) / m_timingWheelSlotWidth;
+  m_timingWheel[k % m_timingWheel.size ()].push_back (key);
+}
+
+void
+FlowMonitor::AdvanceTimingWheel ()
+{
+  Time now = Simulator::Now ();
+  int64_t k = now.GetTimeStep () / m_timingWheelSlotWidth;
+  // packets seen again may go back to this same slot, one turn later
+  TimingWheelSlot slot;
+  slot.swap (m_timingWheel[k % m_timingWheel.size ()]);
+  for (TimingWheelSlot::const_iterator key = slot.begin (); key != slot.end (); ++key)
+    {
+      TrackedPacketMap::iterator tracked = m_trackedPackets.find (*key);
+      if (tracked == m_trackedPackets.end ())
+        {
+          // received or dropped in the meantime
+          continue;
+        }
+      Time expiration = tracked->second.lastSeenTime + m_maxPerHopDelay;
+      if (expiration <= now)
+        {
+          // packet is considered lost, add it to the loss statistics
+          FlowStatsContainerI flow = m_flowStats.find (key->first);
+          NS_ASSERT (flow != m_flowStats.end ());
+          flow->second.lostPackets++;
+
+          // we won't track it anymore
+          m_trackedPackets.erase (tracked);
+        }
+      else
+        {
+          AddToTimingWheel (*key, expiration);
+        }
+    }
+  Simulator::Schedule (Time (m_timingWheelSlotWidth), &FlowMonitor::AdvanceTimingWheel, this);
+}
+
 void
 FlowMonitor::NotifyConstructionCompleted ()
 {
   Object::NotifyConstructionCompleted ();
-  Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
+  if (m_trackedPacketsCapacity > 0)
+    {
+      m_trackedPackets.resize (m_trackedPacketsCapacity);
+    }
+  if (!m_useTimingWheel)
+    {
+      Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
+      return;
+    }
+  m_timingWheelSlotWidth = std::max<int64_t> (m_maxPerHopDelay.GetTimeStep () / m_timingWheelSlots, 1);
+  m_timingWheel.resize (m_timingWheelSlots);
+  // run at the end of each slot
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  Simulator::Schedule (Time (m_timingWheelSlotWidth - now % m_timingWheelSlotWidth),
+                       &FlowMonitor::AdvanceTimingWheel, this);
+}
+
+FlowMonitor::ExportState&
+FlowMonitor::GetExportStateForFlow (FlowId flowId)
+{
+  std::map<FlowId, ExportState>::iterator iter = m_exportState.find (flowId);
+  if (iter != m_exportState.end ())
+    {
+      return iter->second;
+    }
+  ExportState &ref = m_exportState[flowId];
+  ref.txBytes = 0;
+  ref.rxBytes = 0;
+  ref.txPackets = 0;
+  ref.rxPackets = 0;
+  ref.lostPackets = 0;
+  ref.delaySum = Seconds (0);
+  ref.jitterSum = Seconds (0);
+  ref.delayHistogram.SetDefaultBinWidth (m_delayBinWidth);
+  ref.delayHistogram.SetLogLinear (m_histogramSubBuckets > 0 ? m_histogramSubBuckets : EXPORT_HISTOGRAM_SUB_BUCKETS);
+  return ref;
+}
+
+/**
+ * \param histogram a histogram
+ * \param count the number of values in the histogram
+ * \param quantile the quantile, in [0, 1]
+ * \returns the middle of the bin holding the quantile
+ */
+static double
+GetHistogramQuantile (Histogram &histogram, uint32_t count, double quantile)
+{
+  uint64_t rank = (uint64_t)std::ceil (quantile * count);
+  uint64_t seen = 0;
+  for (uint32_t index = 0; index < histogram.GetNBins (); index++)
+    {
+      seen += histogram.GetBinCount (index);
+      if (seen >= rank && seen > 0)
+        {
+          return (histogram.GetBinStart (index) + histogram.GetBinEnd (index)) / 2;
+        }
+    }
+  return 0;
+}
+
+void
+FlowMonitor::EnablePeriodicExport (std::string fileName, Time interval)
+{
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  DisablePeriodicExport ();
+  AsciiTraceHelper asciiTraceHelper;
+  m_exportStream = asciiTraceHelper.CreateFileStream (fileName);
+  m_exportInterval = interval;
+  // only the deltas from now on are exported
+  m_exportState.clear ();
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      ExportState &state = GetExportStateForFlow (flowI->first);
+      state.txBytes = flowI->second.txBytes;
+      state.rxBytes = flowI->second.rxBytes;
+      state.txPackets = flowI->second.txPackets;
+      state.rxPackets = flowI->second.rxPackets;
+      state.lostPackets = flowI->second.lostPackets;
+      state.delaySum = flowI->second.delaySum;
+      state.jitterSum = flowI->second.jitterSum;
+    }
+  *m_exportStream->GetStream () << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,"
+                                << "delayMean,delayMedian,delayP99,jitterMean\n";
+  m_exportEvent = Simulator::Schedule (interval, &FlowMonitor::PeriodicExport, this);
+  // the last interval is written while the simulator is still there
+  m_exportDestroyEvent = Simulator::ScheduleDestroy (&FlowMonitor::DisablePeriodicExport, this);
+  m_lastExportTime = Simulator::Now ();
+}
+
+void
+FlowMonitor::DisablePeriodicExport ()
+{
+  if (!m_exportStream)
+    {
+      return;
+    }
+  Simulator::Cancel (m_exportEvent);
+  Simulator::Cancel (m_exportDestroyEvent);
+  FinishPeriodicExport (Simulator::Now ());
+}
+
+void
+FlowMonitor::FinishPeriodicExport (Time now)
+{
+  ExportInterval (now);
+  m_exportStream = 0;
+  m_exportState.clear ();
+}
+
+void
+FlowMonitor::PeriodicExport ()
+{
+  ExportInterval (Simulator::Now ());
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::ExportInterval (Time now)
+{
+  std::ostream &os = *m_exportStream->GetStream ();
+  m_lastExportTime = now;
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      ExportState &state = GetExportStateForFlow (flowI->first);
+      uint32_t txPackets = stats.txPackets - state.txPackets;
+      uint32_t rxPackets = stats.rxPackets - state.rxPackets;
+      uint32_t lostPackets = stats.lostPackets - state.lostPackets;
+      if (txPackets == 0 && rxPackets == 0 && lostPackets == 0)
+        {
+          continue;
+        }
+      os << now.GetSeconds () << ',' << flowI->first
+         << ',' << txPackets << ',' << stats.txBytes - state.txBytes
+         << ',' << rxPackets << ',' << stats.rxBytes - state.rxBytes
+         << ',' << lostPackets;
+      if (rxPackets > 0)
+        {
+          os << ',' << (stats.delaySum - state.delaySum).GetSeconds () / rxPackets
+             << ',' << GetHistogramQuantile (state.delayHistogram, rxPackets, 0.5)
+             << ',' << GetHistogramQuantile (state.delayHistogram, rxPackets, 0.99)
+             << ',' << (stats.jitterSum - state.jitterSum).GetSeconds () / rxPackets;
+        }
+      else
+        {
+          os << ",,,,";
+        }
+      os << '\n';
+
+      state.txBytes = stats.txBytes;
+      state.rxBytes = stats.rxBytes;
+      state.txPackets = stats.txPackets;
+      state.rxPackets = stats.rxPackets;
+      state.lostPackets = stats.lostPackets;
+      state.delaySum = stats.delaySum;
+      state.jitterSum = stats.jitterSum;
+      Histogram empty (m_delayBinWidth);
+      empty.SetLogLinear (m_histogramSubBuckets > 0 ? m_histogramSubBuckets : EXPORT_HISTOGRAM_SUB_BUCKETS);
+      state.delayHistogram = empty;
+    }
 }
 
 void
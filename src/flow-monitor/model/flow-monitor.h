@@ -31,6 +31,8 @@
 #include "ns3/histogram.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
 
@@ -201,7 +203,8 @@ public:
   void ReportDrop (Ptr<FlowProbe> probe, FlowId flowId, FlowPacketId packetId,
                    uint32_t packetSize, uint32_t reasonCode);
 
-  /// Check right now for packets that appear to be lost
+  /// Check right now for packets that appear to be lost.  This scans
+  /// all the tracked packets, even when the TimingWheel attribute is set.
   void CheckForLostPackets ();
 
   /// Check right now for packets that appear to be lost, considering
@@ -256,6 +259,24 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Periodically write the statistics of each flow over the last
+  /// interval to a CSV file, while the simulation runs.  Each line
+  /// holds, for a flow with some activity during the interval: the
+  /// time at the end of the interval, the FlowId, the numbers of
+  /// transmitted packets and bytes, received packets and bytes and lost
+  /// packets, the mean, median and 99th percentile delay of the
+  /// received packets and their mean jitter, in seconds.  Delay
+  /// percentiles are taken from a log-linear histogram of the interval,
+  /// so the memory used does not grow with the simulated time.
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the interval between two lines of a flow
+  void EnablePeriodicExport (std::string fileName, Time interval);
+
+  /// Write the statistics of the current interval and stop the periodic
+  /// export.  This is done when the simulator is destroyed, if the
+  /// export is still enabled.
+  void DisablePeriodicExport ();
+
 
 protected:
 
@@ -272,13 +293,33 @@ private:
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
   };
 
+  /// Identifies a tracked packet
+  typedef std::pair<FlowId, FlowPacketId> TrackedPacketKey;
+
+  /// Hash function of a TrackedPacketKey
+  class TrackedPacketKeyHash : public std::unary_function<TrackedPacketKey, size_t>
+  {
+public:
+    /// \param key the key
+    /// \returns the hash of the key
+    size_t operator() (const TrackedPacketKey &key) const;
+  };
+
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef sgi::hash_map<TrackedPacketKey, TrackedPacket, TrackedPacketKeyHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  uint32_t m_trackedPacketsCapacity; //!< Number of tracked packets to allocate room for
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
+
+  /// The keys of the packets which may expire in a slot of the timing wheel
+  typedef std::vector<TrackedPacketKey> TimingWheelSlot;
+  bool m_useTimingWheel;          //!< Expire packets with the timing wheel
+  uint32_t m_timingWheelSlots;    //!< Number of slots of the timing wheel
+  int64_t m_timingWheelSlotWidth; //!< Duration of a slot, in time steps
+  std::vector<TimingWheelSlot> m_timingWheel; //!< The timing wheel
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
   // note: this is needed only for serialization
@@ -300,6 +341,53 @@ private:
 
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// The flow statistics at the last periodic export, and the delays
+  /// of the packets received since then
+  struct ExportState
+  {
+    uint64_t txBytes;         //!< Transmitted bytes
+    uint64_t rxBytes;         //!< Received bytes
+    uint32_t txPackets;       //!< Transmitted packets
+    uint32_t rxPackets;       //!< Received packets
+    uint32_t lostPackets;     //!< Lost packets
+    Time delaySum;            //!< Sum of the delays
+    Time jitterSum;           //!< Sum of the jitters
+    Histogram delayHistogram; //!< Delays received since the last export
+  };
+
+  /// FlowId --> ExportState
+  std::map<FlowId, ExportState> m_exportState;
+  Ptr<OutputStreamWrapper> m_exportStream; //!< The periodic export file
+  Time m_exportInterval;   //!< The periodic export interval
+  EventId m_exportEvent;   //!< The next periodic export
+  EventId m_exportDestroyEvent; //!< The export of the last interval when the simulator is destroyed
+  Time m_lastExportTime;   //!< The time of the last periodic export
+  uint32_t m_histogramSubBuckets; //!< Sub-buckets of log-linear histograms, or 0
+
+  /// Write the statistics of the last interval, and schedule the next export
+  void PeriodicExport ();
+  /// Write the statistics of the flows since the last export
+  /// \param now the time at the end of the interval
+  void ExportInterval (Time now);
+  /// Write the statistics of the last interval and close the export file
+  /// \param now the time at the end of the interval
+  void FinishPeriodicExport (Time now);
+  /// Get the periodic export state of a flow
+  /// \param flowId the Flow identification
+  /// \returns the export state of the flow
+  ExportState& GetExportStateForFlow (FlowId flowId);
+
+  /// Add a tracked packet to the timing wheel, in the first slot
+  /// which ends after its expiration time.
+  /// \param key the tracked packet
+  /// \param expiration the time when the packet is to be considered lost
+  void AddToTimingWheel (const TrackedPacketKey &key, Time expiration);
+
+  /// Periodic function which checks the packets in the slot of the
+  /// timing wheel which ends now, and moves to the next slot.  Packets
+  /// seen since they were added to the slot are moved to a later slot.
+  void AdvanceTimingWheel ();
 };
 
 
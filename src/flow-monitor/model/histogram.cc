@@ -45,21 +45,34 @@ Histogram::GetNBins () const
 }
 
 double 
-Histogram::GetBinStart (uint32_t index)
+Histogram::GetBinStart (uint32_t index) const
 {
-  return index*m_binWidth;
+  uint32_t subBuckets = 1U << m_subBucketsLog2;
+  if (!m_logLinear || index < 2 * subBuckets)
+    {
+      return index*m_binWidth;
+    }
+  // bin subBuckets * (shift + 1) + i holds [subBuckets + i, subBuckets + i + 1) << shift
+  uint32_t shift = (index >> m_subBucketsLog2) - 1;
+  uint64_t start = (uint64_t)(index - shift * subBuckets) << shift;
+  return start * m_binWidth;
 }
 
 double 
-Histogram::GetBinEnd (uint32_t index)
+Histogram::GetBinEnd (uint32_t index) const
 {
-  return (index + 1) * m_binWidth;
+  return GetBinStart (index) + GetBinWidth (index);
 }
 
 double 
 Histogram::GetBinWidth (uint32_t index) const
 {
-  return m_binWidth;
+  if (!m_logLinear || (index >> m_subBucketsLog2) < 2)
+    {
+      return m_binWidth;
+    }
+  uint32_t shift = (index >> m_subBucketsLog2) - 1;
+  return (uint64_t (1) << shift) * m_binWidth;
 }
 
 void 
@@ -69,6 +82,44 @@ Histogram::SetDefaultBinWidth (double binWidth)
   m_binWidth = binWidth;
 }
 
+void
+Histogram::SetLogLinear (uint32_t subBuckets)
+{
+  NS_ASSERT (m_histogram.size () == 0); //we can only change the bins if no values were added
+  NS_ASSERT_MSG (subBuckets > 0 && (subBuckets & (subBuckets - 1)) == 0,
+                 "The number of sub-buckets must be a power of two");
+  m_subBucketsLog2 = 0;
+  while ((1U << m_subBucketsLog2) < subBuckets)
+    {
+      m_subBucketsLog2++;
+    }
+  m_logLinear = true;
+}
+
+uint32_t
+Histogram::GetBinIndex (double value) const
+{
+  if (!m_logLinear)
+    {
+      return (uint32_t)std::floor (value/m_binWidth);
+    }
+  double units = std::floor (value/m_binWidth);
+  // values beyond 2^63 bin widths all go to the last bin
+  uint64_t v = units < 9.2e18 ? (uint64_t)units : (uint64_t (1) << 63);
+  uint64_t subBuckets = uint64_t (1) << m_subBucketsLog2;
+  if (v < 2 * subBuckets)
+    {
+      return (uint32_t)v;
+    }
+  uint32_t magnitude = 0;
+  while ((v >> magnitude) > 1)
+    {
+      magnitude++;
+    }
+  uint32_t shift = magnitude - m_subBucketsLog2;
+  return shift * subBuckets + (uint32_t)(v >> shift);
+}
+
 uint32_t 
 Histogram::GetBinCount (uint32_t index) 
 {
@@ -79,7 +130,7 @@ Histogram::GetBinCount (uint32_t index)
 void 
 Histogram::AddValue (double value)
 {
-  uint32_t index = (uint32_t)std::floor (value/m_binWidth);
+  uint32_t index = GetBinIndex (value);
 
   //check if we need to resize the vector
   NS_LOG_DEBUG ("AddValue: index=" << index << ", m_histogram.size()=" << m_histogram.size ());
@@ -94,11 +145,15 @@ Histogram::AddValue (double value)
 Histogram::Histogram (double binWidth)
 {
   m_binWidth = binWidth;
+  m_subBucketsLog2 = 0;
+  m_logLinear = false;
 }
 
 Histogram::Histogram ()
 {
   m_binWidth = DEFAULT_BIN_WIDTH;
+  m_subBucketsLog2 = 0;
+  m_logLinear = false;
 }
 
 
@@ -120,8 +175,8 @@ Histogram::SerializeToXmlStream (std::ostream &os, int indent, std::string eleme
           INDENT (indent);
           os << "<bin"
              << " index=\"" << (index) << "\""
-             << " start=\"" << (index*m_binWidth) << "\""
-             << " width=\"" << m_binWidth << "\""
+             << " start=\"" << GetBinStart (index) << "\""
+             << " width=\"" << GetBinWidth (index) << "\""
              << " count=\"" << m_histogram[index] << "\""
              << " />\n";
         }
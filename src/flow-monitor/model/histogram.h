@@ -36,6 +36,9 @@ namespace ns3 {
  *
  * This class only handles \a positive bins, i.e., it does \a not handles negative data.
  *
+ * The histogram can instead be made log-linear, see SetLogLinear(), in
+ * which case its memory is bounded whatever the range of the data.
+ *
  * \todo Add support for negative data.
  *
  * \todo Add method(s) to estimate parameters from the histogram,
@@ -65,17 +68,18 @@ public:
    * \param index the bin index
    * \return the bin start
    */
-  double GetBinStart (uint32_t index);
+  double GetBinStart (uint32_t index) const;
   /**
    * \brief Returns the bin end, i.e., (index+1)*binWidth
    * \param index the bin index
    * \return the bin start
    */
-  double GetBinEnd (uint32_t index);
+  double GetBinEnd (uint32_t index) const;
   /**
    * \brief Returns the bin width.
    *
-   * Note that all the bins have the same width.
+   * Note that all the bins have the same width, unless the histogram
+   * is log-linear.
    *
    * \param index the bin index
    * \return the bin width
@@ -89,6 +93,27 @@ public:
    * \param binWidth the bin width
    */
   void SetDefaultBinWidth (double binWidth);
+  /**
+   * \brief Make the histogram log-linear.
+   *
+   * The first 2 * subBuckets bins have the default bin width.  Then,
+   * each power of two range of values, [2^k, 2^(k+1)) times
+   * subBuckets * binWidth, is split into subBuckets bins.  The bin width
+   * thus stays within 1/subBuckets of the values in the bin, and the
+   * number of bins grows with the logarithm of the largest value
+   * instead of linearly.
+   *
+   * Note that you can make the histogram log-linear only if it is empty.
+   *
+   * \param subBuckets the number of bins per power of two, a power of two
+   */
+  void SetLogLinear (uint32_t subBuckets);
+  /**
+   * \brief Returns the bin index of a value.
+   * \param value the value
+   * \return the index of the bin the value is added to
+   */
+  uint32_t GetBinIndex (double value) const;
   /**
    * \brief Get the number of data added to the bin.
    * \param index the bin index
@@ -115,6 +140,8 @@ public:
 private:
   std::vector<uint32_t> m_histogram; //!< Histogram data
   double m_binWidth; //!< Bin width
+  uint32_t m_subBucketsLog2; //!< Log2 of the bins per power of two, if log-linear
+  bool m_logLinear; //!< True if the histogram is log-linear
 };
 
 
@@ -96,6 +96,17 @@ bool operator == (const Ipv6FlowClassifier::FiveTuple &t1,
 
 
 
+size_t
+Ipv6FlowClassifier::FiveTupleHash::operator() (const FiveTuple &t) const
+{
+  Ipv6AddressHash addressHash;
+  size_t hash = addressHash (t.sourceAddress);
+  hash = hash * 1000003 ^ addressHash (t.destinationAddress);
+  hash = hash * 1000003 ^ ((size_t (t.sourcePort) << 16) | t.destinationPort);
+  hash = hash * 1000003 ^ t.protocol;
+  return hash;
+}
+
 Ipv6FlowClassifier::Ipv6FlowClassifier ()
 {
 }
@@ -148,23 +159,26 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
   tuple.destinationPort = dstPort;
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
-    = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
+  FlowState state;
+  state.flowId = 0;
+  state.lastPacketId = 0;
+  std::pair<FlowMap::iterator, bool> insert
+    = m_flowMap.insert (std::make_pair (tuple, state));
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
   if (insert.second)
     {
       FlowId newFlowId = GetNewFlowId ();
-      insert.first->second = newFlowId;
-      m_flowPktIdMap[newFlowId] = 0;
+      insert.first->second.flowId = newFlowId;
+      m_flowTuples[newFlowId] = tuple;
     }
   else
     {
-      m_flowPktIdMap[insert.first->second] ++;
+      insert.first->second.lastPacketId++;
     }
 
-  *out_flowId = insert.first->second;
-  *out_packetId = m_flowPktIdMap[*out_flowId];
+  *out_flowId = insert.first->second.flowId;
+  *out_packetId = insert.first->second.lastPacketId;
 
   return true;
 }
@@ -173,13 +187,10 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  std::map<FlowId, FiveTuple>::const_iterator iter = m_flowTuples.find (flowId);
+  if (iter != m_flowTuples.end ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      return iter->second;
     }
   NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
   FiveTuple retval = { Ipv6Address::GetZero (), Ipv6Address::GetZero (), 0, 0, 0 };
@@ -194,16 +205,16 @@ Ipv6FlowClassifier::SerializeToXmlStream (std::ostream &os, int indent) const
   INDENT (indent); os << "<Ipv6FlowClassifier>\n";
 
   indent += 2;
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  for (std::map<FlowId, FiveTuple>::const_iterator
+       iter = m_flowTuples.begin (); iter != m_flowTuples.end (); iter++)
     {
       INDENT (indent);
-      os << "<Flow flowId=\"" << iter->second << "\""
-         << " sourceAddress=\"" << iter->first.sourceAddress << "\""
-         << " destinationAddress=\"" << iter->first.destinationAddress << "\""
-         << " protocol=\"" << int(iter->first.protocol) << "\""
-         << " sourcePort=\"" << iter->first.sourcePort << "\""
-         << " destinationPort=\"" << iter->first.destinationPort << "\""
+      os << "<Flow flowId=\"" << iter->first << "\""
+         << " sourceAddress=\"" << iter->second.sourceAddress << "\""
+         << " destinationAddress=\"" << iter->second.destinationAddress << "\""
+         << " protocol=\"" << int(iter->second.protocol) << "\""
+         << " sourcePort=\"" << iter->second.sourcePort << "\""
+         << " destinationPort=\"" << iter->second.destinationPort << "\""
          << " />\n";
     }
 
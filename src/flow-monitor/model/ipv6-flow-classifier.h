@@ -27,6 +27,7 @@
 
 #include "ns3/ipv6-header.h"
 #include "ns3/flow-classifier.h"
+#include "ns3/sgi-hashmap.h"
 
 namespace ns3 {
 
@@ -74,10 +75,29 @@ public:
 
 private:
 
-  /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
+  /// Hash function of a FiveTuple
+  class FiveTupleHash : public std::unary_function<FiveTuple, size_t>
+  {
+public:
+    /// \param t the FiveTuple
+    /// \returns the hash of the FiveTuple
+    size_t operator() (const FiveTuple &t) const;
+  };
+
+  /// State of a flow
+  struct FlowState
+  {
+    FlowId flowId;             //!< FlowId of the flow
+    FlowPacketId lastPacketId; //!< FlowPacketId of the last classified packet
+  };
+
+  /// Container: FiveTuple, FlowState
+  typedef sgi::hash_map<FiveTuple, FlowState, FiveTupleHash> FlowMap;
+
+  /// Map of FiveTuples to flow states, looked up for every packet
+  FlowMap m_flowMap;
+  /// Map of FlowIds to FiveTuples, for FindFlow and serialization
+  std::map<FlowId, FiveTuple> m_flowTuples;
 
 };
 
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+/// A probe reporting the packet events scheduled by the test
+class FlowMonitorTestProbe : public FlowProbe
+{
+public:
+  /// \param monitor the FlowMonitor the events are reported to
+  FlowMonitorTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+class FlowMonitorLostPacketsTestCase : public TestCase
+{
+public:
+  FlowMonitorLostPacketsTestCase (bool timingWheel);
+  virtual void DoRun (void);
+
+private:
+  void Tx (FlowPacketId packetId);
+  void Forward (FlowPacketId packetId);
+  void Rx (FlowPacketId packetId);
+  void Drop (FlowPacketId packetId);
+  void CheckLost (uint32_t expected);
+
+  bool m_timingWheel;
+  Ptr<FlowMonitor> m_monitor;
+  Ptr<FlowProbe> m_probe;
+};
+
+FlowMonitorLostPacketsTestCase::FlowMonitorLostPacketsTestCase (bool timingWheel)
+  : TestCase (timingWheel ? "Lost packets found by the timing wheel" :
+              "Lost packets found by the periodic check"),
+    m_timingWheel (timingWheel)
+{
+}
+
+void
+FlowMonitorLostPacketsTestCase::Tx (FlowPacketId packetId)
+{
+  m_monitor->ReportFirstTx (m_probe, 1, packetId, 100);
+}
+
+void
+FlowMonitorLostPacketsTestCase::Forward (FlowPacketId packetId)
+{
+  m_monitor->ReportForwarding (m_probe, 1, packetId, 100);
+}
+
+void
+FlowMonitorLostPacketsTestCase::Rx (FlowPacketId packetId)
+{
+  m_monitor->ReportLastRx (m_probe, 1, packetId, 100);
+}
+
+void
+FlowMonitorLostPacketsTestCase::Drop (FlowPacketId packetId)
+{
+  m_monitor->ReportDrop (m_probe, 1, packetId, 100, 0);
+}
+
+void
+FlowMonitorLostPacketsTestCase::CheckLost (uint32_t expected)
+{
+  FlowMonitor::FlowStatsContainer stats = m_monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 1, "Expected a single flow");
+  NS_TEST_EXPECT_MSG_EQ (stats[1].lostPackets, expected,
+                         "Unexpected number of lost packets at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+FlowMonitorLostPacketsTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FlowMonitor");
+  factory.Set ("MaxPerHopDelay", TimeValue (Seconds (1)));
+  factory.Set ("TimingWheel", BooleanValue (m_timingWheel));
+  factory.Set ("TimingWheelSlots", UintegerValue (4));
+  factory.Set ("TrackedPacketsCapacity", UintegerValue (16));
+  m_monitor = factory.Create<FlowMonitor> ();
+  m_probe = Create<FlowMonitorTestProbe> (m_monitor);
+  m_monitor->StartRightNow ();
+
+  // packet 0 is lost, packet 1 is forwarded then lost, packet 2 is
+  // received and packet 3 is dropped
+  for (FlowPacketId packetId = 0; packetId < 4; packetId++)
+    {
+      Simulator::Schedule (Seconds (0.1), &FlowMonitorLostPacketsTestCase::Tx, this, packetId);
+    }
+  Simulator::Schedule (Seconds (0.6), &FlowMonitorLostPacketsTestCase::Forward, this, 1);
+  Simulator::Schedule (Seconds (0.7), &FlowMonitorLostPacketsTestCase::Rx, this, 2);
+  Simulator::Schedule (Seconds (0.8), &FlowMonitorLostPacketsTestCase::Drop, this, 3);
+
+  // the drop counts as a loss
+  Simulator::Schedule (Seconds (0.9), &FlowMonitorLostPacketsTestCase::CheckLost, this, 1);
+  // packet 0 expires at 1.1s, and packet 1 at 1.6s; the timing wheel
+  // finds them at the end of their slot, the periodic check every second
+  Simulator::Schedule (Seconds (1.3), &FlowMonitorLostPacketsTestCase::CheckLost, this,
+                       m_timingWheel ? 2 : 1);
+  Simulator::Schedule (Seconds (1.8), &FlowMonitorLostPacketsTestCase::CheckLost, this,
+                       m_timingWheel ? 3 : 1);
+  Simulator::Schedule (Seconds (2.5), &FlowMonitorLostPacketsTestCase::CheckLost, this, 3);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  m_monitor->StopRightNow ();
+  FlowMonitor::FlowStatsContainer stats = m_monitor->GetFlowStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats[1].txPackets, 4, "Unexpected number of transmitted packets");
+  NS_TEST_EXPECT_MSG_EQ (stats[1].rxPackets, 1, "Unexpected number of received packets");
+  NS_TEST_EXPECT_MSG_EQ (stats[1].lostPackets, 3, "Unexpected number of lost packets");
+
+  Simulator::Destroy ();
+  m_monitor->Dispose ();
+  m_monitor = 0;
+  m_probe = 0;
+}
+
+class FlowMonitorPeriodicExportTestCase : public TestCase
+{
+public:
+  FlowMonitorPeriodicExportTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Tx (FlowId flowId, FlowPacketId packetId);
+  void Rx (FlowId flowId, FlowPacketId packetId);
+
+  Ptr<FlowMonitor> m_monitor;
+  Ptr<FlowProbe> m_probe;
+};
+
+FlowMonitorPeriodicExportTestCase::FlowMonitorPeriodicExportTestCase ()
+  : TestCase ("Periodic export of the flow statistics")
+{
+}
+
+void
+FlowMonitorPeriodicExportTestCase::Tx (FlowId flowId, FlowPacketId packetId)
+{
+  m_monitor->ReportFirstTx (m_probe, flowId, packetId, 100);
+}
+
+void
+FlowMonitorPeriodicExportTestCase::Rx (FlowId flowId, FlowPacketId packetId)
+{
+  m_monitor->ReportLastRx (m_probe, flowId, packetId, 100);
+}
+
+void
+FlowMonitorPeriodicExportTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-monitor-export.csv");
+  m_monitor = CreateObject<FlowMonitor> ();
+  m_probe = Create<FlowMonitorTestProbe> (m_monitor);
+  m_monitor->StartRightNow ();
+  m_monitor->EnablePeriodicExport (fileName, Seconds (1));
+
+  // flow 1 sends a packet every 0.1s, each received after 20ms; flow 2
+  // only sends a packet during the second interval, never received
+  for (uint32_t i = 0; i < 25; i++)
+    {
+      Simulator::Schedule (Seconds (0.1 * i + 0.05), &FlowMonitorPeriodicExportTestCase::Tx, this, 1, i);
+      Simulator::Schedule (Seconds (0.1 * i + 0.07), &FlowMonitorPeriodicExportTestCase::Rx, this, 1, i);
+    }
+  Simulator::Schedule (Seconds (1.5), &FlowMonitorPeriodicExportTestCase::Tx, this, 2, 0);
+  Simulator::Stop (Seconds (2.6));
+  Simulator::Run ();
+  // the last interval is written when the simulator is destroyed, at
+  // the time the simulation stopped
+  Simulator::Destroy ();
+  m_monitor->Dispose ();
+  m_monitor = 0;
+  m_probe = 0;
+
+  std::ifstream file (fileName.c_str ());
+  std::string line;
+  std::getline (file, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,"
+                         "delayMean,delayMedian,delayP99,jitterMean", "Unexpected header");
+  std::getline (file, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 26), "1,1,10,1000,10,1000,0,0.02", "Unexpected first interval");
+  std::getline (file, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 26), "2,1,10,1000,10,1000,0,0.02", "Unexpected second interval");
+  std::getline (file, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "2,2,1,100,0,0,0,,,,", "Unexpected second interval of flow 2");
+  std::getline (file, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 24), "2.6,1,5,500,5,500,0,0.02", "Unexpected last interval");
+  NS_TEST_EXPECT_MSG_EQ (std::getline (file, line).eof (), true, "Unexpected extra line " << line);
+}
+
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorLostPacketsTestCase (false), TestCase::QUICK);
+  AddTestCase (new FlowMonitorLostPacketsTestCase (true), TestCase::QUICK);
+  AddTestCase (new FlowMonitorPeriodicExportTestCase (), TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite;
@@ -69,6 +69,54 @@ HistogramTestCase::DoRun (void)
   }
 }
 
+class LogLinearHistogramTestCase : public ns3::TestCase {
+public:
+  LogLinearHistogramTestCase ();
+  virtual void DoRun (void);
+};
+
+LogLinearHistogramTestCase::LogLinearHistogramTestCase ()
+  : ns3::TestCase ("Log-linear histogram")
+{
+}
+
+void
+LogLinearHistogramTestCase::DoRun (void)
+{
+  Histogram h (0.5);
+  h.SetLogLinear (4);
+
+  // the first 8 bins are linear
+  h.AddValue (0.2);
+  h.AddValue (3.9);
+  NS_TEST_EXPECT_MSG_EQ (h.GetNBins (), 8, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (0), 1, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (7), 1, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinWidth (7), 0.5, 1e-9, "");
+
+  // then 4 bins per power of two
+  h.AddValue (4.0);
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (8), 1, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (8), 4.0, 1e-9, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinWidth (8), 1.0, 1e-9, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinStart (12), 8.0, 1e-9, "");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetBinWidth (12), 2.0, 1e-9, "");
+
+  // every value falls within its bin
+  for (double value = 0.1; value < 1e6; value *= 1.37)
+    {
+      uint32_t index = h.GetBinIndex (value);
+      NS_TEST_ASSERT_MSG_EQ ((h.GetBinStart (index) <= value && value < h.GetBinEnd (index)), true,
+                             "value " << value << " not in bin " << index);
+      NS_TEST_ASSERT_MSG_EQ_TOL (h.GetBinEnd (index), h.GetBinStart (index + 1), 1e-9, "");
+    }
+
+  // a very large value only adds a bounded number of bins
+  h.AddValue (1e12);
+  NS_TEST_EXPECT_MSG_LT (h.GetNBins (), 4 * 42, "");
+  NS_TEST_EXPECT_MSG_EQ (h.GetBinCount (h.GetNBins () - 1), 1, "");
+}
+
 static class HistogramTestSuite : public TestSuite
 {
 public:
@@ -76,5 +124,6 @@ public:
     : TestSuite ("histogram", UNIT) 
   {
     AddTestCase (new HistogramTestCase (), TestCase::QUICK);
+    AddTestCase (new LogLinearHistogramTestCase (), TestCase::QUICK);
   }
 } g_HistogramTestSuite;
@@ -80,6 +80,9 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * When the GlobalValue "GlobalRoutingIncrementalSpf" is true, only the
+   * nodes whose routes may have changed recompute them.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
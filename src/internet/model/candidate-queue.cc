@@ -51,7 +51,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  // the heap is only partially ordered
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::HeapLess);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
@@ -66,7 +68,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_index (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +98,11 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  vNew->m_candidateOrder = m_order++;
+  m_candidates.push_back (vNew);
+  Place (vNew, m_candidates.size () - 1);
+  SiftUp (vNew->m_candidatePosition);
+  m_index.insert (std::make_pair (vNew->GetVertexId (), vNew));
 }
 
 SPFVertex *
@@ -111,7 +115,23 @@ CandidateQueue::Pop (void)
     }
 
   SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (last, 0);
+      SiftDown (0);
+    }
+  std::pair<CandidateIndex_t::iterator, CandidateIndex_t::iterator> range =
+    m_index.equal_range (v->GetVertexId ());
+  for (CandidateIndex_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second == v)
+        {
+          m_index.erase (i);
+          break;
+        }
+    }
   return v;
 }
 
@@ -145,18 +165,12 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  CandidateIndex_t::const_iterator i = m_index.find (addr);
+  if (i == m_index.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
-
-  return 0;
+  return i->second;
 }
 
 void
@@ -164,11 +178,90 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_ASSERT (v->m_candidatePosition < m_candidates.size ()
+             && m_candidates[v->m_candidatePosition] == v);
+
+  v->m_candidateOrder = m_order++;
+  SiftUp (v->m_candidatePosition);
+  SiftDown (v->m_candidatePosition);
+}
+
+void
+CandidateQueue::Place (SPFVertex *v, uint32_t position)
+{
+  m_candidates[position] = v;
+  v->m_candidatePosition = position;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t position)
+{
+  SPFVertex *v = m_candidates[position];
+  while (position > 0)
+    {
+      uint32_t parent = (position - 1) / 2;
+      if (!HeapLess (v, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (m_candidates[parent], position);
+      position = parent;
+    }
+  Place (v, position);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t position)
+{
+  SPFVertex *v = m_candidates[position];
+  uint32_t size = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * position + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && HeapLess (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!HeapLess (m_candidates[child], v))
+        {
+          break;
+        }
+      Place (m_candidates[child], position);
+      position = child;
+    }
+  Place (v, position);
+}
+
+bool
+CandidateQueue::HeapLess (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (CompareSPFVertex (v1, v2))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (v2, v1))
+    {
+      return false;
+    }
+  return v1->m_candidateOrder < v2->m_candidateOrder;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
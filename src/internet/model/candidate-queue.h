@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,6 +46,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, indexed by vertex ID: Push (), Pop () and
+ * Update () take a time logarithmic in the number of candidates, and
+ * Find () does not walk the queue.  The vertices at the same distance
+ * are popped in the order they were pushed, or updated, as with a list
+ * kept sorted.
  */
 class CandidateQueue
 {
@@ -152,6 +159,16 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the order of the Candidate Queue after the distance of
+ * one of its vertices changed.
+ * This is cheaper than Reorder () when a single vertex changed.  The vertex
+ * goes after the vertices at the same distance.
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance changed.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -182,8 +199,40 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+/**
+ * \brief return true if v1 should be popped before v2, in the heap
+ * The vertices CompareSPFVertex () does not order are popped in the order
+ * of their candidate order.
+ * \param v1 first operand
+ * \param v2 second operand
+ * \return True if v1 should be popped before v2; false otherwise
+ */
+  static bool HeapLess (const SPFVertex* v1, const SPFVertex* v2);
+
+/**
+ * \brief Store a vertex at a position of the heap.
+ * \param v the vertex
+ * \param position the position
+ */
+  void Place (SPFVertex *v, uint32_t position);
+
+/**
+ * \brief Move a vertex toward the top of the heap, to its place.
+ * \param position the position of the vertex
+ */
+  void SiftUp (uint32_t position);
+
+/**
+ * \brief Move a vertex toward the bottom of the heap, to its place.
+ * \param position the position of the vertex
+ */
+  void SiftDown (uint32_t position);
+
+  typedef std::vector<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, a binary heap
+  typedef std::multimap<Ipv4Address, SPFVertex*> CandidateIndex_t; //!< SPFVertex pointers by vertex ID
+  CandidateIndex_t m_index;  //!< SPFVertex candidates, by vertex ID
+  uint64_t m_order;  //!< candidate order of the next vertex pushed or updated
 
   /**
    * \brief Stream insertion operator.
@@ -35,6 +35,8 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +46,25 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \brief A global switch to update the global routes incrementally.
+ */
+static GlobalValue g_incrementalSpf = GlobalValue ("GlobalRoutingIncrementalSpf",
+                                                   "A global switch to only recompute the global routes of the routers affected by a topology change",
+                                                   BooleanValue (false),
+                                                   MakeBooleanChecker ());
+
+/**
+ * \returns true if the global routes are updated incrementally
+ */
+static bool
+IsIncrementalSpf (void)
+{
+  BooleanValue value;
+  g_incrementalSpf.GetValue (value);
+  return value.Get ();
+}
+
 /**
  * \brief Stream insertion operator.
  *
@@ -94,7 +115,9 @@ SPFVertex::SPFVertex () :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidatePosition (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -107,7 +130,9 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidatePosition (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -470,7 +495,32 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      std::pair<LSDBMap_t::iterator, bool> inserted = m_database.insert (LSDBPair_t (addr, lsa));
+      if (!inserted.second)
+        {
+          return;
+        }
+//
+// Index the transit link records by link data, keeping the first LSA in the
+// order of the database when several records have the same link data.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          LinkDataMap_t::iterator k = m_linkData.find (lr->GetLinkData ());
+          if (k == m_linkData.end ())
+            {
+              m_linkData.insert (std::make_pair (lr->GetLinkData (), inserted.first));
+            }
+          else if (addr < k->second->first)
+            {
+              k->second = inserted.first;
+            }
+        }
     }
 }
 
@@ -495,15 +545,12 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i == m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return 0;
     }
-  return 0;
+  return i->second;
 }
 
 GlobalRoutingLSA*
@@ -511,24 +558,14 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of its transit link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LinkDataMap_t::const_iterator i = m_linkData.find (addr);
+  if (i == m_linkData.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return 0;
     }
-  return 0;
+  return i->second->second;
 }
 
 // ---------------------------------------------------------------------------
@@ -539,7 +576,8 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfCalculations (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -578,19 +616,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (node, router);
     }
   if (m_lsdb)
     {
@@ -598,6 +624,27 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_spfStates.clear ();
+  m_vertexIndex.clear ();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node, Ptr<GlobalRouter> router)
+{
+  NS_LOG_FUNCTION (this << node << router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
 }
 
 //
@@ -724,12 +771,361 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
+          m_spfrootNode = i;
           SPFCalculate (rtr->GetRouterId ());
         }
     }
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+//
+// Rebuild the link state database and update the routes.  In incremental
+// mode, each SPF calculation recorded the tree of its root, with the
+// distances from the root to the vertices.  If the only changes of the
+// database are changes of the links in router LSAs, the tree of a root only
+// changes if:
+//  - a changed LSA is the LSA of the root: the next hops of the root change;
+//  - a transit link of the tree was removed or its metric increased, or a
+//    transit link got a metric making a path as short as the path in the
+//    tree: the distances or the parents of vertices change;
+//  - a transit link back to the root, or to a transit network, changed: the
+//    next hop addresses are those of these links.
+// The changes of the other links, and of the stub links, do not change the
+// tree but the routes to the addresses of the changed LSAs: the roots whose
+// tree contains a changed LSA rebuild their routes from their tree, without
+// calculating it again.  The other routers keep their routes.  Any other
+// change of the database (a new router or network, an external route)
+// triggers the calculation of all the routes.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsIncrementalSpf () || m_spfStates.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB *previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<LinkChange> changes;
+  std::vector<Ipv4Address> changed;
+  bool incremental = CompareLSDB (previous, changes, changed);
+  delete previous;
+  if (!incremental)
+    {
+      NS_LOG_LOGIC ("Computing the routes of all the routers");
+      m_spfStates.clear ();
+    }
+
+  uint32_t routers = 0;
+  uint32_t computed = 0;
+  uint32_t rebuilt = 0;
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0)
+        {
+          continue;
+        }
+      if (!incremental)
+        {
+          DeleteRoutes (node, rtr);
+        }
+      if (node->GetSystemId () != systemId || rtr->GetNumLSAs () == 0)
+        {
+          continue;
+        }
+      routers++;
+      Ipv4Address root = rtr->GetRouterId ();
+      m_spfrootNode = i;
+      if (incremental)
+        {
+          SPFStates_t::const_iterator state = m_spfStates.find (root);
+          if (state != m_spfStates.end () && !IsAffected (root, state->second, changes))
+            {
+              if (!state->second.stub && IsInTree (state->second, changed))
+                {
+                  DeleteRoutes (node, rtr);
+                  SPFRebuild (root, state->second);
+                  rebuilt++;
+                }
+              continue;
+            }
+          DeleteRoutes (node, rtr);
+        }
+      SPFCalculate (root);
+      computed++;
+    }
+  NS_LOG_INFO ("Computed the routes of " << computed << " of " << routers <<
+               " routers, rebuilt the routes of " << rebuilt << " routers");
+}
+
+bool
+GlobalRouteManagerImpl::CompareLSDB (const GlobalRouteManagerLSDB *previous,
+                                     std::vector<LinkChange> &changes,
+                                     std::vector<Ipv4Address> &changed) const
+{
+  NS_LOG_FUNCTION (this << previous);
+  if (previous->m_database.size () != m_lsdb->m_database.size ()
+      || previous->m_extdatabase.size () != m_lsdb->m_extdatabase.size ())
+    {
+      NS_LOG_LOGIC ("Different number of LSAs");
+      return false;
+    }
+  for (uint32_t j = 0; j < m_lsdb->m_extdatabase.size (); j++)
+    {
+      const GlobalRoutingLSA *a = previous->m_extdatabase[j];
+      const GlobalRoutingLSA *b = m_lsdb->m_extdatabase[j];
+      if (a->GetLinkStateId () != b->GetLinkStateId ()
+          || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+          || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ())
+        {
+          NS_LOG_LOGIC ("Different external LSA " << b->GetLinkStateId ());
+          return false;
+        }
+    }
+  GlobalRouteManagerLSDB::LSDBMap_t::const_iterator i = previous->m_database.begin ();
+  GlobalRouteManagerLSDB::LSDBMap_t::const_iterator j = m_lsdb->m_database.begin ();
+  for (; j != m_lsdb->m_database.end (); i++, j++)
+    {
+      const GlobalRoutingLSA *a = i->second;
+      const GlobalRoutingLSA *b = j->second;
+      if (i->first != j->first || a->GetLSType () != b->GetLSType ())
+        {
+          NS_LOG_LOGIC ("Different LSA " << j->first);
+          return false;
+        }
+      if (b->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          if (a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+              || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+            {
+              NS_LOG_LOGIC ("Different network LSA " << j->first);
+              return false;
+            }
+          for (uint32_t k = 0; k < b->GetNAttachedRouters (); k++)
+            {
+              if (a->GetAttachedRouter (k) != b->GetAttachedRouter (k))
+                {
+                  NS_LOG_LOGIC ("Different network LSA " << j->first);
+                  return false;
+                }
+            }
+          continue;
+        }
+//
+// Split the link records of the router LSA: the stub links give the network
+// routes to the router, the transit links are the graph of the SPF
+// calculation.
+//
+      std::vector<const GlobalRoutingLinkRecord *> stubsA, stubsB, transitsA, transitsB;
+      for (uint32_t k = 0; k < a->GetNLinkRecords (); k++)
+        {
+          const GlobalRoutingLinkRecord *l = a->GetLinkRecord (k);
+          (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork ? stubsA : transitsA).push_back (l);
+        }
+      for (uint32_t k = 0; k < b->GetNLinkRecords (); k++)
+        {
+          const GlobalRoutingLinkRecord *l = b->GetLinkRecord (k);
+          (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork ? stubsB : transitsB).push_back (l);
+        }
+      uint32_t nChanges = changes.size ();
+      CompareTransitLinks (j->first, transitsA, transitsB, changes);
+      bool links = stubsA.size () != stubsB.size () || transitsA.size () != transitsB.size ();
+      for (uint32_t k = 0; !links && k < stubsB.size (); k++)
+        {
+          // the metric of the stub links is not used
+          links = stubsA[k]->GetLinkId () != stubsB[k]->GetLinkId ()
+            || stubsA[k]->GetLinkData () != stubsB[k]->GetLinkData ();
+        }
+      if (links || changes.size () != nChanges)
+        {
+          NS_LOG_LOGIC ("Different links in LSA " << j->first);
+          changed.push_back (j->first);
+        }
+    }
+  return true;
+}
+
+//
+// The transit links of a router LSA are the links of its interfaces, in the
+// order of the interfaces: the links of the previous LSA are matched to the
+// links of the current LSA with the same type, vertex and interface address,
+// the links left are removed or added.  If the matched links are not in the
+// same order, all the links are considered removed and added again, since
+// the order of the links gives the order of the routes of equal cost.
+//
+void
+GlobalRouteManagerImpl::CompareTransitLinks (Ipv4Address from,
+                                             const std::vector<const GlobalRoutingLinkRecord *> &previous,
+                                             const std::vector<const GlobalRoutingLinkRecord *> &current,
+                                             std::vector<LinkChange> &changes) const
+{
+  std::vector<bool> matched (previous.size (), false);
+  std::vector<int32_t> match (current.size (), -1);
+  bool ordered = true;
+  int32_t last = -1;
+  for (uint32_t k = 0; k < current.size (); k++)
+    {
+      for (uint32_t m = 0; m < previous.size (); m++)
+        {
+          if (!matched[m]
+              && previous[m]->GetLinkType () == current[k]->GetLinkType ()
+              && previous[m]->GetLinkId () == current[k]->GetLinkId ()
+              && previous[m]->GetLinkData () == current[k]->GetLinkData ())
+            {
+              matched[m] = true;
+              match[k] = m;
+              ordered = ordered && last < static_cast<int32_t> (m);
+              last = m;
+              break;
+            }
+        }
+    }
+
+  LinkChange change;
+  change.from = from;
+  for (uint32_t m = 0; m < previous.size (); m++)
+    {
+      if (!matched[m] || !ordered)
+        {
+          NS_LOG_LOGIC ("Removed link to " << previous[m]->GetLinkId () << " in LSA " << from);
+          change.to = previous[m]->GetLinkId ();
+          change.previousMetric = previous[m]->GetMetric ();
+          change.metric = SPF_INFINITY;
+          change.network = previous[m]->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork;
+          changes.push_back (change);
+        }
+    }
+  for (uint32_t k = 0; k < current.size (); k++)
+    {
+      change.to = current[k]->GetLinkId ();
+      change.metric = current[k]->GetMetric ();
+      change.network = current[k]->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork;
+      if (match[k] < 0 || !ordered)
+        {
+          NS_LOG_LOGIC ("Added link to " << change.to << " in LSA " << from);
+          change.previousMetric = SPF_INFINITY;
+          changes.push_back (change);
+        }
+      else if (previous[match[k]]->GetMetric () != change.metric)
+        {
+          NS_LOG_LOGIC ("Different metric of link to " << change.to << " in LSA " << from);
+          change.previousMetric = previous[match[k]]->GetMetric ();
+          changes.push_back (change);
+        }
+    }
+}
+
+bool
+GlobalRouteManagerImpl::IsAffected (Ipv4Address root, const SPFState &state,
+                                    const std::vector<LinkChange> &changes) const
+{
+  for (std::vector<LinkChange>::const_iterator i = changes.begin (); i != changes.end (); i++)
+    {
+      uint32_t from = GetDistance (state, i->from);
+      if (from == SPF_INFINITY)
+        {
+          // the vertex, and its links, are not in the tree
+          continue;
+        }
+      if (state.stub || i->from == root || i->to == root)
+        {
+          return true;
+        }
+      // 64 bits, since the metric may be SPF_INFINITY
+      uint64_t to = GetDistance (state, i->to);
+      if (i->network && to == from)
+        {
+          // the link may be the link from the parent network of the vertex
+          return true;
+        }
+      if (i->previousMetric != SPF_INFINITY && to == uint64_t (from) + i->previousMetric)
+        {
+          // the link was in the tree
+          return true;
+        }
+      if (i->metric != SPF_INFINITY && uint64_t (from) + i->metric <= to)
+        {
+          // the link gives a path as short as the path in the tree
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+GlobalRouteManagerImpl::IsInTree (const SPFState &state, const std::vector<Ipv4Address> &vertices) const
+{
+  for (std::vector<Ipv4Address>::const_iterator i = vertices.begin (); i != vertices.end (); i++)
+    {
+      if (GetDistance (state, *i) != SPF_INFINITY)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::RecordVertex (SPFState *state, SPFVertex *v)
+{
+  if (state == 0)
+    {
+      return;
+    }
+  RecordDistance (state, v->GetVertexId (), v->GetDistanceFromRoot ());
+  SPFTreeVertex vertex;
+  vertex.id = v->GetVertexId ();
+  for (uint32_t i = 0; v->GetParent (i) != 0; i++)
+    {
+      vertex.parents.push_back (v->GetParent (i)->GetVertexId ());
+    }
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      vertex.exits.push_back (v->GetRootExitDirection (i));
+    }
+  state->tree.push_back (vertex);
+}
+
+void
+GlobalRouteManagerImpl::RecordDistance (SPFState *state, Ipv4Address vertex, uint32_t distance)
+{
+  if (state == 0)
+    {
+      return;
+    }
+  VertexIndex_t::iterator i = m_vertexIndex.find (vertex);
+  if (i == m_vertexIndex.end ())
+    {
+      i = m_vertexIndex.insert (std::make_pair (vertex, m_vertexIndex.size ())).first;
+    }
+  if (state->distances.size () <= i->second)
+    {
+      state->distances.resize (i->second + 1, SPF_INFINITY);
+    }
+  state->distances[i->second] = distance;
+}
+
+uint32_t
+GlobalRouteManagerImpl::GetDistance (const SPFState &state, Ipv4Address vertex) const
+{
+  VertexIndex_t::const_iterator i = m_vertexIndex.find (vertex);
+  if (i == m_vertexIndex.end () || i->second >= state.distances.size ())
+    {
+      return SPF_INFINITY;
+    }
+  return state.distances[i->second];
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -960,7 +1356,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,9 +1643,16 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  m_spfrootNode = NodeList::Begin ();
   SPFCalculate (root);
 }
 
+uint32_t
+GlobalRouteManagerImpl::DebugGetNSPFCalculations (void) const
+{
+  return m_spfCalculations;
+}
+
 //
 // Used to test if a node is a stub, from an OSPF sense.
 // If there is only one link of type 1 or 2, then a default route
@@ -1342,6 +1745,7 @@ void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  m_spfCalculations++;
 
   SPFVertex *v;
 //
@@ -1369,6 +1773,19 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+//
+// In incremental mode, record the distances of the vertices of the tree, to
+// find out later which changes of the database may change it.
+//
+  SPFState *state = 0;
+  if (IsIncrementalSpf ())
+    {
+      state = &m_spfStates[root];
+      state->stub = false;
+      state->distances.clear ();
+      state->tree.clear ();
+      RecordDistance (state, root, 0);
+    }
 
 //
 // Optimize SPF calculation, for ns-3.
@@ -1380,6 +1797,16 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (state != 0)
+        {
+          // the default route depends on the LSAs of the neighbors
+          state->stub = true;
+          GlobalRoutingLSA *rlsa = v->GetLSA ();
+          for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+            {
+              RecordDistance (state, rlsa->GetLinkRecord (i)->GetLinkId (), 0);
+            }
+        }
       delete m_spfroot;
       return;
     }
@@ -1437,6 +1864,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // to now.
 //
       SPFVertexAddParent (v);
+      RecordVertex (state, v);
 //
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
@@ -1485,6 +1913,75 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
     }  // end for loop
 
+  SPFAddStubAndExternalRoutes ();
+}
+
+//
+// Build the tree recorded by the last SPF calculation of the root again, in
+// the same order, with the LSAs of the current database, and add the routes
+// of the first stage of the calculation as SPFCalculate does: the children
+// of each vertex are in the same order.  The exit directions of a vertex are
+// one exit, or a list sorted by SPFVertex::MergeRootExitDirections: merging
+// them one by one gives the same list.
+//
+void
+GlobalRouteManagerImpl::SPFRebuild (Ipv4Address root, const SPFState &state)
+{
+  NS_LOG_FUNCTION (this << root);
+  NS_ASSERT (!state.stub);
+
+  m_spfroot = new SPFVertex (m_lsdb->GetLSA (root));
+  m_spfroot->SetDistanceFromRoot (0);
+  std::map<Ipv4Address, SPFVertex *> vertices;
+  vertices[root] = m_spfroot;
+  for (std::vector<SPFTreeVertex>::const_iterator i = state.tree.begin (); i != state.tree.end (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetLSA (i->id);
+      NS_ASSERT (lsa != 0 && !i->parents.empty ());
+      SPFVertex *v = new SPFVertex (lsa);
+      v->SetDistanceFromRoot (GetDistance (state, i->id));
+      for (uint32_t k = 0; k < i->parents.size (); k++)
+        {
+          NS_ASSERT (vertices.find (i->parents[k]) != vertices.end ());
+          if (k == 0)
+            {
+              v->SetParent (vertices[i->parents[k]]);
+              continue;
+            }
+          SPFVertex parent;
+          parent.SetParent (vertices[i->parents[k]]);
+          v->MergeParent (&parent);
+        }
+      for (uint32_t k = 0; k < i->exits.size (); k++)
+        {
+          if (k == 0)
+            {
+              v->SetRootExitDirection (i->exits[k]);
+              continue;
+            }
+          SPFVertex exit;
+          exit.SetRootExitDirection (i->exits[k]);
+          v->MergeRootExitDirections (&exit);
+        }
+      SPFVertexAddParent (v);
+      vertices[i->id] = v;
+      if (v->GetVertexType () == SPFVertex::VertexRouter)
+        {
+          SPFIntraAddRouter (v);
+        }
+      else
+        {
+          SPFIntraAddTransit (v);
+        }
+    }
+
+  SPFAddStubAndExternalRoutes ();
+}
+
+void
+GlobalRouteManagerImpl::SPFAddStubAndExternalRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
 // Second stage of SPF calculation procedure
   SPFProcessStubs (m_spfroot);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
@@ -1562,9 +2059,10 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node of the root, found
+// before the SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1731,9 +2229,10 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node of the root, found
+// before the SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1855,9 +2354,10 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
 // Walk the list of nodes in the system looking for the one corresponding to
 // the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// building the routing table.  The walk starts at the node of the root, found
+// before the SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -1946,9 +2446,10 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node of the root, found
+// before the SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -2091,9 +2592,10 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 //
 // We need to walk the list of nodes looking for the one that has the router
 // ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// the routing information to.  The walk starts at the node of the root, found
+// before the SPF calculation.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
+  NodeList::Iterator i = m_spfrootNode;
   NodeList::Iterator listEnd = NodeList::End ();
   for (; i != listEnd; i++)
     {
@@ -2176,6 +2678,7 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                                 " since outgoing interface id is negative " << outIf);
                 }
             }
+          return;
         }
     } 
 }
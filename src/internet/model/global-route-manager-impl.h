@@ -30,6 +30,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/node-list.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -536,6 +537,10 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_candidatePosition; //!< Position of the vertex in the CandidateQueue heap
+  uint64_t m_candidateOrder; //!< Order of the vertex among the candidates at the same distance
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -678,6 +683,10 @@ private:
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  typedef std::map<Ipv4Address, LSDBMap_t::const_iterator> LinkDataMap_t; //!< container of link data / database entries
+  LinkDataMap_t m_linkData; //!< database entries by link data of their TransitNetwork link records
+
+  friend class GlobalRouteManagerImpl;
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -733,6 +742,22 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables after a change of the topology.
+ *
+ * By default, all the routes are deleted and computed again, as with
+ * DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes ().  When the GlobalValue "GlobalRoutingIncrementalSpf"
+ * is true, the new database is compared to the previous one, and only the
+ * routers whose SPF tree may change calculate it again; the routers whose
+ * tree contains changed LSAs rebuild their routes from their previous
+ * tree, and the other routers keep their routes.  This mode keeps the
+ * tree of each router between the calls, i.e., a memory quadratic in the
+ * number of routers.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -744,6 +769,13 @@ public:
  */
   void DebugSPFCalculate (Ipv4Address root);
 
+/**
+ * @brief Debugging routine; get the number of SPF calculations from the unit
+ * tests
+ * @returns the number of SPF calculations since the creation of the manager
+ */
+  uint32_t DebugGetNSPFCalculations (void) const;
+
 private:
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
@@ -765,8 +797,122 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  NodeList::Iterator m_spfrootNode; //!< the node of the root node, where the walks of the node list start
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /**
+   * \brief A vertex of the SPF tree of a router, in incremental mode.
+   */
+  struct SPFTreeVertex
+  {
+    Ipv4Address id;                               //!< the vertex ID
+    std::vector<Ipv4Address> parents;             //!< the IDs of the parents of the vertex
+    std::vector<SPFVertex::NodeExit_t> exits;     //!< the exit directions from the root to the vertex
+  };
+
+  /**
+   * \brief What the routes of a router were computed from, in incremental mode.
+   */
+  struct SPFState
+  {
+    bool stub;                        //!< true if the router only got a default route
+    std::vector<uint32_t> distances;  //!< distances of the vertices from the router, by vertex index
+    std::vector<SPFTreeVertex> tree;  //!< the vertices of the tree but the root, in the order they were added
+  };
+
+  /**
+   * \brief A change of a transit link of a router LSA.
+   *
+   * A removed link has the metric SPF_INFINITY, an added link the previous
+   * metric SPF_INFINITY.
+   */
+  struct LinkChange
+  {
+    Ipv4Address from;         //!< the router of the LSA
+    Ipv4Address to;           //!< the vertex the link leads to
+    uint32_t previousMetric;  //!< the previous metric of the link
+    uint32_t metric;          //!< the metric of the link
+    bool network;             //!< true if the link leads to a transit network
+  };
+
+  typedef std::map<Ipv4Address, SPFState> SPFStates_t; //!< container of SPF states, by router ID
+  SPFStates_t m_spfStates; //!< the SPF states of the routers, in incremental mode
+  typedef std::map<Ipv4Address, uint32_t> VertexIndex_t; //!< container of vertex indices, by vertex ID
+  VertexIndex_t m_vertexIndex; //!< the indices of the vertices in the SPF states
+  uint32_t m_spfCalculations; //!< the number of SPF calculations
+
+  /**
+   * \brief Delete the routes of a router
+   * \param node the node
+   * \param router the global router of the node
+   */
+  void DeleteRoutes (Ptr<Node> node, Ptr<GlobalRouter> router);
+
+  /**
+   * \brief Compare the database to a previous database
+   * \param previous the previous database
+   * \param changes the changes of the transit links of the router LSAs
+   * \param changed the IDs of the router LSAs whose links changed
+   * \returns false if other parts of the database changed
+   */
+  bool CompareLSDB (const GlobalRouteManagerLSDB *previous,
+                    std::vector<LinkChange> &changes,
+                    std::vector<Ipv4Address> &changed) const;
+
+  /**
+   * \brief Compare the transit links of two versions of a router LSA
+   * \param from the router of the LSA
+   * \param previous the previous transit links
+   * \param current the transit links
+   * \param changes the changes of the links
+   */
+  void CompareTransitLinks (Ipv4Address from,
+                            const std::vector<const GlobalRoutingLinkRecord *> &previous,
+                            const std::vector<const GlobalRoutingLinkRecord *> &current,
+                            std::vector<LinkChange> &changes) const;
+
+  /**
+   * \brief Check whether changes of the links may change the SPF tree of a
+   * router
+   * \param root the router ID
+   * \param state the SPF state of the router
+   * \param changes the changes of the transit links of the router LSAs
+   * \returns true if the SPF tree of the router must be computed again
+   */
+  bool IsAffected (Ipv4Address root, const SPFState &state,
+                   const std::vector<LinkChange> &changes) const;
+
+  /**
+   * \brief Check whether the SPF tree of a router contains some vertices
+   * \param state the SPF state of the router
+   * \param vertices the vertex IDs
+   * \returns true if one of the vertices is in the tree
+   */
+  bool IsInTree (const SPFState &state, const std::vector<Ipv4Address> &vertices) const;
+
+  /**
+   * \brief Record a vertex added to the SPF tree in an SPF state
+   * \param state the SPF state, or 0 if not in incremental mode
+   * \param v the vertex
+   */
+  void RecordVertex (SPFState *state, SPFVertex *v);
+
+  /**
+   * \brief Record the distance of a vertex in an SPF state
+   * \param state the SPF state, or 0 if not in incremental mode
+   * \param vertex the vertex ID
+   * \param distance the distance from the root
+   */
+  void RecordDistance (SPFState *state, Ipv4Address vertex, uint32_t distance);
+
+  /**
+   * \brief Get the distance of a vertex in an SPF state
+   * \param state the SPF state
+   * \param vertex the vertex ID
+   * \returns the distance from the root, or SPF_INFINITY if not in the tree
+   */
+  uint32_t GetDistance (const SPFState &state, Ipv4Address vertex) const;
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
@@ -787,6 +933,22 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Add the routes of a router from the SPF tree recorded by its
+   * last SPF calculation, with the links of the current database
+   *
+   * The tree must be the tree of a calculation with the current database.
+   * \param root the root node
+   * \param state the SPF state of the router
+   */
+  void SPFRebuild (Ipv4Address root, const SPFState &state);
+
+  /**
+   * \brief Add the routes to the stub networks and the external routes
+   * from the SPF tree, and delete the tree
+   */
+  void SPFAddStubAndExternalRoutes (void);
+
   /**
    * \brief Process Stub nodes
    *
@@ -62,6 +62,15 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables after a change of the topology
+ *
+ * When the GlobalValue "GlobalRoutingIncrementalSpf" is true, only the
+ * routers whose routes may change compute them again.
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
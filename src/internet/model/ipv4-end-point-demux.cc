@@ -26,8 +26,27 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+bool
+Ipv4EndPointDemux::Tuple::operator == (const Tuple &other) const
+{
+  return localAddress == other.localAddress
+         && localPort == other.localPort
+         && peerAddress == other.peerAddress
+         && peerPort == other.peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::TupleHash::operator() (const Tuple &tuple) const
+{
+  Ipv4AddressHash addressHash;
+  size_t hash = addressHash (tuple.localAddress);
+  hash = hash * 1000003 ^ addressHash (tuple.peerAddress);
+  hash = hash * 1000003 ^ ((size_t (tuple.localPort) << 16) | tuple.peerPort);
+  return hash;
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -35,36 +54,103 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  m_tuples.clear ();
+  m_ports.clear ();
+  for (EndPointMap::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
-      Ipv4EndPoint *endPoint = *i;
+      Ipv4EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Tuple tuple;
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  m_tuples[tuple][endPoint->m_order] = endPoint;
+  m_ports[tuple.localPort][endPoint->m_order] = endPoint;
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Tuple tuple;
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  sgi::hash_map<Tuple, EndPointMap, TupleHash>::iterator i = m_tuples.find (tuple);
+  NS_ASSERT (i != m_tuples.end ());
+  i->second.erase (endPoint->m_order);
+  if (i->second.empty ())
+    {
+      m_tuples.erase (i);
+    }
+  sgi::hash_map<uint16_t, EndPointMap>::iterator j = m_ports.find (tuple.localPort);
+  NS_ASSERT (j != m_ports.end ());
+  j->second.erase (endPoint->m_order);
+  if (j->second.empty ())
+    {
+      m_ports.erase (j);
+    }
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_order = m_order++;
+  m_endPoints[endPoint->m_order] = endPoint;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+const Ipv4EndPointDemux::EndPointMap *
+Ipv4EndPointDemux::Find (Ipv4Address localAddress, uint16_t localPort,
+                         Ipv4Address peerAddress, uint16_t peerPort) const
+{
+  Tuple tuple;
+  tuple.localAddress = localAddress;
+  tuple.localPort = localPort;
+  tuple.peerAddress = peerAddress;
+  tuple.peerPort = peerPort;
+  sgi::hash_map<Tuple, EndPointMap, TupleHash>::const_iterator i = m_tuples.find (tuple);
+  if (i == m_tuples.end ())
+    {
+      return 0;
+    }
+  return &i->second;
+}
+
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  sgi::hash_map<uint16_t, EndPointMap>::iterator j = m_ports.find (port);
+  if (j == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      return false;
+    }
+  for (EndPointMap::iterator i = j->second.begin (); i != j->second.end (); i++) 
+    {
+      if (i->second->GetLocalAddress () == addr) 
         {
           return true;
         }
@@ -82,10 +168,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -98,10 +181,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -121,10 +201,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -132,39 +209,28 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (Find (localAddress, localPort, peerAddress, peerPort) != 0)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointMap::iterator i = m_endPoints.find (endPoint->m_order);
+  if (endPoint->m_demux == this && i != m_endPoints.end () && i->second == endPoint)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -177,14 +243,36 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointMap::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv4EndPoint* endP = *i;
+      Ipv4EndPoint* endP = i->second;
       ret.push_back (endP);
     }
   return ret;
 }
 
+bool
+Ipv4EndPointDemux::IsReceiving (Ipv4EndPoint *endP, Ptr<Ipv4Interface> incomingInterface)
+{
+  if (!endP->IsRxEnabled ())
+    {
+      NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                    << " because endpoint can not receive packets");
+      return false;
+    }
+  if (endP->GetBoundNetDevice ())
+    {
+      if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          return false;
+        }
+    }
+  return true;
+}
 
 /*
  * If we have an exact match, we return it.
@@ -204,65 +292,75 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
     {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
-      if (!endP->IsRxEnabled ())
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
         }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
 
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-      if (endP->GetBoundNetDevice ())
+  if (!isBroadcast)
+    {
+      // Each match is a single four-tuple: probe them, most exact first
+      const EndPointMap *matches[4];
+      matches[0] = Find (daddr, dport, saddr, sport);
+      matches[1] = Find (Ipv4Address::GetAny (), dport, saddr, sport);
+      matches[2] = Find (daddr, dport, Ipv4Address::GetAny (), 0);
+      matches[3] = Find (Ipv4Address::GetAny (), dport, Ipv4Address::GetAny (), 0);
+      for (uint32_t j = 0; j < 4; j++)
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          if (matches[j] == 0)
             {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
               continue;
             }
-        }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+          for (EndPointMap::const_iterator i = matches[j]->begin (); i != matches[j]->end (); i++)
+            {
+              if (IsReceiving (i->second, incomingInterface))
+                {
+                  retval1.push_back (i->second);
+                }
+            }
+          if (!retval1.empty ())
             {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
+              return retval1;
             }
         }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+      return retval1;  // empty, no matches
+    }
+
+  sgi::hash_map<uint16_t, EndPointMap>::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return retval1;
+    }
+  for (EndPointMap::iterator i = port->second.begin (); i != port->second.end (); i++) 
+    {
+      Ipv4EndPoint* endP = i->second;
+
+      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                                 << " daddr=" << endP->GetLocalAddress ()
+                                                 << " sport=" << endP->GetPeerPort ()
+                                                 << " saddr=" << endP->GetPeerAddress ());
+
+      if (!IsReceiving (endP, incomingInterface))
+        {
+          continue;
+        }
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
 
-      if (isBroadcast)
-        {
-          NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
-        }
+      NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
 
-      if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+      if (endP->GetLocalAddress () != Ipv4Address::GetAny ())
         {
           localAddressMatchesExact = (endP->GetLocalAddress () ==
                                       incomingInterfaceAddr);
@@ -289,7 +387,7 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
         { // Only local port matches exactly
           retval1.push_back (endP);
         }
-      if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
+      if ((localAddressMatchesExact || localAddressMatchesWildCard) &&
           remotePeerMatchesWildCard &&
           remoteAddressMatchesWildCard)
         { // Only local port and local address matches exactly
@@ -324,35 +422,36 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  const EndPointMap *exact = Find (daddr, dport, saddr, sport);
+  if (exact != 0)
+    {
+      /* this is an exact match. */
+      return exact->begin ()->second;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  sgi::hash_map<uint16_t, EndPointMap>::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+  for (EndPointMap::iterator i = port->second.begin (); i != port->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
-      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
-      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetPeerAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
       if (tmp < genericity) 
         {
-          generic = (*i);
+          generic = i->second;
           genericity = tmp;
         }
     }
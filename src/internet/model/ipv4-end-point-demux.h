@@ -23,8 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
-#include "ipv4-interface.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/ipv4-interface.h"
 
 namespace ns3 {
 
@@ -38,6 +40,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by their four-tuple, wildcards included, and
+ * by their local port: a lookup probes the four-tuples matching a packet
+ * in the order of precedence of the matches, rather than walking all the
+ * endpoints.  Only the broadcast packets are matched against all the
+ * endpoints of their destination port.  The endpoints notify the demux
+ * when their four-tuple changes.
  */
 
 class Ipv4EndPointDemux {
@@ -161,6 +170,80 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Endpoints, by allocation order.
+   */
+  typedef std::map<uint64_t, Ipv4EndPoint *> EndPointMap;
+
+  /**
+   * \brief The four-tuple of an endpoint.
+   */
+  struct Tuple
+  {
+    Ipv4Address localAddress; //!< The local address.
+    uint16_t localPort;       //!< The local port.
+    Ipv4Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \param other another four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator == (const Tuple &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  class TupleHash : public std::unary_function<Tuple, size_t>
+  {
+public:
+    /**
+     * \param tuple the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (const Tuple &tuple) const;
+  };
+
+  /**
+   * \brief Index an endpoint by its four-tuple and its local port.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the indexes.
+   * \param endPoint the endpoint, with the four-tuple it was indexed with
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add a new endpoint.
+   * \param endPoint the endpoint
+   * \returns the endpoint
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints of a four-tuple.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \returns the endpoints, 0 if none
+   */
+  const EndPointMap *Find (Ipv4Address localAddress, uint16_t localPort,
+                           Ipv4Address peerAddress, uint16_t peerPort) const;
+
+  /**
+   * \brief Check if an endpoint can receive the packets of an interface.
+   * \param endPoint the endpoint
+   * \param incomingInterface the incoming interface
+   * \returns true if the endpoint is enabled and not bound to another device
+   */
+  static bool IsReceiving (Ipv4EndPoint *endPoint, Ptr<Ipv4Interface> incomingInterface);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -184,9 +267,24 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief The IPv4 end points, by allocation order.
+   */
+  EndPointMap m_endPoints;
+
+  /**
+   * \brief The allocation order of the next end point.
+   */
+  uint64_t m_order;
+
+  /**
+   * \brief The IPv4 end points, by four-tuple.
+   */
+  sgi::hash_map<Tuple, EndPointMap, TupleHash> m_tuples;
+
+  /**
+   * \brief The IPv4 end points, by local port.
    */
-  EndPoints m_endPoints;
+  sgi::hash_map<uint16_t, EndPointMap> m_ports;
 };
 
 } // namespace ns3
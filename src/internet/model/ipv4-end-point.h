@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \brief A representation of an internet endpoint/connection
@@ -246,6 +247,18 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  friend class Ipv4EndPointDemux;
+
+  /**
+   * \brief The demux indexing the endpoint by its four-tuple (if any).
+   */
+  Ipv4EndPointDemux *m_demux;
+
+  /**
+   * \brief The allocation order of the endpoint in the demux.
+   */
+  uint64_t m_order;
 };
 
 } // namespace ns3
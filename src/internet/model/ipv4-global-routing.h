@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -263,6 +264,9 @@ private:
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ipv4RouteTrie m_hostTrie;            //!< Routes to hosts, by destination
+  Ipv4RouteTrie m_networkTrie;         //!< Routes to networks, by destination
+  Ipv4RouteTrie m_externalTrie;        //!< External routes, by destination
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
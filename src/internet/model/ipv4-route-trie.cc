@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+Ipv4RouteTrie::Node::Node (uint32_t prefix, uint32_t length)
+  : prefix (prefix),
+    length (length)
+{
+  children[0] = 0;
+  children[1] = 0;
+}
+
+Ipv4RouteTrie::Node::~Node ()
+{
+  delete children[0];
+  delete children[1];
+}
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (new Node (0, 0)),
+    m_order (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_root;
+}
+
+uint32_t
+Ipv4RouteTrie::GetMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+uint32_t
+Ipv4RouteTrie::GetBit (uint32_t address, uint32_t length)
+{
+  return (address >> (31 - length)) & 1;
+}
+
+void
+Ipv4RouteTrie::Insert (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  Entry entry;
+  entry.route = route;
+  entry.metric = metric;
+  entry.length = route->GetDestNetworkMask ().GetPrefixLength ();
+  entry.order = m_order++;
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  if (mask != GetMask (entry.length))
+    {
+      NS_LOG_LOGIC ("Non-contiguous mask " << route->GetDestNetworkMask ());
+      m_irregular.push_back (entry);
+      return;
+    }
+  uint32_t prefix = route->GetDestNetwork ().Get () & mask;
+  uint32_t length = entry.length;
+
+  Node *node = m_root;
+  while (node->length != length)
+    {
+      NS_ASSERT (node->length < length && (prefix & GetMask (node->length)) == node->prefix);
+      uint32_t bit = GetBit (prefix, node->length);
+      Node *child = node->children[bit];
+      if (child == 0)
+        {
+          child = new Node (prefix, length);
+          node->children[bit] = child;
+          node = child;
+          break;
+        }
+      // length of the prefix common to the child and the route
+      uint32_t common = node->length + 1;
+      uint32_t max = std::min (child->length, length);
+      while (common < max && GetBit (child->prefix, common) == GetBit (prefix, common))
+        {
+          common++;
+        }
+      if (common == child->length)
+        {
+          node = child;
+          continue;
+        }
+      // split the edge to the child
+      Node *split = new Node (prefix & GetMask (common), common);
+      split->children[GetBit (child->prefix, common)] = child;
+      node->children[bit] = split;
+      if (common == length)
+        {
+          node = split;
+        }
+      else
+        {
+          node = new Node (prefix, length);
+          split->children[GetBit (prefix, common)] = node;
+        }
+      break;
+    }
+  node->entries.push_back (entry);
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  if (mask != GetMask (length))
+    {
+      for (std::vector<Entry>::iterator i = m_irregular.begin (); i != m_irregular.end (); ++i)
+        {
+          if (i->route == route)
+            {
+              m_irregular.erase (i);
+              return;
+            }
+        }
+      return;
+    }
+  uint32_t prefix = route->GetDestNetwork ().Get () & mask;
+
+  Node **parentLink = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length
+         && (prefix & GetMask ((*link)->length)) == (*link)->prefix)
+    {
+      parentLink = link;
+      link = &(*link)->children[GetBit (prefix, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != length || node->prefix != prefix)
+    {
+      NS_LOG_LOGIC ("Route " << route << " not found");
+      return;
+    }
+  for (std::vector<Entry>::iterator i = node->entries.begin (); i != node->entries.end (); ++i)
+    {
+      if (i->route == route)
+        {
+          node->entries.erase (i);
+          break;
+        }
+    }
+
+  // the nodes without route are only kept to branch
+  if (!node->entries.empty () || node == m_root
+      || (node->children[0] != 0 && node->children[1] != 0))
+    {
+      return;
+    }
+  Node *child = node->children[0] != 0 ? node->children[0] : node->children[1];
+  *link = child;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  delete node;
+  // the parent may be left without route and with a single child
+  Node *parent = *parentLink;
+  if (child == 0 && parent != m_root && parent->entries.empty ())
+    {
+      *parentLink = parent->children[0] != 0 ? parent->children[0] : parent->children[1];
+      parent->children[0] = 0;
+      parent->children[1] = 0;
+      delete parent;
+    }
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  delete m_root;
+  m_root = new Node (0, 0);
+  m_irregular.clear ();
+}
+
+void
+Ipv4RouteTrie::Lookup (Ipv4Address dest, std::vector<Entry> &entries) const
+{
+  uint32_t address = dest.Get ();
+  const Node *node = m_root;
+  while (node != 0 && (address & GetMask (node->length)) == node->prefix)
+    {
+      entries.insert (entries.end (), node->entries.begin (), node->entries.end ());
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->children[GetBit (address, node->length)];
+    }
+  for (std::vector<Entry>::const_iterator i = m_irregular.begin (); i != m_irregular.end (); ++i)
+    {
+      if (i->route->GetDestNetworkMask ().IsMatch (dest, i->route->GetDestNetwork ()))
+        {
+          entries.push_back (*i);
+        }
+    }
+}
+
+} // namespace ns3
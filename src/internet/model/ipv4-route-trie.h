@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief An index of unicast routes by destination prefix.
+ *
+ * The routes are stored in a path-compressed binary trie (a Patricia
+ * trie) of their destination prefixes: looking up the routes matching
+ * an address visits at most one node per bit of the longest matching
+ * prefix, whatever the number of routes.  Routes are inserted and
+ * removed one at a time, the trie is never rebuilt.
+ *
+ * The trie does not own the routes, nor does it decide which one is
+ * used: Lookup() returns all the matching routes, with their prefix
+ * length, metric, and insertion order, so that the routing protocols
+ * keep their own selection rules.  The routes with a non-contiguous
+ * mask are kept aside and checked one by one.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /** A route of the trie. */
+  struct Entry
+  {
+    Ipv4RoutingTableEntry *route;   //!< The route.
+    uint32_t metric;                //!< The metric of the route.
+    uint32_t length;                //!< The prefix length of the route.
+    uint64_t order;                 //!< The insertion order of the route.
+  };
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * Insert a route, after the routes already inserted.
+   * \param route the route, indexed by its destination network and mask
+   * \param metric the metric of the route
+   */
+  void Insert (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * Remove a route.
+   * \param route the route, which must not have changed since it was
+   * inserted
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  /** Remove all the routes. */
+  void Clear (void);
+  /**
+   * \param dest a destination address
+   * \param entries the routes whose destination network matches the
+   * address, in no particular order
+   */
+  void Lookup (Ipv4Address dest, std::vector<Entry> &entries) const;
+
+private:
+  /// Forbid copy
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+  /// Forbid assignment
+  Ipv4RouteTrie &operator= (const Ipv4RouteTrie &);
+
+  /** A node of the trie: a prefix, and its routes, if any. */
+  struct Node
+  {
+    /**
+     * \param prefix the prefix, without host bits
+     * \param length the prefix length
+     */
+    Node (uint32_t prefix, uint32_t length);
+    ~Node ();
+    uint32_t prefix;              //!< The prefix.
+    uint32_t length;              //!< The prefix length.
+    std::vector<Entry> entries;   //!< The routes to the prefix.
+    Node *children[2];            //!< The longer prefixes, by their next bit.
+  };
+
+  /**
+   * \param length a prefix length
+   * \returns the mask of the prefix length
+   */
+  static uint32_t GetMask (uint32_t length);
+  /**
+   * \param address an address
+   * \param length a prefix length, less than 32
+   * \returns the bit of the address after the prefix
+   */
+  static uint32_t GetBit (uint32_t address, uint32_t length);
+
+  Node *m_root;                   //!< The node of the empty prefix.
+  std::vector<Entry> m_irregular; //!< The routes with a non-contiguous mask.
+  uint64_t m_order;               //!< Order of the next route.
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -430,6 +431,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, by destination prefix.
+   */
+  Ipv4RouteTrie m_networkTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -26,10 +26,28 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+bool Ipv6EndPointDemux::Tuple::operator == (const Tuple &other) const
+{
+  return localAddress == other.localAddress
+         && localPort == other.localPort
+         && peerAddress == other.peerAddress
+         && peerPort == other.peerPort;
+}
+
+size_t Ipv6EndPointDemux::TupleHash::operator() (const Tuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  size_t hash = addressHash (tuple.localAddress);
+  hash = hash * 1000003 ^ addressHash (tuple.peerAddress);
+  hash = hash * 1000003 ^ ((size_t (tuple.localPort) << 16) | tuple.peerPort);
+  return hash;
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_order (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -37,34 +55,97 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  m_tuples.clear ();
+  m_ports.clear ();
+  for (EndPointMap::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv6EndPoint *endPoint = *i;
+      Ipv6EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  Tuple tuple;
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  m_tuples[tuple][endPoint->m_order] = endPoint;
+  m_ports[tuple.localPort][endPoint->m_order] = endPoint;
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Tuple tuple;
+  tuple.localAddress = endPoint->GetLocalAddress ();
+  tuple.localPort = endPoint->GetLocalPort ();
+  tuple.peerAddress = endPoint->GetPeerAddress ();
+  tuple.peerPort = endPoint->GetPeerPort ();
+  sgi::hash_map<Tuple, EndPointMap, TupleHash>::iterator i = m_tuples.find (tuple);
+  NS_ASSERT (i != m_tuples.end ());
+  i->second.erase (endPoint->m_order);
+  if (i->second.empty ())
     {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
+      m_tuples.erase (i);
+    }
+  sgi::hash_map<uint16_t, EndPointMap>::iterator j = m_ports.find (tuple.localPort);
+  NS_ASSERT (j != m_ports.end ());
+  j->second.erase (endPoint->m_order);
+  if (j->second.empty ())
+    {
+      m_ports.erase (j);
     }
-  return false;
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_order = m_order++;
+  m_endPoints[endPoint->m_order] = endPoint;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+const Ipv6EndPointDemux::EndPointMap* Ipv6EndPointDemux::Find (Ipv6Address localAddress, uint16_t localPort,
+                                                               Ipv6Address peerAddress, uint16_t peerPort) const
+{
+  Tuple tuple;
+  tuple.localAddress = localAddress;
+  tuple.localPort = localPort;
+  tuple.peerAddress = peerAddress;
+  tuple.peerPort = peerPort;
+  sgi::hash_map<Tuple, EndPointMap, TupleHash>::const_iterator i = m_tuples.find (tuple);
+  if (i == m_tuples.end ())
+    {
+      return 0;
+    }
+  return &i->second;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  sgi::hash_map<uint16_t, EndPointMap>::iterator j = m_ports.find (port);
+  if (j == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
+      return false;
+    }
+  for (EndPointMap::iterator i = j->second.begin (); i != j->second.end (); i++)
+    {
+      if (i->second->GetLocalAddress () == addr)
         {
           return true;
         }
@@ -81,10 +162,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -96,15 +174,12 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (uint16_t port)
 {
-  NS_LOG_FUNCTION (this <<  port);
+  NS_LOG_FUNCTION (this << port);
 
   return Allocate (Ipv6Address::GetAny (), port);
 }
@@ -117,48 +192,34 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       NS_LOG_WARN ("Duplicate address/port; failing.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t localPort,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (Find (localAddress, localPort, peerAddress, peerPort) != 0)
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointMap::iterator i = m_endPoints.find (endPoint->m_order);
+  if (endPoint->m_demux == this && i != m_endPoints.end () && i->second == endPoint)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -173,158 +234,95 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
 
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
+  EndPoints retval;
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      Ipv6EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
 
-      if (!endP->IsRxEnabled ())
+  /* Each match is a single four-tuple: probe them, most exact first.
+     The endpoints bound to the all-routers address only match the
+     packets sent to that address, as exact matches. */
+  const EndPointMap *matches[4];
+  matches[0] = Find (daddr, dport, saddr, sport);  /* Exact match on all 4 */
+  matches[1] = Find (Ipv6Address::GetAny (), dport, saddr, sport);  /* Matches all but local address */
+  matches[2] = Find (daddr, dport, Ipv6Address::GetAny (), 0);  /* Matches exact on local port/adder, wildcards on others */
+  matches[3] = Find (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0);  /* Matches exact on local port, wildcards on others */
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      if (matches[j] == 0)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport)
+      for (EndPointMap::const_iterator i = matches[j]->begin (); i != matches[j]->end (); i++)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
+          Ipv6EndPoint* endP = i->second;
 
-      if (endP->GetBoundNetDevice ())
-        {
-          if (!incomingInterface)
-            {
-              continue;
-            }
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          if (!endP->IsRxEnabled ())
             {
               NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
+                            << " because endpoint can not receive packets");
               continue;
             }
-        }
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
-
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
-
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
+          if (endP->GetBoundNetDevice ())
+            {
+              if (!incomingInterface)
+                {
+                  continue;
+                }
+              if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+                {
+                  NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                                     << " because endpoint is bound to specific device and"
+                                                     << endP->GetBoundNetDevice ()
+                                                     << " does not match packet device " << incomingInterface->GetDevice ());
+                  continue;
+                }
+            }
+          retval.push_back (endP);
         }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+      /* Here we find the most exact match */
+      if (!retval.empty ())
         {
-          continue;
-        }
-
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
+          return retval;
         }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
-    }
-
-  /* Here we find the most exact match */
-  if (!retval4.empty ())
-    {
-      return retval4;
-    }
-  if (!retval3.empty ())
-    {
-      return retval3;
     }
-  if (!retval2.empty ())
-    {
-      return retval2;
-    }
-  return retval1;  /* might be empty if no matches */
+  return retval;  /* empty if no matches */
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  const EndPointMap *exact = Find (dst, dport, src, sport);
+  if (exact != 0)
+    {
+      /* this is an exact match. */
+      return exact->begin ()->second;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  sgi::hash_map<uint16_t, EndPointMap>::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+  for (EndPointMap::iterator i = port->second.begin (); i != port->second.end (); i++)
     {
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
-      if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
-          && (*i)->GetPeerAddress () == src)
-        {
-          /* this is an exact match. */
-          return *i;
-        }
-
-      if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
+      if (i->second->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
-      if ((*i)->GetPeerAddress () == Ipv6Address::GetAny ())
+      if (i->second->GetPeerAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
       if (tmp < genericity)
         {
-          generic = (*i);
+          generic = i->second;
           genericity = tmp;
         }
     }
@@ -355,8 +353,12 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints ret;
+  for (EndPointMap::const_iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+    {
+      ret.push_back (i->second);
+    }
+  return ret;
 }
 
 } /* namespace ns3 */
-
@@ -23,8 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv6-address.h"
-#include "ipv6-interface.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/ipv6-interface.h"
 
 namespace ns3 {
 
@@ -33,6 +35,12 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * The endpoints are indexed by their four-tuple, wildcards included, and
+ * by their local port: a lookup probes the four-tuples matching a packet
+ * in the order of precedence of the matches, rather than walking all the
+ * endpoints.  The endpoints notify the demux when their four-tuple
+ * changes.
  */
 class Ipv6EndPointDemux
 {
@@ -146,6 +154,73 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Endpoints, by allocation order.
+   */
+  typedef std::map<uint64_t, Ipv6EndPoint *> EndPointMap;
+
+  /**
+   * \brief The four-tuple of an endpoint.
+   */
+  struct Tuple
+  {
+    Ipv6Address localAddress; //!< The local address.
+    uint16_t localPort;       //!< The local port.
+    Ipv6Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \param other another four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator == (const Tuple &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  class TupleHash : public std::unary_function<Tuple, size_t>
+  {
+public:
+    /**
+     * \param tuple the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (const Tuple &tuple) const;
+  };
+
+  /**
+   * \brief Index an endpoint by its four-tuple and its local port.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the indexes.
+   * \param endPoint the endpoint, with the four-tuple it was indexed with
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add a new endpoint.
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints of a four-tuple.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the endpoints, 0 if none
+   */
+  const EndPointMap *Find (Ipv6Address localAddress, uint16_t localPort,
+                           Ipv6Address peerAddress, uint16_t peerPort) const;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -168,9 +243,24 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief The IPv6 end points, by allocation order.
+   */
+  EndPointMap m_endPoints;
+
+  /**
+   * \brief The allocation order of the next end point.
+   */
+  uint64_t m_order;
+
+  /**
+   * \brief The IPv6 end points, by four-tuple.
+   */
+  sgi::hash_map<Tuple, EndPointMap, TupleHash> m_tuples;
+
+  /**
+   * \brief The IPv6 end points, by local port.
    */
-  EndPoints m_endPoints;
+  sgi::hash_map<uint16_t, EndPointMap> m_ports;
 };
 
 } /* namespace ns3 */
@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \brief A representation of an internet IPv6 endpoint/connection
@@ -254,6 +255,18 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  friend class Ipv6EndPointDemux;
+
+  /**
+   * \brief The demux indexing the endpoint by its four-tuple (if any).
+   */
+  Ipv6EndPointDemux *m_demux;
+
+  /**
+   * \brief The allocation order of the endpoint in the demux.
+   */
+  uint64_t m_order;
 };
 
 } /* namespace ns3 */
@@ -139,13 +139,14 @@ TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
       m_inFastRec = true;
       NS_LOG_INFO ("Triple dupack. Enter fast recovery mode. Reset cwnd to " << m_cWnd <<
                    ", ssthresh to " << m_ssThresh << " at fast recovery seqnum " << m_recover);
+      m_highRxtMark = m_txBuffer->HeadSequence ();
       DoRetransmit ();
     }
   else if (m_inFastRec)
     { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
       m_cWnd += m_segmentSize;
       NS_LOG_INFO ("Dupack in fast recovery mode. Increase cwnd to " << m_cWnd);
-      if (!m_sendPendingDataEvent.IsRunning ())
+      if (!RetransmitSackHole () && !m_sendPendingDataEvent.IsRunning ())
         {
           SendPendingData (m_connected);
         }
@@ -121,13 +121,14 @@ TcpReno::DupAck (const TcpHeader& t, uint32_t count)
       m_cWnd = m_ssThresh + 3 * m_segmentSize;
       m_inFastRec = true;
       NS_LOG_INFO ("Triple dupack. Reset cwnd to " << m_cWnd << ", ssthresh to " << m_ssThresh);
+      m_highRxtMark = m_txBuffer->HeadSequence ();
       DoRetransmit ();
     }
   else if (m_inFastRec)
     { // In fast recovery, inc cwnd for every additional dupack (RFC2581, sec.3.2)
       m_cWnd += m_segmentSize;
       NS_LOG_INFO ("Increased cwnd to " << m_cWnd);
-      if (!m_sendPendingDataEvent.IsRunning ())
+      if (!RetransmitSackHole () && !m_sendPendingDataEvent.IsRunning ())
         {
           SendPendingData (m_connected);
         }
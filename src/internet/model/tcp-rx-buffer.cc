@@ -156,8 +156,14 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The buffered packets do not
+  // overlap, so only the last one starting at or before the head of the
+  // incoming packet may cover it.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -196,19 +202,12 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
   m_data [ headSeq ] = p;
+  m_lastRxSeq = headSeq;
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  for (BufIterator i = m_data.find (m_nextRxSeq); i != m_data.end () && i->first == m_nextRxSeq; ++i)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
       m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
       m_availBytes += i->second->GetSize ();
     }
@@ -229,7 +228,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -238,8 +237,18 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       // Check if we send the whole pkt or just a partial
       uint32_t pktSize = i->second->GetSize ();
       if (pktSize <= extractSize)
-        { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+        { // Whole packet is extracted, the first one without copying its data
+          if (outPkt == 0)
+            {
+              // a copy, without the packet tags of the segment, as
+              // AddAtEnd does not copy them either
+              outPkt = i->second->Copy ();
+              outPkt->RemoveAllPacketTags ();
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second);
+            }
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -247,15 +256,25 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
+          Ptr<Packet> fragment = i->second->CreateFragment (0, extractSize);
+          if (outPkt == 0)
+            {
+              outPkt = fragment;
+              outPkt->RemoveAllPacketTags ();
+            }
+          else
+            {
+              outPkt->AddAtEnd (fragment);
+            }
+          m_data.insert (i, std::make_pair (i->first + SequenceNumber32 (extractSize),
+                                            i->second->CreateFragment (extractSize, pktSize - extractSize)));
           m_data.erase (i);
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
     }
-  if (outPkt->GetSize () == 0)
+  if (outPkt == 0 || outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
       return 0;
@@ -265,4 +284,41 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   return outPkt;
 }
 
+TcpOptionSack::SackList
+TcpRxBuffer::GetSackList (uint32_t maxBlocks) const
+{
+  NS_LOG_FUNCTION (this << maxBlocks);
+
+  // Merge the out-of-order packets into blocks of contiguous data
+  TcpOptionSack::SackList blocks;
+  std::map<SequenceNumber32, Ptr<Packet> >::const_iterator i = m_data.upper_bound (m_nextRxSeq);
+  for (; i != m_data.end (); ++i)
+    {
+      SequenceNumber32 tail = i->first + SequenceNumber32 (i->second->GetSize ());
+      if (!blocks.empty () && blocks.back ().second == i->first)
+        {
+          blocks.back ().second = tail;
+        }
+      else
+        {
+          blocks.push_back (TcpOptionSack::SackBlock (i->first, tail));
+        }
+    }
+
+  // Report first the block of the most recent data
+  for (TcpOptionSack::SackList::iterator b = blocks.begin (); b != blocks.end (); ++b)
+    {
+      if (b->first <= m_lastRxSeq && m_lastRxSeq < b->second)
+        {
+          blocks.splice (blocks.begin (), blocks, b);
+          break;
+        }
+    }
+  while (blocks.size () > maxBlocks)
+    {
+      blocks.pop_back ();
+    }
+  return blocks;
+}
+
 } //namepsace ns3
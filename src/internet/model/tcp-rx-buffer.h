@@ -27,6 +27,7 @@
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
 #include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +37,11 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The segments are kept by sequence number, so that the segments
+ * overlapping an incoming one are found by a lookup rather than by
+ * walking the buffer.  Extract returns the first segment itself, without
+ * copying its data, when it holds all the data to extract.
  */
 class TcpRxBuffer : public Object
 {
@@ -124,6 +130,17 @@ public:
    * \returns a packet
    */
   Ptr<Packet> Extract (uint32_t maxSize);
+
+  /**
+   * Get the blocks of contiguous data buffered beyond RCV.NXT, to be
+   * reported in a SACK option. As required by \RFC{2018}, the block
+   * holding the most recently received segment comes first, the others
+   * follow by sequence number.
+   *
+   * \param maxBlocks maximum number of blocks to return
+   * \returns the blocks
+   */
+  TcpOptionSack::SackList GetSackList (uint32_t maxBlocks) const;
 public:
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
@@ -133,6 +150,7 @@ public:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
+  SequenceNumber32 m_lastRxSeq;              //!< Seqnum of the first byte of the data last buffered
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
 };
 
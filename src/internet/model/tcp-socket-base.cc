@@ -49,6 +49,8 @@
 #include "tcp-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
 #include "rtt-estimator.h"
 
 #include <math.h>
@@ -96,6 +98,16 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("Sack", "Enable or disable SACK option",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DelAckCoalescing",
+                   "Defer the ACKs due to the end of the current time step, so that "
+                   "the in-order segments received at once are acknowledged by a single ACK",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_delAckCoalescing),
+                   MakeBooleanChecker ())
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms. See http://www.postel.org/pipermail/end2end-interest/2004-November/004402.html
@@ -190,7 +202,11 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndScaleFactor (0),
     m_rcvScaleFactor (0),
     m_timestampEnabled (true),
-    m_timestampToEcho (0)
+    m_timestampToEcho (0),
+    m_sackEnabled (false),
+    m_sackNegotiated (false),
+    m_highRxtMark (0),
+    m_delAckCoalescing (false)
 
 {
   NS_LOG_FUNCTION (this);
@@ -237,7 +253,11 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndScaleFactor (sock.m_sndScaleFactor),
     m_rcvScaleFactor (sock.m_rcvScaleFactor),
     m_timestampEnabled (sock.m_timestampEnabled),
-    m_timestampToEcho (sock.m_timestampToEcho)
+    m_timestampToEcho (sock.m_timestampToEcho),
+    m_sackEnabled (sock.m_sackEnabled),
+    m_sackNegotiated (sock.m_sackNegotiated),
+    m_highRxtMark (sock.m_highRxtMark),
+    m_delAckCoalescing (sock.m_delAckCoalescing)
 
 {
   NS_LOG_FUNCTION (this);
@@ -1888,7 +1908,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   NS_LOG_FUNCTION (this << seq << maxSize << withAck);
 
   bool isRetransmission = false;
-  if ( seq == m_txBuffer->HeadSequence () )
+  if ( seq == m_txBuffer->HeadSequence () || seq < m_highRxtMark )
     {
       isRetransmission = true;
     }
@@ -2144,7 +2164,15 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      if (++m_delAckCount >= m_delAckMaxCount && m_delAckCoalescing)
+        { // Defer the ACK after the segments received in the same time step
+          if (m_delAckEvent.IsExpired () || !Simulator::GetDelayLeft (m_delAckEvent).IsZero ())
+            {
+              m_delAckEvent.Cancel ();
+              m_delAckEvent = Simulator::ScheduleNow (&TcpSocketBase::DelAckTimeout, this);
+            }
+        }
+      else if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -2268,6 +2296,10 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack)
   NS_LOG_LOGIC ("TCP " << this << " NewAck " << ack <<
                 " numberAck " << (ack - m_txBuffer->HeadSequence ())); // Number bytes ack'ed
   m_txBuffer->DiscardUpTo (ack);
+  if (m_highRxtMark < ack)
+    { // Keep the mark within the window, the sequence numbers wrap around
+      m_highRxtMark = ack;
+    }
   if (GetTxAvailable () > 0)
     {
       NotifySend (GetTxAvailable ());
@@ -2305,6 +2337,9 @@ TcpSocketBase::ReTxTimeout ()
     {
       return;
     }
+  // The peer may have discarded the SACKed data (RFC 2018, sec. 8)
+  m_txBuffer->ResetScoreboard ();
+  m_highRxtMark = m_txBuffer->HeadSequence ();
 
   Retransmit ();
 }
@@ -2407,11 +2442,17 @@ TcpSocketBase::DoRetransmit ()
         }
       return;
     }
+  if (m_sackNegotiated && m_txBuffer->HeadSequence () < m_highRxtMark)
+    { // Already retransmitted from the SACK scoreboard in this recovery
+      NS_LOG_LOGIC ("TcpSocketBase " << this << " seq " << m_txBuffer->HeadSequence () << " already retxed");
+      return;
+    }
   // Retransmit a data packet: Call SendDataPacket
   NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing seq " << m_txBuffer->HeadSequence ());
   uint32_t sz = SendDataPacket (m_txBuffer->HeadSequence (), m_segmentSize, true);
   // In case of RTO, advance m_nextTxSequence
   m_nextTxSequence = std::max (m_nextTxSequence.Get (), m_txBuffer->HeadSequence () + sz);
+  m_highRxtMark = std::max (m_highRxtMark, m_txBuffer->HeadSequence () + sz);
 
 }
 
@@ -2581,6 +2622,13 @@ TcpSocketBase::ReadOptions (const TcpHeader& header)
               ScaleSsThresh (m_sndScaleFactor);
             }
         }
+      // Keep the attribute untouched: a listening socket reads the options
+      // of every SYN it receives, and its forks inherit the negotiated flag
+      m_sackNegotiated = m_sackEnabled && header.HasOption (TcpOption::SACKPERMITTED);
+    }
+  else if (m_sackNegotiated && header.HasOption (TcpOption::SACK))
+    {
+      ProcessOptionSack (header.GetOption (TcpOption::SACK));
     }
 
   bool timestampAttribute = m_timestampEnabled;
@@ -2608,6 +2656,19 @@ TcpSocketBase::AddOptions (TcpHeader& header)
     {
       AddOptionTimestamp (header);
     }
+
+  if (header.GetFlags () & TcpHeader::SYN)
+    {
+      // The SYN-ACK only permits SACK if the SYN did
+      if (m_sackEnabled && (!(header.GetFlags () & TcpHeader::ACK) || m_sackNegotiated))
+        {
+          AddOptionSackPermitted (header);
+        }
+    }
+  else if (m_sackNegotiated && (header.GetFlags () & TcpHeader::ACK))
+    {
+      AddOptionSack (header);
+    }
 }
 
 void
@@ -2702,6 +2763,84 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+void
+TcpSocketBase::AddOptionSackPermitted (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+  NS_ASSERT (header.GetFlags () & TcpHeader::SYN);
+
+  header.AppendOption (CreateObject<TcpOptionSackPermitted> ());
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK-permitted");
+}
+
+void
+TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
+{
+  NS_LOG_FUNCTION (this << option);
+
+  Ptr<const TcpOptionSack> sack = DynamicCast<const TcpOptionSack> (option);
+  const TcpOptionSack::SackList &list = sack->GetSackList ();
+  for (TcpOptionSack::SackList::const_iterator i = list.begin (); i != list.end (); ++i)
+    {
+      m_txBuffer->AddSackBlock (i->first, i->second);
+    }
+
+  NS_LOG_INFO (m_node->GetId () << " Got SACK option with " <<
+               sack->GetNumSackBlocks () << " blocks");
+}
+
+void
+TcpSocketBase::AddOptionSack (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  if (m_rxBuffer->Size () == m_rxBuffer->Available ())
+    { // No out-of-order data
+      return;
+    }
+  // Option space left, once padded, for the kind, length, and 8 bytes per block
+  uint32_t space = 40 - (header.GetLength () * 4 - 20);
+  if (space < 10)
+    {
+      return;
+    }
+  TcpOptionSack::SackList list = m_rxBuffer->GetSackList ((space - 2) / 8);
+  if (list.empty ())
+    {
+      return;
+    }
+  Ptr<TcpOptionSack> option = CreateObject<TcpOptionSack> ();
+  for (TcpOptionSack::SackList::const_iterator i = list.begin (); i != list.end (); ++i)
+    {
+      option->AddSackBlock (*i);
+    }
+
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK with " <<
+               option->GetNumSackBlocks () << " blocks");
+}
+
+bool
+TcpSocketBase::RetransmitSackHole (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_sackNegotiated)
+    {
+      return false;
+    }
+  SequenceNumber32 seq = std::max (m_highRxtMark, m_txBuffer->HeadSequence ());
+  uint32_t size;
+  if (!m_txBuffer->NextHole (seq, size) || seq >= m_nextTxSequence)
+    {
+      return false;
+    }
+  NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing SACK hole at seq " << seq);
+  uint32_t sz = SendDataPacket (seq, std::min (size, m_segmentSize), true);
+  m_highRxtMark = seq + sz;
+  return true;
+}
+
 void TcpSocketBase::UpdateWindowSize (const TcpHeader &header)
 {
   NS_LOG_FUNCTION (this << header);
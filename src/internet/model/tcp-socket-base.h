@@ -685,6 +685,45 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Add the SACK-permitted option to the header
+   *
+   * \param header TcpHeader of a SYN segment
+   */
+  void AddOptionSackPermitted (TcpHeader& header);
+
+  /**
+   * \brief Process the SACK option from the other side
+   *
+   * Mark the blocks reported by the peer in the scoreboard of the Tx buffer.
+   *
+   * \param option Option from the packet
+   */
+  void ProcessOptionSack (const Ptr<const TcpOption> option);
+  /**
+   * \brief Add the SACK option to the header
+   *
+   * Report the blocks of out-of-order data in the Rx buffer, as many as
+   * the option space left allows. Nothing is added if there are none.
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSack (TcpHeader& header);
+
+  /**
+   * \brief Retransmit a segment of the first hole of the SACK scoreboard
+   * that was not retransmitted yet in the current recovery
+   *
+   * Called by the congestion controls upon a duplicate ACK in fast
+   * recovery, in place of sending new data, so that several holes are
+   * repaired in one round trip instead of one hole per partial ACK.
+   * The congestion controls set m_highRxtMark to the head of the Tx
+   * buffer when entering fast recovery.
+   *
+   * \returns true if a segment was retransmitted
+   */
+  bool RetransmitSackHole (void);
+
   /**
    * \brief Scale the initial SsThresh value to the correct one
    *
@@ -773,6 +812,12 @@ protected:
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
 
+  bool     m_sackEnabled;         //!< SACK option enabled
+  bool     m_sackNegotiated;      //!< SACK permitted by both ends on the SYN segments
+  SequenceNumber32 m_highRxtMark; //!< Highest seqno retransmitted in the current recovery + 1
+
+  bool     m_delAckCoalescing;    //!< Send the ACKs due at the end of the time step
+
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
 };
 
@@ -57,7 +57,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_headOffset (0)
 {
 }
 
@@ -111,7 +111,10 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          Block block;
+          block.offset = m_headOffset + m_size;
+          block.packet = p;
+          m_data.push_back (block);
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -133,6 +136,31 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return lastSeq - seq;
 }
 
+TcpTxBuffer::BufIterator
+TcpTxBuffer::Find (uint64_t offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  NS_ASSERT (!m_data.empty () && m_data.front ().offset <= offset);
+  // Binary search of the last packet starting at or before the offset
+  BufIterator first = m_data.begin ();
+  uint32_t count = m_data.size ();
+  while (count > 1)
+    {
+      uint32_t half = count / 2;
+      BufIterator middle = first + half;
+      if (middle->offset <= offset)
+        {
+          first = middle;
+          count -= half;
+        }
+      else
+        {
+          count = half;
+        }
+    }
+  return first;
+}
+
 Ptr<Packet>
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
@@ -148,55 +176,33 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  uint64_t offset = m_headOffset + (seq - m_firstByteSeq.Get ());
+  BufIterator i = Find (offset);
+  uint32_t packetOffset = offset - i->offset;
+  uint32_t fragmentLength = i->packet->GetSize () - packetOffset;
+  NS_LOG_LOGIC ("First byte found in packet at stream offset " << i->offset
+                                                              << ", packet len=" << i->packet->GetSize ());
+  if (fragmentLength >= s)
+    { // Data to be copied falls entirely in this packet
+      return i->packet->CreateFragment (packetOffset, s);
+    }
+  // This packet only fulfills part of the request
+  Ptr<Packet> outPacket = i->packet->CreateFragment (packetOffset, fragmentLength);
+  uint32_t left = s - fragmentLength;
+  for (++i; left > 0; ++i)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
+      NS_ASSERT (i != m_data.end ());
+      uint32_t pktSize = i->packet->GetSize ();
+      if (pktSize > left)
         { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          outPacket->AddAtEnd (i->packet->CreateFragment (0, left));
+          left = 0;
           break;
         }
-      else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-        }
-      count += pktSize;
+      outPacket->AddAtEnd (i->packet);
+      left -= pktSize;
     }
+  NS_LOG_LOGIC ("Output packet is of size " << outPacket->GetSize ());
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
@@ -217,30 +223,28 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
+  // Discard the bytes, then the packets entirely behind the seqnum. The
+  // first packet may start before the head: it is not fragmented, the
+  // sequence numbers are mapped to its bytes by the stream offset.
+  uint32_t offset = std::min (m_size, static_cast<uint32_t> (seq - m_firstByteSeq.Get ()));  // Number of bytes to remove
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  m_size -= offset;
+  m_headOffset += offset;
+  m_firstByteSeq += offset;
+  while (!m_data.empty ()
+         && m_data.front ().offset + m_data.front ().packet->GetSize () <= m_headOffset)
     {
-      if (offset > (*i)->GetSize ())
-        { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
-          m_size -= pktSize;
-          offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
-        }
-      else if (offset > 0)
-        { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
-          m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
-          break;
+      NS_LOG_LOGIC ("Removed one packet of size " << m_data.front ().packet->GetSize ());
+      m_data.pop_front ();
+    }
+  // Forget the SACKed blocks acknowledged, and trim the one straddling the head
+  while (!m_sacked.empty () && m_sacked.begin ()->first < m_headOffset)
+    {
+      uint64_t end = m_sacked.begin ()->second;
+      m_sacked.erase (m_sacked.begin ());
+      if (end > m_headOffset)
+        {
+          m_sacked[m_headOffset] = end;
         }
     }
   // Catching the case of ACKing a FIN
@@ -253,4 +257,73 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+void
+TcpTxBuffer::AddSackBlock (const SequenceNumber32& begin, const SequenceNumber32& end)
+{
+  NS_LOG_FUNCTION (this << begin << end);
+  int32_t first = std::max (begin - m_firstByteSeq.Get (), 0);
+  int32_t last = std::min (end - m_firstByteSeq.Get (), static_cast<int32_t> (m_size));
+  if (first >= last)
+    {
+      NS_LOG_LOGIC ("Block out of the buffer, ignored");
+      return;
+    }
+  uint64_t b = m_headOffset + first;
+  uint64_t e = m_headOffset + last;
+
+  // Merge the block with the blocks it overlaps or touches
+  std::map<uint64_t, uint64_t>::iterator i = m_sacked.upper_bound (b);
+  if (i != m_sacked.begin ())
+    {
+      std::map<uint64_t, uint64_t>::iterator previous = i;
+      --previous;
+      if (previous->second >= b)
+        {
+          b = previous->first;
+          e = std::max (e, previous->second);
+          m_sacked.erase (previous);
+        }
+    }
+  while (i != m_sacked.end () && i->first <= e)
+    {
+      e = std::max (e, i->second);
+      m_sacked.erase (i++);
+    }
+  m_sacked[b] = e;
+}
+
+void
+TcpTxBuffer::ResetScoreboard (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sacked.clear ();
+}
+
+bool
+TcpTxBuffer::NextHole (SequenceNumber32& seq, uint32_t& size) const
+{
+  NS_LOG_FUNCTION (this << seq);
+  if (m_sacked.empty ())
+    {
+      return false;
+    }
+  uint64_t offset = m_headOffset + std::max (seq - m_firstByteSeq.Get (), 0);
+  std::map<uint64_t, uint64_t>::const_iterator i = m_sacked.upper_bound (offset);
+  if (i != m_sacked.begin ())
+    {
+      std::map<uint64_t, uint64_t>::const_iterator previous = i;
+      --previous;
+      // Skip the SACKed block holding the sequence number
+      offset = std::max (offset, previous->second);
+    }
+  if (i == m_sacked.end ())
+    { // No SACKed data beyond: not a hole
+      return false;
+    }
+  seq = m_firstByteSeq + SequenceNumber32 (offset - m_headOffset);
+  size = i->first - offset;
+  NS_LOG_LOGIC ("Hole at " << seq << " of " << size << " bytes");
+  return true;
+}
+
 } // namepsace ns3
@@ -21,7 +21,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
+#include <map>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +37,15 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets added by the application are kept as they are, each with
+ * the offset of its first byte in the stream of data sent, so that the
+ * packet holding a sequence number is found by a binary search rather
+ * than by walking the buffer.  The segments are built from fragments of
+ * these packets, which share their data until either is written.
+ *
+ * The buffer also keeps the scoreboard of the data the peer reported
+ * in SACK options, to find the holes to retransmit.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,14 +137,56 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  /**
+   * Mark a block of data as received by the peer, as reported in a SACK
+   * option. The parts of the block outside the buffer are ignored.
+   *
+   * \param begin the sequence number of the first byte of the block
+   * \param end the sequence number following the last byte of the block
+   */
+  void AddSackBlock (const SequenceNumber32& begin, const SequenceNumber32& end);
+
+  /**
+   * Forget the data reported in SACK options, as the peer may discard
+   * them (\RFC{2018} sec. 8). Called upon a retransmission timeout.
+   */
+  void ResetScoreboard (void);
+
+  /**
+   * Find the first hole of the scoreboard from a sequence number, i.e.
+   * the first data neither acknowledged nor reported in a SACK option,
+   * followed by data reported in a SACK option.
+   *
+   * \param seq the sequence number to search from, set to the sequence
+   * number of the first byte of the hole
+   * \param size set to the number of bytes of the hole
+   * \returns false if there is no hole from the sequence number
+   */
+  bool NextHole (SequenceNumber32& seq, uint32_t& size) const;
+
 private:
+  /// A packet of the buffer
+  struct Block
+  {
+    uint64_t offset;      //!< Offset of the first byte of the packet in the stream
+    Ptr<Packet> packet;   //!< The packet
+  };
   /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<Block>::iterator BufIterator;
+
+  /**
+   * \brief Find the packet holding a byte of the buffer
+   * \param offset the offset of the byte in the stream, within the buffer
+   * \returns the packet holding the byte
+   */
+  BufIterator Find (uint64_t offset);
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  uint64_t m_headOffset;                        //!< Offset of the first byte of data in the stream
+  std::deque<Block> m_data;                     //!< Corresponding data (may be null)
+  std::map<uint64_t, uint64_t> m_sacked;        //!< Disjoint blocks reported in SACK options, [first offset, last offset + 1)
 };
 
 } // namepsace ns3
@@ -253,13 +253,14 @@ TcpWestwood::DupAck (const TcpHeader& header, uint32_t count)
         }
       m_inFastRec = true;
       NS_LOG_INFO ("Triple dupack. Enter fast recovery mode. Reset cwnd to " << m_cWnd <<", ssthresh to " << m_ssThresh);
+      m_highRxtMark = m_txBuffer->HeadSequence ();
       DoRetransmit ();
     }
   else if (m_inFastRec)
     {// Increase cwnd for every additional DUPACK as in Reno
       m_cWnd += m_segmentSize;
       NS_LOG_INFO ("Dupack in fast recovery mode. Increase cwnd to " << m_cWnd);
-      if (!m_sendPendingDataEvent.IsRunning ())
+      if (!RetransmitSackHole () && !m_sendPendingDataEvent.IsRunning ())
         {
           SendPendingData (m_connected);
         }
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/private/ipv4-end-point.h"
+#include "ns3/private/ipv4-end-point-demux.h"
+#include "ns3/private/ipv6-end-point.h"
+#include "ns3/private/ipv6-end-point-demux.h"
+
+#include <iostream>
+#include <ctime>
+
+using namespace ns3;
+
+/**
+ * Check the order of precedence of the matches of Ipv4EndPointDemux,
+ * including the endpoints whose four-tuple changes after allocation.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup precedence")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  Ipv4EndPoint *listen = demux.Allocate (9);
+  Ipv4EndPoint *bound = demux.Allocate (local, 9);
+  Ipv4EndPoint *connected = demux.Allocate (local, 9, peer, 5000);
+  Ipv4EndPoint *duplicate = demux.Allocate (local, 9);
+  NS_TEST_ASSERT_MSG_EQ (duplicate, 0, "Duplicate local address and port");
+  duplicate = demux.Allocate (local, 9, peer, 5000);
+  NS_TEST_ASSERT_MSG_EQ (duplicate, 0, "Duplicate four-tuple");
+
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 9, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Exact match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "Exact match expected");
+  endPoints = demux.Lookup (local, 9, peer, 5001, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "Local address match expected");
+  endPoints = demux.Lookup (Ipv4Address ("10.0.1.1"), 9, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local port match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listen, "Local port match expected");
+  endPoints = demux.Lookup (local, 10, peer, 5000, interface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "No match expected");
+
+  // disabled endpoints are skipped for the next most exact match
+  connected->SetRxEnabled (false);
+  endPoints = demux.Lookup (local, 9, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "Local address match expected");
+  connected->SetRxEnabled (true);
+
+  // broadcast packets go to the endpoints of the port bound to the
+  // interface address or to any address, in allocation order
+  endPoints = demux.Lookup (Ipv4Address ("10.0.0.255"), 9, peer, 6000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 2, "Broadcast matches expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listen, "Broadcast match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.back (), bound, "Broadcast match expected");
+
+  // the endpoints are found by their new four-tuple
+  Ipv4EndPoint *client = demux.Allocate ();
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "Ephemeral port not allocated");
+  client->SetPeer (peer, 80);
+  endPoints = demux.Lookup (local, port, peer, 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Match but local address expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), client, "Match but local address expected");
+  endPoints = demux.Lookup (local, port, peer, 81, interface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "Match on the old four-tuple");
+  client->SetLocalAddress (local);
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, port, peer, 80), client, "Exact match expected");
+
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 9, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 9, peer, 80), bound, "Generic match expected");
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Deallocated port still used");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 2, "Wrong number of endpoints");
+}
+
+/**
+ * Check the order of precedence of the matches of Ipv6EndPointDemux,
+ * including the endpoints whose four-tuple changes after allocation.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup precedence")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listen = demux.Allocate (9);
+  Ipv6EndPoint *bound = demux.Allocate (local, 9);
+  Ipv6EndPoint *connected = demux.Allocate (local, 9, peer, 5000);
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 9, peer, 5000, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Exact match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "Exact match expected");
+  endPoints = demux.Lookup (local, 9, peer, 5001, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "Local address match expected");
+  endPoints = demux.Lookup (Ipv6Address ("2001:2::1"), 9, peer, 5000, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local port match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listen, "Local port match expected");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (peer, 80);
+  endPoints = demux.Lookup (local, port, peer, 80, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Match but local address expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), client, "Match but local address expected");
+  client->SetLocalPort (8080);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Old port still used");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 8080, peer, 80), client, "Generic match expected");
+
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 9, peer, 5000, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "Local address match expected");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 3, "Wrong number of endpoints");
+}
+
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite;
+
+//----------------------------
+//
+// Performance test
+
+/**
+ * Measure the time of Ipv4EndPointDemux::Lookup on a server with many
+ * connections on its listening port, such as a packet sink farm.
+ */
+class Ipv4EndPointDemuxLookupTimeTestCase : public TestCase
+{
+public:
+  /**
+   * \param connections the number of connections to the server
+   */
+  Ipv4EndPointDemuxLookupTimeTestCase (uint32_t connections);
+private:
+  virtual void DoRun (void);
+
+  enum { REPETITIONS = 1000000 };
+
+  uint32_t m_connections; //!< The number of connections to the server.
+};
+
+Ipv4EndPointDemuxLookupTimeTestCase::Ipv4EndPointDemuxLookupTimeTestCase (uint32_t connections)
+  : TestCase ("Measure average Ipv4EndPointDemux lookup time"),
+    m_connections (connections)
+{
+}
+
+void
+Ipv4EndPointDemuxLookupTimeTestCase::DoRun (void)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (local, Ipv4Mask ("255.0.0.0")));
+
+  Ipv4EndPointDemux demux;
+  demux.Allocate (9);
+  for (uint32_t i = 0; i < m_connections; i++)
+    {
+      demux.Allocate (local, 9, Ipv4Address (0x0b000000 + i), 49153);
+    }
+
+  uint32_t found = 0;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; i++)
+    {
+      Ipv4Address peer (0x0b000000 + i % (m_connections + 1));
+      found += demux.Lookup (local, 9, peer, 49153, interface).size ();
+    }
+  clock_t stop = clock ();
+  NS_TEST_EXPECT_MSG_EQ (found, REPETITIONS, "Each lookup matches one endpoint");
+
+  double per = 1E6 * double (stop - start) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << "Ipv4EndPointDemux lookup time: connections: " << m_connections
+            << "\treps: " << REPETITIONS
+            << "\tticks: " << stop - start
+            << "\tper: " << per << " microsec/lookup"
+            << std::endl;
+}
+
+class EndPointDemuxPerformanceTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxPerformanceTestSuite ();
+};
+
+EndPointDemuxPerformanceTestSuite::EndPointDemuxPerformanceTestSuite ()
+  : TestSuite ("end-point-demux-perf", PERFORMANCE)
+{
+  AddTestCase (new Ipv4EndPointDemuxLookupTimeTestCase (10), TestCase::QUICK);
+  AddTestCase (new Ipv4EndPointDemuxLookupTimeTestCase (10000), TestCase::QUICK);
+}
+
+static EndPointDemuxPerformanceTestSuite g_endPointDemuxPerformanceTestSuite;
@@ -15,6 +15,7 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -36,6 +37,13 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/global-value.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-route-manager-impl.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/output-stream-wrapper.h"
 
 using namespace ns3;
 
@@ -420,6 +428,211 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
 }
 
 
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param nodes the routers
+   * \returns the routing tables of the routers
+   */
+  std::string GetRoutes (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Incremental global routing gives the routes of a full computation")
+{
+}
+
+std::string
+Ipv4GlobalRoutingIncrementalTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::ostringstream os;
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&os);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ()->PrintRoutingTable (stream);
+    }
+  return os.str ();
+}
+
+// A 3x3 grid of routers, with point-to-point links, whose metrics change.
+// After each change, the routes updated incrementally must be those of a
+// full computation.
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (true));
+
+  NodeContainer c;
+  c.Create (9);
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<std::pair<Ptr<Ipv4>, uint32_t> > interfaces;
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      for (uint32_t j = i + 1; j < 9; j++)
+        {
+          if ((j == i + 1 && j % 3 != 0) || j == i + 3)
+            {
+              Ipv4InterfaceContainer link = ipv4.Assign (devHelper.Install (NodeContainer (c.Get (i), c.Get (j))));
+              ipv4.NewNetwork ();
+              interfaces.push_back (link.Get (0));
+              interfaces.push_back (link.Get (1));
+            }
+        }
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  for (uint32_t step = 0; step < 40; step++)
+    {
+      // change the metric of one side of a link, or of both sides, and
+      // sometimes take a link down and up
+      std::pair<Ptr<Ipv4>, uint32_t> interface = interfaces[(step * 5) % interfaces.size ()];
+      uint16_t metric = 1 + (step * 3) % 4;
+      interface.first->SetMetric (interface.second, metric);
+      if (step % 3 == 0)
+        {
+          std::pair<Ptr<Ipv4>, uint32_t> peer = interfaces[((step * 5) % interfaces.size ()) ^ 1];
+          peer.first->SetMetric (peer.second, metric);
+        }
+      if (step % 10 == 5)
+        {
+          interface.first->SetDown (interface.second);
+        }
+      if (step % 10 == 7)
+        {
+          interfaces[(step * 5 - 10) % interfaces.size ()].first->SetUp (interfaces[(step * 5 - 10) % interfaces.size ()].second);
+        }
+
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::string incremental = GetRoutes (c);
+      GlobalRouteManager::DeleteGlobalRoutes ();
+      GlobalRouteManager::BuildGlobalRoutingDatabase ();
+      GlobalRouteManager::InitializeRoutes ();
+      std::string full = GetRoutes (c);
+      NS_TEST_EXPECT_MSG_EQ (incremental, full, "Different routes after step " << step);
+    }
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+}
+
+class Ipv4GlobalRoutingIncrementalFlapTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalFlapTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param nodes the routers
+   * \returns the routing tables of the routers
+   */
+  std::string GetRoutes (NodeContainer nodes);
+  /**
+   * Recompute the routes incrementally, and check them against a full
+   * computation
+   * \param nodes the routers
+   * \param step the name of the step
+   * \returns the number of SPF calculations of the incremental update
+   */
+  uint32_t Recompute (NodeContainer nodes, std::string step);
+};
+
+Ipv4GlobalRoutingIncrementalFlapTestCase::Ipv4GlobalRoutingIncrementalFlapTestCase ()
+  : TestCase ("Incremental global routing only calculates the trees using a flapping link")
+{
+}
+
+std::string
+Ipv4GlobalRoutingIncrementalFlapTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::ostringstream os;
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&os);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ()->PrintRoutingTable (stream);
+    }
+  return os.str ();
+}
+
+uint32_t
+Ipv4GlobalRoutingIncrementalFlapTestCase::Recompute (NodeContainer nodes, std::string step)
+{
+  GlobalRouteManagerImpl *impl = SimulationSingleton<GlobalRouteManagerImpl>::Get ();
+  uint32_t calculations = impl->DebugGetNSPFCalculations ();
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  calculations = impl->DebugGetNSPFCalculations () - calculations;
+  std::string incremental = GetRoutes (nodes);
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  std::string full = GetRoutes (nodes);
+  NS_TEST_EXPECT_MSG_EQ (incremental, full, "Different routes after " << step);
+  return calculations;
+}
+
+// A 3x3 grid of routers, with point-to-point links of metric 1 but the link
+// between the routers 4 and 5, of metric 10: no shortest path uses it.  When
+// the link goes down and up, only the routers 4 and 5, whose LSAs are the
+// LSAs of the link, calculate their tree again; the other routers rebuild
+// their routes from their previous tree.
+void
+Ipv4GlobalRoutingIncrementalFlapTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (true));
+
+  NodeContainer c;
+  c.Create (9);
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer flapping;
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      for (uint32_t j = i + 1; j < 9; j++)
+        {
+          if ((j == i + 1 && j % 3 != 0) || j == i + 3)
+            {
+              Ipv4InterfaceContainer link = ipv4.Assign (devHelper.Install (NodeContainer (c.Get (i), c.Get (j))));
+              ipv4.NewNetwork ();
+              if (i == 4 && j == 5)
+                {
+                  flapping = link;
+                }
+            }
+        }
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      flapping.Get (i).first->SetMetric (flapping.Get (i).second, 10);
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::pair<Ptr<Ipv4>, uint32_t> interface = flapping.Get (0);
+  interface.first->SetDown (interface.second);
+  NS_TEST_EXPECT_MSG_EQ (Recompute (c, "link down"), 2, "Wrong number of SPF calculations after the link went down");
+  interface.first->SetUp (interface.second);
+  NS_TEST_EXPECT_MSG_EQ (Recompute (c, "link up"), 2, "Wrong number of SPF calculations after the link went up");
+  NS_TEST_EXPECT_MSG_EQ (Recompute (c, "no change"), 0, "Wrong number of SPF calculations without a change");
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+}
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -431,6 +644,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingIncrementalFlapTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -35,6 +35,8 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route-trie.h"
 
 using namespace ns3;
 
@@ -179,6 +181,100 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+// Unit tests of the prefix trie indexing the static routes
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param trie the trie
+   * \param dest a destination
+   * \returns the route to dest with the longest prefix, or 0
+   */
+  Ipv4RoutingTableEntry *Longest (const Ipv4RouteTrie &trie, const char *dest);
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Longest prefix match in the route trie")
+{
+}
+
+Ipv4RoutingTableEntry *
+Ipv4RouteTrieTestCase::Longest (const Ipv4RouteTrie &trie, const char *dest)
+{
+  std::vector<Ipv4RouteTrie::Entry> entries;
+  trie.Lookup (Ipv4Address (dest), entries);
+  const Ipv4RouteTrie::Entry *best = 0;
+  for (std::vector<Ipv4RouteTrie::Entry>::const_iterator i = entries.begin (); i != entries.end (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (i->route->GetDestNetworkMask ().IsMatch (Ipv4Address (dest), i->route->GetDestNetwork ()),
+                             true, "Route " << *i->route << " does not match " << dest);
+      if (best == 0 || i->length > best->length)
+        {
+          best = &*i;
+        }
+    }
+  return best == 0 ? 0 : best->route;
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  Ipv4RoutingTableEntry routes[6];
+  routes[0] = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask::GetZero (), 1);
+  routes[1] = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1);
+  routes[2] = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 2);
+  routes[3] = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.3.0"), Ipv4Mask ("255.255.255.0"), 3);
+  routes[4] = Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address ("10.1.2.3"), 4);
+  routes[5] = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.0.0.5"), Ipv4Mask ("255.0.0.255"), 5);
+
+  Ipv4RouteTrie trie;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      trie.Insert (&routes[i], i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.2.3"), &routes[4], "Host route not selected");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.2.4"), &routes[2], "/24 route not selected");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.3.4"), &routes[3], "/24 route not selected");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.4.4"), &routes[1], "/16 route not selected");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "192.168.0.1"), &routes[0], "Default route not selected");
+
+  // the route with a non-contiguous mask is checked apart
+  std::vector<Ipv4RouteTrie::Entry> entries;
+  trie.Lookup (Ipv4Address ("10.9.9.5"), entries);
+  NS_TEST_EXPECT_MSG_EQ (entries.size (), 2, "Non-contiguous mask not matched");
+  NS_TEST_EXPECT_MSG_EQ (entries.back ().route, &routes[5], "Non-contiguous mask not matched");
+  NS_TEST_EXPECT_MSG_EQ (entries.back ().metric, 5, "Wrong metric");
+
+  // removing the intermediate prefixes keeps the longer ones reachable
+  trie.Remove (&routes[1]);
+  trie.Remove (&routes[2]);
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.2.3"), &routes[4], "Host route lost");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.2.4"), &routes[0], "Removed route selected");
+  NS_TEST_EXPECT_MSG_EQ (Longest (trie, "10.1.3.4"), &routes[3], "/24 route lost");
+  trie.Remove (&routes[4]);
+  trie.Remove (&routes[5]);
+  entries.clear ();
+  trie.Lookup (Ipv4Address ("10.1.2.3"), entries);
+  NS_TEST_EXPECT_MSG_EQ (entries.size (), 1, "Removed routes still matched");
+
+  // routes to the same prefix are kept in insertion order
+  trie.Insert (&routes[1], 7);
+  trie.Insert (&routes[1], 7);
+  entries.clear ();
+  trie.Lookup (Ipv4Address ("10.1.0.1"), entries);
+  NS_TEST_EXPECT_MSG_EQ (entries.size (), 3, "Duplicate route lost");
+  NS_TEST_EXPECT_MSG_EQ ((entries[1].order < entries[2].order), true, "Insertion order lost");
+
+  trie.Clear ();
+  entries.clear ();
+  trie.Lookup (Ipv4Address ("10.1.3.4"), entries);
+  NS_TEST_EXPECT_MSG_EQ (entries.size (), 0, "Routes left after Clear");
+}
+
 class Ipv4StaticRoutingTestSuite : public TestSuite
 {
 public:
@@ -189,6 +285,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4RouteTrieTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/socket.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace ns3 {
+
+/**
+ * \param first the stream offset of the first byte
+ * \param size the number of bytes
+ * \returns a packet whose bytes are their stream offsets, modulo 256
+ */
+static Ptr<Packet>
+CreateStreamPacket (uint32_t first, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = (first + i) & 0xff;
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+/**
+ * \param p a packet
+ * \param first the expected stream offset of its first byte
+ * \returns true if the bytes of the packet are their stream offsets
+ */
+static bool
+CheckStreamPacket (Ptr<const Packet> p, uint32_t first)
+{
+  std::vector<uint8_t> data (p->GetSize () + 1);
+  p->CopyData (&data[0], p->GetSize ());
+  for (uint32_t i = 0; i < p->GetSize (); i++)
+    {
+      if (data[i] != ((first + i) & 0xff))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("Segments of the TcpTxBuffer across and within the packets added")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  // the sequence numbers wrap around in the buffer
+  uint32_t isn = 0xffffff00;
+  Ptr<TcpTxBuffer> tx = CreateObject<TcpTxBuffer> (isn);
+  tx->SetMaxBufferSize (10000);
+  uint32_t sizes[] = { 100, 1, 500, 37, 1000, 250, 3 };
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (tx->Add (CreateStreamPacket (total, sizes[i])), true, "Add failed");
+      total += sizes[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ (tx->Size (), total, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (tx->Add (CreateStreamPacket (0, 10000)), false, "Add beyond the buffer size");
+
+  uint32_t acked = 0;
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t offset = acked; offset < total; offset += 97)
+        {
+          for (uint32_t length = 1; length < 1500; length += 211)
+            {
+              Ptr<Packet> p = tx->CopyFromSequence (length, SequenceNumber32 (isn + offset));
+              uint32_t expected = std::min (length, total - offset);
+              NS_TEST_ASSERT_MSG_EQ (p->GetSize (), expected, "Wrong segment size at " << offset);
+              bool check = CheckStreamPacket (p, offset);
+              NS_TEST_ASSERT_MSG_EQ (check, true, "Wrong segment data at " << offset);
+            }
+        }
+      // acknowledge within and at the end of packets
+      acked += round == 0 ? 150 : 488;
+      tx->DiscardUpTo (SequenceNumber32 (isn + acked));
+      NS_TEST_ASSERT_MSG_EQ (tx->HeadSequence (), SequenceNumber32 (isn + acked), "Wrong head");
+      NS_TEST_ASSERT_MSG_EQ (tx->Size (), total - acked, "Wrong size after discard");
+    }
+  // the data added after a discard follow the buffered data
+  NS_TEST_ASSERT_MSG_EQ (tx->Add (CreateStreamPacket (total, 64)), true, "Add failed");
+  total += 64;
+  Ptr<Packet> p = tx->CopyFromSequence (total, SequenceNumber32 (isn + acked));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), total - acked, "Wrong segment size");
+  bool check = CheckStreamPacket (p, acked);
+  NS_TEST_ASSERT_MSG_EQ (check, true, "Wrong segment data");
+
+  // acknowledge everything and the FIN
+  tx->DiscardUpTo (SequenceNumber32 (isn + total + 1));
+  NS_TEST_ASSERT_MSG_EQ (tx->Size (), 0, "Buffer not empty");
+  NS_TEST_ASSERT_MSG_EQ (tx->HeadSequence (), SequenceNumber32 (isn + total + 1), "Wrong head");
+}
+
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a segment to the buffer
+   * \param rx the buffer
+   * \param isn the initial sequence number
+   * \param first the stream offset of the first byte of the segment
+   * \param size the size of the segment
+   * \returns the value returned by TcpRxBuffer::Add
+   */
+  bool Add (Ptr<TcpRxBuffer> rx, uint32_t isn, uint32_t first, uint32_t size);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("Reordering and overlapping segments in the TcpRxBuffer")
+{
+}
+
+bool
+TcpRxBufferTestCase::Add (Ptr<TcpRxBuffer> rx, uint32_t isn, uint32_t first, uint32_t size)
+{
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (isn + first));
+  return rx->Add (CreateStreamPacket (first, size), header);
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  uint32_t isn = 0xfffffe00;
+  Ptr<TcpRxBuffer> rx = CreateObject<TcpRxBuffer> (isn);
+  rx->SetMaxBufferSize (100000);
+
+  // out of order segments
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 1000, 500), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 2000, 500), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (rx->Available (), 0, "Data available before the hole is filled");
+  NS_TEST_ASSERT_MSG_EQ (rx->NextRxSequence (), SequenceNumber32 (isn), "Wrong RCV.NXT");
+  // duplicate segment
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 1100, 300), false, "Duplicate buffered");
+  // segment overlapping the head of a buffered one, and one embedding another
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 800, 400), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 1900, 700), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (rx->Size (), 200 + 500 + 700, "Wrong size");
+  // fill the hole at the head
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 0, 900), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (rx->NextRxSequence (), SequenceNumber32 (isn + 1500), "Wrong RCV.NXT");
+  NS_TEST_ASSERT_MSG_EQ (rx->Available (), 1500, "Wrong available size");
+
+  // extract within a segment, then across segments
+  Ptr<Packet> p = rx->Extract (300);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 300, "Wrong extracted size");
+  bool check = CheckStreamPacket (p, 0);
+  NS_TEST_ASSERT_MSG_EQ (check, true, "Wrong extracted data");
+  p = rx->Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1000, "Wrong extracted size");
+  check = CheckStreamPacket (p, 300);
+  NS_TEST_ASSERT_MSG_EQ (check, true, "Wrong extracted data");
+
+  // fill the last hole
+  NS_TEST_ASSERT_MSG_EQ (Add (rx, isn, 1400, 600), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (rx->NextRxSequence (), SequenceNumber32 (isn + 2600), "Wrong RCV.NXT");
+  p = rx->Extract (10000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 1300, "Wrong extracted size");
+  check = CheckStreamPacket (p, 1300);
+  NS_TEST_ASSERT_MSG_EQ (check, true, "Wrong extracted data");
+  NS_TEST_ASSERT_MSG_EQ (rx->Size (), 0, "Buffer not empty");
+  bool empty = rx->Extract (100) == 0;
+  NS_TEST_ASSERT_MSG_EQ (empty, true, "Extracted from an empty buffer");
+
+  // a whole segment is extracted as a copy, without its packet tags, so
+  // that the socket can tag it
+  Ptr<Packet> segment = CreateStreamPacket (2600, 100);
+  segment->AddPacketTag (SocketIpTtlTag ());
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (isn + 2600));
+  NS_TEST_ASSERT_MSG_EQ (rx->Add (segment, header), true, "Add failed");
+  p = rx->Extract (100);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "Wrong extracted size");
+  bool same = p == segment;
+  NS_TEST_EXPECT_MSG_EQ (same, false, "Extracted the buffered packet itself");
+  SocketIpTtlTag tag;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), false, "Extracted the packet tags of the segment");
+}
+
+class TcpSackBufferTestCase : public TestCase
+{
+public:
+  TcpSackBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpSackBufferTestCase::TcpSackBufferTestCase ()
+  : TestCase ("SACK blocks of the TcpRxBuffer and scoreboard of the TcpTxBuffer")
+{
+}
+
+void
+TcpSackBufferTestCase::DoRun (void)
+{
+  uint32_t isn = 0xfffffc00;
+  Ptr<TcpRxBuffer> rx = CreateObject<TcpRxBuffer> (isn);
+  rx->SetMaxBufferSize (100000);
+  uint32_t segments[][2] = { { 0, 500 }, { 1000, 500 }, { 1500, 500 }, { 3000, 500 }, { 5000, 500 } };
+  for (uint32_t i = 0; i < sizeof (segments) / sizeof (segments[0]); i++)
+    {
+      TcpHeader header;
+      header.SetSequenceNumber (SequenceNumber32 (isn + segments[i][0]));
+      rx->Add (CreateStreamPacket (segments[i][0], segments[i][1]), header);
+    }
+  // the contiguous segments are merged, the most recent block comes first
+  TcpOptionSack::SackList list = rx->GetSackList (TcpOptionSack::MAX_BLOCKS);
+  NS_TEST_ASSERT_MSG_EQ (list.size (), 3, "Wrong number of blocks");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().first, SequenceNumber32 (isn + 5000), "Wrong first block");
+  list.pop_front ();
+  NS_TEST_ASSERT_MSG_EQ (list.front ().first, SequenceNumber32 (isn + 1000), "Wrong second block");
+  NS_TEST_ASSERT_MSG_EQ (list.front ().second, SequenceNumber32 (isn + 2000), "Wrong second block");
+  list = rx->GetSackList (2);
+  NS_TEST_ASSERT_MSG_EQ (list.size (), 2, "Blocks beyond the limit");
+  NS_TEST_ASSERT_MSG_EQ (list.back ().first, SequenceNumber32 (isn + 1000), "Wrong second block");
+
+  Ptr<TcpTxBuffer> tx = CreateObject<TcpTxBuffer> (isn);
+  tx->SetMaxBufferSize (100000);
+  tx->Add (CreateStreamPacket (0, 6000));
+  SequenceNumber32 seq (isn);
+  uint32_t size = 0;
+  bool found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Hole without SACKed data");
+  tx->AddSackBlock (SequenceNumber32 (isn + 1000), SequenceNumber32 (isn + 1500));
+  tx->AddSackBlock (SequenceNumber32 (isn + 1500), SequenceNumber32 (isn + 2000));
+  tx->AddSackBlock (SequenceNumber32 (isn + 3000), SequenceNumber32 (isn + 3500));
+  // blocks beyond the buffer are ignored
+  tx->AddSackBlock (SequenceNumber32 (isn + 7000), SequenceNumber32 (isn + 8000));
+  found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Hole not found");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (isn), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (size, 1000, "Wrong hole size");
+  // from a SACKed block, the hole after it
+  seq = SequenceNumber32 (isn + 1200);
+  found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Hole not found");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (isn + 2000), "Wrong hole");
+  NS_TEST_ASSERT_MSG_EQ (size, 1000, "Wrong hole size");
+  seq = SequenceNumber32 (isn + 3200);
+  found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Hole after the last SACKed block");
+
+  // the acknowledged blocks are discarded
+  tx->DiscardUpTo (SequenceNumber32 (isn + 1200));
+  seq = SequenceNumber32 (isn);
+  found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Hole not found");
+  NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (isn + 2000), "Wrong hole");
+  tx->ResetScoreboard ();
+  found = tx->NextHole (seq, size);
+  NS_TEST_ASSERT_MSG_EQ (found, false, "Hole after the reset");
+}
+
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpSackBufferTestCase, TestCase::QUICK);
+  }
+} g_tcpBufferTestSuite;
+
+} // namespace ns3
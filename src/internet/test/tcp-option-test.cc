@@ -22,6 +22,8 @@
 #include "ns3/tcp-option.h"
 #include "ns3/private/tcp-option-winscale.h"
 #include "ns3/private/tcp-option-ts.h"
+#include "ns3/private/tcp-option-sack-permitted.h"
+#include "ns3/tcp-option-sack.h"
 
 #include <string.h>
 
@@ -164,6 +166,84 @@ TcpOptionTSTestCase::DoTeardown ()
 {
 }
 
+class TcpOptionSackTestCase : public TestCase
+{
+public:
+  TcpOptionSackTestCase (std::string name, uint32_t blocks);
+
+  void TestSerialize ();
+  void TestDeserialize ();
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_blocks;
+  TcpOptionSack::SackList m_list;
+  Buffer m_buffer;
+};
+
+
+TcpOptionSackTestCase::TcpOptionSackTestCase (std::string name, uint32_t blocks)
+  : TestCase (name),
+    m_blocks (blocks)
+{
+}
+
+void
+TcpOptionSackTestCase::DoRun ()
+{
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+
+  for (uint32_t i = 0; i < m_blocks; ++i)
+    {
+      SequenceNumber32 left (x->GetInteger ());
+      m_list.push_back (TcpOptionSack::SackBlock (left, left + x->GetInteger (1, 65535)));
+    }
+  TestSerialize ();
+  TestDeserialize ();
+
+  TcpOptionSackPermitted permitted;
+  Buffer buffer;
+  buffer.AddAtStart (permitted.GetSerializedSize ());
+  permitted.Serialize (buffer.Begin ());
+  NS_TEST_EXPECT_MSG_EQ (buffer.Begin ().PeekU8 (), TcpOption::SACKPERMITTED, "Different kind found");
+  NS_TEST_EXPECT_MSG_EQ (permitted.Deserialize (buffer.Begin ()), 2, "Malformed SACK-permitted option");
+}
+
+void
+TcpOptionSackTestCase::TestSerialize ()
+{
+  TcpOptionSack opt;
+
+  for (TcpOptionSack::SackList::const_iterator i = m_list.begin (); i != m_list.end (); ++i)
+    {
+      opt.AddSackBlock (*i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (opt.GetNumSackBlocks (), m_blocks, "Blocks aren't saved correctly");
+  NS_TEST_EXPECT_MSG_EQ (opt.GetSerializedSize (), 2 + 8 * m_blocks, "Wrong size");
+
+  m_buffer.AddAtStart (opt.GetSerializedSize ());
+
+  opt.Serialize (m_buffer.Begin ());
+}
+
+void
+TcpOptionSackTestCase::TestDeserialize ()
+{
+  TcpOptionSack opt;
+
+  Buffer::Iterator start = m_buffer.Begin ();
+  uint8_t kind = start.PeekU8 ();
+
+  NS_TEST_EXPECT_MSG_EQ (kind, TcpOption::SACK, "Different kind found");
+
+  uint32_t size = opt.Deserialize (start);
+
+  NS_TEST_EXPECT_MSG_EQ (size, 2 + 8 * m_blocks, "Different size found");
+  bool same = opt.GetSackList () == m_list;
+  NS_TEST_EXPECT_MSG_EQ (same, true, "Different blocks found");
+}
+
 static class TcpOptionTestSuite : public TestSuite
 {
 public:
@@ -176,6 +256,10 @@ public:
                                               "scale value", i), TestCase::QUICK);
       }
     AddTestCase (new TcpOptionTSTestCase ("Testing serialization of random values for timestamp"), TestCase::QUICK);
+    for (uint32_t i = 1; i <= TcpOptionSack::MAX_BLOCKS; ++i)
+      {
+        AddTestCase (new TcpOptionSackTestCase ("Testing serialization of SACK blocks", i), TestCase::QUICK);
+      }
   }
 
 } g_TcpOptionTestSuite;
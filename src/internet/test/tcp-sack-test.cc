@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+
+#define private public
+#define protected public
+
+#include "ns3/socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/node.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/icmpv4-l4-protocol.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+
+#include "ns3/tcp-socket-base.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SackTestSuite");
+
+/**
+ * Check the SACK negotiation of the connections accepted by a listening
+ * socket: a client without SACK must not disable SACK for the next
+ * clients, and the attribute of the sockets must not be modified.
+ */
+class SackNegotiationTestCase : public TestCase
+{
+public:
+  SackNegotiationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  Ptr<Node> CreateInternetNode (void);
+  Ptr<SimpleNetDevice> AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask);
+
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  void SourceHandleConnectionCreated (Ptr<Socket> sock);
+  void Connect (Ptr<TcpSocketBase> source, Address addr);
+
+  Ptr<TcpSocketBase> m_server;
+  Ptr<TcpSocketBase> m_sources[2];
+  uint32_t m_accepted;
+  bool m_acceptedNegotiated[2];
+};
+
+SackNegotiationTestCase::SackNegotiationTestCase ()
+  : TestCase ("SACK negotiation with a listening socket")
+{
+}
+
+void
+SackNegotiationTestCase::DoRun (void)
+{
+  m_accepted = 0;
+
+  const char* netmask = "255.255.255.0";
+  Ptr<Node> server = CreateInternetNode ();
+  Ptr<Node> source = CreateInternetNode ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  AddSimpleNetDevice (server, "192.168.1.1", netmask)->SetChannel (channel);
+  AddSimpleNetDevice (source, "192.168.1.2", netmask)->SetChannel (channel);
+
+  m_server = DynamicCast<TcpSocketBase> (server->GetObject<TcpSocketFactory> ()->CreateSocket ());
+  m_server->SetAttribute ("Sack", BooleanValue (true));
+  m_server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 50000));
+  m_server->Listen ();
+  m_server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                               MakeCallback (&SackNegotiationTestCase::ServerHandleConnectionCreated, this));
+
+  // the first client does not permit SACK, the second one does
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      m_sources[i] = DynamicCast<TcpSocketBase> (source->GetObject<TcpSocketFactory> ()->CreateSocket ());
+      m_sources[i]->SetAttribute ("Sack", BooleanValue (i == 1));
+      m_sources[i]->SetConnectCallback (MakeCallback (&SackNegotiationTestCase::SourceHandleConnectionCreated, this),
+                                        MakeNullCallback<void, Ptr<Socket> > ());
+      Simulator::Schedule (Seconds (i), &SackNegotiationTestCase::Connect, this,
+                           m_sources[i], InetSocketAddress (Ipv4Address ("192.168.1.1"), 50000));
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_accepted, 2, "Connections not accepted");
+  NS_TEST_EXPECT_MSG_EQ (m_acceptedNegotiated[0], false, "SACK negotiated with a client without SACK");
+  NS_TEST_EXPECT_MSG_EQ (m_acceptedNegotiated[1], true, "SACK not negotiated with a client with SACK");
+  NS_TEST_EXPECT_MSG_EQ (m_server->m_sackEnabled, true, "Sack attribute of the listening socket modified");
+  NS_TEST_EXPECT_MSG_EQ (m_sources[0]->m_sackNegotiated, false, "SACK negotiated by a client without SACK");
+  NS_TEST_EXPECT_MSG_EQ (m_sources[1]->m_sackNegotiated, true, "SACK not negotiated by a client with SACK");
+}
+
+void
+SackNegotiationTestCase::DoTeardown (void)
+{
+  m_server = 0;
+  m_sources[0] = 0;
+  m_sources[1] = 0;
+  Simulator::Destroy ();
+}
+
+void
+SackNegotiationTestCase::Connect (Ptr<TcpSocketBase> source, Address addr)
+{
+  source->Connect (addr);
+}
+
+void
+SackNegotiationTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  NS_ASSERT (m_accepted < 2);
+  Ptr<TcpSocketBase> b = DynamicCast<TcpSocketBase> (s);
+  m_acceptedNegotiated[m_accepted++] = b->m_sackNegotiated;
+  s->Close ();
+}
+
+void
+SackNegotiationTestCase::SourceHandleConnectionCreated (Ptr<Socket> sock)
+{
+  sock->Close ();
+}
+
+Ptr<Node>
+SackNegotiationTestCase::CreateInternetNode ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  //ARP
+  Ptr<ArpL3Protocol> arp = CreateObject<ArpL3Protocol> ();
+  node->AggregateObject (arp);
+  //IPV4
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  //Routing for Ipv4
+  Ptr<Ipv4ListRouting> ipv4Routing = CreateObject<Ipv4ListRouting> ();
+  ipv4->SetRoutingProtocol (ipv4Routing);
+  Ptr<Ipv4StaticRouting> ipv4staticRouting = CreateObject<Ipv4StaticRouting> ();
+  ipv4Routing->AddRoutingProtocol (ipv4staticRouting, 0);
+  node->AggregateObject (ipv4);
+  //ICMP
+  Ptr<Icmpv4L4Protocol> icmp = CreateObject<Icmpv4L4Protocol> ();
+  node->AggregateObject (icmp);
+  //UDP
+  Ptr<UdpL4Protocol> udp = CreateObject<UdpL4Protocol> ();
+  node->AggregateObject (udp);
+  //TCP
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+  node->AggregateObject (tcp);
+  return node;
+}
+
+Ptr<SimpleNetDevice>
+SackNegotiationTestCase::AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask)
+{
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  node->AddDevice (dev);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t ndid = ipv4->AddInterface (dev);
+  Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (Ipv4Address (ipaddr), Ipv4Mask (netmask));
+  ipv4->AddAddress (ndid, ipv4Addr);
+  ipv4->SetUp (ndid);
+  return dev;
+}
+
+static class TcpSackTestSuite : public TestSuite
+{
+public:
+  TcpSackTestSuite ()
+    : TestSuite ("tcp-sack", UNIT)
+  {
+    AddTestCase (new SackNegotiationTestCase, TestCase::QUICK);
+  }
+
+} g_tcpSackTestSuite;
+
+} // namespace ns3
@@ -59,6 +59,7 @@
 #include <ns3/epc-helper.h>
 #include <iostream>
 #include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/pathloss-matrix-propagation-loss-model.h>
 #include <ns3/lte-spectrum-value-helper.h>
 #include <ns3/epc-x2.h>
 
@@ -93,6 +94,7 @@ LteHelper::DoInitialize (void)
   if (dlSplm != 0)
     {
       NS_LOG_LOGIC (this << " using a SpectrumPropagationLossModel in DL");
+      NS_ABORT_MSG_IF (m_usePathlossMatrix, "the pathloss matrix requires a PropagationLossModel");
       m_downlinkChannel->AddSpectrumPropagationLossModel (dlSplm);
     }
   else
@@ -100,7 +102,16 @@ LteHelper::DoInitialize (void)
       NS_LOG_LOGIC (this << " using a PropagationLossModel in DL");
       Ptr<PropagationLossModel> dlPlm = m_downlinkPathlossModel->GetObject<PropagationLossModel> ();
       NS_ASSERT_MSG (dlPlm != 0, " " << m_downlinkPathlossModel << " is neither PropagationLossModel nor SpectrumPropagationLossModel");
-      m_downlinkChannel->AddPropagationLossModel (dlPlm);
+      if (m_usePathlossMatrix)
+        {
+          m_downlinkPathlossMatrix = CreateObject<PathlossMatrixPropagationLossModel> ();
+          m_downlinkPathlossMatrix->SetPropagationLossModel (dlPlm);
+          m_downlinkChannel->AddPropagationLossModel (m_downlinkPathlossMatrix);
+        }
+      else
+        {
+          m_downlinkChannel->AddPropagationLossModel (dlPlm);
+        }
     }
 
   m_uplinkPathlossModel = m_ulPathlossModelFactory.Create ();
@@ -108,6 +119,7 @@ LteHelper::DoInitialize (void)
   if (ulSplm != 0)
     {
       NS_LOG_LOGIC (this << " using a SpectrumPropagationLossModel in UL");
+      NS_ABORT_MSG_IF (m_usePathlossMatrix, "the pathloss matrix requires a PropagationLossModel");
       m_uplinkChannel->AddSpectrumPropagationLossModel (ulSplm);
     }
   else
@@ -115,7 +127,16 @@ LteHelper::DoInitialize (void)
       NS_LOG_LOGIC (this << " using a PropagationLossModel in UL");
       Ptr<PropagationLossModel> ulPlm = m_uplinkPathlossModel->GetObject<PropagationLossModel> ();
       NS_ASSERT_MSG (ulPlm != 0, " " << m_uplinkPathlossModel << " is neither PropagationLossModel nor SpectrumPropagationLossModel");
-      m_uplinkChannel->AddPropagationLossModel (ulPlm);
+      if (m_usePathlossMatrix)
+        {
+          m_uplinkPathlossMatrix = CreateObject<PathlossMatrixPropagationLossModel> ();
+          m_uplinkPathlossMatrix->SetPropagationLossModel (ulPlm);
+          m_uplinkChannel->AddPropagationLossModel (m_uplinkPathlossMatrix);
+        }
+      else
+        {
+          m_uplinkChannel->AddPropagationLossModel (ulPlm);
+        }
     }
   if (!m_fadingModelType.empty ())
     {
@@ -200,6 +221,23 @@ TypeId LteHelper::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&LteHelper::m_usePdschForCqiGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("UsePathlossMatrix",
+                   "If true, the DL and UL channels use the pathloss precomputed "
+                   "by PrecomputePathlossMatrix between the eNBs and the UEs which "
+                   "do not move, instead of computing it at every transmission. "
+                   "Only supported with a PropagationLossModel as pathloss model.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteHelper::m_usePathlossMatrix),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PathlossMatrixFilePrefix",
+                   "If not empty, PrecomputePathlossMatrix loads the pathloss "
+                   "from the files <prefix>-dl.txt and <prefix>-ul.txt, when they "
+                   "exist, for the nodes at the same positions, and saves the "
+                   "pathloss to them. Note that the pathloss loaded includes the "
+                   "shadowing of the simulation which saved it.",
+                   StringValue (""),
+                   MakeStringAccessor (&LteHelper::m_pathlossMatrixFilePrefix),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -210,6 +248,8 @@ LteHelper::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_downlinkChannel = 0;
   m_uplinkChannel = 0;
+  m_downlinkPathlossMatrix = 0;
+  m_uplinkPathlossMatrix = 0;
   Object::DoDispose ();
 }
 
@@ -364,6 +404,42 @@ LteHelper::SetFadingModelAttribute (std::string n, const AttributeValue &v)
   m_fadingModelFactory.Set (n, v);
 }
 
+void
+LteHelper::PrecomputePathlossMatrix (NetDeviceContainer enbDevices, NetDeviceContainer ueDevices)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (!m_usePathlossMatrix, "the UsePathlossMatrix attribute is not set");
+  Initialize ();  // will run DoInitialize () if necessary
+
+  std::string dlFileName = m_pathlossMatrixFilePrefix + "-dl.txt";
+  std::string ulFileName = m_pathlossMatrixFilePrefix + "-ul.txt";
+  if (!m_pathlossMatrixFilePrefix.empty ())
+    {
+      m_downlinkPathlossMatrix->Load (dlFileName);
+      m_uplinkPathlossMatrix->Load (ulFileName);
+    }
+
+  for (NetDeviceContainer::Iterator enbIt = enbDevices.Begin (); enbIt != enbDevices.End (); ++enbIt)
+    {
+      Ptr<MobilityModel> enbMobility = (*enbIt)->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (enbMobility != 0, "no mobility model in the node of eNB device " << *enbIt);
+      for (NetDeviceContainer::Iterator ueIt = ueDevices.Begin (); ueIt != ueDevices.End (); ++ueIt)
+        {
+          Ptr<MobilityModel> ueMobility = (*ueIt)->GetNode ()->GetObject<MobilityModel> ();
+          NS_ASSERT_MSG (ueMobility != 0, "no mobility model in the node of UE device " << *ueIt);
+          m_downlinkPathlossMatrix->Add (enbMobility, ueMobility);
+          m_uplinkPathlossMatrix->Add (ueMobility, enbMobility);
+        }
+    }
+  NS_LOG_INFO ("precomputed the pathloss of " << m_downlinkPathlossMatrix->GetN () << " eNB-UE pairs");
+
+  if (!m_pathlossMatrixFilePrefix.empty ())
+    {
+      m_downlinkPathlossMatrix->Save (dlFileName);
+      m_uplinkPathlossMatrix->Save (ulFileName);
+    }
+}
+
 void 
 LteHelper::SetSpectrumChannelType (std::string type) 
 {
@@ -555,6 +631,11 @@ LteHelper::InstallSingleEnbDevice (Ptr<Node> n)
     {
       NS_LOG_WARN ("UL propagation model does not have a Frequency attribute");
     }
+  if (m_usePathlossMatrix)
+    {
+      m_downlinkPathlossMatrix->SetAttribute ("Frequency", DoubleValue (dlFreq));
+      m_uplinkPathlossMatrix->SetAttribute ("Frequency", DoubleValue (ulFreq));
+    }
 
   dev->Initialize ();
 
@@ -47,6 +47,7 @@ class SpectrumChannel;
 class EpcHelper;
 class PropagationLossModel;
 class SpectrumPropagationLossModel;
+class PathlossMatrixPropagationLossModel;
 
 /**
  * \ingroup lte
@@ -490,6 +491,23 @@ public:
    */
   void SetFadingModelAttribute (std::string n, const AttributeValue &v);
 
+  /**
+   * Precompute the DL and UL pathloss between each of the given eNodeBs
+   * and each of the given UEs, which the channels then use instead of
+   * the pathloss model as long as the nodes do not move. Requires the
+   * `UsePathlossMatrix` attribute. The positions of the nodes must be
+   * final, and consistent with the buildings if any.
+   *
+   * If the `PathlossMatrixFilePrefix` attribute is set, the pathloss saved
+   * by a previous simulation of the same topology (e.g., another
+   * replication) is reused instead of being computed again, and the
+   * pathloss of the pairs is saved for the next simulations.
+   *
+   * \param enbDevices the set of eNodeB devices
+   * \param ueDevices the set of UE devices
+   */
+  void PrecomputePathlossMatrix (NetDeviceContainer enbDevices, NetDeviceContainer ueDevices);
+
   /**
    * Enables full-blown logging for major components of the LENA architecture.
    */
@@ -646,6 +664,10 @@ private:
   Ptr<Object> m_downlinkPathlossModel;
   /// The path loss model used in the uplink channel.
   Ptr<Object> m_uplinkPathlossModel;
+  /// The precomputed path loss used in the downlink channel, if any.
+  Ptr<PathlossMatrixPropagationLossModel> m_downlinkPathlossMatrix;
+  /// The precomputed path loss used in the uplink channel, if any.
+  Ptr<PathlossMatrixPropagationLossModel> m_uplinkPathlossMatrix;
 
   /// Factory of MAC scheduler object.
   ObjectFactory m_schedulerFactory;
@@ -731,6 +753,16 @@ private:
    * DL-CQI will be calculated from PDCCH as signal and PDCCH as interference.
    */
   bool m_usePdschForCqiGeneration;
+  /**
+   * The `UsePathlossMatrix` attribute. If true, the channels use the
+   * path loss precomputed by PrecomputePathlossMatrix().
+   */
+  bool m_usePathlossMatrix;
+  /**
+   * The `PathlossMatrixFilePrefix` attribute. Prefix of the files in which
+   * the precomputed path loss is loaded from and saved to.
+   */
+  std::string m_pathlossMatrixFilePrefix;
 
 }; // end of `class LteHelper`
 
@@ -29,6 +29,9 @@
 #include <ns3/string.h>
 #include <ns3/boolean.h>
 #include <ns3/spectrum-channel.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/antenna-model.h>
 #include <ns3/config.h>
 #include <ns3/rem-spectrum-phy.h>
 #include <ns3/mobility-building-info.h>
@@ -40,6 +43,7 @@
 
 #include <fstream>
 #include <limits>
+#include <cmath>
 
 namespace ns3 {
 
@@ -62,6 +66,7 @@ void
 RadioEnvironmentMapHelper::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_recordingPhy = 0;
 }
 
 TypeId
@@ -144,6 +149,14 @@ RadioEnvironmentMapHelper::GetTypeId (void)
                    IntegerValue (-1),
                    MakeIntegerAccessor (&RadioEnvironmentMapHelper::m_rbId),
                    MakeIntegerChecker<int32_t> ())
+    .AddAttribute ("DirectEvaluation",
+                   "If true, the signals transmitted during the listening period are recorded "
+                   "once, and the SINR of every point is computed directly from the propagation "
+                   "models of the channel, without a listener and events per point. "
+                   "MaxPointsPerIteration is then the number of positions used in turn by the points.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RadioEnvironmentMapHelper::m_directEvaluation),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -225,6 +238,36 @@ RadioEnvironmentMapHelper::DelayedInstall ()
     {
       m_maxPointsPerIteration = m_xRes * m_yRes;
     }
+
+  if (m_directEvaluation)
+    {
+      // The points of the map take these positions in turn, as they take
+      // the listeners of the iterations, so that the models which keep a
+      // state per pair of mobility models behave the same.
+      for (uint32_t i = 0; i < m_maxPointsPerIteration; ++i)
+        {
+          RemPoint p;
+          p.bmm = CreateObject<ConstantPositionMobilityModel> ();
+          Ptr<MobilityBuildingInfo> buildingInfo = CreateObject<MobilityBuildingInfo> ();
+          p.bmm->AggregateObject (buildingInfo); // operation usually done by BuildingsHelper::Install
+          m_rem.push_back (p);
+        }
+
+      // The listener has no mobility model, hence the channel delivers
+      // the signals to it without any propagation loss.
+      m_recordingPhy = CreateObject<RemSpectrumPhy> ();
+      m_recordingPhy->SetRxSpectrumModel (LteSpectrumValueHelper::GetSpectrumModel (m_earfcn, m_bandwidth));
+      m_recordingPhy->SetUseDataChannel (m_useDataChannel);
+      m_recordingPhy->SetRbId (m_rbId);
+      m_recordingPhy->SetRecordSignals (true);
+      m_channel->AddRx (m_recordingPhy);
+
+      // listen as long as the listeners of the first iteration
+      Simulator::Schedule (Seconds (0.0001 + 0.0005),
+                           &RadioEnvironmentMapHelper::EvaluateDirectly,
+                           this);
+      return;
+    }
   
   for (uint32_t i = 0; i < m_maxPointsPerIteration; ++i)
     {
@@ -340,6 +383,96 @@ RadioEnvironmentMapHelper::PrintAndReset ()
     }
 }
 
+void
+RadioEnvironmentMapHelper::EvaluateDirectly ()
+{
+  NS_LOG_FUNCTION (this);
+  m_recordingPhy->Deactivate ();
+  const std::vector<Ptr<SpectrumSignalParameters> > &signals = m_recordingPhy->GetRecordedSignals ();
+  NS_LOG_LOGIC ("evaluating " << signals.size () << " signals");
+
+  Ptr<PropagationLossModel> propagationLoss = m_channel->GetPropagationLossModel ();
+  Ptr<SpectrumPropagationLossModel> spectrumPropagationLoss = m_channel->GetSpectrumPropagationLossModel ();
+  double maxLossDb = std::numeric_limits<double>::max ();
+  DoubleValue maxLossDbValue;
+  if (m_channel->GetAttributeFailSafe ("MaxLossDb", maxLossDbValue))
+    {
+      maxLossDb = maxLossDbValue.Get ();
+    }
+
+  // the power of the signals before any loss
+  std::vector<double> txPowers;
+  for (uint32_t i = 0; i < signals.size (); ++i)
+    {
+      txPowers.push_back (m_recordingPhy->GetPower (signals[i]->psd));
+    }
+
+  std::list<RemPoint>::iterator remIt = m_rem.begin ();
+  for (double x = m_xMin; x < m_xMax + 0.5*m_xStep; x += m_xStep)
+    {
+      for (double y = m_yMin; y < m_yMax + 0.5*m_yStep ; y += m_yStep)
+        {
+          Ptr<MobilityModel> rxMobility = remIt->bmm;
+          if (++remIt == m_rem.end ())
+            {
+              remIt = m_rem.begin ();
+            }
+          rxMobility->SetPosition (Vector (x, y, m_z));
+          BuildingsHelper::MakeConsistent (rxMobility);
+
+          // the losses are applied as by the channel for a receiver without antenna
+          double referenceSignalPower = 0;
+          double sumPower = 0;
+          for (uint32_t i = 0; i < signals.size (); ++i)
+            {
+              double power = txPowers[i];
+              Ptr<MobilityModel> txMobility = signals[i]->txPhy->GetMobility ();
+              if (txMobility != 0)
+                {
+                  double pathLossDb = 0;
+                  if (signals[i]->txAntenna != 0)
+                    {
+                      Angles txAngles (rxMobility->GetPosition (), txMobility->GetPosition ());
+                      pathLossDb -= signals[i]->txAntenna->GetGainDb (txAngles);
+                    }
+                  if (propagationLoss != 0)
+                    {
+                      pathLossDb -= propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+                    }
+                  if (pathLossDb > maxLossDb)
+                    {
+                      // beyond range
+                      continue;
+                    }
+                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+                  if (spectrumPropagationLoss != 0)
+                    {
+                      Ptr<SpectrumValue> psd = Copy<SpectrumValue> (signals[i]->psd);
+                      *psd *= pathGainLinear;
+                      psd = spectrumPropagationLoss->CalcRxPowerSpectralDensity (psd, txMobility, rxMobility);
+                      power = m_recordingPhy->GetPower (psd);
+                    }
+                  else
+                    {
+                      power *= pathGainLinear;
+                    }
+                }
+              sumPower += power;
+              if (power > referenceSignalPower)
+                {
+                  referenceSignalPower = power;
+                }
+            }
+
+          double sinr = referenceSignalPower / (sumPower - referenceSignalPower + m_noisePower);
+          NS_LOG_LOGIC ("output: " << x << "\t" << y << "\t" << m_z << "\t" << sinr);
+          m_outFile << x << "\t" << y << "\t" << m_z << "\t" << sinr << "\n";
+        }
+    }
+
+  Finalize ();
+}
+
 void 
 RadioEnvironmentMapHelper::Finalize ()
 {
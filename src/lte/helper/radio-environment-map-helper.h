@@ -88,9 +88,20 @@ private:
    * The method will divide the whole map into parts (each contains at most a
    * certain number of SINR listening points), and then call RunOneIteration()
    * on each part, one by one.
+   *
+   * With direct evaluation, the method instead deploys a single listener
+   * which records the transmitted signals, and schedules EvaluateDirectly()
+   * at the end of the listening period.
    */
   void DelayedInstall ();
 
+  /**
+   * Compute the SINR at every point of the map from the signals recorded by
+   * the listener, with the propagation models of the channel, and write it.
+   * No event is scheduled per point.
+   */
+  void EvaluateDirectly ();
+
   /**
    * Mobilize all the listeners to a specified area. Afterwards, schedule a
    * call to PrintAndReset() in 0.5 milliseconds.
@@ -111,7 +122,7 @@ private:
   /// A complete Radio Environment Map is composed of many of this structure.
   struct RemPoint 
   {
-    /// Simplified listener which compute SINR over the DL channel.
+    /// Simplified listener which compute SINR over the DL channel (none with direct evaluation).
     Ptr<RemSpectrumPhy> phy;
     /// Position of the listener in the environment.
     Ptr<MobilityModel> bmm;
@@ -152,6 +163,11 @@ private:
   bool m_useDataChannel;  ///< The `UseDataChannel` attribute.
   int32_t m_rbId;         ///< The `RbId` attribute.
 
+  bool m_directEvaluation;  ///< The `DirectEvaluation` attribute.
+
+  /// Listener which records the transmitted signals, with direct evaluation.
+  Ptr<RemSpectrumPhy> m_recordingPhy;
+
 }; // end of `class RadioEnvironmentMapHelper`
 
 
@@ -1344,16 +1344,14 @@ FdBetFfMacScheduler::DoSchedDlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
               // create the new entry
               m_p10CqiRxed.insert ( std::pair<uint16_t, uint8_t > (rnti, params.m_cqiList.at (i).m_wbCqi.at (0)) ); // only codeword 0 at this stage (SISO)
               // generate correspondent timer
-              m_p10CqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+              m_p10CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
           else
             {
               // update the CQI value and refresh correspondent timer
               (*it).second = params.m_cqiList.at (i).m_wbCqi.at (0);
               // update correspondent timer
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_p10CqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
+              m_p10CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
         }
       else if ( params.m_cqiList.at (i).m_cqiType == CqiListElement_s::A30 )
@@ -1366,15 +1364,13 @@ FdBetFfMacScheduler::DoSchedDlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
             {
               // create the new entry
               m_a30CqiRxed.insert ( std::pair<uint16_t, SbMeasResult_s > (rnti, params.m_cqiList.at (i).m_sbMeasResult) );
-              m_a30CqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+              m_a30CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
           else
             {
               // update the CQI value and refresh correspondent timer
               (*it).second = params.m_cqiList.at (i).m_sbMeasResult;
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_a30CqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
+              m_a30CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
         }
       else
@@ -1926,7 +1922,7 @@ FdBetFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
                   }
                 m_ueCqi.insert (std::pair <uint16_t, std::vector <double> > ((*itMap).second.at (i), newCqi));
                 // generate correspondent timer
-                m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > ((*itMap).second.at (i), m_cqiTimersThreshold));
+                m_ueCqiTimers.Set ((*itMap).second.at (i), m_cqiTimersThreshold);
               }
             else
               {
@@ -1934,9 +1930,7 @@ FdBetFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
                 (*itCqi).second.at (i) = sinr;
                 NS_LOG_DEBUG (this << " RNTI " << (*itMap).second.at (i) << " RB " << i << " SINR " << sinr);
                 // update correspondent timer
-                std::map <uint16_t, uint32_t>::iterator itTimers;
-                itTimers = m_ueCqiTimers.find ((*itMap).second.at (i));
-                (*itTimers).second = m_cqiTimersThreshold;
+                m_ueCqiTimers.Set ((*itMap).second.at (i), m_cqiTimersThreshold);
 
               }
 
@@ -1973,7 +1967,7 @@ FdBetFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
               }
             m_ueCqi.insert (std::pair <uint16_t, std::vector <double> > (rnti, newCqi));
             // generate correspondent timer
-            m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+            m_ueCqiTimers.Set (rnti, m_cqiTimersThreshold);
           }
         else
           {
@@ -1985,9 +1979,7 @@ FdBetFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sc
                 NS_LOG_INFO (this << " RNTI " << rnti << " update SRS-CQI for RB  " << j << " value " << sinr);
               }
             // update correspondent timer
-            std::map <uint16_t, uint32_t>::iterator itTimers;
-            itTimers = m_ueCqiTimers.find (rnti);
-            (*itTimers).second = m_cqiTimersThreshold;
+            m_ueCqiTimers.Set (rnti, m_cqiTimersThreshold);
 
           }
 
@@ -2011,49 +2003,27 @@ void
 FdBetFfMacScheduler::RefreshDlCqiMaps (void)
 {
   // refresh DL CQI P01 Map
-  std::map <uint16_t,uint32_t>::iterator itP10 = m_p10CqiTimers.begin ();
-  while (itP10 != m_p10CqiTimers.end ())
+  std::vector<uint16_t> expired;
+  m_p10CqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " P10-CQI for user " << (*itP10).first << " is " << (uint32_t)(*itP10).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itP10).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t,uint8_t>::iterator itMap = m_p10CqiRxed.find ((*itP10).first);
-          NS_ASSERT_MSG (itMap != m_p10CqiRxed.end (), " Does not find CQI report for user " << (*itP10).first);
-          NS_LOG_INFO (this << " P10-CQI expired for user " << (*itP10).first);
-          m_p10CqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itP10;
-          itP10++;
-          m_p10CqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itP10).second--;
-          itP10++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t,uint8_t>::iterator itMap = m_p10CqiRxed.find (*it);
+      NS_ASSERT_MSG (itMap != m_p10CqiRxed.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " P10-CQI expired for user " << *it);
+      m_p10CqiRxed.erase (itMap);
     }
 
   // refresh DL CQI A30 Map
-  std::map <uint16_t,uint32_t>::iterator itA30 = m_a30CqiTimers.begin ();
-  while (itA30 != m_a30CqiTimers.end ())
+  expired.clear ();
+  m_a30CqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " A30-CQI for user " << (*itA30).first << " is " << (uint32_t)(*itA30).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itA30).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t,SbMeasResult_s>::iterator itMap = m_a30CqiRxed.find ((*itA30).first);
-          NS_ASSERT_MSG (itMap != m_a30CqiRxed.end (), " Does not find CQI report for user " << (*itA30).first);
-          NS_LOG_INFO (this << " A30-CQI expired for user " << (*itA30).first);
-          m_a30CqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itA30;
-          itA30++;
-          m_a30CqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itA30).second--;
-          itA30++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t,SbMeasResult_s>::iterator itMap = m_a30CqiRxed.find (*it);
+      NS_ASSERT_MSG (itMap != m_a30CqiRxed.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " A30-CQI expired for user " << *it);
+      m_a30CqiRxed.erase (itMap);
     }
 
   return;
@@ -2064,27 +2034,16 @@ void
 FdBetFfMacScheduler::RefreshUlCqiMaps (void)
 {
   // refresh UL CQI  Map
-  std::map <uint16_t,uint32_t>::iterator itUl = m_ueCqiTimers.begin ();
-  while (itUl != m_ueCqiTimers.end ())
+  std::vector<uint16_t> expired;
+  m_ueCqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " UL-CQI for user " << (*itUl).first << " is " << (uint32_t)(*itUl).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itUl).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t, std::vector <double> >::iterator itMap = m_ueCqi.find ((*itUl).first);
-          NS_ASSERT_MSG (itMap != m_ueCqi.end (), " Does not find CQI report for user " << (*itUl).first);
-          NS_LOG_INFO (this << " UL-CQI exired for user " << (*itUl).first);
-          (*itMap).second.clear ();
-          m_ueCqi.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itUl;
-          itUl++;
-          m_ueCqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itUl).second--;
-          itUl++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t, std::vector <double> >::iterator itMap = m_ueCqi.find (*it);
+      NS_ASSERT_MSG (itMap != m_ueCqi.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " UL-CQI exired for user " << *it);
+      (*itMap).second.clear ();
+      m_ueCqi.erase (itMap);
     }
 
   return;
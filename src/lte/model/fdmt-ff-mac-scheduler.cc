@@ -1011,91 +1011,99 @@ FdMtFfMacScheduler::DoSchedDlTriggerReq (const struct FfMacSchedSapProvider::Sch
 
 
 
+  // the UEs which can be allocated in this TTI, with their layers and
+  // their subband CQIs (none if not reported yet), in the order of m_flowStatsDl
+  std::vector <std::set <uint16_t>::iterator> ues;
+  std::vector <int> ueLayers;
+  std::vector <const SbMeasResult_s*> ueSbCqis;
+  std::set <uint16_t>::iterator it;
+  for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+    {
+      std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
+      if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it))))
+        {
+          // UE already allocated for HARQ or without HARQ process available -> drop it
+          if (itRnti != rntiAllocated.end ())
+            {
+              NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
+            }
+          if (!HarqProcessAvailability ((*it)))
+            {
+              NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
+            }
+          continue;
+        }
+      std::map <uint16_t,uint8_t>::iterator itTxMode;
+      itTxMode = m_uesTxMode.find ((*it));
+      if (itTxMode == m_uesTxMode.end ())
+        {
+          NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
+        }
+      if (LcActivePerFlow ((*it)) == 0)
+        {
+          // this UE has no data to transmit
+          continue;
+        }
+      int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
+      std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
+      itCqi = m_a30CqiRxed.find ((*it));
+      ues.push_back (it);
+      ueLayers.push_back (nLayer);
+      ueSbCqis.push_back (itCqi == m_a30CqiRxed.end () ? 0 : &(*itCqi).second);
+    }
+
+  // the rate of a RBG with each CQI
+  std::vector <double> rbgRates = m_amc->GetRatesFromCqi (rbgSize);
+
   for (int i = 0; i < rbgNum; i++)
     {
       NS_LOG_INFO (this << " ALLOCATION for RBG " << i << " of " << rbgNum);
       if (rbgMap.at (i) == false)
         {
-          std::set <uint16_t>::iterator it;
           std::set <uint16_t>::iterator itMax = m_flowStatsDl.end ();
           double rcqiMax = 0.0;
-          for (it = m_flowStatsDl.begin (); it != m_flowStatsDl.end (); it++)
+          for (uint32_t u = 0; u < ues.size (); u++)
             {
-              std::set <uint16_t>::iterator itRnti = rntiAllocated.find ((*it));
-              if ((itRnti != rntiAllocated.end ())||(!HarqProcessAvailability ((*it))))
-                {
-                  // UE already allocated for HARQ or without HARQ process available -> drop it
-                  if (itRnti != rntiAllocated.end ())
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ tx" << (uint16_t)(*it));
-                  }
-                  if (!HarqProcessAvailability ((*it)))
-                  {
-                    NS_LOG_DEBUG (this << " RNTI discared for HARQ id" << (uint16_t)(*it));
-                  }
-                  continue;
-                }
-
-              std::map <uint16_t,SbMeasResult_s>::iterator itCqi;
-              itCqi = m_a30CqiRxed.find ((*it));
-              std::map <uint16_t,uint8_t>::iterator itTxMode;
-              itTxMode = m_uesTxMode.find ((*it));
-              if (itTxMode == m_uesTxMode.end ())
-                {
-                  NS_FATAL_ERROR ("No Transmission Mode info on user " << (*it));
-                }
-              int nLayer = TransmissionModesLayers::TxMode2LayerNum ((*itTxMode).second);
-              std::vector <uint8_t> sbCqi;
-              if (itCqi == m_a30CqiRxed.end ())
+              it = ues[u];
+              int nLayer = ueLayers[u];
+              double achievableRate = 0.0;
+              if (ueSbCqis[u] == 0)
                 {
+                  // no CQI reported yet -> lowest value on all the layers
                   for (uint8_t k = 0; k < nLayer; k++)
                     {
-                      sbCqi.push_back (1);  // start with lowest value
+                      achievableRate += rbgRates.at (1);
                     }
                 }
               else
                 {
-                  sbCqi = (*itCqi).second.m_higherLayerSelected.at (i).m_sbCqi;
-                }
-              uint8_t cqi1 = sbCqi.at (0);
-              uint8_t cqi2 = 1;
-              if (sbCqi.size () > 1)
-                {
-                  cqi2 = sbCqi.at (1);
-                }
-              if ((cqi1 > 0)||(cqi2 > 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
-                {
-                  if (LcActivePerFlow ((*it)) > 0)
+                  const std::vector <uint8_t> &sbCqi = ueSbCqis[u]->m_higherLayerSelected.at (i).m_sbCqi;
+                  uint8_t cqi1 = sbCqi.at (0);
+                  uint8_t cqi2 = 1;
+                  if (sbCqi.size () > 1)
                     {
-                      // this UE has data to transmit
-                      double achievableRate = 0.0;
-                      uint8_t mcs = 0;
-                      for (uint8_t k = 0; k < nLayer; k++)
-                        {
-                          if (sbCqi.size () > k)
-                            {
-                              mcs = m_amc->GetMcsFromCqi (sbCqi.at (k));
-                            }
-                          else
-                            {
-                              // no info on this subband -> worst MCS
-                              mcs = 0;
-                            }
-                          achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);   // = TB size / TTI
-                        }
+                      cqi2 = sbCqi.at (1);
+                    }
+                  if ((cqi1 == 0)&&(cqi2 == 0)) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+                    {
+                      continue;
+                    }
+                  for (uint8_t k = 0; k < nLayer; k++)
+                    {
+                      // no info on this subband -> worst MCS, the one of CQI 0
+                      achievableRate += rbgRates.at (sbCqi.size () > k ? sbCqi.at (k) : 0);   // = TB size / TTI
+                    }
+                }
 
-                      double rcqi = achievableRate;
-                      NS_LOG_INFO (this << " RNTI " << (*it) << " MCS " << (uint32_t)mcs << " achievableRate " << achievableRate << " RCQI " << rcqi);
+              double rcqi = achievableRate;
+              NS_LOG_INFO (this << " RNTI " << (*it) << " achievableRate " << achievableRate << " RCQI " << rcqi);
 
-                      if (rcqi > rcqiMax)
-                        {
-                          rcqiMax = rcqi;
-                          itMax = it;
-                        }
-                    }
-                }   // end if cqi
-              
-            } // end for m_rlcBufferReq
+              if (rcqi > rcqiMax)
+                {
+                  rcqiMax = rcqi;
+                  itMax = it;
+                }
+            } // end for ues
 
           if (itMax == m_flowStatsDl.end ())
             {
@@ -1323,16 +1331,14 @@ FdMtFfMacScheduler::DoSchedDlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
               // create the new entry
               m_p10CqiRxed.insert ( std::pair<uint16_t, uint8_t > (rnti, params.m_cqiList.at (i).m_wbCqi.at (0)) ); // only codeword 0 at this stage (SISO)
               // generate correspondent timer
-              m_p10CqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+              m_p10CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
           else
             {
               // update the CQI value and refresh correspondent timer
               (*it).second = params.m_cqiList.at (i).m_wbCqi.at (0);
               // update correspondent timer
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_p10CqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
+              m_p10CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
         }
       else if ( params.m_cqiList.at (i).m_cqiType == CqiListElement_s::A30 )
@@ -1345,15 +1351,13 @@ FdMtFfMacScheduler::DoSchedDlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
             {
               // create the new entry
               m_a30CqiRxed.insert ( std::pair<uint16_t, SbMeasResult_s > (rnti, params.m_cqiList.at (i).m_sbMeasResult) );
-              m_a30CqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+              m_a30CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
           else
             {
               // update the CQI value and refresh correspondent timer
               (*it).second = params.m_cqiList.at (i).m_sbMeasResult;
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_a30CqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
+              m_a30CqiTimers.Set (rnti, m_cqiTimersThreshold);
             }
         }
       else
@@ -1882,7 +1886,7 @@ FdMtFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
                   }
                 m_ueCqi.insert (std::pair <uint16_t, std::vector <double> > ((*itMap).second.at (i), newCqi));
                 // generate correspondent timer
-                m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > ((*itMap).second.at (i), m_cqiTimersThreshold));
+                m_ueCqiTimers.Set ((*itMap).second.at (i), m_cqiTimersThreshold);
               }
             else
               {
@@ -1890,9 +1894,7 @@ FdMtFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
                 (*itCqi).second.at (i) = sinr;
                 NS_LOG_DEBUG (this << " RNTI " << (*itMap).second.at (i) << " RB " << i << " SINR " << sinr);
                 // update correspondent timer
-                std::map <uint16_t, uint32_t>::iterator itTimers;
-                itTimers = m_ueCqiTimers.find ((*itMap).second.at (i));
-                (*itTimers).second = m_cqiTimersThreshold;
+                m_ueCqiTimers.Set ((*itMap).second.at (i), m_cqiTimersThreshold);
 
               }
 
@@ -1929,7 +1931,7 @@ FdMtFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
               }
             m_ueCqi.insert (std::pair <uint16_t, std::vector <double> > (rnti, newCqi));
             // generate correspondent timer
-            m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
+            m_ueCqiTimers.Set (rnti, m_cqiTimersThreshold);
           }
         else
           {
@@ -1941,9 +1943,7 @@ FdMtFfMacScheduler::DoSchedUlCqiInfoReq (const struct FfMacSchedSapProvider::Sch
                 NS_LOG_INFO (this << " RNTI " << rnti << " update SRS-CQI for RB  " << j << " value " << sinr);
               }
             // update correspondent timer
-            std::map <uint16_t, uint32_t>::iterator itTimers;
-            itTimers = m_ueCqiTimers.find (rnti);
-            (*itTimers).second = m_cqiTimersThreshold;
+            m_ueCqiTimers.Set (rnti, m_cqiTimersThreshold);
 
           }
 
@@ -1967,49 +1967,27 @@ void
 FdMtFfMacScheduler::RefreshDlCqiMaps (void)
 {
   // refresh DL CQI P01 Map
-  std::map <uint16_t,uint32_t>::iterator itP10 = m_p10CqiTimers.begin ();
-  while (itP10 != m_p10CqiTimers.end ())
+  std::vector<uint16_t> expired;
+  m_p10CqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " P10-CQI for user " << (*itP10).first << " is " << (uint32_t)(*itP10).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itP10).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t,uint8_t>::iterator itMap = m_p10CqiRxed.find ((*itP10).first);
-          NS_ASSERT_MSG (itMap != m_p10CqiRxed.end (), " Does not find CQI report for user " << (*itP10).first);
-          NS_LOG_INFO (this << " P10-CQI expired for user " << (*itP10).first);
-          m_p10CqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itP10;
-          itP10++;
-          m_p10CqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itP10).second--;
-          itP10++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t,uint8_t>::iterator itMap = m_p10CqiRxed.find (*it);
+      NS_ASSERT_MSG (itMap != m_p10CqiRxed.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " P10-CQI expired for user " << *it);
+      m_p10CqiRxed.erase (itMap);
     }
 
   // refresh DL CQI A30 Map
-  std::map <uint16_t,uint32_t>::iterator itA30 = m_a30CqiTimers.begin ();
-  while (itA30 != m_a30CqiTimers.end ())
+  expired.clear ();
+  m_a30CqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " A30-CQI for user " << (*itA30).first << " is " << (uint32_t)(*itA30).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itA30).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t,SbMeasResult_s>::iterator itMap = m_a30CqiRxed.find ((*itA30).first);
-          NS_ASSERT_MSG (itMap != m_a30CqiRxed.end (), " Does not find CQI report for user " << (*itA30).first);
-          NS_LOG_INFO (this << " A30-CQI expired for user " << (*itA30).first);
-          m_a30CqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itA30;
-          itA30++;
-          m_a30CqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itA30).second--;
-          itA30++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t,SbMeasResult_s>::iterator itMap = m_a30CqiRxed.find (*it);
+      NS_ASSERT_MSG (itMap != m_a30CqiRxed.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " A30-CQI expired for user " << *it);
+      m_a30CqiRxed.erase (itMap);
     }
 
   return;
@@ -2020,27 +1998,16 @@ void
 FdMtFfMacScheduler::RefreshUlCqiMaps (void)
 {
   // refresh UL CQI  Map
-  std::map <uint16_t,uint32_t>::iterator itUl = m_ueCqiTimers.begin ();
-  while (itUl != m_ueCqiTimers.end ())
+  std::vector<uint16_t> expired;
+  m_ueCqiTimers.Expire (expired);
+  for (std::vector<uint16_t>::iterator it = expired.begin (); it != expired.end (); ++it)
     {
-      NS_LOG_INFO (this << " UL-CQI for user " << (*itUl).first << " is " << (uint32_t)(*itUl).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itUl).second == 0)
-        {
-          // delete correspondent entries
-          std::map <uint16_t, std::vector <double> >::iterator itMap = m_ueCqi.find ((*itUl).first);
-          NS_ASSERT_MSG (itMap != m_ueCqi.end (), " Does not find CQI report for user " << (*itUl).first);
-          NS_LOG_INFO (this << " UL-CQI exired for user " << (*itUl).first);
-          (*itMap).second.clear ();
-          m_ueCqi.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itUl;
-          itUl++;
-          m_ueCqiTimers.erase (temp);
-        }
-      else
-        {
-          (*itUl).second--;
-          itUl++;
-        }
+      // delete correspondent entries
+      std::map <uint16_t, std::vector <double> >::iterator itMap = m_ueCqi.find (*it);
+      NS_ASSERT_MSG (itMap != m_ueCqi.end (), " Does not find CQI report for user " << *it);
+      NS_LOG_INFO (this << " UL-CQI exired for user " << *it);
+      (*itMap).second.clear ();
+      m_ueCqi.erase (itMap);
     }
 
   return;
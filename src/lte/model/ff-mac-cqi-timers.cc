@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ff-mac-cqi-timers.h"
+#include <ns3/log.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FfMacCqiTimers");
+
+FfMacCqiTimers::FfMacCqiTimers ()
+  : m_tti (0),
+    m_wheel (WHEEL_SIZE)
+{
+}
+
+void
+FfMacCqiTimers::Set (uint16_t rnti, uint32_t duration)
+{
+  NS_LOG_FUNCTION (this << rnti << duration);
+  uint64_t expiry = m_tti + duration + 1;
+  std::pair<std::map<uint16_t, uint64_t>::iterator, bool> ret;
+  ret = m_expiry.insert (std::make_pair (rnti, expiry));
+  if (!ret.second)
+    {
+      if (ret.first->second == expiry)
+        {
+          return;
+        }
+      // the entry in the slot of the previous expiry is now stale
+      ret.first->second = expiry;
+    }
+  m_wheel[expiry & (WHEEL_SIZE - 1)].push_back (rnti);
+}
+
+bool
+FfMacCqiTimers::IsRunning (uint16_t rnti) const
+{
+  return m_expiry.find (rnti) != m_expiry.end ();
+}
+
+void
+FfMacCqiTimers::Expire (std::vector<uint16_t> &expired)
+{
+  m_tti++;
+  std::vector<uint16_t> &slot = m_wheel[m_tti & (WHEEL_SIZE - 1)];
+  // keep the timers of the next revolutions, drop the stale entries
+  std::vector<uint16_t>::iterator kept = slot.begin ();
+  for (std::vector<uint16_t>::iterator it = slot.begin (); it != slot.end (); ++it)
+    {
+      std::map<uint16_t, uint64_t>::iterator itExpiry = m_expiry.find (*it);
+      if (itExpiry == m_expiry.end ()
+          || (itExpiry->second & (WHEEL_SIZE - 1)) != (m_tti & (WHEEL_SIZE - 1)))
+        {
+          continue;
+        }
+      if (itExpiry->second == m_tti)
+        {
+          NS_LOG_LOGIC ("timer of RNTI " << *it << " expired");
+          expired.push_back (*it);
+          m_expiry.erase (itExpiry);
+        }
+      else if (itExpiry->second > m_tti)
+        {
+          *kept++ = *it;
+        }
+    }
+  slot.erase (kept, slot.end ());
+}
+
+} // namespace ns3
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_CQI_TIMERS_H
+#define FF_MAC_CQI_TIMERS_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * The validity timers of the CQI reports of the UEs of a FF MAC
+ * scheduler, counted in TTIs.
+ *
+ * A timer set to n TTIs expires at the (n+1)-th call of Expire after
+ * it was set, as the counters which the schedulers used to decrement
+ * at every TTI.  The timers are kept in a timer wheel, by TTI of
+ * expiry: a TTI only visits the timers which expire in it, instead
+ * of all the timers.
+ */
+class FfMacCqiTimers
+{
+public:
+  FfMacCqiTimers ();
+
+  /**
+   * Set the timer of a UE, replacing any running timer of the UE.
+   * \param rnti the RNTI of the UE
+   * \param duration the number of TTIs before the expiry
+   */
+  void Set (uint16_t rnti, uint32_t duration);
+  /**
+   * \param rnti the RNTI of the UE
+   * \returns true if the timer of the UE is running
+   */
+  bool IsRunning (uint16_t rnti) const;
+  /**
+   * Advance the time by one TTI.
+   * \param expired the RNTIs of the timers which expired
+   */
+  void Expire (std::vector<uint16_t> &expired);
+
+private:
+  /// The number of slots of the wheel, a power of two.
+  static const uint32_t WHEEL_SIZE = 1024;
+
+  uint64_t m_tti;                                 //!< The number of calls of Expire.
+  std::map<uint16_t, uint64_t> m_expiry;          //!< The TTI of expiry of the running timers, by RNTI.
+  std::vector<std::vector<uint16_t> > m_wheel;    //!< The RNTIs, in the slot of their TTI of expiry; some are stale.
+};
+
+} // namespace ns3
+
+#endif /* FF_MAC_CQI_TIMERS_H */
@@ -293,6 +293,19 @@ LteAmc::GetTbSizeFromMcs (int mcs, int nprb)
   return (TransportBlockSizeTable[nprb - 1][itbs]);
 }
 
+std::vector<double>
+LteAmc::GetRatesFromCqi (int nprb)
+{
+  NS_LOG_FUNCTION (nprb);
+  std::vector<double> rates;
+  rates.reserve (16);
+  for (int cqi = 0; cqi <= 15; ++cqi)
+    {
+      rates.push_back ((GetTbSizeFromMcs (GetMcsFromCqi (cqi), nprb) / 8) / 0.001);   // = TB size / TTI
+    }
+  return rates;
+}
+
 
 double
 LteAmc::GetSpectralEfficiencyFromCqi (int cqi)
@@ -82,6 +82,16 @@ public:
   */
   /*static*/ int GetTbSizeFromMcs (int mcs, int nprb);
 
+  /**
+   * \brief Get the rate achievable with each CQI value over a number
+   * of PRB, i.e. the Transport Block Size of the MCS of the CQI per TTI.
+   * The schedulers evaluate their metrics with this table instead of
+   * converting each CQI to a MCS and a Transport Block Size.
+   * \param nprb the no. of PRB
+   * \return the rates in bytes/s, indexed by CQI value (0..15)
+   */
+  std::vector<double> GetRatesFromCqi (int nprb);
+
   /**
    * \brief Get the spectral efficiency value associated
    * to the received CQI
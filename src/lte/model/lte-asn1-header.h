@@ -25,6 +25,7 @@
 
 #include <bitset>
 #include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -69,12 +70,31 @@ protected:
   mutable uint8_t m_numSerializationPendingBits; //!< number of pending bits
   mutable bool m_isDataSerialized; //!< true if data is serialized
   mutable Buffer m_serializationResult; //!< serialization result
+  mutable std::vector<uint8_t> m_serializationOctets; //!< octets not yet added to m_serializationResult
 
   /**
-   * Function to write in m_serializationResult, after resizing its size
+   * Function to write an octet of the serialization; the octets are added
+   * to m_serializationResult all at once, by FlushSerializedOctets
    * \param octet bits to write
    */
   void WriteOctet (uint8_t octet) const;
+  /**
+   * Add the octets written since the last call to m_serializationResult
+   */
+  void FlushSerializedOctets () const;
+  /**
+   * Serialize the least significant bits of a value, most significant first
+   * \param value value to serialize
+   * \param numBits number of bits to serialize (at most 32)
+   */
+  void SerializeBits (uint32_t value, int numBits) const;
+  /**
+   * Get the number of bits of a constrained whole number
+   * (Clause 11.5.6 ITU-T X.691)
+   * \param range number of values of the constrained whole number
+   * \returns the smallest number of bits which can encode range values
+   */
+  static int GetRequiredBits (int range);
 
   // Serialization functions
 
@@ -256,6 +276,15 @@ protected:
 
   // Deserialization functions
 
+  /**
+   * Deserialize bits, most significant first
+   * \param value buffer to store the result
+   * \param numBits number of bits to deserialize (at most 32)
+   * \param bIterator buffer iterator
+   * \returns the modified buffer iterator
+   */
+  Buffer::Iterator DeserializeBits (uint32_t *value, int numBits,
+                                    Buffer::Iterator bIterator);
   /**
    * Deserialize a bitset
    * \param data buffer to store the result
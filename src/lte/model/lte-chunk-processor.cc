@@ -63,7 +63,14 @@ LteChunkProcessor::EvaluateChunk (const SpectrumValue& sinr, Time duration)
     {
       m_sumValues = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumValues) += sinr * duration.GetSeconds ();
+  NS_ASSERT (sinr.GetSpectrumModel () == m_sumValues->GetSpectrumModel ());
+  // accumulate in place, without the temporary of sinr * duration
+  double seconds = duration.GetSeconds ();
+  Values::iterator sum = m_sumValues->ValuesBegin ();
+  for (Values::const_iterator it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); ++it, ++sum)
+    {
+      *sum += *it * seconds;
+    }
   m_totDuration += duration;
 }
 
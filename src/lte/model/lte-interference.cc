@@ -53,6 +53,8 @@ LteInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_interf = 0;
+  m_sinr = 0;
   Object::DoDispose ();
 } 
 
@@ -78,6 +80,7 @@ LteInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
       m_rxSignal = rxPsd->Copy ();
       m_lastChangeTime = Now ();
       m_receiving = true;
+      UpdateSinr (0);
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_rsPowerChunkProcessorList.begin (); it != m_rsPowerChunkProcessorList.end (); ++it)
         {
           (*it)->Start ();
@@ -99,6 +102,7 @@ LteInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
       // make sure they use orthogonal resource blocks
       NS_ASSERT (Sum ((*rxPsd) * (*m_rxSignal)) == 0.0);
       (*m_rxSignal) += (*rxPsd);
+      UpdateSinr (rxPsd);
     }
 }
 
@@ -156,6 +160,10 @@ LteInterference::DoAddSignal  (Ptr<const SpectrumValue> spd)
   NS_LOG_FUNCTION (this << *spd);
   ConditionallyEvaluateChunk ();
   (*m_allSignals) += (*spd);
+  if (m_receiving)
+    {
+      UpdateSinr (spd);
+    }
 }
 
 void
@@ -167,6 +175,10 @@ LteInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signa
   if (deltaSignalId > 0)
     {   
       (*m_allSignals) -= (*spd);
+      if (m_receiving)
+        {
+          UpdateSinr (spd);
+        }
     }
   else
     {
@@ -188,17 +200,14 @@ LteInterference::ConditionallyEvaluateChunk ()
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
 
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-
-      SpectrumValue sinr = (*m_rxSignal) / interf;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
         {
-          (*it)->EvaluateChunk (sinr, duration);
+          (*it)->EvaluateChunk (*m_sinr, duration);
         }
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_interfChunkProcessorList.begin (); it != m_interfChunkProcessorList.end (); ++it)
         {
-          (*it)->EvaluateChunk (interf, duration);
+          (*it)->EvaluateChunk (*m_interf, duration);
         }
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_rsPowerChunkProcessorList.begin (); it != m_rsPowerChunkProcessorList.end (); ++it)
         {
@@ -208,6 +217,40 @@ LteInterference::ConditionallyEvaluateChunk ()
     }
 }
 
+void
+LteInterference::UpdateSinr (Ptr<const SpectrumValue> spd)
+{
+  NS_LOG_FUNCTION (this);
+  if (spd == 0)
+    {
+      m_interf = m_allSignals->Copy ();
+      (*m_interf) -= (*m_rxSignal);
+      (*m_interf) += (*m_noise);
+      m_sinr = m_rxSignal->Copy ();
+      (*m_sinr) /= (*m_interf);
+      return;
+    }
+  // same operations as above, restricted to the bands of the signal
+  NS_ASSERT (spd->GetSpectrumModel () == m_interf->GetSpectrumModel ());
+  Values::const_iterator signal = spd->ConstValuesBegin ();
+  Values::const_iterator all = m_allSignals->ConstValuesBegin ();
+  Values::const_iterator rx = m_rxSignal->ConstValuesBegin ();
+  Values::const_iterator noise = m_noise->ConstValuesBegin ();
+  Values::iterator interf = m_interf->ValuesBegin ();
+  Values::iterator sinr = m_sinr->ValuesBegin ();
+  for (; signal != spd->ConstValuesEnd (); ++signal, ++all, ++rx, ++noise, ++interf, ++sinr)
+    {
+      if (*signal != 0)
+        {
+          double value = *all;
+          value -= *rx;
+          value += *noise;
+          *interf = value;
+          *sinr = *rx / value;
+        }
+    }
+}
+
 void
 LteInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd)
 {
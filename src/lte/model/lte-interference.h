@@ -42,6 +42,11 @@ class LteChunkProcessor;
  * This class implements a gaussian interference model, i.e., all
  * incoming signals are added to the total interference.
  *
+ * During a RX attempt, the interference and the SINR are kept up to
+ * date incrementally: a new or ending signal only updates the
+ * resource blocks where its power spectral density is not zero, and
+ * the chunk processors are passed the stored values.
+ *
  */
 class LteInterference : public Object
 {
@@ -118,6 +123,13 @@ private:
   void ConditionallyEvaluateChunk ();
   void DoAddSignal  (Ptr<const SpectrumValue> spd);
   void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId);
+  /**
+   * Compute again the interference and the SINR of the RX attempt.
+   *
+   * @param spd if not 0, the interference and the SINR are only
+   * computed at the bands where spd is not zero
+   */
+  void UpdateSinr (Ptr<const SpectrumValue> spd);
 
 
 
@@ -135,6 +147,13 @@ private:
 
   Ptr<const SpectrumValue> m_noise;
 
+  Ptr<SpectrumValue> m_interf; /**< stores the power spectral density of
+                                * the interference plus noise perceived
+                                * by the signal being RX
+                                */
+
+  Ptr<SpectrumValue> m_sinr; /**< stores the SINR of the signal being RX */
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
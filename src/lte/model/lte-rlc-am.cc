@@ -27,6 +27,8 @@
 #include "ns3/lte-rlc-sdu-status-tag.h"
 #include "ns3/lte-rlc-tag.h"
 
+#include <bitset>
+
 
 namespace ns3 {
 
@@ -40,7 +42,6 @@ LteRlcAm::LteRlcAm ()
   NS_LOG_FUNCTION (this);
 
   // Buffers
-  m_txonBufferSize = 0;
   m_retxBuffer.resize (1024);
   m_retxBufferSize = 0;
   m_txedBuffer.resize (1024);
@@ -133,8 +134,7 @@ LteRlcAm::DoDispose ()
   m_statusProhibitTimer.Cancel ();
   m_rbsTimer.Cancel ();
 
-  m_txonBuffer.clear ();
-  m_txonBufferSize = 0;
+  m_txonBuffer.Clear ();
   m_txedBuffer.clear ();
   m_txedBufferSize = 0;
   m_retxBuffer.clear ();
@@ -157,22 +157,11 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << m_rnti << (uint32_t) m_lcid << p->GetSize ());
 
-  /** Store arrival time */
-  Time now = Simulator::Now ();
-  RlcTag timeTag (now);
-  p->AddPacketTag (timeTag);
-
-  /** Store PDCP PDU */
-
-  LteRlcSduStatusTag tag;
-  tag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-  p->AddPacketTag (tag);
-
+  /** Store PDCP PDU, with its arrival time */
   NS_LOG_LOGIC ("Txon Buffer: New packet added");
-  m_txonBuffer.push_back (p);
-  m_txonBufferSize += p->GetSize ();
-  NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.size() );
-  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+  m_txonBuffer.Push (p);
+  NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.GetNSdus ());
+  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetSize ());
 
   /** Report Buffer Status */
   DoReportBufferStatus ();
@@ -302,10 +291,10 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   // Calculate the Polling Bit (5.2.2.1)
                   rlcAmHeader.SetPollingBit (LteRlcAmHeader::STATUS_REPORT_NOT_REQUESTED);
 
-                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.empty () 
+                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.IsEmpty () 
                                 << " retxBufferSize="  << m_retxBufferSize
                                 << " packet->GetSize ()=" << packet->GetSize ());
-                  if (((m_txonBuffer.empty ()) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ())) 
+                  if (((m_txonBuffer.IsEmpty ()) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ())) 
                       || (m_vtS >= m_vtMs)
                       || m_pollRetransmitTimerJustExpired)
                     {
@@ -377,7 +366,7 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
         }
       NS_ASSERT_MSG (found, "m_retxBufferSize > 0, but no PDU considered for retx found");
     }
-  else if ( m_txonBufferSize > 0 )
+  else if ( m_txonBuffer.GetSize () > 0 )
     {
       if (bytes < 7)
       {
@@ -419,103 +408,54 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   uint32_t dataFieldTotalSize = 0;
   uint32_t dataFieldAddedSize = 0;
   std::vector < Ptr<Packet> > dataField;
+  uint8_t firstSduStatus = 0;
+  uint8_t lastSduStatus = 0;
 
-  // Remove the first packet from the transmission buffer.
-  // If only a segment of the packet is taken, then the remaining is given back later
-  if ( m_txonBuffer.size () == 0 )
+  // Take the data from the first SDUs of the transmission buffer.
+  // If only a segment of a SDU is taken, the remaining stays in the buffer
+  if ( m_txonBuffer.IsEmpty () )
     {
       NS_LOG_LOGIC ("No data pending");
       return;
     }
 
-  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txonBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.GetNSdus ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txonBuffer.GetFrontSize ());
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
-  NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-  Ptr<Packet> firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
-  m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-  NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
 
-  while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
+  while ( (! m_txonBuffer.IsEmpty ()) && (nextSegmentSize > 0) )
     {
-      NS_LOG_LOGIC ("WHILE ( firstSegment && firstSegment->GetSize > 0 && nextSegmentSize > 0 )");
-      NS_LOG_LOGIC ("    firstSegment size = " << firstSegment->GetSize ());
+      uint32_t firstSduSize = m_txonBuffer.GetFrontSize ();
+      NS_LOG_LOGIC ("WHILE ( txonBuffer not empty && nextSegmentSize > 0 )");
+      NS_LOG_LOGIC ("    firstSdu size     = " << firstSduSize);
       NS_LOG_LOGIC ("    nextSegmentSize   = " << nextSegmentSize);
-      if ( (firstSegment->GetSize () > nextSegmentSize) ||
+      Ptr<Packet> newSegment;
+      if ( (firstSduSize > nextSegmentSize) ||
            // Segment larger than 2047 octets can only be mapped to the end of the Data field
-           (firstSegment->GetSize () > 2047)
+           (firstSduSize > 2047)
          )
         {
           // Take the minimum size, due to the 2047-bytes 3GPP exception
           // This exception is due to the length of the LI field (just 11 bits)
-          uint32_t currSegmentSize = std::min (firstSegment->GetSize (), nextSegmentSize);
+          uint32_t currSegmentSize = std::min (firstSduSize, nextSegmentSize);
 
-          NS_LOG_LOGIC ("    IF ( firstSegment > nextSegmentSize ||");
-          NS_LOG_LOGIC ("         firstSegment > 2047 )");
+          NS_LOG_LOGIC ("    IF ( firstSdu > nextSegmentSize ||");
+          NS_LOG_LOGIC ("         firstSdu > 2047 )");
 
-          // Segment txBuffer.FirstBuffer and
-          // Give back the remaining segment to the transmission buffer
-          Ptr<Packet> newSegment = firstSegment->CreateFragment (0, currSegmentSize);
+          // Segment the first SDU, the remaining segment stays in the
+          // transmission buffer
+          uint8_t sduStatus = m_txonBuffer.PopFront (currSegmentSize, newSegment);
           NS_LOG_LOGIC ("    newSegment size   = " << newSegment->GetSize ());
-
-          // Status tag of the new and remaining segments
-          // Note: This is the only place where a PDU is segmented and
-          // therefore its status can change
-          LteRlcSduStatusTag oldTag, newTag;
-          firstSegment->RemovePacketTag (oldTag);
-          newSegment->RemovePacketTag (newTag);
-          if (oldTag.GetStatus () == LteRlcSduStatusTag::FULL_SDU)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::FIRST_SEGMENT);
-              oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-          else if (oldTag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::MIDDLE_SEGMENT);
-              //oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-
-          // Give back the remaining segment to the transmission buffer
-          firstSegment->RemoveAtStart (currSegmentSize);
-          NS_LOG_LOGIC ("    firstSegment size (after RemoveAtStart) = " << firstSegment->GetSize ());
-          if (firstSegment->GetSize () > 0)
-            {
-              firstSegment->AddPacketTag (oldTag);
-
-              m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-              m_txonBufferSize += (*(m_txonBuffer.begin()))->GetSize ();
-
-              NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txonBuffer.begin()))->GetSize ());
-              NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
-            }
-          else
+          if (dataField.empty ())
             {
-              // Whole segment was taken, so adjust tag
-              if (newTag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-                }
-              else if (newTag.GetStatus () == LteRlcSduStatusTag::MIDDLE_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-                }
+              firstSduStatus = sduStatus;
             }
-          // Segment is completely taken or
-          // the remaining segment is given back to the transmission buffer
-          firstSegment = 0;
-
-          // Put status tag once it has been adjusted
-          newSegment->AddPacketTag (newTag);
+          lastSduStatus = sduStatus;
 
           // Add Segment to Data field
           dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
           dataField.push_back (newSegment);
-          newSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::DATA_FIELD_FOLLOWS);
@@ -527,18 +467,22 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
           // nextSegmentSize MUST be zero (only if segment is smaller or equal to 2047)
 
-          // (NO more segments) ? exit
-          // break;
+          // (NO more segments) → exit
+          break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txonBuffer.size () == 0) )
+      else if ( (nextSegmentSize - firstSduSize <= 2) || (m_txonBuffer.GetNSdus () == 1) )
         {
-          NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txonBuffer.size == 0");
-
+          NS_LOG_LOGIC ("    IF nextSegmentSize - firstSdu->GetSize () <= 2 || txonBuffer.size == 1");
           // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
+          uint8_t sduStatus = m_txonBuffer.PopFront (firstSduSize, newSegment);
+          if (dataField.empty ())
+            {
+              firstSduStatus = sduStatus;
+            }
+          lastSduStatus = sduStatus;
+          dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
-          firstSegment = 0;
+          dataField.push_back (newSegment);
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::DATA_FIELD_FOLLOWS);
@@ -548,52 +492,43 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNSdus ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
           // nextSegmentSize <= 2 (only if txBuffer is not empty)
 
-          // (NO more segments) ? exit
-          // break;
+          // (NO more segments) → exit
+          break;
         }
-      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
+      else // (firstSdu->GetSize () < m_nextSegmentSize) && (m_txonBuffer.size () > 1)
         {
-          NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txonBuffer.size > 0");
+          NS_LOG_LOGIC ("    IF firstSdu < NextSegmentSize && txonBuffer.size > 1");
           // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
+          uint8_t sduStatus = m_txonBuffer.PopFront (firstSduSize, newSegment);
+          if (dataField.empty ())
+            {
+              firstSduStatus = sduStatus;
+            }
+          lastSduStatus = sduStatus;
+          dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
+          dataField.push_back (newSegment);
 
           // ExtensionBit (Next_Segment - 1) = 1
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::E_LI_FIELDS_FOLLOWS);
 
           // LengthIndicator (Next_Segment)  = txBuffer.FirstBuffer.length()
-          rlcAmHeader.PushLengthIndicator (firstSegment->GetSize ());
+          rlcAmHeader.PushLengthIndicator (dataFieldAddedSize);
 
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNSdus ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
-          NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
-          firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
-          m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
-          NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
         }
-
+      NS_LOG_LOGIC ("        txonBufferSize = " << m_txonBuffer.GetSize ());
     }
 
   //
@@ -610,14 +545,10 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   // Calculate FramingInfo flag according the status of the SDUs in the DataField
   uint8_t framingInfo = 0;
-  std::vector< Ptr<Packet> >::iterator it;
-  it = dataField.begin ();
 
   // FIRST SEGMENT
-  LteRlcSduStatusTag tag;
-  (*it)->RemovePacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-       (tag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
+  if ( (firstSduStatus == LteRlcSduStatusTag::FULL_SDU) ||
+       (firstSduStatus == LteRlcSduStatusTag::FIRST_SEGMENT)
      )
     {
       framingInfo |= LteRlcAmHeader::FIRST_BYTE;
@@ -626,22 +557,18 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
     {
       framingInfo |= LteRlcAmHeader::NO_FIRST_BYTE;
     }
-  (*it)->AddPacketTag (tag);
 
   // Add all SDUs (in DataField) to the Packet
-  while (it < dataField.end ())
+  for (std::vector< Ptr<Packet> >::iterator it = dataField.begin (); it != dataField.end (); ++it)
     {
       NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
 
       packet->AddAtEnd (*it);
-      it++;
     }
 
   // LAST SEGMENT (Note: There could be only one and be the first one)
-  it--;
-  (*it)->RemovePacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT) )
+  if ( (lastSduStatus == LteRlcSduStatusTag::FULL_SDU) ||
+        (lastSduStatus == LteRlcSduStatusTag::LAST_SEGMENT) )
     {
       framingInfo |= LteRlcAmHeader::LAST_BYTE;
     }
@@ -649,7 +576,6 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
     {
       framingInfo |= LteRlcAmHeader::NO_LAST_BYTE;
     }
-  (*it)->AddPacketTag (tag);
 
   // Set the FramingInfo flag after the calculation
   rlcAmHeader.SetFramingInfo (framingInfo);
@@ -664,7 +590,7 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   NS_LOG_LOGIC ("BYTE_WITHOUT_POLL = " << m_byteWithoutPoll);
 
   if ( (m_pduWithoutPoll >= m_pollPdu) || (m_byteWithoutPoll >= m_pollByte) ||
-       ( (m_txonBuffer.empty ()) && (m_retxBufferSize == 0) ) ||
+       ( (m_txonBuffer.IsEmpty ()) && (m_retxBufferSize == 0) ) ||
        (m_vtS >= m_vtMs)
        || m_pollRetransmitTimerJustExpired
      )
@@ -1006,6 +932,14 @@ LteRlcAm::DoReceivePdu (Ptr<Packet> p)
       ackSn.SetModulusBase (m_vtA);
       sn.SetModulusBase (m_vtA);
 
+      // Mark the NACKed SNs once, rather than searching the NACK list for each SN
+      std::bitset<1024> nackedSns;
+      int nack;
+      while ((nack = rlcAmHeader.PopNack ()) != -1)
+        {
+          nackedSns.set (nack);
+        }
+
       bool incrementVtA = true; 
 
       for (sn = m_vtA; sn < ackSn && sn < m_vtS; sn++)
@@ -1020,7 +954,7 @@ LteRlcAm::DoReceivePdu (Ptr<Packet> p)
               m_pollRetransmitTimer.Cancel ();
             }
 
-          if (rlcAmHeader.IsNackPresent (sn))
+          if (nackedSns.test (seqNumberValue))
             {
               NS_LOG_LOGIC ("sn " << sn << " is NACKed");
 
@@ -1542,7 +1476,7 @@ LteRlcAm::DoReportBufferStatus (void)
 
   Time now = Simulator::Now ();
 
-  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetSize ());
   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
   NS_LOG_LOGIC ("txedBufferSize = " << m_txedBufferSize);
   NS_LOG_LOGIC ("VT(A) = " << m_vtA);
@@ -1550,11 +1484,9 @@ LteRlcAm::DoReportBufferStatus (void)
 
   // Transmission Queue HOL time
   Time txonQueueHolDelay (0);
-  if ( m_txonBufferSize > 0 )
+  if ( m_txonBuffer.GetSize () > 0 )
     {
-      RlcTag txonQueueHolTimeTag;
-      m_txonBuffer.front ()->PeekPacketTag (txonQueueHolTimeTag);
-      txonQueueHolDelay = now - txonQueueHolTimeTag.GetSenderTimestamp ();
+      txonQueueHolDelay = now - m_txonBuffer.GetFrontArrivalTime ();
     }
 
   // Retransmission Queue HOL time
@@ -1580,7 +1512,7 @@ LteRlcAm::DoReportBufferStatus (void)
   LteMacSapProvider::ReportBufferStatusParameters r;
   r.rnti = m_rnti;
   r.lcid = m_lcid;
-  r.txQueueSize = m_txonBufferSize;
+  r.txQueueSize = m_txonBuffer.GetSize ();
   r.txQueueHolDelay = txonQueueHolDelay.GetMilliSeconds ();
   r.retxQueueSize = m_retxBufferSize + m_txedBufferSize;
   r.retxQueueHolDelay = retxQueueHolDelay.GetMilliSeconds ();
@@ -1656,7 +1588,7 @@ LteRlcAm::ExpirePollRetransmitTimer (void)
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("PollRetransmit Timer has expired");
 
-  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetSize ());
   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
   NS_LOG_LOGIC ("txedBufferSize = " << m_txedBufferSize);
   NS_LOG_LOGIC ("statusPduRequested = " << m_statusPduRequested);
@@ -1666,7 +1598,7 @@ LteRlcAm::ExpirePollRetransmitTimer (void)
   // see section 5.2.2.3
   // note the difference between Rel 8 and Rel 11 specs; we follow Rel 11 here
   NS_ASSERT (m_vtS <= m_vtMs);
-  if ((m_txonBufferSize == 0 && m_retxBufferSize == 0)
+  if ((m_txonBuffer.GetSize () == 0 && m_retxBufferSize == 0)
       || (m_vtS == m_vtMs))
     {
       NS_LOG_INFO ("txonBuffer and retxBuffer empty. Move PDUs up to = " << m_vtS.GetValue () - 1 << " to retxBuffer");
@@ -1704,7 +1636,7 @@ LteRlcAm::ExpireRbsTimer (void)
 {
   NS_LOG_LOGIC ("RBS Timer expires");
 
-  if (m_txonBufferSize + m_txedBufferSize + m_retxBufferSize > 0)
+  if (m_txonBuffer.GetSize () + m_txedBufferSize + m_retxBufferSize > 0)
     {
       DoReportBufferStatus ();
       m_rbsTimer = Simulator::Schedule (m_rbsTimerValue, &LteRlcAm::ExpireRbsTimer, this);
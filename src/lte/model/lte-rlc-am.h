@@ -24,6 +24,7 @@
 #include <ns3/event-id.h>
 #include <ns3/lte-rlc-sequence-number.h>
 #include <ns3/lte-rlc.h>
+#include <ns3/lte-rlc-sdu-buffer.h>
 
 #include <vector>
 #include <map>
@@ -79,7 +80,7 @@ private:
   void DoReportBufferStatus ();
 
 private:
-    std::vector < Ptr<Packet> > m_txonBuffer;       // Transmission buffer
+    LteRlcSduBuffer m_txonBuffer;                  // Transmission buffer
 
     struct RetxPdu
     {
@@ -92,7 +93,6 @@ private:
                                        ///< for retransmission 
   std::vector <RetxPdu> m_retxBuffer;  ///< Buffer for PDUs considered for retransmission
 
-    uint32_t m_txonBufferSize;
     uint32_t m_retxBufferSize;
     uint32_t m_txedBufferSize;
 
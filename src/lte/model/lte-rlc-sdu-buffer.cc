@@ -0,0 +1,118 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lte-rlc-sdu-buffer.h"
+#include "ns3/lte-rlc-sdu-status-tag.h"
+#include <ns3/simulator.h>
+#include <ns3/log.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LteRlcSduBuffer");
+
+LteRlcSduBuffer::LteRlcSduBuffer ()
+  : m_frontOffset (0),
+    m_size (0)
+{
+}
+
+void
+LteRlcSduBuffer::Push (Ptr<Packet> sdu)
+{
+  NS_LOG_FUNCTION (this << sdu->GetSize ());
+  Sdu s;
+  s.packet = sdu;
+  s.arrivalTime = Simulator::Now ();
+  m_sdus.push_back (s);
+  m_size += sdu->GetSize ();
+}
+
+uint8_t
+LteRlcSduBuffer::PopFront (uint32_t bytes, Ptr<Packet> &segment)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  NS_ASSERT_MSG (bytes <= GetFrontSize (), "segment of " << bytes << " bytes larger than the SDU");
+  Ptr<Packet> sdu = m_sdus.front ().packet;
+  bool first = (m_frontOffset == 0);
+  bool last = (bytes == GetFrontSize ());
+  if (first && last)
+    {
+      segment = sdu;
+    }
+  else
+    {
+      segment = sdu->CreateFragment (m_frontOffset, bytes);
+    }
+  m_size -= bytes;
+  if (last)
+    {
+      m_sdus.pop_front ();
+      m_frontOffset = 0;
+    }
+  else
+    {
+      m_frontOffset += bytes;
+    }
+
+  if (first)
+    {
+      return last ? LteRlcSduStatusTag::FULL_SDU : LteRlcSduStatusTag::FIRST_SEGMENT;
+    }
+  return last ? LteRlcSduStatusTag::LAST_SEGMENT : LteRlcSduStatusTag::MIDDLE_SEGMENT;
+}
+
+void
+LteRlcSduBuffer::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sdus.clear ();
+  m_frontOffset = 0;
+  m_size = 0;
+}
+
+bool
+LteRlcSduBuffer::IsEmpty (void) const
+{
+  return m_sdus.empty ();
+}
+
+uint32_t
+LteRlcSduBuffer::GetNSdus (void) const
+{
+  return m_sdus.size ();
+}
+
+uint32_t
+LteRlcSduBuffer::GetSize (void) const
+{
+  return m_size;
+}
+
+uint32_t
+LteRlcSduBuffer::GetFrontSize (void) const
+{
+  NS_ASSERT (!m_sdus.empty ());
+  return m_sdus.front ().packet->GetSize () - m_frontOffset;
+}
+
+Time
+LteRlcSduBuffer::GetFrontArrivalTime (void) const
+{
+  NS_ASSERT (!m_sdus.empty ());
+  return m_sdus.front ().arrivalTime;
+}
+
+} // namespace ns3
@@ -0,0 +1,97 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_RLC_SDU_BUFFER_H
+#define LTE_RLC_SDU_BUFFER_H
+
+#include <ns3/packet.h>
+#include <ns3/nstime.h>
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * The transmission buffer of RLC SDUs of the RLC UM and AM entities.
+ *
+ * The SDUs are kept whole, in arrival order, and the segmentation only
+ * advances a byte offset in the first SDU: the segments are fragments of
+ * the SDUs, and the status of a segment (see LteRlcSduStatusTag) follows
+ * from its offset and size, without tagging the packets.
+ */
+class LteRlcSduBuffer
+{
+public:
+  LteRlcSduBuffer ();
+
+  /**
+   * Add a SDU at the end of the buffer, arrived now.
+   * \param sdu the SDU
+   */
+  void Push (Ptr<Packet> sdu);
+
+  /**
+   * Remove the first bytes of the buffer, all in the first SDU.
+   * \param bytes the number of bytes, at most GetFrontSize ()
+   * \param segment the packet of the bytes, which is the SDU itself when
+   *        the SDU is taken whole
+   * \return the status of the segment, as in LteRlcSduStatusTag
+   */
+  uint8_t PopFront (uint32_t bytes, Ptr<Packet> &segment);
+
+  /**
+   * Remove all the SDUs.
+   */
+  void Clear (void);
+
+  /**
+   * \return true if there is no SDU in the buffer
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \return the number of SDUs in the buffer, including the segmented one
+   */
+  uint32_t GetNSdus (void) const;
+  /**
+   * \return the number of bytes in the buffer
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \return the number of bytes left in the first SDU
+   */
+  uint32_t GetFrontSize (void) const;
+  /**
+   * \return the arrival time of the first SDU
+   */
+  Time GetFrontArrivalTime (void) const;
+
+private:
+  /// A SDU of the buffer.
+  struct Sdu
+  {
+    Ptr<Packet> packet; ///< The SDU.
+    Time arrivalTime;   ///< The arrival time of the SDU.
+  };
+
+  std::deque<Sdu> m_sdus;      ///< The SDUs.
+  uint32_t m_frontOffset;      ///< The number of bytes of the first SDU already removed.
+  uint32_t m_size;             ///< The number of bytes in the buffer.
+};
+
+} // namespace ns3
+
+#endif // LTE_RLC_SDU_BUFFER_H
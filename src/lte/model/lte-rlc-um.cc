@@ -34,7 +34,6 @@ NS_OBJECT_ENSURE_REGISTERED (LteRlcUm);
 
 LteRlcUm::LteRlcUm ()
   : m_maxTxBufferSize (10 * 1024),
-    m_txBufferSize (0),
     m_sequenceNumber (0),
     m_vrUr (0),
     m_vrUx (0),
@@ -73,6 +72,7 @@ LteRlcUm::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_reorderingTimer.Cancel ();
   m_rbsTimer.Cancel ();
+  m_txBuffer.Clear ();
 
   LteRlc::DoDispose ();
 }
@@ -86,30 +86,20 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << m_rnti << (uint32_t) m_lcid << p->GetSize ());
 
-  if (m_txBufferSize + p->GetSize () <= m_maxTxBufferSize)
+  if (m_txBuffer.GetSize () + p->GetSize () <= m_maxTxBufferSize)
     {
-      /** Store arrival time */
-      RlcTag timeTag (Simulator::Now ());
-      p->AddPacketTag (timeTag);
-
-      /** Store PDCP PDU */
-
-      LteRlcSduStatusTag tag;
-      tag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-      p->AddPacketTag (tag);
-
+      /** Store PDCP PDU, with its arrival time */
       NS_LOG_LOGIC ("Tx Buffer: New packet added");
-      m_txBuffer.push_back (p);
-      m_txBufferSize += p->GetSize ();
-      NS_LOG_LOGIC ("NumOfBuffers = " << m_txBuffer.size() );
-      NS_LOG_LOGIC ("txBufferSize = " << m_txBufferSize);
+      m_txBuffer.Push (p);
+      NS_LOG_LOGIC ("NumOfBuffers = " << m_txBuffer.GetNSdus ());
+      NS_LOG_LOGIC ("txBufferSize = " << m_txBuffer.GetSize ());
     }
   else
     {
       // Discard full RLC SDU
       NS_LOG_LOGIC ("TxBuffer is full. RLC SDU discarded");
       NS_LOG_LOGIC ("MaxTxBufferSize = " << m_maxTxBufferSize);
-      NS_LOG_LOGIC ("txBufferSize    = " << m_txBufferSize);
+      NS_LOG_LOGIC ("txBufferSize    = " << m_txBuffer.GetSize ());
       NS_LOG_LOGIC ("packet size     = " << p->GetSize ());
     }
 
@@ -144,103 +134,54 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   uint32_t dataFieldTotalSize = 0;
   uint32_t dataFieldAddedSize = 0;
   std::vector < Ptr<Packet> > dataField;
+  uint8_t firstSduStatus = 0;
+  uint8_t lastSduStatus = 0;
 
-  // Remove the first packet from the transmission buffer.
-  // If only a segment of the packet is taken, then the remaining is given back later
-  if ( m_txBuffer.size () == 0 )
+  // Take the data from the first SDUs of the transmission buffer.
+  // If only a segment of a SDU is taken, the remaining stays in the buffer
+  if ( m_txBuffer.IsEmpty () )
     {
       NS_LOG_LOGIC ("No data pending");
       return;
     }
 
-  NS_LOG_LOGIC ("SDUs in TxBuffer  = " << m_txBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("SDUs in TxBuffer  = " << m_txBuffer.GetNSdus ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txBuffer.GetFrontSize ());
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
-  NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-  Ptr<Packet> firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-  m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
-  NS_LOG_LOGIC ("txBufferSize      = " << m_txBufferSize );
-  m_txBuffer.erase (m_txBuffer.begin ());
 
-  while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
+  while ( (! m_txBuffer.IsEmpty ()) && (nextSegmentSize > 0) )
     {
-      NS_LOG_LOGIC ("WHILE ( firstSegment && firstSegment->GetSize > 0 && nextSegmentSize > 0 )");
-      NS_LOG_LOGIC ("    firstSegment size = " << firstSegment->GetSize ());
+      uint32_t firstSduSize = m_txBuffer.GetFrontSize ();
+      NS_LOG_LOGIC ("WHILE ( txBuffer not empty && nextSegmentSize > 0 )");
+      NS_LOG_LOGIC ("    firstSdu size     = " << firstSduSize);
       NS_LOG_LOGIC ("    nextSegmentSize   = " << nextSegmentSize);
-      if ( (firstSegment->GetSize () > nextSegmentSize) ||
+      Ptr<Packet> newSegment;
+      if ( (firstSduSize > nextSegmentSize) ||
            // Segment larger than 2047 octets can only be mapped to the end of the Data field
-           (firstSegment->GetSize () > 2047)
+           (firstSduSize > 2047)
          )
         {
           // Take the minimum size, due to the 2047-bytes 3GPP exception
           // This exception is due to the length of the LI field (just 11 bits)
-          uint32_t currSegmentSize = std::min (firstSegment->GetSize (), nextSegmentSize);
+          uint32_t currSegmentSize = std::min (firstSduSize, nextSegmentSize);
 
-          NS_LOG_LOGIC ("    IF ( firstSegment > nextSegmentSize ||");
-          NS_LOG_LOGIC ("         firstSegment > 2047 )");
+          NS_LOG_LOGIC ("    IF ( firstSdu > nextSegmentSize ||");
+          NS_LOG_LOGIC ("         firstSdu > 2047 )");
 
-          // Segment txBuffer.FirstBuffer and
-          // Give back the remaining segment to the transmission buffer
-          Ptr<Packet> newSegment = firstSegment->CreateFragment (0, currSegmentSize);
+          // Segment the first SDU, the remaining segment stays in the
+          // transmission buffer
+          uint8_t sduStatus = m_txBuffer.PopFront (currSegmentSize, newSegment);
           NS_LOG_LOGIC ("    newSegment size   = " << newSegment->GetSize ());
-
-          // Status tag of the new and remaining segments
-          // Note: This is the only place where a PDU is segmented and
-          // therefore its status can change
-          LteRlcSduStatusTag oldTag, newTag;
-          firstSegment->RemovePacketTag (oldTag);
-          newSegment->RemovePacketTag (newTag);
-          if (oldTag.GetStatus () == LteRlcSduStatusTag::FULL_SDU)
+          if (dataField.empty ())
             {
-              newTag.SetStatus (LteRlcSduStatusTag::FIRST_SEGMENT);
-              oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
+              firstSduStatus = sduStatus;
             }
-          else if (oldTag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::MIDDLE_SEGMENT);
-              //oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-
-          // Give back the remaining segment to the transmission buffer
-          firstSegment->RemoveAtStart (currSegmentSize);
-          NS_LOG_LOGIC ("    firstSegment size (after RemoveAtStart) = " << firstSegment->GetSize ());
-          if (firstSegment->GetSize () > 0)
-            {
-              firstSegment->AddPacketTag (oldTag);
-
-              m_txBuffer.insert (m_txBuffer.begin (), firstSegment);
-              m_txBufferSize += (*(m_txBuffer.begin()))->GetSize ();
-
-              NS_LOG_LOGIC ("    TX buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    TX buffers = " << m_txBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txBuffer.begin()))->GetSize ());
-              NS_LOG_LOGIC ("    txBufferSize = " << m_txBufferSize );
-            }
-          else
-            {
-              // Whole segment was taken, so adjust tag
-              if (newTag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-                }
-              else if (newTag.GetStatus () == LteRlcSduStatusTag::MIDDLE_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-                }
-            }
-          // Segment is completely taken or
-          // the remaining segment is given back to the transmission buffer
-          firstSegment = 0;
-
-          // Put status tag once it has been adjusted
-          newSegment->AddPacketTag (newTag);
+          lastSduStatus = sduStatus;
 
           // Add Segment to Data field
           dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
           dataField.push_back (newSegment);
-          newSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcHeader.PushExtensionBit (LteRlcHeader::DATA_FIELD_FOLLOWS);
@@ -253,16 +194,21 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           // nextSegmentSize MUST be zero (only if segment is smaller or equal to 2047)
 
           // (NO more segments) → exit
-          // break;
+          break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txBuffer.size () == 0) )
+      else if ( (nextSegmentSize - firstSduSize <= 2) || (m_txBuffer.GetNSdus () == 1) )
         {
-          NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txBuffer.size == 0");
+          NS_LOG_LOGIC ("    IF nextSegmentSize - firstSdu->GetSize () <= 2 || txBuffer.size == 1");
           // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
+          uint8_t sduStatus = m_txBuffer.PopFront (firstSduSize, newSegment);
+          if (dataField.empty ())
+            {
+              firstSduStatus = sduStatus;
+            }
+          lastSduStatus = sduStatus;
+          dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
-          firstSegment = 0;
+          dataField.push_back (newSegment);
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcHeader.PushExtensionBit (LteRlcHeader::DATA_FIELD_FOLLOWS);
@@ -272,68 +218,54 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.GetNSdus ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
           // nextSegmentSize <= 2 (only if txBuffer is not empty)
 
           // (NO more segments) → exit
-          // break;
+          break;
         }
-      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
+      else // (firstSdu->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 1)
         {
-          NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txBuffer.size > 0");
+          NS_LOG_LOGIC ("    IF firstSdu < NextSegmentSize && txBuffer.size > 1");
           // Add txBuffer.FirstBuffer to DataField
-          dataFieldAddedSize = firstSegment->GetSize ();
+          uint8_t sduStatus = m_txBuffer.PopFront (firstSduSize, newSegment);
+          if (dataField.empty ())
+            {
+              firstSduStatus = sduStatus;
+            }
+          lastSduStatus = sduStatus;
+          dataFieldAddedSize = newSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
-          dataField.push_back (firstSegment);
+          dataField.push_back (newSegment);
 
           // ExtensionBit (Next_Segment - 1) = 1
           rlcHeader.PushExtensionBit (LteRlcHeader::E_LI_FIELDS_FOLLOWS);
 
           // LengthIndicator (Next_Segment)  = txBuffer.FirstBuffer.length()
-          rlcHeader.PushLengthIndicator (firstSegment->GetSize ());
+          rlcHeader.PushLengthIndicator (dataFieldAddedSize);
 
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.GetNSdus ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
-          NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
-          firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-          m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
-          m_txBuffer.erase (m_txBuffer.begin ());
-          NS_LOG_LOGIC ("        txBufferSize = " << m_txBufferSize );
         }
-
+      NS_LOG_LOGIC ("        txBufferSize = " << m_txBuffer.GetSize ());
     }
 
   // Build RLC header
   rlcHeader.SetSequenceNumber (m_sequenceNumber++);
 
   // Build RLC PDU with DataField and Header
-  std::vector< Ptr<Packet> >::iterator it;
-  it = dataField.begin ();
-
   uint8_t framingInfo = 0;
 
   // FIRST SEGMENT
-  LteRlcSduStatusTag tag;
-  (*it)->RemovePacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT) )
+  if ( (firstSduStatus == LteRlcSduStatusTag::FULL_SDU) ||
+       (firstSduStatus == LteRlcSduStatusTag::FIRST_SEGMENT) )
     {
       framingInfo |= LteRlcHeader::FIRST_BYTE;
     }
@@ -341,21 +273,17 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
     {
       framingInfo |= LteRlcHeader::NO_FIRST_BYTE;
     }
-  (*it)->AddPacketTag (tag);
 
-  while (it < dataField.end ())
+  for (std::vector< Ptr<Packet> >::iterator it = dataField.begin (); it != dataField.end (); ++it)
     {
       NS_LOG_LOGIC ("Adding SDU/segment to packet, length = " << (*it)->GetSize ());
 
       packet->AddAtEnd (*it);
-      it++;
     }
 
   // LAST SEGMENT (Note: There could be only one and be the first one)
-  it--;
-  (*it)->RemovePacketTag (tag);
-  if ( (tag.GetStatus () == LteRlcSduStatusTag::FULL_SDU) ||
-        (tag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT) )
+  if ( (lastSduStatus == LteRlcSduStatusTag::FULL_SDU) ||
+       (lastSduStatus == LteRlcSduStatusTag::LAST_SEGMENT) )
     {
       framingInfo |= LteRlcHeader::LAST_BYTE;
     }
@@ -363,7 +291,6 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
     {
       framingInfo |= LteRlcHeader::NO_LAST_BYTE;
     }
-  (*it)->AddPacketTag (tag);
 
   rlcHeader.SetFramingInfo (framingInfo);
 
@@ -385,7 +312,7 @@ LteRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   m_macSapProvider->TransmitPdu (params);
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
       m_rbsTimer.Cancel ();
       m_rbsTimer = Simulator::Schedule (MilliSeconds (10), &LteRlcUm::ExpireRbsTimer, this);
@@ -1114,13 +1041,11 @@ LteRlcUm::DoReportBufferStatus (void)
   Time holDelay (0);
   uint32_t queueSize = 0;
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
-      RlcTag holTimeTag;
-      m_txBuffer.front ()->PeekPacketTag (holTimeTag);
-      holDelay = Simulator::Now () - holTimeTag.GetSenderTimestamp ();
+      holDelay = Simulator::Now () - m_txBuffer.GetFrontArrivalTime ();
 
-      queueSize = m_txBufferSize + 2 * m_txBuffer.size (); // Data in tx queue + estimated headers size
+      queueSize = m_txBuffer.GetSize () + 2 * m_txBuffer.GetNSdus (); // Data in tx queue + estimated headers size
     }
 
   LteMacSapProvider::ReportBufferStatusParameters r;
@@ -1181,7 +1106,7 @@ LteRlcUm::ExpireRbsTimer (void)
 {
   NS_LOG_LOGIC ("RBS Timer expires");
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
       DoReportBufferStatus ();
       m_rbsTimer = Simulator::Schedule (MilliSeconds (10), &LteRlcUm::ExpireRbsTimer, this);
@@ -23,6 +23,7 @@
 
 #include "ns3/lte-rlc-sequence-number.h"
 #include "ns3/lte-rlc.h"
+#include "ns3/lte-rlc-sdu-buffer.h"
 
 #include <ns3/event-id.h>
 #include <map>
@@ -67,8 +68,7 @@ private:
 
 private:
   uint32_t m_maxTxBufferSize;
-  uint32_t m_txBufferSize;
-  std::vector < Ptr<Packet> > m_txBuffer;       // Transmission buffer
+  LteRlcSduBuffer m_txBuffer;                   // Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; // Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     // Reassembling buffer
 
@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pathloss-matrix-propagation-loss-model.h"
+#include <ns3/log.h>
+#include <ns3/mobility-model.h>
+#include <ns3/node.h>
+#include <ns3/double.h>
+#include <ns3/pointer.h>
+#include <ns3/object-ptr-container.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PathlossMatrixPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (PathlossMatrixPropagationLossModel);
+
+TypeId
+PathlossMatrixPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PathlossMatrixPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<PathlossMatrixPropagationLossModel> ()
+    .AddAttribute ("Frequency",
+                   "The carrier frequency (in Hz) of the pathloss, which is "
+                   "checked when loading a file saved by another simulation",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&PathlossMatrixPropagationLossModel::m_frequency),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+PathlossMatrixPropagationLossModel::PathlossMatrixPropagationLossModel ()
+  : m_frequency (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PathlossMatrixPropagationLossModel::~PathlossMatrixPropagationLossModel ()
+{
+}
+
+void
+PathlossMatrixPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_propagationLoss = 0;
+  m_pathloss.clear ();
+  m_loadedPathloss.clear ();
+  PropagationLossModel::DoDispose ();
+}
+
+void
+PathlossMatrixPropagationLossModel::SetPropagationLossModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_propagationLoss = model;
+}
+
+Ptr<PropagationLossModel>
+PathlossMatrixPropagationLossModel::GetPropagationLossModel (void) const
+{
+  return m_propagationLoss;
+}
+
+uint32_t
+PathlossMatrixPropagationLossModel::GetNodeId (Ptr<MobilityModel> mobility)
+{
+  Ptr<Node> node = mobility->GetObject<Node> ();
+  NS_ASSERT_MSG (node != 0, "the mobility model " << mobility << " is not aggregated to a node");
+  return node->GetId ();
+}
+
+bool
+PathlossMatrixPropagationLossModel::IsSamePosition (const Vector &v1, const Vector &v2)
+{
+  return (v1.x == v2.x) && (v1.y == v2.y) && (v1.z == v2.z);
+}
+
+void
+PathlossMatrixPropagationLossModel::Add (Ptr<MobilityModel> a, Ptr<MobilityModel> b)
+{
+  NS_LOG_FUNCTION (this << a << b);
+  PathlossEntry entry;
+  entry.aPosition = a->GetPosition ();
+  entry.bPosition = b->GetPosition ();
+
+  std::map<NodeIdPair, PathlossEntry>::const_iterator it;
+  it = m_loadedPathloss.find (std::make_pair (GetNodeId (a), GetNodeId (b)));
+  if (it != m_loadedPathloss.end ()
+      && IsSamePosition (it->second.aPosition, entry.aPosition)
+      && IsSamePosition (it->second.bPosition, entry.bPosition))
+    {
+      entry.loss = it->second.loss;
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_propagationLoss != 0, "no propagation loss model to compute the pathloss");
+      entry.loss = -m_propagationLoss->CalcRxPower (0.0, a, b);
+    }
+  NS_LOG_LOGIC ("pathloss " << entry.loss << " dB from " << entry.aPosition << " to " << entry.bPosition);
+  m_pathloss[std::make_pair (a, b)] = entry;
+}
+
+std::string
+PathlossMatrixPropagationLossModel::GetHeader (void) const
+{
+  NS_ASSERT_MSG (m_propagationLoss != 0, "no propagation loss model to compute the pathloss");
+  std::ostringstream oss;
+  oss << std::setprecision (std::numeric_limits<double>::digits10 + 2);
+  oss << "# " << m_propagationLoss->GetInstanceTypeId ().GetName ()
+      << " Frequency=" << m_frequency;
+  TypeId tid;
+  for (tid = m_propagationLoss->GetInstanceTypeId (); tid.HasParent (); tid = tid.GetParent ())
+    {
+      for (uint32_t i = 0; i < tid.GetAttributeN (); ++i)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!info.accessor->HasGetter ()
+              || dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              continue;
+            }
+          Ptr<AttributeValue> value = info.checker->Create ();
+          if (!m_propagationLoss->GetAttributeFailSafe (info.name, *value))
+            {
+              continue;
+            }
+          oss << " " << info.name << "=";
+          // the address of the object pointed to differs in every simulation
+          const PointerValue *pointer = dynamic_cast<const PointerValue *> (PeekPointer (value));
+          if (pointer != 0)
+            {
+              Ptr<Object> object = pointer->GetObject ();
+              if (object != 0)
+                {
+                  oss << object->GetInstanceTypeId ().GetName ();
+                }
+              else
+                {
+                  oss << "0";
+                }
+            }
+          else
+            {
+              oss << value->SerializeToString (info.checker);
+            }
+        }
+    }
+  return oss.str ();
+}
+
+bool
+PathlossMatrixPropagationLossModel::Load (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream inFile (fileName.c_str ());
+  if (!inFile.is_open ())
+    {
+      NS_LOG_LOGIC ("can't open file " << fileName);
+      return false;
+    }
+  std::string header;
+  std::getline (inFile, header);
+  if (header != GetHeader ())
+    {
+      NS_LOG_WARN ("ignoring file " << fileName << ", saved with another configuration: "
+                   << header << " instead of " << GetHeader ());
+      return false;
+    }
+  uint32_t aId;
+  uint32_t bId;
+  PathlossEntry entry;
+  while (inFile >> aId >> bId
+         >> entry.aPosition.x >> entry.aPosition.y >> entry.aPosition.z
+         >> entry.bPosition.x >> entry.bPosition.y >> entry.bPosition.z
+         >> entry.loss)
+    {
+      m_loadedPathloss[std::make_pair (aId, bId)] = entry;
+    }
+  NS_LOG_INFO ("loaded the pathloss of " << m_loadedPathloss.size () << " pairs from " << fileName);
+  return true;
+}
+
+void
+PathlossMatrixPropagationLossModel::Save (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ofstream outFile (fileName.c_str ());
+  if (!outFile.is_open ())
+    {
+      NS_FATAL_ERROR ("Can't open file " << fileName);
+    }
+  // enough digits to read back the same values
+  outFile << std::setprecision (std::numeric_limits<double>::digits10 + 2);
+  outFile << GetHeader () << std::endl;
+  for (std::map<MobilityPair, PathlossEntry>::const_iterator it = m_pathloss.begin ();
+       it != m_pathloss.end ();
+       ++it)
+    {
+      const PathlossEntry &entry = it->second;
+      outFile << GetNodeId (it->first.first) << " " << GetNodeId (it->first.second) << " "
+              << entry.aPosition.x << " " << entry.aPosition.y << " " << entry.aPosition.z << " "
+              << entry.bPosition.x << " " << entry.bPosition.y << " " << entry.bPosition.z << " "
+              << entry.loss << std::endl;
+    }
+}
+
+uint32_t
+PathlossMatrixPropagationLossModel::GetN (void) const
+{
+  return m_pathloss.size ();
+}
+
+double
+PathlossMatrixPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                                   Ptr<MobilityModel> a,
+                                                   Ptr<MobilityModel> b) const
+{
+  std::map<MobilityPair, PathlossEntry>::const_iterator it = m_pathloss.find (std::make_pair (a, b));
+  if (it != m_pathloss.end ()
+      && IsSamePosition (it->second.aPosition, a->GetPosition ())
+      && IsSamePosition (it->second.bPosition, b->GetPosition ()))
+    {
+      return txPowerDbm - it->second.loss;
+    }
+  NS_ASSERT_MSG (m_propagationLoss != 0, "no propagation loss model to compute the pathloss");
+  return m_propagationLoss->CalcRxPower (txPowerDbm, a, b);
+}
+
+int64_t
+PathlossMatrixPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_propagationLoss != 0)
+    {
+      return m_propagationLoss->AssignStreams (stream);
+    }
+  return 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PATHLOSS_MATRIX_PROPAGATION_LOSS_MODEL_H
+#define PATHLOSS_MATRIX_PROPAGATION_LOSS_MODEL_H
+
+#include <ns3/propagation-loss-model.h>
+#include <ns3/vector.h>
+#include <map>
+#include <string>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup lte
+ *
+ * A propagation loss model which stores the pathloss of pairs of
+ * stationary nodes, computed once by another propagation loss model,
+ * e.g. a buildings propagation loss model.
+ *
+ * The pathloss of a pair added with Add is used as long as the two
+ * nodes are at the positions of the computation; the pathloss of the
+ * other pairs, and of the pairs whose nodes moved, is computed by the
+ * wrapped model at every call.
+ *
+ * The pathloss of the pairs can be saved to a file and loaded in
+ * another simulation of the same topology, e.g. another replication,
+ * in which the pairs are identified by the ids and the positions of
+ * their nodes.  Note that the pathloss loaded includes the shadowing
+ * drawn in the simulation which saved it.
+ *
+ * The first line of the file describes the computation of the pathloss:
+ * the TypeId and the attributes of the wrapped model, and the frequency
+ * set with the Frequency attribute.  A file whose first line differs
+ * from the description of the current configuration is ignored.
+ */
+class PathlossMatrixPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PathlossMatrixPropagationLossModel ();
+  virtual ~PathlossMatrixPropagationLossModel ();
+
+  /**
+   * \param model the model which computes the pathloss
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> model);
+
+  /**
+   * \return the model which computes the pathloss
+   */
+  Ptr<PropagationLossModel> GetPropagationLossModel (void) const;
+
+  /**
+   * Store the pathloss from a node to another at their current
+   * positions, computed by the wrapped model unless it was loaded for
+   * these nodes and positions.
+   *
+   * \param a the mobility model of the transmitter
+   * \param b the mobility model of the receiver
+   */
+  void Add (Ptr<MobilityModel> a, Ptr<MobilityModel> b);
+
+  /**
+   * Load the pathloss saved by Save, to be used by the following calls
+   * of Add instead of the wrapped model.  The file is ignored if it was
+   * saved with another wrapped model, other attributes of the wrapped
+   * model or another frequency.
+   *
+   * \param fileName the name of the file
+   * \return false if the file could not be opened or was ignored
+   */
+  bool Load (std::string fileName);
+
+  /**
+   * Save the pathloss of the pairs added.
+   *
+   * \param fileName the name of the file
+   */
+  void Save (std::string fileName) const;
+
+  /**
+   * \return the number of pairs added
+   */
+  uint32_t GetN (void) const;
+
+private:
+  // inherited from Object
+  virtual void DoDispose (void);
+
+  // inherited from PropagationLossModel
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /**
+   * \param mobility a mobility model aggregated to a node
+   * \return the id of the node
+   */
+  static uint32_t GetNodeId (Ptr<MobilityModel> mobility);
+
+  /**
+   * \param v1 a position
+   * \param v2 another position
+   * \return true if the positions are the same
+   */
+  static bool IsSamePosition (const Vector &v1, const Vector &v2);
+
+  /**
+   * \return the first line of the saved files, which describes the
+   * wrapped model, its attributes and the frequency
+   */
+  std::string GetHeader (void) const;
+
+  /// The pathloss from a node to another.
+  struct PathlossEntry
+  {
+    Vector aPosition; ///< The position of the transmitter.
+    Vector bPosition; ///< The position of the receiver.
+    double loss;      ///< The pathloss in dB, positive.
+  };
+
+  /// Mobility models pair
+  typedef std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > MobilityPair;
+  /// Node ids pair
+  typedef std::pair<uint32_t, uint32_t> NodeIdPair;
+
+  Ptr<PropagationLossModel> m_propagationLoss;                //!< The model which computes the pathloss.
+  std::map<MobilityPair, PathlossEntry> m_pathloss;           //!< The pathloss of the pairs added.
+  std::map<NodeIdPair, PathlossEntry> m_loadedPathloss;       //!< The pathloss loaded, by node ids.
+  double m_frequency;                                         //!< The carrier frequency (Hz).
+};
+
+} // namespace ns3
+
+#endif /* PATHLOSS_MATRIX_PROPAGATION_LOSS_MODEL_H */
@@ -26,6 +26,7 @@
 #include <ns3/ff-mac-csched-sap.h>
 #include <ns3/ff-mac-sched-sap.h>
 #include <ns3/ff-mac-scheduler.h>
+#include <ns3/ff-mac-cqi-timers.h>
 #include <vector>
 #include <map>
 #include <ns3/nstime.h>
@@ -215,7 +216,7 @@ private:
   /*
   * Map of UE's timers on DL CQI P01 received
   */
-  std::map <uint16_t,uint32_t> m_p10CqiTimers;
+  FfMacCqiTimers m_p10CqiTimers;
 
   /*
   * Map of UE's DL CQI A30 received
@@ -224,7 +225,7 @@ private:
   /*
   * Map of UE's timers on DL CQI A30 received
   */
-  std::map <uint16_t,uint32_t> m_a30CqiTimers;
+  FfMacCqiTimers m_a30CqiTimers;
 
   /*
   * Map of previous allocated UE per RBG
@@ -239,7 +240,7 @@ private:
   /*
   * Map of UEs' timers on UL-CQI per RBG
   */
-  std::map <uint16_t, uint32_t> m_ueCqiTimers;
+  FfMacCqiTimers m_ueCqiTimers;
 
   /*
   * Map of UE's buffer status reports received
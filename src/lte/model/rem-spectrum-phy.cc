@@ -43,7 +43,8 @@ RemSpectrumPhy::RemSpectrumPhy ()
     m_sumPower (0),
     m_active (true),
     m_useDataChannel (false),
-    m_rbId (-1)
+    m_rbId (-1),
+    m_recordSignals (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -60,6 +61,7 @@ RemSpectrumPhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_mobility = 0;
+  m_recordedSignals.clear ();
   SpectrumPhy::DoDispose ();
 }
 
@@ -134,15 +136,11 @@ RemSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
           if (lteDlDataRxParams != 0)
             {
               NS_LOG_DEBUG ("StartRx data");
-              double power = 0;
-              if (m_rbId >= 0)
+              if (m_recordSignals)
                 {
-                  power = (*(params->psd))[m_rbId] * 180000;
-                }
-              else
-                {
-                  power = Integral (*(params->psd));
+                  m_recordedSignals.push_back (params);
                 }
+              double power = GetPower (params->psd);
 
               m_sumPower += power;
               if (power > m_referenceSignalPower)
@@ -157,15 +155,11 @@ RemSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
           if (lteDlCtrlRxParams != 0)
             {
               NS_LOG_DEBUG ("StartRx control");
-              double power = 0;
-              if (m_rbId >= 0)
+              if (m_recordSignals)
                 {
-                  power = (*(params->psd))[m_rbId] * 180000;
-                }
-              else
-                {
-                  power = Integral (*(params->psd));
+                  m_recordedSignals.push_back (params);
                 }
+              double power = GetPower (params->psd);
 
               m_sumPower += power;
               if (power > m_referenceSignalPower)
@@ -221,5 +215,30 @@ RemSpectrumPhy::SetRbId (int32_t rbId)
   m_rbId = rbId;
 }
 
+void
+RemSpectrumPhy::SetRecordSignals (bool value)
+{
+  m_recordSignals = value;
+}
+
+const std::vector<Ptr<SpectrumSignalParameters> >&
+RemSpectrumPhy::GetRecordedSignals () const
+{
+  return m_recordedSignals;
+}
+
+double
+RemSpectrumPhy::GetPower (Ptr<const SpectrumValue> psd) const
+{
+  if (m_rbId >= 0)
+    {
+      return (*psd)[m_rbId] * 180000;
+    }
+  else
+    {
+      return Integral (*psd);
+    }
+}
+
 
 } // namespace ns3
@@ -29,8 +29,10 @@
 #include <ns3/net-device.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-channel.h>
+#include <ns3/spectrum-signal-parameters.h>
 #include <string>
 #include <fstream>
+#include <vector>
 
 namespace ns3 {
 
@@ -114,6 +116,29 @@ public:
    */
   void SetRbId (int32_t rbId);
 
+  /**
+   * set the recording of the received signals
+   *
+   * \param value if true, the parameters of the signals processed
+   * while active are kept, so that the signals can be evaluated at
+   * other points than the one of this instance
+   */
+  void SetRecordSignals (bool value);
+
+  /**
+   *
+   * \return the parameters of the signals recorded so far
+   */
+  const std::vector<Ptr<SpectrumSignalParameters> >& GetRecordedSignals () const;
+
+  /**
+   * \param psd the power spectral density of a signal
+   *
+   * \return the power of the signal over the RB set with SetRbId, or
+   * over all the RBs if none
+   */
+  double GetPower (Ptr<const SpectrumValue> psd) const;
+
 private:
   Ptr<MobilityModel> m_mobility;
   Ptr<const SpectrumModel> m_rxSpectrumModel;
@@ -126,6 +151,9 @@ private:
   bool m_useDataChannel;
   int32_t m_rbId;
 
+  bool m_recordSignals;
+  std::vector<Ptr<SpectrumSignalParameters> > m_recordedSignals;
+
 };
 
 
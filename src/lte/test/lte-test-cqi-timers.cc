@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/ff-mac-cqi-timers.h>
+#include <algorithm>
+#include <sstream>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestCqiTimers");
+
+/**
+ * \ingroup lte
+ *
+ * Check FfMacCqiTimers against the counters which the FF MAC schedulers
+ * used to decrement at every TTI, with random timer settings.
+ */
+class LteCqiTimersTestCase : public TestCase
+{
+public:
+  /**
+   * \param maxDuration the maximum duration of the timers, in TTIs
+   */
+  LteCqiTimersTestCase (uint32_t maxDuration);
+  virtual ~LteCqiTimersTestCase ();
+
+private:
+  static std::string BuildNameString (uint32_t maxDuration);
+  virtual void DoRun (void);
+
+  uint32_t m_maxDuration;
+};
+
+std::string
+LteCqiTimersTestCase::BuildNameString (uint32_t maxDuration)
+{
+  std::ostringstream oss;
+  oss << "CQI timers, maximum duration " << maxDuration << " TTIs";
+  return oss.str ();
+}
+
+LteCqiTimersTestCase::LteCqiTimersTestCase (uint32_t maxDuration)
+  : TestCase (BuildNameString (maxDuration)),
+    m_maxDuration (maxDuration)
+{
+}
+
+LteCqiTimersTestCase::~LteCqiTimersTestCase ()
+{
+}
+
+void
+LteCqiTimersTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  FfMacCqiTimers timers;
+  std::map<uint16_t, uint32_t> counters;
+  const uint16_t nUes = 64;
+
+  for (uint32_t tti = 0; tti < 20000; tti++)
+    {
+      // the reports received in the TTI
+      uint32_t nSet = rng->GetInteger (0, 4);
+      for (uint32_t i = 0; i < nSet; i++)
+        {
+          uint16_t rnti = rng->GetInteger (1, nUes);
+          uint32_t duration = rng->GetInteger (0, m_maxDuration);
+          timers.Set (rnti, duration);
+          counters[rnti] = duration;
+        }
+
+      std::vector<uint16_t> expected;
+      std::map<uint16_t, uint32_t>::iterator it = counters.begin ();
+      while (it != counters.end ())
+        {
+          if ((*it).second == 0)
+            {
+              expected.push_back ((*it).first);
+              counters.erase (it++);
+            }
+          else
+            {
+              (*it).second--;
+              ++it;
+            }
+        }
+
+      std::vector<uint16_t> expired;
+      timers.Expire (expired);
+      std::sort (expired.begin (), expired.end ());
+      NS_TEST_ASSERT_MSG_EQ (expired.size (), expected.size (), "wrong number of expired timers at TTI " << tti);
+      for (uint32_t i = 0; i < expected.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (expired.at (i), expected.at (i), "wrong expired timer at TTI " << tti);
+        }
+
+      for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+        {
+          bool running = (counters.find (rnti) != counters.end ());
+          NS_TEST_ASSERT_MSG_EQ (timers.IsRunning (rnti), running, "wrong state of the timer of RNTI " << rnti << " at TTI " << tti);
+        }
+    }
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * FfMacCqiTimers test suite
+ */
+class LteCqiTimersTestSuite : public TestSuite
+{
+public:
+  LteCqiTimersTestSuite ();
+};
+
+LteCqiTimersTestSuite::LteCqiTimersTestSuite ()
+  : TestSuite ("lte-cqi-timers", UNIT)
+{
+  AddTestCase (new LteCqiTimersTestCase (10), TestCase::QUICK);
+  AddTestCase (new LteCqiTimersTestCase (1000), TestCase::QUICK);
+  // longer than a revolution of the timer wheel
+  AddTestCase (new LteCqiTimersTestCase (5000), TestCase::QUICK);
+}
+
+static LteCqiTimersTestSuite g_lteCqiTimersTestSuite;
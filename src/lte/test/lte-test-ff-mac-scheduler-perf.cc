@@ -0,0 +1,314 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/object-factory.h>
+#include <ns3/boolean.h>
+#include <ns3/ff-mac-scheduler.h>
+#include <ns3/ff-mac-csched-sap.h>
+#include <ns3/ff-mac-sched-sap.h>
+#include <ns3/lte-fr-no-op-algorithm.h>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestFfMacSchedulerPerf");
+
+/**
+ * \ingroup lte
+ *
+ * The MAC side of the SAPs of a FF MAC scheduler: counts the
+ * allocations of the scheduler and drops them.
+ */
+class LteFfMacSchedulerPerfSapUser : public FfMacSchedSapUser,
+                                     public FfMacCschedSapUser
+{
+public:
+  LteFfMacSchedulerPerfSapUser ();
+
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params);
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params);
+
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params);
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params);
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params);
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params);
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params);
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params);
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params);
+
+  uint32_t m_dlAllocations;  //!< The number of DL allocations.
+  uint32_t m_ulAllocations;  //!< The number of UL allocations.
+};
+
+LteFfMacSchedulerPerfSapUser::LteFfMacSchedulerPerfSapUser ()
+  : m_dlAllocations (0),
+    m_ulAllocations (0)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+{
+  m_dlAllocations += params.m_buildDataList.size ();
+}
+
+void
+LteFfMacSchedulerPerfSapUser::SchedUlConfigInd (const struct SchedUlConfigIndParameters& params)
+{
+  m_ulAllocations += params.m_dciList.size ();
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+LteFfMacSchedulerPerfSapUser::CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * Measure the time a FF MAC scheduler takes per TTI for the UEs of a
+ * loaded eNB: the scheduler is driven through its SAPs as LteEnbMac
+ * does, without the PHY and the channel, every UE has backlogged DL and
+ * UL data and reports its CQI and its buffer status periodically.
+ */
+class LteFfMacSchedulerPerfTestCase : public TestCase
+{
+public:
+  /**
+   * \param schedulerType the TypeId name of the scheduler
+   * \param nUes the number of UEs of the eNB
+   */
+  LteFfMacSchedulerPerfTestCase (std::string schedulerType, uint16_t nUes);
+  virtual ~LteFfMacSchedulerPerfTestCase ();
+
+private:
+  static std::string BuildNameString (std::string schedulerType, uint16_t nUes);
+  virtual void DoRun (void);
+
+  /// The number of TTIs measured.
+  static const uint32_t N_TTIS = 2000;
+  /// The period of the CQI and buffer status reports of each UE, in TTIs.
+  static const uint32_t REPORT_PERIOD = 40;
+  /// The DL and UL bandwidth, in RBs.
+  static const uint8_t BANDWIDTH = 25;
+  /// The maximum and guaranteed bit rates of the bearers, in bit/s.
+  static const uint64_t BIT_RATE = 64000;
+
+  std::string m_schedulerType;
+  uint16_t m_nUes;
+};
+
+std::string
+LteFfMacSchedulerPerfTestCase::BuildNameString (std::string schedulerType, uint16_t nUes)
+{
+  std::ostringstream oss;
+  oss << schedulerType << ", " << nUes << " UEs";
+  return oss.str ();
+}
+
+LteFfMacSchedulerPerfTestCase::LteFfMacSchedulerPerfTestCase (std::string schedulerType, uint16_t nUes)
+  : TestCase (BuildNameString (schedulerType, nUes)),
+    m_schedulerType (schedulerType),
+    m_nUes (nUes)
+{
+}
+
+LteFfMacSchedulerPerfTestCase::~LteFfMacSchedulerPerfTestCase ()
+{
+}
+
+void
+LteFfMacSchedulerPerfTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_schedulerType);
+  factory.Set ("HarqEnabled", BooleanValue (false));
+  Ptr<FfMacScheduler> scheduler = factory.Create<FfMacScheduler> ();
+  Ptr<LteFrNoOpAlgorithm> ffr = CreateObject<LteFrNoOpAlgorithm> ();
+  ffr->SetDlBandwidth (BANDWIDTH);
+  ffr->SetUlBandwidth (BANDWIDTH);
+  scheduler->SetLteFfrSapProvider (ffr->GetLteFfrSapProvider ());
+  ffr->SetLteFfrSapUser (scheduler->GetLteFfrSapUser ());
+
+  LteFfMacSchedulerPerfSapUser mac;
+  scheduler->SetFfMacSchedSapUser (&mac);
+  scheduler->SetFfMacCschedSapUser (&mac);
+  FfMacSchedSapProvider *sched = scheduler->GetFfMacSchedSapProvider ();
+  FfMacCschedSapProvider *csched = scheduler->GetFfMacCschedSapProvider ();
+
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_ulBandwidth = BANDWIDTH;
+  cellConfig.m_dlBandwidth = BANDWIDTH;
+  csched->CschedCellConfigReq (cellConfig);
+
+  for (uint16_t rnti = 1; rnti <= m_nUes; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+      ueConfig.m_rnti = rnti;
+      ueConfig.m_transmissionMode = 0;
+      ueConfig.m_reconfigureFlag = false;
+      csched->CschedUeConfigReq (ueConfig);
+
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+      lcConfig.m_rnti = rnti;
+      lcConfig.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = 3;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      // the token bank schedulers only allocate to the flows with a
+      // maximum bit rate
+      lc.m_eRabMaximulBitrateUl = BIT_RATE;
+      lc.m_eRabMaximulBitrateDl = BIT_RATE;
+      lc.m_eRabGuaranteedBitrateUl = BIT_RATE;
+      lc.m_eRabGuaranteedBitrateDl = BIT_RATE;
+      lcConfig.m_logicalChannelConfigList.push_back (lc);
+      csched->CschedLcConfigReq (lcConfig);
+
+      FfMacSchedSapProvider::SchedDlRlcBufferReqParameters buffer;
+      buffer.m_rnti = rnti;
+      buffer.m_logicalChannelIdentity = 3;
+      buffer.m_rlcTransmissionQueueSize = 100000000;
+      buffer.m_rlcTransmissionQueueHolDelay = 0;
+      buffer.m_rlcRetransmissionQueueSize = 0;
+      buffer.m_rlcRetransmissionHolDelay = 0;
+      buffer.m_rlcStatusPduSize = 0;
+      sched->SchedDlRlcBufferReq (buffer);
+    }
+
+  clock_t start = clock ();
+  for (uint32_t tti = 0; tti < N_TTIS; tti++)
+    {
+      uint16_t sfnSf = ((0x3FF & (tti / 10)) << 4) | (0xF & (tti % 10 + 1));
+
+      // the reports of the UEs whose turn it is
+      FfMacSchedSapProvider::SchedDlCqiInfoReqParameters cqiInfo;
+      cqiInfo.m_sfnSf = sfnSf;
+      FfMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters macCtrlInfo;
+      macCtrlInfo.m_sfnSf = sfnSf;
+      for (uint16_t rnti = 1 + tti % REPORT_PERIOD; rnti <= m_nUes; rnti += REPORT_PERIOD)
+        {
+          CqiListElement_s cqi;
+          cqi.m_rnti = rnti;
+          cqi.m_ri = 1;
+          cqi.m_cqiType = CqiListElement_s::P10;
+          cqi.m_wbCqi.push_back (1 + rnti % 15);
+          cqi.m_wbPmi = 0;
+          cqiInfo.m_cqiList.push_back (cqi);
+
+          MacCeListElement_s bsr;
+          bsr.m_rnti = rnti;
+          bsr.m_macCeType = MacCeListElement_s::BSR;
+          bsr.m_macCeValue.m_bufferStatus.resize (4, 0);
+          bsr.m_macCeValue.m_bufferStatus.at (1) = 40;
+          macCtrlInfo.m_macCeList.push_back (bsr);
+        }
+      sched->SchedDlCqiInfoReq (cqiInfo);
+      sched->SchedUlMacCtrlInfoReq (macCtrlInfo);
+
+      FfMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+      dlTrigger.m_sfnSf = sfnSf;
+      sched->SchedDlTriggerReq (dlTrigger);
+
+      FfMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+      ulTrigger.m_sfnSf = sfnSf;
+      sched->SchedUlTriggerReq (ulTrigger);
+    }
+  clock_t stop = clock ();
+
+  scheduler->Dispose ();
+  ffr->Dispose ();
+
+  NS_TEST_ASSERT_MSG_GT (mac.m_dlAllocations, 0, "No DL allocation");
+  NS_TEST_ASSERT_MSG_GT (mac.m_ulAllocations, 0, "No UL allocation");
+
+  std::cout << "FF MAC scheduler time per TTI: " << GetName () << ": "
+            << 1e6 * (stop - start) / CLOCKS_PER_SEC / N_TTIS << " us"
+            << std::endl;
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * FF MAC scheduler benchmark: 1000 UEs per eNB
+ */
+class LteFfMacSchedulerPerfTestSuite : public TestSuite
+{
+public:
+  LteFfMacSchedulerPerfTestSuite ();
+};
+
+LteFfMacSchedulerPerfTestSuite::LteFfMacSchedulerPerfTestSuite ()
+  : TestSuite ("lte-ff-mac-scheduler-perf", PERFORMANCE)
+{
+  const char *schedulers[] = {
+    "ns3::RrFfMacScheduler",
+    "ns3::PfFfMacScheduler",
+    "ns3::FdMtFfMacScheduler",
+    "ns3::TdMtFfMacScheduler",
+    "ns3::TtaFfMacScheduler",
+    "ns3::FdBetFfMacScheduler",
+    "ns3::TdBetFfMacScheduler",
+    "ns3::FdTbfqFfMacScheduler",
+    "ns3::TdTbfqFfMacScheduler",
+    "ns3::PssFfMacScheduler",
+    "ns3::CqaFfMacScheduler"
+  };
+  for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+    {
+      AddTestCase (new LteFfMacSchedulerPerfTestCase (schedulers[i], 1000), TestCase::QUICK);
+    }
+}
+
+static LteFfMacSchedulerPerfTestSuite g_lteFfMacSchedulerPerfTestSuite;
@@ -0,0 +1,321 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/config.h>
+#include <ns3/string.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/building.h>
+#include <ns3/buildings-helper.h>
+#include <ns3/hybrid-buildings-propagation-loss-model.h>
+#include <ns3/pathloss-matrix-propagation-loss-model.h>
+#include <ns3/lte-helper.h>
+#include <ns3/channel-list.h>
+#include <ns3/spectrum-channel.h>
+#include <fstream>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestPathlossMatrix");
+
+/**
+ * \ingroup lte
+ *
+ * Check that PathlossMatrixPropagationLossModel returns the pathloss of
+ * the wrapped model, and the pathloss loaded from a file for the same
+ * nodes at the same positions.
+ */
+class LtePathlossMatrixModelTestCase : public TestCase
+{
+public:
+  LtePathlossMatrixModelTestCase ();
+  virtual ~LtePathlossMatrixModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LtePathlossMatrixModelTestCase::LtePathlossMatrixModelTestCase ()
+  : TestCase ("Pathloss matrix of a buildings propagation loss model")
+{
+}
+
+LtePathlossMatrixModelTestCase::~LtePathlossMatrixModelTestCase ()
+{
+}
+
+void
+LtePathlossMatrixModelTestCase::DoRun (void)
+{
+  Ptr<Building> building = CreateObject<Building> ();
+  building->SetBoundaries (Box (100.0, 150.0, 0.0, 50.0, 0.0, 20.0));
+  building->SetNFloors (5);
+
+  NodeContainer enbNodes;
+  enbNodes.Create (2);
+  NodeContainer ueNodes;
+  ueNodes.Create (3);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (300.0, 100.0, 30.0));
+  positionAlloc->Add (Vector (50.0, 20.0, 1.5));
+  positionAlloc->Add (Vector (120.0, 20.0, 1.5));   // indoor
+  positionAlloc->Add (Vector (140.0, 40.0, 13.5));  // indoor, upper floor
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (ueNodes);
+  BuildingsHelper::MakeMobilityModelConsistent ();
+
+  Ptr<HybridBuildingsPropagationLossModel> buildingsLoss = CreateObject<HybridBuildingsPropagationLossModel> ();
+  Ptr<PathlossMatrixPropagationLossModel> matrix = CreateObject<PathlossMatrixPropagationLossModel> ();
+  matrix->SetPropagationLossModel (buildingsLoss);
+  for (uint32_t i = 0; i < enbNodes.GetN (); ++i)
+    {
+      for (uint32_t j = 0; j < ueNodes.GetN (); ++j)
+        {
+          matrix->Add (enbNodes.Get (i)->GetObject<MobilityModel> (), ueNodes.Get (j)->GetObject<MobilityModel> ());
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (matrix->GetN (), 6, "wrong number of pairs");
+
+  // the shadowing of the buildings model is drawn once per pair
+  std::map<std::pair<uint32_t, uint32_t>, double> expected;
+  for (uint32_t i = 0; i < enbNodes.GetN (); ++i)
+    {
+      for (uint32_t j = 0; j < ueNodes.GetN (); ++j)
+        {
+          Ptr<MobilityModel> a = enbNodes.Get (i)->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> b = ueNodes.Get (j)->GetObject<MobilityModel> ();
+          double rxPower = buildingsLoss->CalcRxPower (30.0, a, b);
+          expected[std::make_pair (i, j)] = rxPower;
+          NS_TEST_ASSERT_MSG_EQ_TOL (matrix->CalcRxPower (30.0, a, b), rxPower, 1e-9,
+                                     "wrong precomputed pathloss from eNB " << i << " to UE " << j);
+          // the pairs not added are computed by the wrapped model
+          NS_TEST_ASSERT_MSG_EQ_TOL (matrix->CalcRxPower (30.0, b, a), buildingsLoss->CalcRxPower (30.0, b, a), 1e-9,
+                                     "wrong pathloss from UE " << j << " to eNB " << i);
+        }
+    }
+
+  std::string fileName = CreateTempDirFilename ("pathloss-matrix.txt");
+  matrix->Save (fileName);
+
+  // the first UE moves
+  Ptr<MobilityModel> movedMobility = ueNodes.Get (0)->GetObject<MobilityModel> ();
+  movedMobility->SetPosition (Vector (60.0, -20.0, 1.5));
+  BuildingsHelper::MakeConsistent (movedMobility);
+  Ptr<MobilityModel> enbMobility = enbNodes.Get (0)->GetObject<MobilityModel> ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (matrix->CalcRxPower (30.0, enbMobility, movedMobility),
+                             buildingsLoss->CalcRxPower (30.0, enbMobility, movedMobility), 1e-9,
+                             "wrong pathloss of a UE which moved");
+
+  // another simulation of the topology, with a model of the same
+  // configuration which would draw another shadowing
+  Ptr<HybridBuildingsPropagationLossModel> otherBuildingsLoss = CreateObject<HybridBuildingsPropagationLossModel> ();
+  Ptr<PathlossMatrixPropagationLossModel> loadedMatrix = CreateObject<PathlossMatrixPropagationLossModel> ();
+  loadedMatrix->SetPropagationLossModel (otherBuildingsLoss);
+  NS_TEST_ASSERT_MSG_EQ (loadedMatrix->Load (fileName), true, "can't load the pathloss matrix");
+  for (uint32_t i = 0; i < enbNodes.GetN (); ++i)
+    {
+      for (uint32_t j = 0; j < ueNodes.GetN (); ++j)
+        {
+          Ptr<MobilityModel> a = enbNodes.Get (i)->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> b = ueNodes.Get (j)->GetObject<MobilityModel> ();
+          loadedMatrix->Add (a, b);
+          // the pathloss saved for the UE which moved is not used
+          double rxPower = (j == 0) ? otherBuildingsLoss->CalcRxPower (30.0, a, b) : expected[std::make_pair (i, j)];
+          NS_TEST_ASSERT_MSG_EQ_TOL (loadedMatrix->CalcRxPower (30.0, a, b), rxPower, 1e-9,
+                                     "wrong loaded pathloss from eNB " << i << " to UE " << j);
+        }
+    }
+
+  // the file is ignored with another model, other attributes of the
+  // model or another frequency
+  Ptr<PathlossMatrixPropagationLossModel> ignoringMatrix = CreateObject<PathlossMatrixPropagationLossModel> ();
+  ignoringMatrix->SetPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  NS_TEST_ASSERT_MSG_EQ (ignoringMatrix->Load (fileName), false, "file of another model loaded");
+  Ptr<HybridBuildingsPropagationLossModel> shadowedLoss = CreateObject<HybridBuildingsPropagationLossModel> ();
+  shadowedLoss->SetAttribute ("ShadowSigmaOutdoor", DoubleValue (3.0));
+  ignoringMatrix->SetPropagationLossModel (shadowedLoss);
+  NS_TEST_ASSERT_MSG_EQ (ignoringMatrix->Load (fileName), false, "file of other attributes loaded");
+  ignoringMatrix->SetPropagationLossModel (CreateObject<HybridBuildingsPropagationLossModel> ());
+  ignoringMatrix->SetAttribute ("Frequency", DoubleValue (2.1e9));
+  NS_TEST_ASSERT_MSG_EQ (ignoringMatrix->Load (fileName), false, "file of another frequency loaded");
+  Ptr<MobilityModel> ueMobility = ueNodes.Get (1)->GetObject<MobilityModel> ();
+  ignoringMatrix->Add (enbMobility, ueMobility);
+  NS_TEST_ASSERT_MSG_EQ_TOL (ignoringMatrix->CalcRxPower (30.0, enbMobility, ueMobility),
+                             ignoringMatrix->GetPropagationLossModel ()->CalcRxPower (30.0, enbMobility, ueMobility), 1e-9,
+                             "pathloss of an ignored file used");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * Check that the SINR reported by the UEs is the same with and without
+ * the pathloss matrix of LteHelper.
+ */
+class LtePathlossMatrixHelperTestCase : public TestCase
+{
+public:
+  LtePathlossMatrixHelperTestCase ();
+  virtual ~LtePathlossMatrixHelperTestCase ();
+
+  /**
+   * Record the SINR reported by a UE.
+   * \param context the context of the trace
+   * \param cellId the cell ID
+   * \param rnti the RNTI
+   * \param rsrp the RSRP
+   * \param sinr the SINR
+   */
+  void ReportSinr (std::string context, uint16_t cellId, uint16_t rnti, double rsrp, double sinr);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Simulate the scenario.
+   * \param usePathlossMatrix the `UsePathlossMatrix` attribute of LteHelper
+   * \return the sum of the SINR reported by the UEs
+   */
+  double RunScenario (bool usePathlossMatrix);
+
+  double m_sinrSum;       ///< The sum of the SINR reported by the UEs.
+  uint32_t m_nReports;    ///< The number of reports.
+};
+
+LtePathlossMatrixHelperTestCase::LtePathlossMatrixHelperTestCase ()
+  : TestCase ("Pathloss matrix of LteHelper")
+{
+}
+
+LtePathlossMatrixHelperTestCase::~LtePathlossMatrixHelperTestCase ()
+{
+}
+
+void
+LtePathlossMatrixHelperTestCase::ReportSinr (std::string context, uint16_t cellId, uint16_t rnti, double rsrp, double sinr)
+{
+  m_sinrSum += sinr;
+  m_nReports++;
+}
+
+double
+LtePathlossMatrixHelperTestCase::RunScenario (bool usePathlossMatrix)
+{
+  m_sinrSum = 0;
+  m_nReports = 0;
+
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisPropagationLossModel"));
+  lteHelper->SetAttribute ("UsePathlossMatrix", BooleanValue (usePathlossMatrix));
+  std::string filePrefix = CreateTempDirFilename ("lte-pathloss-matrix");
+  lteHelper->SetAttribute ("PathlossMatrixFilePrefix", StringValue (filePrefix));
+
+  NodeContainer enbNodes;
+  enbNodes.Create (2);
+  NodeContainer ueNodes;
+  ueNodes.Create (4);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (500.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (50.0, 20.0, 1.5));
+  positionAlloc->Add (Vector (200.0, -30.0, 1.5));
+  positionAlloc->Add (Vector (300.0, 40.0, 1.5));
+  positionAlloc->Add (Vector (480.0, 10.0, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  lteHelper->Attach (ueDevs.Get (0), enbDevs.Get (0));
+  lteHelper->Attach (ueDevs.Get (1), enbDevs.Get (0));
+  lteHelper->Attach (ueDevs.Get (2), enbDevs.Get (1));
+  lteHelper->Attach (ueDevs.Get (3), enbDevs.Get (1));
+  EpsBearer bearer (EpsBearer::GBR_CONV_VOICE);
+  lteHelper->ActivateDataRadioBearer (ueDevs, bearer);
+  if (usePathlossMatrix)
+    {
+      lteHelper->PrecomputePathlossMatrix (enbDevs, ueDevs);
+      for (uint32_t i = 0; i < ChannelList::GetNChannels (); ++i)
+        {
+          Ptr<SpectrumChannel> channel = ChannelList::GetChannel (i)->GetObject<SpectrumChannel> ();
+          Ptr<PathlossMatrixPropagationLossModel> matrix;
+          matrix = channel->GetPropagationLossModel ()->GetObject<PathlossMatrixPropagationLossModel> ();
+          NS_TEST_EXPECT_MSG_NE (matrix, 0, "no pathloss matrix in channel " << i);
+          NS_TEST_EXPECT_MSG_EQ (matrix->GetN (), 8, "wrong number of pairs in channel " << i);
+        }
+      std::ifstream dlFile ((filePrefix + "-dl.txt").c_str ());
+      NS_TEST_EXPECT_MSG_EQ (dlFile.is_open (), true, "DL pathloss matrix not saved");
+      std::ifstream ulFile ((filePrefix + "-ul.txt").c_str ());
+      NS_TEST_EXPECT_MSG_EQ (ulFile.is_open (), true, "UL pathloss matrix not saved");
+    }
+
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUePhy/ReportCurrentCellRsrpSinr",
+                   MakeCallback (&LtePathlossMatrixHelperTestCase::ReportSinr, this));
+
+  Simulator::Stop (Seconds (0.1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_sinrSum;
+}
+
+void
+LtePathlossMatrixHelperTestCase::DoRun (void)
+{
+  double sinrSum = RunScenario (false);
+  uint32_t nReports = m_nReports;
+  double matrixSinrSum = RunScenario (true);
+  NS_TEST_ASSERT_MSG_GT (nReports, 0, "no SINR reported");
+  NS_TEST_ASSERT_MSG_EQ (m_nReports, nReports, "wrong number of SINR reports with the pathloss matrix");
+  NS_TEST_ASSERT_MSG_EQ_TOL (matrixSinrSum, sinrSum, sinrSum * 1e-9, "wrong SINR with the pathloss matrix");
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * PathlossMatrixPropagationLossModel test suite
+ */
+class LtePathlossMatrixTestSuite : public TestSuite
+{
+public:
+  LtePathlossMatrixTestSuite ();
+};
+
+LtePathlossMatrixTestSuite::LtePathlossMatrixTestSuite ()
+  : TestSuite ("lte-pathloss-matrix", SYSTEM)
+{
+  AddTestCase (new LtePathlossMatrixModelTestCase, TestCase::QUICK);
+  AddTestCase (new LtePathlossMatrixHelperTestCase, TestCase::QUICK);
+}
+
+static LtePathlossMatrixTestSuite g_ltePathlossMatrixTestSuite;
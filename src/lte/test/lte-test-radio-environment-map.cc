@@ -0,0 +1,209 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/integer.h>
+#include <ns3/boolean.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/buildings-helper.h>
+#include <ns3/lte-helper.h>
+#include <ns3/radio-environment-map-helper.h>
+#include <fstream>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestRadioEnvironmentMap");
+
+/**
+ * \ingroup lte
+ *
+ * Check that the direct evaluation of the RadioEnvironmentMapHelper
+ * produces the same map as the evaluation with a listener per point.
+ */
+class LteRadioEnvironmentMapTestCase : public TestCase
+{
+public:
+  /**
+   * \param useDataChannel whether the map is built from the data channel
+   * \param rbId the RB of the map, -1 for the whole band
+   */
+  LteRadioEnvironmentMapTestCase (bool useDataChannel, int32_t rbId);
+  virtual ~LteRadioEnvironmentMapTestCase ();
+
+private:
+  static std::string BuildNameString (bool useDataChannel, int32_t rbId);
+  virtual void DoRun (void);
+  /**
+   * Simulate the scenario and write its REM.
+   * \param directEvaluation the `DirectEvaluation` attribute of the REM helper
+   * \param fileName the output file of the REM
+   */
+  void RunScenario (bool directEvaluation, std::string fileName);
+  /**
+   * \param fileName an output file of the REM
+   * \returns the values of the file
+   */
+  std::vector<double> ReadValues (std::string fileName);
+
+  bool m_useDataChannel;
+  int32_t m_rbId;
+};
+
+std::string
+LteRadioEnvironmentMapTestCase::BuildNameString (bool useDataChannel, int32_t rbId)
+{
+  std::ostringstream oss;
+  oss << "REM direct evaluation, " << (useDataChannel ? "data" : "control") << " channel, RB " << rbId;
+  return oss.str ();
+}
+
+LteRadioEnvironmentMapTestCase::LteRadioEnvironmentMapTestCase (bool useDataChannel, int32_t rbId)
+  : TestCase (BuildNameString (useDataChannel, rbId)),
+    m_useDataChannel (useDataChannel),
+    m_rbId (rbId)
+{
+}
+
+LteRadioEnvironmentMapTestCase::~LteRadioEnvironmentMapTestCase ()
+{
+}
+
+void
+LteRadioEnvironmentMapTestCase::RunScenario (bool directEvaluation, std::string fileName)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisPropagationLossModel"));
+  lteHelper->SetEnbAntennaModelType ("ns3::CosineAntennaModel");
+  lteHelper->SetEnbAntennaModelAttribute ("Beamwidth", DoubleValue (100));
+
+  NodeContainer enbNodes;
+  enbNodes.Create (3);
+  NodeContainer ueNodes;
+  ueNodes.Create (3);
+
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (500.0, 0.0, 30.0));
+  positionAlloc->Add (Vector (250.0, 400.0, 30.0));
+  positionAlloc->Add (Vector (100.0, 50.0, 1.5));
+  positionAlloc->Add (Vector (450.0, -50.0, 1.5));
+  positionAlloc->Add (Vector (250.0, 300.0, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (ueNodes);
+
+  NetDeviceContainer enbDevs;
+  for (uint32_t i = 0; i < enbNodes.GetN (); ++i)
+    {
+      lteHelper->SetEnbAntennaModelAttribute ("Orientation", DoubleValue (i * 120.0));
+      enbDevs.Add (lteHelper->InstallEnbDevice (enbNodes.Get (i)));
+    }
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  for (uint32_t i = 0; i < ueDevs.GetN (); ++i)
+    {
+      lteHelper->Attach (ueDevs.Get (i), enbDevs.Get (i));
+    }
+  EpsBearer bearer (EpsBearer::GBR_CONV_VOICE);
+  lteHelper->ActivateDataRadioBearer (ueDevs, bearer);
+
+  Ptr<RadioEnvironmentMapHelper> remHelper = CreateObject<RadioEnvironmentMapHelper> ();
+  remHelper->SetAttribute ("ChannelPath", StringValue ("/ChannelList/0"));
+  remHelper->SetAttribute ("OutputFile", StringValue (fileName));
+  remHelper->SetAttribute ("XMin", DoubleValue (-200.0));
+  remHelper->SetAttribute ("XMax", DoubleValue (700.0));
+  remHelper->SetAttribute ("XRes", UintegerValue (31));
+  remHelper->SetAttribute ("YMin", DoubleValue (-300.0));
+  remHelper->SetAttribute ("YMax", DoubleValue (600.0));
+  remHelper->SetAttribute ("YRes", UintegerValue (29));
+  remHelper->SetAttribute ("Z", DoubleValue (1.5));
+  remHelper->SetAttribute ("MaxPointsPerIteration", UintegerValue (200));
+  remHelper->SetAttribute ("UseDataChannel", BooleanValue (m_useDataChannel));
+  remHelper->SetAttribute ("RbId", IntegerValue (m_rbId));
+  remHelper->SetAttribute ("DirectEvaluation", BooleanValue (directEvaluation));
+  remHelper->Install ();
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+std::vector<double>
+LteRadioEnvironmentMapTestCase::ReadValues (std::string fileName)
+{
+  std::vector<double> values;
+  std::ifstream file (fileName.c_str ());
+  double value;
+  while (file >> value)
+    {
+      values.push_back (value);
+    }
+  return values;
+}
+
+void
+LteRadioEnvironmentMapTestCase::DoRun (void)
+{
+  std::string eventFileName = CreateTempDirFilename ("rem-event.out");
+  std::string directFileName = CreateTempDirFilename ("rem-direct.out");
+  RunScenario (false, eventFileName);
+  RunScenario (true, directFileName);
+
+  std::vector<double> eventValues = ReadValues (eventFileName);
+  std::vector<double> directValues = ReadValues (directFileName);
+  NS_TEST_ASSERT_MSG_EQ (eventValues.size (), 31 * 29 * 4, "wrong number of values in the REM");
+  NS_TEST_ASSERT_MSG_EQ (directValues.size (), eventValues.size (), "wrong number of values with direct evaluation");
+  for (uint32_t i = 0; i < eventValues.size (); ++i)
+    {
+      // the files have 6 significant digits
+      NS_TEST_ASSERT_MSG_EQ_TOL (directValues.at (i), eventValues.at (i), std::abs (eventValues.at (i)) * 1e-5,
+                                 "wrong value " << i << " of the REM with direct evaluation");
+    }
+}
+
+
+/**
+ * \ingroup lte
+ *
+ * RadioEnvironmentMapHelper test suite
+ */
+class LteRadioEnvironmentMapTestSuite : public TestSuite
+{
+public:
+  LteRadioEnvironmentMapTestSuite ();
+};
+
+LteRadioEnvironmentMapTestSuite::LteRadioEnvironmentMapTestSuite ()
+  : TestSuite ("lte-radio-environment-map", SYSTEM)
+{
+  AddTestCase (new LteRadioEnvironmentMapTestCase (false, -1), TestCase::QUICK);
+  AddTestCase (new LteRadioEnvironmentMapTestCase (true, -1), TestCase::QUICK);
+  AddTestCase (new LteRadioEnvironmentMapTestCase (true, 10), TestCase::QUICK);
+}
+
+static LteRadioEnvironmentMapTestSuite g_lteRadioEnvironmentMapTestSuite;
@@ -30,6 +30,8 @@
 #include "ns3/lte-rrc-header.h"
 #include "ns3/lte-rrc-sap.h"
 
+#include <ctime>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("Asn1EncodingTest");
@@ -1020,6 +1022,89 @@ MeasurementReportTestCase::DoRun (void)
   packet = 0;
 }
 
+// --------------------------- CLASS Asn1RoundTripTimeTestCase -----------------------------
+/**
+ * Measure the time to serialize and deserialize the common RRC messages
+ */
+class Asn1RoundTripTimeTestCase : public RrcHeaderTestCase
+{
+public:
+  Asn1RoundTripTimeTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Serialize a message in a packet and deserialize it, repeatedly
+   * \param msg the message
+   * \param name the name of the message
+   */
+  template <class H, class M>
+  void TimeRoundTrip (M msg, std::string name);
+};
+
+Asn1RoundTripTimeTestCase::Asn1RoundTripTimeTestCase ()
+  : RrcHeaderTestCase ("Measure the round trip time of the RRC messages")
+{
+}
+
+template <class H, class M>
+void
+Asn1RoundTripTimeTestCase::TimeRoundTrip (M msg, std::string name)
+{
+  const uint32_t iterations = 20000;
+  uint32_t size = 0;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      packet = Create<Packet> ();
+      H source;
+      source.SetMessage (msg);
+      packet->AddHeader (source);
+      H destination;
+      packet->RemoveHeader (destination);
+      size = destination.GetSerializedSize ();
+    }
+  clock_t stop = clock ();
+  packet = 0;
+  NS_TEST_ASSERT_MSG_GT (size, 0, "Empty " << name);
+
+  std::cout << "ASN.1 round trip time: " << name << " (" << size << " bytes): "
+            << 1e6 * (stop - start) / CLOCKS_PER_SEC / iterations << " us"
+            << std::endl;
+}
+
+void
+Asn1RoundTripTimeTestCase::DoRun (void)
+{
+  LteRrcSap::RrcConnectionRequest request;
+  request.ueIdentity = 0x83fecafecaULL;
+  TimeRoundTrip<RrcConnectionRequestHeader> (request, "RrcConnectionRequest");
+
+  LteRrcSap::RrcConnectionSetup setup;
+  setup.rrcTransactionIdentifier = 3;
+  setup.radioResourceConfigDedicated = CreateRadioResourceConfigDedicated ();
+  TimeRoundTrip<RrcConnectionSetupHeader> (setup, "RrcConnectionSetup");
+
+  LteRrcSap::MeasurementReport report;
+  report.measResults.measId = 5;
+  report.measResults.rsrpResult = 18;
+  report.measResults.rsrqResult = 21;
+  report.measResults.haveMeasResultNeighCells = true;
+  LteRrcSap::MeasResultEutra mResEutra;
+  mResEutra.physCellId = 9;
+  mResEutra.haveRsrpResult = true;
+  mResEutra.rsrpResult = 33;
+  mResEutra.haveRsrqResult = true;
+  mResEutra.rsrqResult = 22;
+  mResEutra.haveCgiInfo = false;
+  for (uint16_t i = 0; i < 4; i++)
+    {
+      mResEutra.physCellId = i + 1;
+      report.measResults.measResultListEutra.push_back (mResEutra);
+    }
+  TimeRoundTrip<MeasurementReportHeader> (report, "MeasurementReport");
+}
+
 // --------------------------- CLASS Asn1EncodingSuite -----------------------------
 class Asn1EncodingSuite : public TestSuite
 {
@@ -1046,3 +1131,18 @@ Asn1EncodingSuite::Asn1EncodingSuite ()
 
 Asn1EncodingSuite asn1EncodingSuite;
 
+// --------------------------- CLASS Asn1EncodingPerformanceSuite -----------------------------
+class Asn1EncodingPerformanceSuite : public TestSuite
+{
+public:
+  Asn1EncodingPerformanceSuite ();
+};
+
+Asn1EncodingPerformanceSuite::Asn1EncodingPerformanceSuite ()
+  : TestSuite ("test-asn1-encoding-perf", PERFORMANCE)
+{
+  NS_LOG_FUNCTION (this);
+  AddTestCase (new Asn1RoundTripTimeTestCase (), TestCase::QUICK);
+}
+
+Asn1EncodingPerformanceSuite asn1EncodingPerformanceSuite;
@@ -0,0 +1,483 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "topology-partitioner.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TopologyPartitioner");
+
+/** Coarsening stops when the graph has less vertices per partition. */
+static const uint32_t COARSEST_VERTICES_PER_PARTITION = 16;
+/** Coarsening stops when a level merges less than this fraction of vertices. */
+static const double MIN_COARSENING = 0.05;
+/** Maximum number of refinement passes at each level. */
+static const uint32_t REFINEMENT_PASSES = 8;
+
+/**
+ * Order vertices by decreasing weight, then by index.
+ */
+class HeavierVertex
+{
+public:
+  /**
+   * \param weights the vertex weights
+   */
+  HeavierVertex (const std::vector<double> &weights)
+    : m_weights (weights)
+  {
+  }
+  /**
+   * \param a a vertex
+   * \param b another vertex
+   * \returns true if \p a is heavier than \p b
+   */
+  bool operator () (uint32_t a, uint32_t b) const
+  {
+    if (m_weights[a] != m_weights[b])
+      {
+        return m_weights[a] > m_weights[b];
+      }
+    return a < b;
+  }
+private:
+  const std::vector<double> &m_weights; //!< The vertex weights.
+};
+
+TopologyPartitioner::TopologyPartitioner ()
+  : m_imbalance (0.05),
+    m_deviceLoad (1),
+    m_nPartitions (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TopologyPartitioner::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  NS_ASSERT (imbalance >= 0);
+  m_imbalance = imbalance;
+}
+
+void
+TopologyPartitioner::SetDeviceLoad (double load)
+{
+  NS_LOG_FUNCTION (this << load);
+  m_deviceLoad = load;
+}
+
+void
+TopologyPartitioner::AddNodeLoad (uint32_t node, double load)
+{
+  NS_LOG_FUNCTION (this << node << load);
+  m_nodeLoads[node] += load;
+}
+
+void
+TopologyPartitioner::AddFlow (uint32_t source, uint32_t destination, double rate)
+{
+  NS_LOG_FUNCTION (this << source << destination << rate);
+  m_nodeLoads[source] += rate;
+  m_nodeLoads[destination] += rate;
+}
+
+void
+TopologyPartitioner::SetLinkRate (uint32_t a, uint32_t b, double rate)
+{
+  NS_LOG_FUNCTION (this << a << b << rate);
+  m_linkRates[std::make_pair (std::min (a, b), std::max (a, b))] = rate;
+}
+
+void
+TopologyPartitioner::Partition (NodeContainer nodes, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ABORT_MSG_IF (n == 0, "At least one partition is needed");
+  m_nPartitions = n;
+
+  // build the graph of the nodes
+  std::map<uint32_t, uint32_t> vertices;
+  m_nodes.clear ();
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      vertices[(*i)->GetId ()] = m_nodes.size ();
+      m_nodes.push_back ((*i)->GetId ());
+    }
+  m_graph.weights.assign (m_nodes.size (), 0);
+  std::vector<std::map<uint32_t, double> > edges (m_nodes.size ());
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      uint32_t v = vertices[node->GetId ()];
+      m_graph.weights[v] = 1 + m_deviceLoad * node->GetNDevices ();
+      std::map<uint32_t, double>::const_iterator load = m_nodeLoads.find (node->GetId ());
+      if (load != m_nodeLoads.end ())
+        {
+          m_graph.weights[v] += load->second;
+        }
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<Channel> channel = node->GetDevice (j)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              Ptr<NetDevice> device = channel->GetDevice (k);
+              if (device == 0 || device->GetNode () == 0)
+                {
+                  continue;
+                }
+              std::map<uint32_t, uint32_t>::const_iterator u = vertices.find (device->GetNode ()->GetId ());
+              if (u == vertices.end () || u->second == v)
+                {
+                  continue;
+                }
+              uint32_t a = std::min (node->GetId (), device->GetNode ()->GetId ());
+              uint32_t b = std::max (node->GetId (), device->GetNode ()->GetId ());
+              std::map<std::pair<uint32_t, uint32_t>, double>::const_iterator rate =
+                m_linkRates.find (std::make_pair (a, b));
+              // several channels between the same nodes do not add up
+              edges[v][u->second] = rate != m_linkRates.end () ? rate->second : 1;
+            }
+        }
+    }
+  m_graph.edges.assign (m_nodes.size (), std::vector<std::pair<uint32_t, double> > ());
+  for (uint32_t v = 0; v < m_nodes.size (); v++)
+    {
+      m_graph.edges[v].assign (edges[v].begin (), edges[v].end ());
+    }
+
+  double total = 0;
+  for (uint32_t v = 0; v < m_graph.weights.size (); v++)
+    {
+      total += m_graph.weights[v];
+    }
+  double maxWeight = total / n * (1 + m_imbalance);
+
+  // coarsen
+  std::vector<Graph> graphs;
+  std::vector<std::vector<uint32_t> > maps;
+  graphs.push_back (m_graph);
+  while (graphs.back ().weights.size () > COARSEST_VERTICES_PER_PARTITION * n)
+    {
+      Graph coarse;
+      std::vector<uint32_t> map;
+      // merged vertices must still fit in a partition
+      Coarsen (graphs.back (), coarse, map, maxWeight / 2);
+      uint32_t size = graphs.back ().weights.size ();
+      if (coarse.weights.size () > size * (1 - MIN_COARSENING))
+        {
+          break;
+        }
+      NS_LOG_LOGIC ("coarsened " << size << " vertices to " << coarse.weights.size ());
+      graphs.push_back (coarse);
+      maps.push_back (map);
+    }
+
+  // partition the coarsest graph, then project and refine
+  std::vector<uint32_t> partition = InitialPartition (graphs.back (), n, maxWeight);
+  Refine (graphs.back (), n, maxWeight, partition);
+  for (uint32_t level = maps.size (); level > 0; level--)
+    {
+      const std::vector<uint32_t> &map = maps[level - 1];
+      std::vector<uint32_t> finer (map.size ());
+      for (uint32_t v = 0; v < map.size (); v++)
+        {
+          finer[v] = partition[map[v]];
+        }
+      partition.swap (finer);
+      Refine (graphs[level - 1], n, maxWeight, partition);
+    }
+
+  m_partitions.clear ();
+  m_assignment = partition;
+  for (uint32_t v = 0; v < m_nodes.size (); v++)
+    {
+      m_partitions[m_nodes[v]] = partition[v];
+    }
+  NS_LOG_INFO ("cross-partition rate " << GetCrossPartitionRate ());
+}
+
+void
+TopologyPartitioner::Coarsen (const Graph &graph, Graph &coarse, std::vector<uint32_t> &map,
+                              double maxWeight)
+{
+  uint32_t size = graph.weights.size ();
+  const uint32_t unmatched = 0xffffffff;
+  map.assign (size, unmatched);
+  std::vector<uint32_t> order;
+  for (uint32_t v = 0; v < size; v++)
+    {
+      order.push_back (v);
+    }
+  // match the lightest vertices first, they merge more easily
+  std::sort (order.begin (), order.end (), HeavierVertex (graph.weights));
+  std::reverse (order.begin (), order.end ());
+  uint32_t next = 0;
+  for (std::vector<uint32_t>::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      uint32_t v = *i;
+      if (map[v] != unmatched)
+        {
+          continue;
+        }
+      uint32_t best = unmatched;
+      double bestWeight = 0;
+      for (std::vector<std::pair<uint32_t, double> >::const_iterator e = graph.edges[v].begin ();
+           e != graph.edges[v].end (); ++e)
+        {
+          if (map[e->first] == unmatched && e->second > bestWeight
+              && graph.weights[v] + graph.weights[e->first] <= maxWeight)
+            {
+              best = e->first;
+              bestWeight = e->second;
+            }
+        }
+      map[v] = next;
+      if (best != unmatched)
+        {
+          map[best] = next;
+        }
+      next++;
+    }
+
+  coarse.weights.assign (next, 0);
+  std::vector<std::map<uint32_t, double> > edges (next);
+  for (uint32_t v = 0; v < size; v++)
+    {
+      coarse.weights[map[v]] += graph.weights[v];
+      for (std::vector<std::pair<uint32_t, double> >::const_iterator e = graph.edges[v].begin ();
+           e != graph.edges[v].end (); ++e)
+        {
+          if (map[e->first] != map[v])
+            {
+              edges[map[v]][map[e->first]] += e->second;
+            }
+        }
+    }
+  coarse.edges.assign (next, std::vector<std::pair<uint32_t, double> > ());
+  for (uint32_t v = 0; v < next; v++)
+    {
+      coarse.edges[v].assign (edges[v].begin (), edges[v].end ());
+    }
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::InitialPartition (const Graph &graph, uint32_t n, double maxWeight)
+{
+  uint32_t size = graph.weights.size ();
+  const uint32_t unassigned = 0xffffffff;
+  std::vector<uint32_t> partition (size, unassigned);
+  std::vector<double> loads (n, 0);
+  std::vector<uint32_t> order;
+  for (uint32_t v = 0; v < size; v++)
+    {
+      order.push_back (v);
+    }
+  std::sort (order.begin (), order.end (), HeavierVertex (graph.weights));
+  for (std::vector<uint32_t>::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      uint32_t v = *i;
+      std::vector<double> connection (n, 0);
+      for (std::vector<std::pair<uint32_t, double> >::const_iterator e = graph.edges[v].begin ();
+           e != graph.edges[v].end (); ++e)
+        {
+          if (partition[e->first] != unassigned)
+            {
+              connection[partition[e->first]] += e->second;
+            }
+        }
+      // the most connected partition with room left, else the lightest
+      uint32_t best = 0;
+      bool fits = false;
+      for (uint32_t p = 0; p < n; p++)
+        {
+          bool pFits = loads[p] + graph.weights[v] <= maxWeight;
+          if ((pFits && !fits)
+              || (pFits == fits
+                  && (connection[p] > connection[best]
+                      || (connection[p] == connection[best] && loads[p] < loads[best]))))
+            {
+              best = p;
+              fits = pFits;
+            }
+        }
+      partition[v] = best;
+      loads[best] += graph.weights[v];
+    }
+  return partition;
+}
+
+void
+TopologyPartitioner::Refine (const Graph &graph, uint32_t n, double maxWeight,
+                             std::vector<uint32_t> &partition)
+{
+  uint32_t size = graph.weights.size ();
+  std::vector<double> loads (n, 0);
+  for (uint32_t v = 0; v < size; v++)
+    {
+      loads[partition[v]] += graph.weights[v];
+    }
+  for (uint32_t pass = 0; pass < REFINEMENT_PASSES; pass++)
+    {
+      uint32_t moves = 0;
+      for (uint32_t v = 0; v < size; v++)
+        {
+          uint32_t from = partition[v];
+          double weight = graph.weights[v];
+          std::vector<double> connection (n, 0);
+          for (std::vector<std::pair<uint32_t, double> >::const_iterator e = graph.edges[v].begin ();
+               e != graph.edges[v].end (); ++e)
+            {
+              connection[partition[e->first]] += e->second;
+            }
+          bool overloaded = loads[from] > maxWeight;
+          uint32_t best = from;
+          double bestGain = 0;
+          for (uint32_t p = 0; p < n; p++)
+            {
+              if (p == from || loads[p] + weight > maxWeight)
+                {
+                  continue;
+                }
+              // an overloaded partition gives vertices away even at
+              // a loss, otherwise moves must reduce the cut, or keep it
+              // and improve the balance
+              double gain = connection[p] - connection[from];
+              bool better;
+              if (best == from)
+                {
+                  better = overloaded || gain > 0
+                    || (gain == 0 && connection[p] > 0 && loads[p] + weight < loads[from]);
+                }
+              else
+                {
+                  better = gain > bestGain || (gain == bestGain && loads[p] < loads[best]);
+                }
+              if (better)
+                {
+                  best = p;
+                  bestGain = gain;
+                }
+            }
+          if (best != from)
+            {
+              partition[v] = best;
+              loads[from] -= weight;
+              loads[best] += weight;
+              moves++;
+            }
+        }
+      if (moves == 0)
+        {
+          break;
+        }
+    }
+}
+
+uint32_t
+TopologyPartitioner::GetPartition (uint32_t node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator i = m_partitions.find (node);
+  return i != m_partitions.end () ? i->second : 0;
+}
+
+std::vector<double>
+TopologyPartitioner::GetPartitionLoads (void) const
+{
+  std::vector<double> loads (m_nPartitions, 0);
+  for (uint32_t v = 0; v < m_assignment.size (); v++)
+    {
+      loads[m_assignment[v]] += m_graph.weights[v];
+    }
+  return loads;
+}
+
+double
+TopologyPartitioner::GetCrossPartitionRate (void) const
+{
+  double rate = 0;
+  for (uint32_t v = 0; v < m_assignment.size (); v++)
+    {
+      for (std::vector<std::pair<uint32_t, double> >::const_iterator e = m_graph.edges[v].begin ();
+           e != m_graph.edges[v].end (); ++e)
+        {
+          if (v < e->first && m_assignment[v] != m_assignment[e->first])
+            {
+              rate += e->second;
+            }
+        }
+    }
+  return rate;
+}
+
+void
+TopologyPartitioner::Report (std::ostream &os) const
+{
+  std::vector<double> loads = GetPartitionLoads ();
+  std::vector<uint32_t> sizes (m_nPartitions, 0);
+  std::map<std::pair<uint32_t, uint32_t>, double> rates;
+  for (uint32_t v = 0; v < m_assignment.size (); v++)
+    {
+      sizes[m_assignment[v]]++;
+      for (std::vector<std::pair<uint32_t, double> >::const_iterator e = m_graph.edges[v].begin ();
+           e != m_graph.edges[v].end (); ++e)
+        {
+          uint32_t a = m_assignment[v];
+          uint32_t b = m_assignment[e->first];
+          if (v < e->first && a != b)
+            {
+              rates[std::make_pair (std::min (a, b), std::max (a, b))] += e->second;
+            }
+        }
+    }
+  for (uint32_t p = 0; p < m_nPartitions; p++)
+    {
+      os << "partition " << p << ": " << sizes[p] << " nodes, load " << loads[p] << std::endl;
+    }
+  for (std::map<std::pair<uint32_t, uint32_t>, double>::const_iterator i = rates.begin ();
+       i != rates.end (); ++i)
+    {
+      os << "partitions " << i->first.first << "-" << i->first.second
+         << ": cross-partition rate " << i->second << std::endl;
+    }
+  os << "total cross-partition rate " << GetCrossPartitionRate () << std::endl;
+}
+
+void
+TopologyPartitioner::Write (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ofstream os (fileName.c_str ());
+  NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot open " << fileName);
+  for (std::map<uint32_t, uint32_t>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      os << i->first << " " << i->second << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TOPOLOGY_PARTITIONER_H
+#define TOPOLOGY_PARTITIONER_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include "ns3/node-container.h"
+
+namespace ns3 {
+
+/**
+ * \brief Assign the nodes of a topology to the partitions of a parallel
+ * simulation.
+ *
+ * The partitioner builds a graph with a vertex per node, and an edge
+ * between the nodes whose devices share a channel.  Vertices are
+ * weighted by the expected event load of the node, edges by the
+ * expected rate of events across the link.  It then looks for an
+ * assignment of the nodes to the partitions which balances the load of
+ * the partitions and minimizes the weight of the edges between
+ * partitions, i.e., the synchronization between them, with a multilevel
+ * algorithm in the style of METIS: the graph is coarsened by merging
+ * the vertices of the heaviest edges, the coarsest graph is partitioned
+ * greedily, and the partition is projected back and refined at each
+ * level by moving boundary vertices.
+ *
+ * The load of a node is, by default, one plus the number of its
+ * devices.  AddNodeLoad() and AddFlow() add the load of the
+ * applications, and SetLinkRate() sets the event rate of a link, one by
+ * default.  Since the routes are not known, a flow only loads its
+ * endpoints.
+ *
+ * The assignment can be applied to a MultithreadedSimulatorImpl:
+ * \code
+ *   TopologyPartitioner partitioner;
+ *   partitioner.Partition (NodeContainer::GetGlobal (), impl->GetNPartitions ());
+ *   for (uint32_t i = 0; i < NodeList::GetNNodes (); i++)
+ *     {
+ *       impl->SetPartition (i, partitioner.GetPartition (i));
+ *     }
+ * \endcode
+ * The system ids of the MPI simulators must instead be known when the
+ * nodes are created: Write() saves the assignment, so that a run of the
+ * script can read it back to create each node with its system id.
+ */
+class TopologyPartitioner
+{
+public:
+  TopologyPartitioner ();
+
+  /**
+   * \param imbalance the tolerated load imbalance, e.g., 0.05 allows
+   * the partitions to be 5% over the average load.  The default is 0.05.
+   */
+  void SetImbalance (double imbalance);
+  /**
+   * \param load the load of each device, 1 by default.
+   */
+  void SetDeviceLoad (double load);
+  /**
+   * Add to the expected event load of a node.
+   * \param node the node id
+   * \param load the additional load, in events per second
+   */
+  void AddNodeLoad (uint32_t node, double load);
+  /**
+   * Add the load of a flow to its endpoints.
+   * \param source the id of the source node
+   * \param destination the id of the destination node
+   * \param rate the rate of the flow, in packets per second
+   */
+  void AddFlow (uint32_t source, uint32_t destination, double rate);
+  /**
+   * Set the expected rate of events between two neighbor nodes.
+   * \param a the id of a node
+   * \param b the id of the other node
+   * \param rate the rate of events, in either direction
+   */
+  void SetLinkRate (uint32_t a, uint32_t b, double rate);
+
+  /**
+   * Compute the assignment of the nodes.
+   * \param nodes the nodes to assign; the channels to other nodes are ignored
+   * \param n the number of partitions
+   */
+  void Partition (NodeContainer nodes, uint32_t n);
+
+  /**
+   * \param node a node id
+   * \returns the partition of the node, zero if it was not partitioned
+   */
+  uint32_t GetPartition (uint32_t node) const;
+  /**
+   * \returns the load of each partition
+   */
+  std::vector<double> GetPartitionLoads (void) const;
+  /**
+   * \returns the total rate of events between the partitions
+   */
+  double GetCrossPartitionRate (void) const;
+  /**
+   * Print the load of each partition, and the rate of events between
+   * each pair of partitions.
+   * \param os the output stream
+   */
+  void Report (std::ostream &os) const;
+  /**
+   * Write the assignment, a line "node partition" per node.
+   * \param fileName the file name
+   */
+  void Write (std::string fileName) const;
+
+private:
+  /** A weighted, undirected graph. */
+  struct Graph
+  {
+    std::vector<double> weights;                            //!< Vertex weights.
+    std::vector<std::vector<std::pair<uint32_t, double> > > edges; //!< Neighbors of each vertex.
+  };
+
+  /**
+   * Merge the vertices matched along their heaviest edge.
+   * \param graph the graph to coarsen
+   * \param coarse the coarser graph
+   * \param map the vertex of the coarser graph of each vertex
+   * \param maxWeight the maximum weight of a merged vertex
+   */
+  static void Coarsen (const Graph &graph, Graph &coarse, std::vector<uint32_t> &map,
+                       double maxWeight);
+  /**
+   * Assign the vertices greedily, heaviest first, to the partition they
+   * are most connected to among those with room left.
+   * \param graph the graph
+   * \param n the number of partitions
+   * \param maxWeight the maximum weight of a partition
+   * \returns the partition of each vertex
+   */
+  static std::vector<uint32_t> InitialPartition (const Graph &graph, uint32_t n, double maxWeight);
+  /**
+   * Move boundary vertices to reduce the cut weight and the imbalance.
+   * \param graph the graph
+   * \param n the number of partitions
+   * \param maxWeight the maximum weight of a partition
+   * \param partition the partition of each vertex, updated
+   */
+  static void Refine (const Graph &graph, uint32_t n, double maxWeight,
+                      std::vector<uint32_t> &partition);
+
+  double m_imbalance;   //!< Tolerated imbalance.
+  double m_deviceLoad;  //!< Load of a device.
+  std::map<uint32_t, double> m_nodeLoads;  //!< Additional node loads.
+  std::map<std::pair<uint32_t, uint32_t>, double> m_linkRates; //!< Link rates, by ordered node ids.
+  uint32_t m_nPartitions;                //!< Number of partitions.
+  std::vector<uint32_t> m_nodes;         //!< Id of each vertex.
+  std::map<uint32_t, uint32_t> m_partitions; //!< Partition of each node id.
+  std::vector<uint32_t> m_assignment;    //!< Partition of each vertex.
+  Graph m_graph;                         //!< The graph of the nodes.
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_PARTITIONER_H */
@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/async-trace-writer.h"
 
 #include "trace-helper.h"
 
@@ -56,7 +57,18 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
-  file->Open (filename, filemode);
+  //
+  // New files can be written from a background thread, if the user
+  // asked for it.  Files opened for reading or appending can not.
+  //
+  if (AsyncTraceWriter::IsEnabled () && (filemode & (std::ios::in | std::ios::app)) == 0)
+    {
+      file->OpenAsync (filename);
+    }
+  else
+    {
+      file->Open (filename, filemode);
+    }
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
   file->Init (dataLinkType, snapLen, tzCorrection);
@@ -192,7 +204,18 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
 {
   NS_LOG_FUNCTION (filename << filemode);
 
-  Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+  Ptr<OutputStreamWrapper> StreamWrapper;
+  if (AsyncTraceWriter::IsEnabled () && (filemode & std::ios::in) == 0)
+    {
+      AsyncTraceWriter *writer = new AsyncTraceWriter (filename, filemode);
+      NS_ABORT_MSG_UNLESS (writer->IsOpen (), "AsciiTraceHelper::CreateFileStream():  " <<
+                           "Unable to Open " << filename << " for mode " << filemode);
+      StreamWrapper = Create<OutputStreamWrapper> (writer);
+    }
+  else
+    {
+      StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+    }
 
   //
   // Note that the ascii trace helper promptly forgets all about the trace file.
@@ -310,14 +333,14 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 //
@@ -336,14 +359,14 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 //
@@ -363,14 +386,14 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 //
@@ -387,14 +410,14 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 void 
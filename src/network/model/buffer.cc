@@ -77,6 +77,7 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define UNINITIALIZED ((Buffer::FreeList*)0)
 uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList *Buffer::g_freeList = 0;
+bool Buffer::g_freeListEnabled = true;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
@@ -103,6 +104,7 @@ Buffer::Recycle (struct Buffer::Data *data)
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
+      !g_freeListEnabled ||
       IS_DESTROYED (g_freeList) ||
       g_freeList->size () > 1000)
     {
@@ -124,7 +126,7 @@ Buffer::Create (uint32_t dataSize)
     {
       g_freeList = new Buffer::FreeList ();
     }
-  else if (IS_INITIALIZED (g_freeList))
+  else if (IS_INITIALIZED (g_freeList) && g_freeListEnabled)
     {
       while (!g_freeList->empty ()) 
         {
@@ -142,7 +144,20 @@ Buffer::Create (uint32_t dataSize)
   NS_ASSERT (data->m_count == 1);
   return data;
 }
+
+void
+Buffer::EnableFreeList (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  g_freeListEnabled = enable;
+}
 #else /* BUFFER_FREE_LIST */
+
+void
+Buffer::EnableFreeList (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+}
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
@@ -555,6 +570,25 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  Buffer tmp (0, false);
+  tmp.m_data = Buffer::Create (m_data->m_size);
+  memcpy (tmp.m_data->m_data + m_start, m_data->m_data + m_start, GetInternalSize ());
+  tmp.m_data->m_dirtyStart = m_start;
+  tmp.m_data->m_dirtyEnd = m_end;
+  tmp.m_maxZeroAreaStart = m_maxZeroAreaStart;
+  tmp.m_zeroAreaStart = m_zeroAreaStart;
+  tmp.m_zeroAreaEnd = m_zeroAreaEnd;
+  tmp.m_start = m_start;
+  tmp.m_end = m_end;
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
@@ -617,6 +617,23 @@ private:
    */
   Buffer &operator = (Buffer const &o);
   Buffer ();
+  /**
+   * \brief Enable or disable the reuse of freed buffer data storage
+   *
+   * The free list is shared by all the threads, so it must be disabled
+   * while more than one thread creates or destroys buffers, e.g., when
+   * running the MultithreadedSimulatorImpl.  It is enabled by default.
+   *
+   * \param enable true to reuse freed data storage
+   */
+  static void EnableFreeList (bool enable);
+  /**
+   * \brief Create a copy of the buffer which does not share its
+   * data storage.
+   *
+   * \returns a copy of the buffer
+   */
+  Buffer CreateDeepCopy (void) const;
   /**
    * \brief Constructor
    *
@@ -794,6 +811,7 @@ private:
   };
   static uint32_t g_maxSize; //!< Max observed data size
   static FreeList *g_freeList; //!< Buffer data container
+  static bool g_freeListEnabled; //!< Reuse the buffer data containers
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
@@ -58,6 +58,7 @@ public:
   ~ByteTagListDataFreeList ();
 } g_freeList; //!< Container for struct ByteTagListData
 static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static bool g_freeListEnabled = true; //!< reuse the freed data
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -225,6 +226,24 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   return tag;
 }
 
+ByteTagList
+ByteTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList copy;
+  if (m_data != 0)
+    {
+      copy.m_data = copy.Allocate (m_data->size);
+      std::memcpy (&copy.m_data->data, &m_data->data, m_used);
+      copy.m_data->dirty = m_used;
+    }
+  copy.m_minStart = m_minStart;
+  copy.m_maxEnd = m_maxEnd;
+  copy.m_adjustment = m_adjustment;
+  copy.m_used = m_used;
+  return copy;
+}
+
 void 
 ByteTagList::Add (const ByteTagList &o)
 {
@@ -344,7 +363,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (g_freeListEnabled && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -378,7 +397,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (!g_freeListEnabled ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -391,8 +411,21 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     }
 }
 
+void
+ByteTagList::EnableFreeList (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  g_freeListEnabled = enable;
+}
+
 #else /* USE_FREE_LIST */
 
+void
+ByteTagList::EnableFreeList (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+}
+
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
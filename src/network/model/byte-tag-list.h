@@ -140,6 +140,17 @@ private:
   };
 
   ByteTagList ();
+
+  /**
+   * \brief Enable or disable the reuse of freed tag storage
+   *
+   * The free list is shared by all the threads, so it must be disabled
+   * while more than one thread creates or destroys byte tags, e.g., when
+   * running the MultithreadedSimulatorImpl.  It is enabled by default.
+   *
+   * \param enable true to reuse freed tag storage
+   */
+  static void EnableFreeList (bool enable);
   
   /**
    * 
@@ -188,6 +199,13 @@ private:
    */ 
   void RemoveAll (void);
 
+  /**
+   * \brief Create a copy of the tags which does not share their storage.
+   *
+   * \returns the copied tags
+   */
+  ByteTagList CreateDeepCopy (void) const;
+
   /**
    * \param offsetStart the offset which uniquely identifies the first data byte 
    *        present in the byte buffer associated to this ByteTagList.
@@ -19,6 +19,7 @@
 #include "channel.h"
 #include "channel-list.h"
 #include "net-device.h"
+#include "node.h"
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
@@ -29,6 +30,9 @@ NS_LOG_COMPONENT_DEFINE ("Channel");
 
 NS_OBJECT_ENSURE_REGISTERED (Channel);
 
+/** Whether the channels hand over deep copies of the packets. */
+static bool g_deepCopyEnabled = false;
+
 TypeId 
 Channel::GetTypeId (void)
 {
@@ -62,4 +66,57 @@ Channel::GetId (void) const
   return m_id;
 }
 
+Time
+Channel::GetMinimumDelay (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return Seconds (0);
+}
+
+Time
+Channel::GetMinimumDelayBetweenGroups (const std::vector<uint32_t> &groups) const
+{
+  NS_LOG_FUNCTION (this);
+  bool found = false;
+  uint32_t first = 0;
+  for (uint32_t i = 0; i < GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = GetDevice (i);
+      if (device == 0 || device->GetNode () == 0)
+        {
+          continue;
+        }
+      uint32_t group = groups.at (device->GetNode ()->GetId ());
+      if (!found)
+        {
+          found = true;
+          first = group;
+        }
+      else if (group != first)
+        {
+          return GetMinimumDelay ();
+        }
+    }
+  return Time::Max ();
+}
+
+void
+Channel::PrepareParallelRun (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Channel::EnableDeepCopy (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  g_deepCopyEnabled = enable;
+}
+
+bool
+Channel::IsDeepCopyEnabled (void)
+{
+  return g_deepCopyEnabled;
+}
+
 } // namespace ns3
@@ -18,9 +18,11 @@
 #define NS3_CHANNEL_H
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -39,6 +41,10 @@ class NetDevice;
  *
  * Subclasses must use Simulator::ScheduleWithContext to correctly update
  * event contexts when scheduling an event from one node to another one.
+ * When IsDeepCopyEnabled(), the receiving node may run on another
+ * thread: these events must then only hold deep copies of the packets,
+ * see Packet::CreateDeepCopy(), and raw pointers to the receiving
+ * devices, whose reference counts are not atomic.
  */
 class Channel : public Object
 {
@@ -74,6 +80,62 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const = 0;
 
+  /**
+   * \returns a lower bound of the delay between the time a NetDevice
+   * connected to this Channel starts a transmission and the time
+   * another NetDevice of the Channel is notified of it.
+   *
+   * Parallel simulators use this bound as the lookahead between nodes
+   * connected by this Channel.  The default, zero, is always safe;
+   * subclasses whose devices only interact through events delayed by
+   * at least a known propagation delay should return it.
+   */
+  virtual Time GetMinimumDelay (void) const;
+
+  /**
+   * \param groups the group of each node, indexed by node id
+   * \returns a lower bound of the delay between the time a NetDevice
+   * connected to this Channel starts a transmission and the time a
+   * device whose node is in another group is notified of it, or
+   * Time::Max () if all the nodes of the devices are in the same group.
+   * The devices without node are ignored.
+   *
+   * Parallel simulators use this bound as the lookahead between the
+   * groups of nodes they simulate in parallel.  The default returns
+   * GetMinimumDelay () if there are two groups; subclasses whose delay
+   * depends on the devices, e.g., on their distance, should refine it.
+   */
+  virtual Time GetMinimumDelayBetweenGroups (const std::vector<uint32_t> &groups) const;
+
+  /**
+   * \brief Prepare the channel for a run whose partitions transmit
+   * concurrently.
+   *
+   * Parallel simulators call it on the main thread, once the topology
+   * is final and before their threads start.  Subclasses which need
+   * more than a raw pointer to the receiving devices while
+   * IsDeepCopyEnabled(), e.g., their node or their mobility model,
+   * should look it up here rather than from the transmitting thread.
+   * The default does nothing.
+   */
+  virtual void PrepareParallelRun (void);
+
+  /**
+   * \brief Enable or disable the deep copy of the packets handed over
+   * by the channels to other nodes.
+   *
+   * The MultithreadedSimulatorImpl enables it while its threads run.
+   * It is disabled by default.
+   *
+   * \param enable true to hand over deep copies
+   */
+  static void EnableDeepCopy (bool enable);
+  /**
+   * \returns true if the channels must hand over deep copies of the
+   * packets to other nodes.
+   */
+  static bool IsDeepCopyEnabled (void);
+
 private:
   uint32_t m_id; //!< Channel id for this channel
 };
@@ -159,6 +159,16 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable or disable the reuse of freed metadata storage
+   *
+   * The free list is shared by all the threads, so it must be disabled
+   * while more than one thread creates or destroys packets, e.g., when
+   * running the MultithreadedSimulatorImpl.  It is enabled by default.
+   *
+   * \param enable true to reuse freed metadata storage
+   */
+  static void EnableFreeList (bool enable);
 
   /**
    * \brief Constructor
@@ -216,6 +226,12 @@ private:
    * and then, RemoveAtEnd (end).
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
+  /**
+   * \brief Creates a copy which does not share the metadata storage.
+   *
+   * \return the copied metadata
+   */
+  PacketMetadata CreateDeepCopy (void) const;
 
   /**
    * \brief Add a metadata at the metadata start
@@ -659,6 +675,7 @@ public:
   static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_freeListEnabled; //!< Reuse the metadata data storage
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -284,5 +284,22 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+PacketTagList
+PacketTagList::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  struct TagData **prevNext = &copy.m_next;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *data = new struct TagData (*cur);
+      data->count = 1;
+      data->next = 0;
+      *prevNext = data;
+      prevNext = &data->next;
+    }
+  return copy;
+}
+
 } /* namespace ns3 */
 
@@ -237,6 +237,12 @@ public:
    * \returns pointer to head of tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * Create a copy of the list which shares no TagData with it.
+   *
+   * \returns the copied list
+   */
+  PacketTagList CreateDeepCopy (void) const;
 
 private:
   /**
@@ -127,6 +127,22 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::CreateDeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (m_buffer.CreateDeepCopy (),
+                                              m_byteTagList.CreateDeepCopy (),
+                                              m_packetTagList.CreateDeepCopy (),
+                                              m_metadata.CreateDeepCopy ()),
+                                  false);
+  if (m_nixVector)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -424,6 +424,20 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with the
+   * original packet.
+   *
+   * The reference counts of the datasets shared by Copy() are not
+   * atomic: a packet handed over to another thread, e.g., to a node of
+   * another partition of the MultithreadedSimulatorImpl, must be a
+   * deep copy.  The copy keeps the uid, the tags and the metadata of the
+   * packet.
+   */
+  Ptr<Packet> CreateDeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
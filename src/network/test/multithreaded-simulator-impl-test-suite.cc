@@ -0,0 +1,342 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/packet.h"
+#include "ns3/channel.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/system-thread.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \returns a MultithreadedSimulatorImpl with two partitions, installed
+ * as the simulator implementation.
+ */
+static Ptr<MultithreadedSimulatorImpl>
+SetMultithreadedImplementation (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("Threads", UintegerValue (2));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+  return impl;
+}
+
+class MultithreadedPingPongTestCase : public TestCase
+{
+public:
+  MultithreadedPingPongTestCase (Time delay);
+  virtual void DoRun (void);
+
+private:
+  void Send (uint32_t i);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from);
+
+  Time m_delay;
+  NetDeviceContainer m_devices;
+  /// The reception times, and contexts, of each node, only accessed
+  /// by the thread of its partition
+  std::vector<Time> m_rxTimes[2];
+  std::vector<uint32_t> m_rxContexts[2];
+};
+
+MultithreadedPingPongTestCase::MultithreadedPingPongTestCase (Time delay)
+  : TestCase (delay.IsZero () ? "Ping-pong between partitions without lookahead" :
+              "Ping-pong between partitions"),
+    m_delay (delay)
+{
+}
+
+void
+MultithreadedPingPongTestCase::Send (uint32_t i)
+{
+  m_devices.Get (i)->Send (Create<Packet> (100), m_devices.Get (1 - i)->GetAddress (), 0x800);
+}
+
+bool
+MultithreadedPingPongTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  uint32_t i = device == m_devices.Get (0) ? 0 : 1;
+  m_rxTimes[i].push_back (Simulator::Now ());
+  m_rxContexts[i].push_back (Simulator::GetContext ());
+  // node 1 answers every packet, node 0 stops after the tenth answer
+  if (i == 1 || m_rxTimes[i].size () < 10)
+    {
+      Send (i);
+    }
+  return true;
+}
+
+void
+MultithreadedPingPongTestCase::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = SetMultithreadedImplementation ();
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetChannelAttribute ("Delay", TimeValue (m_delay));
+  m_devices = helper.Install (nodes);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      impl->SetPartition (nodes.Get (i)->GetId (), i);
+      m_devices.Get (i)->SetReceiveCallback (MakeCallback (&MultithreadedPingPongTestCase::Receive, this));
+    }
+
+  Time start = Seconds (1);
+  Time step = m_delay.IsZero () ? Time (0) : m_delay;
+  Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), start,
+                                  &MultithreadedPingPongTestCase::Send, this, 0);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), m_delay, "Unexpected lookahead");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxTimes[i].size (), 10, "Unexpected number of packets received by node " << i);
+      for (uint32_t j = 0; j < 10; j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i][j], start + step * (2 * j + 2 - i),
+                                 "Unexpected reception time of packet " << j << " by node " << i);
+          NS_TEST_EXPECT_MSG_EQ (m_rxContexts[i][j], nodes.Get (i)->GetId (),
+                                 "Unexpected context of packet " << j << " received by node " << i);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), start + step * 20, "Unexpected time after Run");
+
+  Simulator::Destroy ();
+  m_devices = NetDeviceContainer ();
+}
+
+/**
+ * Both nodes send packets to each other at the same time, so that their
+ * partitions run concurrently in each window, and check the data and
+ * the tags of the packets received.  The packets received must not
+ * share their data with the packets sent by the other thread.
+ */
+class MultithreadedConcurrentTrafficTestCase : public TestCase
+{
+public:
+  MultithreadedConcurrentTrafficTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Send (uint32_t i, uint32_t seq);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from);
+
+  static const uint32_t N_PACKETS = 2000;  //!< packets sent by each node
+  static const uint32_t PAYLOAD_SIZE = 100; //!< payload of the packets
+
+  NetDeviceContainer m_devices;
+  /// The packets received, and the errors found, by each node, only
+  /// accessed by the thread of its partition
+  uint32_t m_rxPackets[2];
+  uint32_t m_rxErrors[2];
+  bool m_rxOnMainThread[2];
+  SystemThread::ThreadId m_mainThread; //!< the thread running DoRun
+};
+
+MultithreadedConcurrentTrafficTestCase::MultithreadedConcurrentTrafficTestCase ()
+  : TestCase ("Concurrent traffic between partitions")
+{
+}
+
+void
+MultithreadedConcurrentTrafficTestCase::Send (uint32_t i, uint32_t seq)
+{
+  uint8_t payload[PAYLOAD_SIZE];
+  for (uint32_t j = 0; j < PAYLOAD_SIZE; j++)
+    {
+      payload[j] = seq + j;
+    }
+  Ptr<Packet> packet = Create<Packet> (payload, PAYLOAD_SIZE);
+  packet->AddByteTag (FlowIdTag (seq));
+  packet->AddPacketTag (FlowIdTag (seq));
+  m_devices.Get (i)->Send (packet, m_devices.Get (1 - i)->GetAddress (), 0x800);
+  // the sender keeps modifying its own packet
+  packet->RemoveAtStart (PAYLOAD_SIZE / 2);
+  packet->RemoveAllPacketTags ();
+}
+
+bool
+MultithreadedConcurrentTrafficTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                                 uint16_t protocol, const Address &from)
+{
+  uint32_t i = device == m_devices.Get (0) ? 0 : 1;
+  uint32_t seq = m_rxPackets[i];
+  m_rxPackets[i]++;
+  m_rxOnMainThread[i] = SystemThread::Equals (m_mainThread);
+  FlowIdTag byteTag;
+  FlowIdTag packetTag;
+  if (packet->GetSize () != PAYLOAD_SIZE
+      || !packet->FindFirstMatchingByteTag (byteTag) || byteTag.GetFlowId () != seq
+      || !packet->PeekPacketTag (packetTag) || packetTag.GetFlowId () != seq)
+    {
+      m_rxErrors[i]++;
+      return true;
+    }
+  uint8_t payload[PAYLOAD_SIZE];
+  packet->CopyData (payload, PAYLOAD_SIZE);
+  for (uint32_t j = 0; j < PAYLOAD_SIZE; j++)
+    {
+      if (payload[j] != static_cast<uint8_t> (seq + j))
+        {
+          m_rxErrors[i]++;
+          break;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedConcurrentTrafficTestCase::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = SetMultithreadedImplementation ();
+  m_mainThread = SystemThread::Self ();
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  m_devices = helper.Install (nodes);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      impl->SetPartition (nodes.Get (i)->GetId (), i);
+      m_devices.Get (i)->SetReceiveCallback (MakeCallback (&MultithreadedConcurrentTrafficTestCase::Receive, this));
+      m_rxPackets[i] = 0;
+      m_rxErrors[i] = 0;
+      m_rxOnMainThread[i] = false;
+      // about a hundred packets per window
+      for (uint32_t seq = 0; seq < N_PACKETS; seq++)
+        {
+          Simulator::ScheduleWithContext (nodes.Get (i)->GetId (), MicroSeconds (10 * seq),
+                                          &MultithreadedConcurrentTrafficTestCase::Send, this, i, seq);
+        }
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MilliSeconds (1), "Unexpected lookahead");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxPackets[i], N_PACKETS, "Unexpected number of packets received by node " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_rxErrors[i], 0, "Corrupted packets received by node " << i);
+    }
+  // the main thread runs partition 0, and a worker thread partition 1
+  NS_TEST_EXPECT_MSG_EQ (m_rxOnMainThread[0], true, "Partition 0 did not run on the main thread");
+  NS_TEST_EXPECT_MSG_EQ (m_rxOnMainThread[1], false, "Partition 1 did not run on its own thread");
+  NS_TEST_EXPECT_MSG_EQ (Channel::IsDeepCopyEnabled (), false, "Deep copies still enabled after Run");
+
+  Simulator::Destroy ();
+  m_devices = NetDeviceContainer ();
+}
+
+class MultithreadedGlobalEventsTestCase : public TestCase
+{
+public:
+  MultithreadedGlobalEventsTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Event (uint32_t id);
+
+  /// The events which ran, in order; the test nodes are in separate
+  /// partitions without channel, so their events run alone
+  std::vector<uint32_t> m_events;
+};
+
+MultithreadedGlobalEventsTestCase::MultithreadedGlobalEventsTestCase ()
+  : TestCase ("Events without context and Stop")
+{
+}
+
+void
+MultithreadedGlobalEventsTestCase::Event (uint32_t id)
+{
+  m_events.push_back (id);
+}
+
+void
+MultithreadedGlobalEventsTestCase::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = SetMultithreadedImplementation ();
+  Ptr<Node> node = CreateObject<Node> ();
+  impl->SetPartition (node->GetId (), 1);
+
+  // event 1 runs in partition 1 before the event without context 2,
+  // which runs before event 3 at the same time; event 4 is removed
+  // and event 6 is after the end of the simulation
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (1),
+                                  &MultithreadedGlobalEventsTestCase::Event, this, 1);
+  Simulator::Schedule (Seconds (2), &MultithreadedGlobalEventsTestCase::Event, this, 2);
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (2),
+                                  &MultithreadedGlobalEventsTestCase::Event, this, 3);
+  EventId removed = Simulator::Schedule (Seconds (3), &MultithreadedGlobalEventsTestCase::Event, this, 4);
+  Simulator::Schedule (Seconds (4), &MultithreadedGlobalEventsTestCase::Event, this, 5);
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (6),
+                                  &MultithreadedGlobalEventsTestCase::Event, this, 6);
+  Simulator::Remove (removed);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (removed), true, "The removed event should be expired");
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), impl->GetMaximumSimulationTime (),
+                         "Unexpected lookahead without channel");
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), 4, "Unexpected number of events");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_events[i], i + 1, "Unexpected event " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_events[3], 5, "Unexpected last event");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (5), "Unexpected time after Stop");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), true, "Unexpected state after Stop");
+
+  // the simulation resumes where it stopped
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), 5, "Unexpected number of events after resuming");
+  NS_TEST_EXPECT_MSG_EQ (m_events[4], 6, "Unexpected event after resuming");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (6), "Unexpected time after resuming");
+
+  Simulator::Destroy ();
+}
+
+class MultithreadedSimulatorImplTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorImplTestSuite ();
+};
+
+MultithreadedSimulatorImplTestSuite::MultithreadedSimulatorImplTestSuite ()
+  : TestSuite ("multithreaded-simulator-impl", UNIT)
+{
+  AddTestCase (new MultithreadedPingPongTestCase (MilliSeconds (10)), TestCase::QUICK);
+  AddTestCase (new MultithreadedPingPongTestCase (Seconds (0)), TestCase::QUICK);
+  AddTestCase (new MultithreadedConcurrentTrafficTestCase (), TestCase::QUICK);
+  AddTestCase (new MultithreadedGlobalEventsTestCase (), TestCase::QUICK);
+}
+
+static MultithreadedSimulatorImplTestSuite g_multithreadedSimulatorImplTestSuite;
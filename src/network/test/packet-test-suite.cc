@@ -582,6 +582,38 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test CreateDeepCopy: the copy keeps the data, the tags and the
+   * uid, and behaves like an independent packet.
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello world"), 11);
+    tmp->AddByteTag (ATestTag<30> ());
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddPacketTag (ATestTag<15> ());
+    Ptr<Packet> deep = tmp->CreateDeepCopy ();
+    NS_TEST_EXPECT_MSG_EQ (deep->GetUid (), tmp->GetUid (), "Deep copy with another uid");
+    NS_TEST_EXPECT_MSG_EQ (deep->GetSize (), 21, "Wrong size of the deep copy");
+    CHECK (deep, 1, E (30, 10, 21));
+    ATestTag<15> tag;
+    NS_TEST_EXPECT_MSG_EQ (deep->PeekPacketTag (tag), true, "Packet tag not copied");
+
+    ATestHeader<10> h;
+    deep->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_error, false, "Wrong header in the deep copy");
+    deep->RemovePacketTag (tag);
+    deep->AddAtEnd (Create<Packet> (reinterpret_cast<const uint8_t*> ("!"), 1));
+    tmp->AddByteTag (ATestTag<32> ());
+    CHECK (tmp, 2, E (30, 10, 21), E (32, 0, 21));
+    CHECK (deep, 1, E (30, 0, 11));
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (tag), true, "Packet tag removed from the original");
+
+    uint8_t buf[12];
+    deep->CopyData (buf, 12);
+    std::string data (reinterpret_cast<const char *> (buf), 12);
+    NS_TEST_EXPECT_MSG_EQ (data, "hello world!", "Wrong data in the deep copy");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 21, "Original packet modified");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
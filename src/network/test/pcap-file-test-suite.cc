@@ -20,11 +20,15 @@
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
+#include <fstream>
+#include <vector>
 #include <cstring>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/async-trace-writer.h"
+#include "ns3/system-wall-clock-ms.h"
 
 using namespace ns3;
 
@@ -1121,6 +1125,280 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that files written from a background thread have
+// the same contents as files written directly.
+// ===========================================================================
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::OpenAsync writes the same file as PcapFile::Open")
+{
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  //
+  // Write the known packets in a file opened with Open and in a file
+  // opened with OpenAsync, and check that the files are identical.
+  //
+  std::string filenames[2];
+  filenames[0] = CreateTempDirFilename ("sync.pcap");
+  filenames[1] = CreateTempDirFilename ("async.pcap");
+  for (uint32_t j = 0; j < 2; ++j)
+    {
+      PcapFile f;
+      if (j == 0)
+        {
+          f.Open (filenames[j], std::ios::out);
+        }
+      else
+        {
+          f.OpenAsync (filenames[j]);
+        }
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filenames[j] << ") returns error");
+      f.Init (1, N_PACKET_BYTES);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Init (1, " << N_PACKET_BYTES << ") returns error");
+
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          PacketEntry const & p = knownPackets[i];
+
+          f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+          NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+        }
+      f.Close ();
+    }
+
+  FILE *p0 = std::fopen (filenames[0].c_str (), "rb");
+  FILE *p1 = std::fopen (filenames[1].c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (p0, 0, "Open did not create " << filenames[0]);
+  NS_TEST_ASSERT_MSG_NE (p1, 0, "OpenAsync did not create " << filenames[1]);
+  bool identical = true;
+  uint32_t length = 0;
+  while (true)
+    {
+      int c0 = std::fgetc (p0);
+      int c1 = std::fgetc (p1);
+      if (c0 != c1)
+        {
+          identical = false;
+          break;
+        }
+      if (c0 == EOF)
+        {
+          break;
+        }
+      ++length;
+    }
+  std::fclose (p0);
+  std::fclose (p1);
+  remove (filenames[0].c_str ());
+  remove (filenames[1].c_str ());
+  NS_TEST_EXPECT_MSG_EQ (identical, true, "File written with OpenAsync differs from file written with Open");
+  NS_TEST_EXPECT_MSG_GT (length, 24, "File written with OpenAsync has no records");
+
+  //
+  // Write through blocks much smaller than the data, so that many blocks
+  // are queued for the writer thread, and check the file byte for byte.
+  //
+  std::string filename3 = CreateTempDirFilename ("async.txt");
+  const uint32_t n = 100000;
+  {
+    AsyncTraceWriter writer (filename3, std::ios::out, 64);
+    NS_TEST_ASSERT_MSG_EQ (writer.IsOpen (), true, "AsyncTraceWriter (" << filename3 << ") not open");
+    std::ostream os (&writer);
+    for (uint32_t i = 0; i < n; ++i)
+      {
+        os << (char)('a' + i % 26);
+        if (i % 1000 == 0)
+          {
+            os << std::endl;
+          }
+      }
+    NS_TEST_EXPECT_MSG_EQ (os.fail (), false, "Write must not fail");
+  }
+  FILE *p = std::fopen (filename3.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (p, 0, "AsyncTraceWriter did not create " << filename3);
+  uint32_t i = 0;
+  bool same = true;
+  int c;
+  while ((c = std::fgetc (p)) != EOF)
+    {
+      if (c == '\n')
+        {
+          continue;
+        }
+      if (c != 'a' + (int)(i % 26))
+        {
+          same = false;
+          break;
+        }
+      ++i;
+    }
+  std::fclose (p);
+  remove (filename3.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (same, true, "AsyncTraceWriter file contents differ");
+  NS_TEST_EXPECT_MSG_EQ (i, n, "AsyncTraceWriter file has wrong length");
+
+  //
+  // Write many files at once through the shared writer thread, and
+  // check that Flush puts all the data of a buffer in its file.
+  //
+  const uint32_t nFiles = 50;
+  std::vector<std::string> filenames4;
+  std::vector<AsyncTraceWriter *> writers;
+  std::vector<std::ostream *> streams;
+  for (uint32_t j = 0; j < nFiles; ++j)
+    {
+      std::ostringstream oss;
+      oss << "async-" << j << ".txt";
+      filenames4.push_back (CreateTempDirFilename (oss.str ()));
+      writers.push_back (new AsyncTraceWriter (filenames4[j], std::ios::out, 256));
+      NS_TEST_ASSERT_MSG_EQ (writers[j]->IsOpen (), true, "AsyncTraceWriter (" << filenames4[j] << ") not open");
+      streams.push_back (new std::ostream (writers[j]));
+    }
+  const uint32_t nLines = 1000;
+  for (uint32_t k = 0; k < nLines; ++k)
+    {
+      for (uint32_t j = 0; j < nFiles; ++j)
+        {
+          *streams[j] << j << " " << k << "\n";
+        }
+    }
+  for (uint32_t j = 0; j < nFiles; ++j)
+    {
+      // flushing the stream does not wait for the writer thread
+      streams[j]->flush ();
+      NS_TEST_EXPECT_MSG_EQ (streams[j]->fail (), false, "Flush must not fail");
+      NS_TEST_EXPECT_MSG_EQ (writers[j]->Flush (), true, "Flush must not fail");
+      // the file is still open, all the lines must be in it already
+      std::ifstream in (filenames4[j].c_str ());
+      uint32_t lines = 0;
+      bool inOrder = true;
+      uint32_t file, line;
+      while (in >> file >> line)
+        {
+          inOrder = inOrder && file == j && line == lines;
+          ++lines;
+        }
+      NS_TEST_EXPECT_MSG_EQ (inOrder, true, "Lines of " << filenames4[j] << " mixed up");
+      NS_TEST_EXPECT_MSG_EQ (lines, nLines, "Flush did not write all the lines of " << filenames4[j]);
+    }
+  for (uint32_t j = 0; j < nFiles; ++j)
+    {
+      delete streams[j];
+      delete writers[j];
+      remove (filenames4[j].c_str ());
+    }
+}
+
+// ===========================================================================
+// Test case to measure the time the simulation thread spends writing an
+// ascii trace, directly and through an AsyncTraceWriter.
+// ===========================================================================
+class AsciiWriteTimeTestCase : public TestCase
+{
+public:
+  /**
+   * \param flush whether each line ends with std::endl rather than '\n'
+   */
+  AsciiWriteTimeTestCase (bool flush);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the lines of a trace to a stream.
+   * \param os the stream
+   * \returns false if a write failed
+   */
+  bool WriteLines (std::ostream &os) const;
+
+  bool m_flush;
+};
+
+AsciiWriteTimeTestCase::AsciiWriteTimeTestCase (bool flush)
+  : TestCase (flush ? "Measure the time to write ascii trace lines ending with std::endl" :
+              "Measure the time to write ascii trace lines ending with a newline character"),
+    m_flush (flush)
+{
+}
+
+bool
+AsciiWriteTimeTestCase::WriteLines (std::ostream &os) const
+{
+  const uint32_t nLines = 200000;
+  for (uint32_t i = 0; i < nLines; ++i)
+    {
+      // the length and the content of a line of AsciiTraceHelper
+      os << "r " << 1e-5 * i << " /NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/MacRx "
+         << "ns3::Ipv4Header (tos 0x0 DSCP Default ECN Not-ECT ttl 64 id " << i
+         << " protocol 17 offset (bytes) 0 flags [none] length: 1052 10.1.1.1 > 10.1.1.2) "
+         << "ns3::UdpHeader (length: 1032 49153 > 9) Payload (size=1024)";
+      if (m_flush)
+        {
+          os << std::endl;
+        }
+      else
+        {
+          os << '\n';
+        }
+    }
+  return !os.fail ();
+}
+
+void
+AsciiWriteTimeTestCase::DoRun (void)
+{
+  std::string filenames[2];
+  filenames[0] = CreateTempDirFilename ("sync.tr");
+  filenames[1] = CreateTempDirFilename ("async.tr");
+  int64_t ms[2];
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  {
+    std::ofstream os (filenames[0].c_str ());
+    NS_TEST_ASSERT_MSG_EQ (WriteLines (os), true, "Write to " << filenames[0] << " failed");
+  }
+  ms[0] = clock.End ();
+
+  // the simulation thread also waits for the writer when closing
+  clock.Start ();
+  {
+    AsyncTraceWriter writer (filenames[1], std::ios::out);
+    std::ostream os (&writer);
+    NS_TEST_ASSERT_MSG_EQ (WriteLines (os), true, "Write to " << filenames[1] << " failed");
+  }
+  ms[1] = clock.End ();
+
+  std::ifstream in0 (filenames[0].c_str ());
+  std::ifstream in1 (filenames[1].c_str ());
+  std::string line0, line1;
+  bool identical = true;
+  while (identical && std::getline (in0, line0))
+    {
+      identical = std::getline (in1, line1) && line0 == line1;
+    }
+  identical = identical && !std::getline (in1, line1);
+  remove (filenames[0].c_str ());
+  remove (filenames[1].c_str ());
+  NS_TEST_EXPECT_MSG_EQ (identical, true, "File written with AsyncTraceWriter differs");
+
+  std::cout << "Ascii trace write time: " << (m_flush ? "std::endl" : "newline")
+            << " std::ofstream: " << ms[0] << " ms"
+            << " AsyncTraceWriter: " << ms[1] << " ms"
+            << std::endl;
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1138,6 +1416,21 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
+}
+
+class AsyncTraceWriterPerformanceTestSuite : public TestSuite
+{
+public:
+  AsyncTraceWriterPerformanceTestSuite ();
+};
+
+AsyncTraceWriterPerformanceTestSuite::AsyncTraceWriterPerformanceTestSuite ()
+  : TestSuite ("async-trace-writer-perf", PERFORMANCE)
+{
+  AddTestCase (new AsciiWriteTimeTestCase (true), TestCase::QUICK);
+  AddTestCase (new AsciiWriteTimeTestCase (false), TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
+static AsyncTraceWriterPerformanceTestSuite asyncTraceWriterPerformanceTestSuite;
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/topology-partitioner.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * Connect two nodes with a simple channel.
+ * \param nodes the nodes
+ * \param a the index of a node
+ * \param b the index of the other node
+ */
+static void
+Connect (NodeContainer nodes, uint32_t a, uint32_t b)
+{
+  SimpleNetDeviceHelper helper;
+  helper.Install (NodeContainer (nodes.Get (a), nodes.Get (b)));
+}
+
+class TopologyPartitionerRingsTestCase : public TestCase
+{
+public:
+  TopologyPartitionerRingsTestCase ();
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerRingsTestCase::TopologyPartitionerRingsTestCase ()
+  : TestCase ("Partition two rings joined by a link")
+{
+}
+
+void
+TopologyPartitionerRingsTestCase::DoRun (void)
+{
+  // two rings of 20 nodes, with cross links between the nodes of each
+  // ring, joined by a link between nodes 0 and 20
+  NodeContainer nodes;
+  nodes.Create (40);
+  for (uint32_t ring = 0; ring < 2; ring++)
+    {
+      for (uint32_t i = 0; i < 20; i++)
+        {
+          Connect (nodes, ring * 20 + i, ring * 20 + (i + 1) % 20);
+        }
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          Connect (nodes, ring * 20 + i, ring * 20 + i + 10);
+        }
+    }
+  Connect (nodes, 0, 20);
+
+  TopologyPartitioner partitioner;
+  partitioner.Partition (nodes, 2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetCrossPartitionRate (), 1, "Only the joining link should be cut");
+  std::vector<double> loads = partitioner.GetPartitionLoads ();
+  NS_TEST_ASSERT_MSG_EQ (loads.size (), 2, "Unexpected number of partitions");
+  NS_TEST_EXPECT_MSG_EQ (loads[0], loads[1], "The partitions should be balanced");
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (nodes.Get (i)->GetId ()),
+                             partitioner.GetPartition (nodes.Get (0)->GetId ()),
+                             "Node " << i << " should be with the first ring");
+      NS_TEST_EXPECT_MSG_NE (partitioner.GetPartition (nodes.Get (20 + i)->GetId ()),
+                             partitioner.GetPartition (nodes.Get (0)->GetId ()),
+                             "Node " << 20 + i << " should not be with the first ring");
+    }
+
+  // a fast joining link moves the cut into the rings
+  partitioner.SetLinkRate (nodes.Get (0)->GetId (), nodes.Get (20)->GetId (), 100);
+  partitioner.Partition (nodes, 2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (nodes.Get (0)->GetId ()),
+                         partitioner.GetPartition (nodes.Get (20)->GetId ()),
+                         "The fast link should not be cut");
+  NS_TEST_EXPECT_MSG_LT (partitioner.GetCrossPartitionRate (), 100, "Unexpected cut");
+  loads = partitioner.GetPartitionLoads ();
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (std::max (loads[0], loads[1]), (loads[0] + loads[1]) / 2 * 1.05,
+                               "The partitions should be balanced");
+
+  Simulator::Destroy ();
+}
+
+class TopologyPartitionerLoadTestCase : public TestCase
+{
+public:
+  TopologyPartitionerLoadTestCase ();
+  virtual void DoRun (void);
+};
+
+TopologyPartitionerLoadTestCase::TopologyPartitionerLoadTestCase ()
+  : TestCase ("Partition a loaded line")
+{
+}
+
+void
+TopologyPartitionerLoadTestCase::DoRun (void)
+{
+  // a line of 8 nodes, with a flow loading the first two as much as the
+  // other six
+  NodeContainer nodes;
+  nodes.Create (8);
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      Connect (nodes, i, i + 1);
+    }
+
+  TopologyPartitioner partitioner;
+  partitioner.SetDeviceLoad (0);
+  partitioner.AddFlow (nodes.Get (0)->GetId (), nodes.Get (1)->GetId (), 2);
+  partitioner.Partition (nodes, 2);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetCrossPartitionRate (), 1, "A single link should be cut");
+  std::vector<double> loads = partitioner.GetPartitionLoads ();
+  NS_TEST_EXPECT_MSG_EQ (loads[0], loads[1], "The partitions should be balanced");
+  NS_TEST_EXPECT_MSG_NE (partitioner.GetPartition (nodes.Get (1)->GetId ()),
+                         partitioner.GetPartition (nodes.Get (2)->GetId ()),
+                         "The line should be cut after the loaded nodes");
+
+  // a single partition holds everything, other nodes are in the first one
+  partitioner.Partition (nodes, 1);
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetCrossPartitionRate (), 0, "Nothing should be cut");
+  NS_TEST_EXPECT_MSG_EQ (partitioner.GetPartition (nodes.Get (7)->GetId () + 1), 0,
+                         "Unknown nodes should be in the first partition");
+
+  Simulator::Destroy ();
+}
+
+class TopologyPartitionerTestSuite : public TestSuite
+{
+public:
+  TopologyPartitionerTestSuite ();
+};
+
+TopologyPartitionerTestSuite::TopologyPartitionerTestSuite ()
+  : TestSuite ("topology-partitioner", UNIT)
+{
+  AddTestCase (new TopologyPartitionerRingsTestCase (), TestCase::QUICK);
+  AddTestCase (new TopologyPartitionerLoadTestCase (), TestCase::QUICK);
+}
+
+static TopologyPartitionerTestSuite g_topologyPartitionerTestSuite;
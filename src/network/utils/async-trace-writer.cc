@@ -0,0 +1,539 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/ptr.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
+#include "async-trace-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncTraceWriter");
+
+/**
+ * \brief A global switch to write pcap and ascii trace files from
+ * a background thread.
+ */
+static GlobalValue g_asyncTraceWrite = GlobalValue ("AsyncTraceWrite",
+                                                    "A global switch to write pcap and ascii trace files from a background thread",
+                                                    BooleanValue (false),
+                                                    MakeBooleanChecker ());
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * How long the threads wait on a condition before checking the
+ * queue again, in ns.  This only bounds the cost of a missed wakeup.
+ */
+static const uint64_t WAIT_NS = 10000000;
+
+/**
+ * \brief The queue of full blocks of all the open buffers, and the
+ * writer thread which empties it.
+ */
+class AsyncTraceWriter::Queue
+{
+public:
+  /** Maximum number of full blocks waiting for the writer. */
+  static const uint32_t MAX_DEPTH = 64;
+
+  /**
+   * \returns the queue.
+   */
+  static Queue * Get (void);
+
+  /**
+   * Count a newly opened buffer, starting the writer thread if
+   * this is the only one.
+   */
+  void Open (void);
+  /**
+   * Count a closed buffer, whose blocks are all written, stopping the
+   * writer thread if no buffer is open.
+   */
+  void Close (void);
+  /**
+   * Queue a full block, waiting for room if the queue is full.
+   * \param writer the buffer of the block.
+   * \param data the block.
+   * \param size number of valid bytes in \p data.
+   */
+  void Push (AsyncTraceWriter *writer, char *data, uint32_t size);
+  /**
+   * Wait until all the queued blocks of a buffer are written.
+   * \param writer the buffer.
+   */
+  void Drain (AsyncTraceWriter *writer);
+
+  /** Protects the queue, and the m_pending and m_failed buffer members. */
+  SystemMutex m_mutex;
+
+private:
+  Queue ();
+  /**
+   * The writer thread main loop.
+   */
+  void Run (void);
+
+  /** A block waiting to be written. */
+  struct Entry
+  {
+    AsyncTraceWriter *writer;  //!< The buffer of the block.
+    char *data;                //!< The block.
+    uint32_t size;             //!< Number of valid bytes in data.
+  };
+
+  SystemMutex m_threadMutex;    //!< Serializes starting and stopping the writer thread.
+  std::deque<Entry> m_entries;  //!< Blocks waiting for the writer.
+  uint32_t m_open;              //!< Number of open buffers.
+  bool m_stop;                  //!< Tells the writer to exit when done.
+  SystemCondition m_notEmpty;   //!< Signaled when a block is queued.
+  SystemCondition m_written;    //!< Signaled when a block is written.
+  Ptr<SystemThread> m_thread;   //!< The writer thread.
+};
+
+AsyncTraceWriter::Queue::Queue ()
+  : m_open (0),
+    m_stop (false)
+{
+}
+
+AsyncTraceWriter::Queue *
+AsyncTraceWriter::Queue::Get (void)
+{
+  // never deleted, so that it outlives buffers destroyed at exit
+  static Queue *queue = new Queue ();
+  return queue;
+}
+
+void
+AsyncTraceWriter::Queue::Open (void)
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection threadCs (m_threadMutex);
+  CriticalSection cs (m_mutex);
+  if (m_open++ == 0)
+    {
+      NS_LOG_LOGIC ("starting the writer thread");
+      m_stop = false;
+      m_thread = Create<SystemThread> (MakeCallback (&AsyncTraceWriter::Queue::Run, this));
+      m_thread->Start ();
+    }
+}
+
+void
+AsyncTraceWriter::Queue::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  // an Open () must not start a new thread before this one exits
+  CriticalSection threadCs (m_threadMutex);
+  Ptr<SystemThread> thread;
+  {
+    CriticalSection cs (m_mutex);
+    NS_ASSERT (m_open > 0);
+    if (--m_open > 0)
+      {
+        return;
+      }
+    m_stop = true;
+    thread = m_thread;
+    m_thread = 0;
+  }
+  NS_LOG_LOGIC ("stopping the writer thread");
+  m_notEmpty.SetCondition (true);
+  m_notEmpty.Signal ();
+  thread->Join ();
+}
+
+void
+AsyncTraceWriter::Queue::Push (AsyncTraceWriter *writer, char *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << writer << size);
+  Entry entry;
+  entry.writer = writer;
+  entry.data = data;
+  entry.size = size;
+  while (true)
+    {
+      m_written.SetCondition (false);
+      {
+        CriticalSection cs (m_mutex);
+        if (m_entries.size () < MAX_DEPTH)
+          {
+            m_entries.push_back (entry);
+            writer->m_pending++;
+            break;
+          }
+      }
+      NS_LOG_LOGIC ("writer queue full, waiting");
+      m_written.TimedWait (WAIT_NS);
+    }
+  m_notEmpty.SetCondition (true);
+  m_notEmpty.Signal ();
+}
+
+void
+AsyncTraceWriter::Queue::Drain (AsyncTraceWriter *writer)
+{
+  NS_LOG_FUNCTION (this << writer);
+  while (true)
+    {
+      m_written.SetCondition (false);
+      {
+        CriticalSection cs (m_mutex);
+        if (writer->m_pending == 0)
+          {
+            return;
+          }
+      }
+      m_written.TimedWait (WAIT_NS);
+    }
+}
+
+void
+AsyncTraceWriter::Queue::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Entry entry;
+      m_notEmpty.SetCondition (false);
+      {
+        CriticalSection cs (m_mutex);
+        if (m_entries.empty ())
+          {
+            if (m_stop)
+              {
+                return;
+              }
+            entry.data = 0;
+          }
+        else
+          {
+            entry = m_entries.front ();
+            m_entries.pop_front ();
+          }
+      }
+      if (entry.data == 0)
+        {
+          m_notEmpty.TimedWait (WAIT_NS);
+          continue;
+        }
+      // the buffer of the entry can not be closed while the entry is
+      // pending, so its file can be written without the lock
+      bool ok = entry.writer->WriteBlock (entry.data, entry.size);
+      {
+        CriticalSection cs (m_mutex);
+        if (!ok)
+          {
+            entry.writer->m_failed = true;
+          }
+        entry.writer->m_pending--;
+      }
+      m_written.SetCondition (true);
+      m_written.Broadcast ();
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * \brief A stream buffer without data, whose flush is a Flush() of an
+ * AsyncTraceWriter.
+ *
+ * The stream of the trace sinks only hands the current block to the
+ * writer when flushed; FatalImpl flushes this one too, so that the
+ * data is in the file before the program aborts.
+ */
+class AsyncTraceWriter::FatalFlush : public std::streambuf
+{
+public:
+  /**
+   * \param writer the buffer to flush.
+   */
+  FatalFlush (AsyncTraceWriter *writer)
+    : m_writer (writer)
+  {
+  }
+
+protected:
+  /**
+   * Flush the buffer and wait until its data is in the file.
+   * \returns 0, or -1 if a write failed.
+   */
+  virtual int sync (void)
+  {
+    return m_writer->Flush () ? 0 : -1;
+  }
+
+private:
+  AsyncTraceWriter *m_writer;  //!< The buffer to flush.
+};
+
+AsyncTraceWriter::AsyncTraceWriter (std::string filename, std::ios::openmode filemode,
+                                    uint32_t blockSize)
+  : m_blockSize (blockSize),
+    m_current (0),
+    m_submitted (0),
+    m_closed (false),
+    m_failed (false),
+    m_pending (0),
+    m_fatalFlush (0),
+    m_fatalStream (0)
+{
+  NS_LOG_FUNCTION (this << filename << filemode << blockSize);
+  NS_ASSERT (blockSize > 0);
+  m_file.open (filename.c_str (), filemode | std::ios::out);
+  if (!m_file.is_open ())
+    {
+      m_closed = true;
+      return;
+    }
+  setp (0, 0);
+#ifdef HAVE_PTHREAD_H
+  Queue::Get ()->Open ();
+#endif /* HAVE_PTHREAD_H */
+  m_fatalFlush = new FatalFlush (this);
+  m_fatalStream = new std::ostream (m_fatalFlush);
+  FatalImpl::RegisterStream (m_fatalStream);
+}
+
+AsyncTraceWriter::~AsyncTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+AsyncTraceWriter::IsEnabled (void)
+{
+  BooleanValue value;
+  g_asyncTraceWrite.GetValue (value);
+  return value.Get ();
+}
+
+bool
+AsyncTraceWriter::IsOpen (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.is_open ();
+}
+
+bool
+AsyncTraceWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (Queue::Get ()->m_mutex);
+#endif /* HAVE_PTHREAD_H */
+  return m_failed;
+}
+
+bool
+AsyncTraceWriter::WriteBlock (char *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_file.write (data, size);
+  // the block may have been handed over by sync ()
+  m_file.flush ();
+  delete [] data;
+  return !m_file.fail ();
+}
+
+bool
+AsyncTraceWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return false;
+    }
+  if (m_current == 0)
+    {
+      return true;
+    }
+  char *data = m_current;
+  uint32_t size = pptr () - pbase ();
+  m_current = 0;
+  setp (0, 0);
+  if (size == 0)
+    {
+      delete [] data;
+      return true;
+    }
+  m_submitted += size;
+#ifdef HAVE_PTHREAD_H
+  Queue::Get ()->Push (this, data, size);
+#else /* HAVE_PTHREAD_H */
+  if (!WriteBlock (data, size))
+    {
+      m_failed = true;
+    }
+#endif /* HAVE_PTHREAD_H */
+  return true;
+}
+
+void
+AsyncTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  Submit ();
+  m_closed = true;
+#ifdef HAVE_PTHREAD_H
+  Queue::Get ()->Drain (this);
+  Queue::Get ()->Close ();
+#endif /* HAVE_PTHREAD_H */
+  m_file.close ();
+  FatalImpl::UnregisterStream (m_fatalStream);
+  delete m_fatalStream;
+  delete m_fatalFlush;
+  m_fatalStream = 0;
+  m_fatalFlush = 0;
+}
+
+bool
+AsyncTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return !Fail ();
+    }
+  Submit ();
+#ifdef HAVE_PTHREAD_H
+  Queue::Get ()->Drain (this);
+#endif /* HAVE_PTHREAD_H */
+  // no block of this buffer is pending, so the writer thread does
+  // not use the file
+  m_file.flush ();
+  if (m_file.fail ())
+    {
+#ifdef HAVE_PTHREAD_H
+      CriticalSection cs (Queue::Get ()->m_mutex);
+#endif /* HAVE_PTHREAD_H */
+      m_failed = true;
+    }
+  return !Fail ();
+}
+
+AsyncTraceWriter::int_type
+AsyncTraceWriter::overflow (int_type c)
+{
+  if (!Submit ())
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      m_current = new char[m_blockSize];
+      setp (m_current, m_current + m_blockSize);
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+AsyncTraceWriter::xsputn (const char *s, std::streamsize n)
+{
+  std::streamsize written = 0;
+  while (written < n)
+    {
+      std::streamsize room = epptr () - pptr ();
+      if (room == 0)
+        {
+          if (!Submit ())
+            {
+              break;
+            }
+          m_current = new char[m_blockSize];
+          setp (m_current, m_current + m_blockSize);
+          continue;
+        }
+      std::streamsize chunk = std::min (room, n - written);
+      std::memcpy (pptr (), s + written, chunk);
+      // pbump takes an int, chunk is at most m_blockSize
+      pbump (static_cast<int> (chunk));
+      written += chunk;
+    }
+  return written;
+}
+
+int
+AsyncTraceWriter::sync (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  {
+    CriticalSection cs (Queue::Get ()->m_mutex);
+    if (m_pending > 0)
+      {
+        // the writer did not write the previous block yet: let the
+        // current one grow, rather than queue a block per flush
+        return m_failed ? -1 : 0;
+      }
+  }
+#endif /* HAVE_PTHREAD_H */
+  // the writer thread flushes the file once it wrote the block:
+  // waiting for it is left to Flush () and Close ()
+  Submit ();
+  return Fail () ? -1 : 0;
+}
+
+AsyncTraceWriter::pos_type
+AsyncTraceWriter::GetPosition (void) const
+{
+  return pos_type (off_type (m_submitted + (pptr () - pbase ())));
+}
+
+AsyncTraceWriter::pos_type
+AsyncTraceWriter::seekoff (off_type off, std::ios_base::seekdir way,
+                           std::ios_base::openmode which)
+{
+  pos_type current = GetPosition ();
+  if (m_closed || !(which & std::ios_base::out))
+    {
+      return pos_type (off_type (-1));
+    }
+  if ((way == std::ios_base::cur && off == 0)
+      || (way == std::ios_base::beg && off == off_type (current)))
+    {
+      return current;
+    }
+  return pos_type (off_type (-1));
+}
+
+AsyncTraceWriter::pos_type
+AsyncTraceWriter::seekpos (pos_type pos, std::ios_base::openmode which)
+{
+  return seekoff (off_type (pos), std::ios_base::beg, which);
+}
+
+} // namespace ns3
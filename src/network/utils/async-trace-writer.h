@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_TRACE_WRITER_H
+#define ASYNC_TRACE_WRITER_H
+
+#include <streambuf>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief A stream buffer which writes a file from a background thread.
+ *
+ * Trace sinks run in the simulation thread, and writing each record
+ * through a std::ofstream makes them pay for the file I/O.  This
+ * stream buffer instead copies the bytes written to it into blocks.
+ * Full blocks are handed to a writer thread, shared by all the
+ * buffers, which writes each one to its file with a single call.
+ * The simulation thread only takes a lock once per block, and blocks
+ * waiting for the writer only when the shared queue of full blocks is
+ * at its bounded depth.
+ *
+ * A block is only allocated when there is data to put in it, and is
+ * released once written, so an idle file costs no buffer memory.  The
+ * writer thread runs while at least one buffer is open.
+ *
+ * The bytes reaching the file are exactly the bytes written to the
+ * buffer, so the file format does not change.  Flushing the stream
+ * (as std::endl does) hands the current block to the writer without
+ * waiting for it, unless the writer is still busy with the previous
+ * block of the buffer, in which case the current block keeps growing
+ * until a later flush.
+ * A flush still costs a lock, and often a block: trace sinks should
+ * end their lines with '\n'.  Only Flush() and Close() wait
+ * until all the data written so far is in the file; a fatal error
+ * does so too, see FatalImpl::RegisterStream().
+ *
+ * The buffer only supports output, and seeking only to the current
+ * position (which lets PcapFile write its file header as usual).
+ *
+ * When ns-3 is built without thread support, full blocks are written
+ * by the simulation thread itself.
+ *
+ * Use of this buffer by PcapHelper and AsciiTraceHelper is controlled
+ * by the "AsyncTraceWrite" GlobalValue, see IsEnabled().
+ */
+class AsyncTraceWriter : public std::streambuf
+{
+public:
+  /** Default size of the blocks, in bytes. */
+  static const uint32_t DEFAULT_BLOCK_SIZE = 1 << 14;
+
+  /**
+   * Open a file, and start the writer thread if it is not running.
+   *
+   * \param filename file name
+   * \param filemode std::ios::openmode flags, std::ios::out is implied.
+   * \param blockSize size of the blocks handed to the writer, in bytes.
+   */
+  AsyncTraceWriter (std::string filename, std::ios::openmode filemode,
+                    uint32_t blockSize = DEFAULT_BLOCK_SIZE);
+  /**
+   * Close the file, see Close().
+   */
+  virtual ~AsyncTraceWriter ();
+
+  /**
+   * \returns true if the file could be opened.
+   */
+  bool IsOpen (void) const;
+  /**
+   * \returns true if a write to the file failed.
+   */
+  bool Fail (void) const;
+  /**
+   * Write all buffered data and close the file, stopping the writer
+   * thread if no other buffer is open.  Calling Close() more than
+   * once has no effect.
+   */
+  void Close (void);
+  /**
+   * Write all buffered data, and wait until it is in the file.
+   * \returns false if a write failed.
+   */
+  bool Flush (void);
+
+  /**
+   * \returns true if the "AsyncTraceWrite" GlobalValue is set, i.e.,
+   * if trace helpers should write files through this buffer.
+   */
+  static bool IsEnabled (void);
+
+protected:
+  /**
+   * Hand the current block to the writer and store \p c in a new one.
+   * \param c the character which did not fit in the current block.
+   * \returns \p c, or EOF on error.
+   */
+  virtual int_type overflow (int_type c);
+  /**
+   * Copy a character sequence into the blocks.
+   * \param s the characters to write.
+   * \param n the number of characters.
+   * \returns the number of characters written.
+   */
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  /**
+   * Hand the current block to the writer, without waiting for it, if
+   * the writer is done with the previous blocks of this buffer.
+   * \returns 0, or -1 if a write failed.
+   */
+  virtual int sync (void);
+  /**
+   * Get the current output position; any actual repositioning fails.
+   * \param off offset relative to \p way.
+   * \param way the reference position.
+   * \param which the sequence to reposition.
+   * \returns the current position, or -1 on error.
+   */
+  virtual pos_type seekoff (off_type off, std::ios_base::seekdir way,
+                            std::ios_base::openmode which = std::ios_base::out);
+  /**
+   * Get the current output position; any actual repositioning fails.
+   * \param pos the requested absolute position.
+   * \param which the sequence to reposition.
+   * \returns the current position, or -1 on error.
+   */
+  virtual pos_type seekpos (pos_type pos,
+                            std::ios_base::openmode which = std::ios_base::out);
+
+private:
+  /** The queue of full blocks and the writer thread, shared by all buffers. */
+  class Queue;
+  /** The stream buffer whose flush, on a fatal error, calls Flush(). */
+  class FatalFlush;
+
+  /**
+   * Hand the current block, if not empty, to the writer.  The next
+   * write allocates a new block.
+   * \returns false if the buffer is closed.
+   */
+  bool Submit (void);
+  /**
+   * Write a block to the file and release it.  Called by the writer
+   * thread, or by the simulation thread without thread support.
+   * \param data the block.
+   * \param size number of valid bytes in \p data.
+   * \returns false if the write failed.
+   */
+  bool WriteBlock (char *data, uint32_t size);
+  /**
+   * \returns the current output position.
+   */
+  pos_type GetPosition (void) const;
+
+  std::ofstream m_file;   //!< The file, written by the writer thread.
+  uint32_t m_blockSize;   //!< Size of the blocks.
+  char *m_current;        //!< The block being filled, if any.
+  uint64_t m_submitted;   //!< Bytes handed to the writer so far.
+  bool m_closed;          //!< true once Close() was called.
+  bool m_failed;          //!< true if a write failed, guarded by the Queue mutex.
+  uint32_t m_pending;     //!< Blocks queued or being written, guarded by the Queue mutex.
+  FatalFlush *m_fatalFlush;     //!< Calls Flush() on a fatal error.
+  std::ostream *m_fatalStream;  //!< The stream of m_fatalFlush, registered with FatalImpl.
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_WRITER_H */
@@ -0,0 +1,818 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+#include "ns3/simulator.h"
+#include "ns3/make-event.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/buffer.h"
+#include "ns3/packet-metadata.h"
+#include "ns3/byte-tag-list.h"
+#include "multithreaded-simulator-impl.h"
+
+namespace ns3 {
+
+// Note:  as in DefaultSimulatorImpl, logging in the event paths is
+// avoided, all the more since it is not thread-safe.
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** Largest timestamp, see GetMaximumSimulationTime(). */
+static const uint64_t MAX_TS = 0x7fffffffffffffffULL;
+/** Context of the events without context. */
+static const uint32_t NO_CONTEXT = 0xffffffff;
+
+/**
+ * The threads wait for the start of a window on a condition, and the
+ * main thread for the end of the window on another one.  SystemCondition
+ * resets its condition when a waiter wakes up, so it cannot wake all the
+ * workers at once: use pthreads directly.
+ */
+struct MultithreadedSimulatorImpl::Sync
+{
+  pthread_key_t key;       //!< Partition run by the calling thread.
+  pthread_mutex_t mutex;   //!< Protects the fields below, and m_stop.
+  pthread_cond_t start;    //!< Signaled when a window starts.
+  pthread_cond_t done;     //!< Signaled when the last worker is done.
+  uint64_t generation;     //!< Number of windows started.
+  uint64_t end;            //!< End of the current window.
+  uint32_t running;        //!< Number of workers in the window.
+  uint32_t nextWorker;     //!< Index of the next worker to start.
+  bool exit;               //!< Tells the workers to exit.
+};
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Network")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("Threads",
+                   "The number of partitions, each run by a thread.  "
+                   "Zero uses one thread per online processor.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_nThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_nThreads (0),
+    m_distributed (false),
+    m_parallel (false),
+    m_stop (false),
+    m_lookahead (0),
+    m_windowEnd (0)
+{
+  NS_LOG_FUNCTION (this);
+  // uids are allocated from 4, see DefaultSimulatorImpl
+  m_global = new Partition ();
+  m_global->index = 0;
+  m_global->currentTs = 0;
+  m_global->currentContext = NO_CONTEXT;
+  m_global->currentUid = 0;
+  m_global->uid = 4;
+  m_global->unscheduledEvents = 0;
+
+  m_sync = new Sync ();
+  pthread_key_create (&m_sync->key, 0);
+  pthread_mutex_init (&m_sync->mutex, 0);
+  pthread_cond_init (&m_sync->start, 0);
+  pthread_cond_init (&m_sync->done, 0);
+  m_sync->generation = 0;
+  m_sync->end = 0;
+  m_sync->running = 0;
+  m_sync->nextWorker = 1;
+  m_sync->exit = false;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_threads.empty ());
+  pthread_cond_destroy (&m_sync->done);
+  pthread_cond_destroy (&m_sync->start);
+  pthread_mutex_destroy (&m_sync->mutex);
+  pthread_key_delete (m_sync->key);
+  delete m_sync;
+  m_sync = 0;
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  pthread_mutex_lock (&m_sync->mutex);
+  m_sync->exit = true;
+  pthread_cond_broadcast (&m_sync->start);
+  pthread_mutex_unlock (&m_sync->mutex);
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      ClearEvents (*i);
+      delete *i;
+    }
+  m_partitions.clear ();
+  ClearEvents (m_global);
+  delete m_global;
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::ClearEvents (Partition *partition)
+{
+  for (std::vector<InboxEvent>::iterator i = partition->inbox.begin (); i != partition->inbox.end (); ++i)
+    {
+      i->ev.impl->Unref ();
+    }
+  partition->inbox.clear ();
+  if (partition->events != 0)
+    {
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->events = 0;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        CriticalSection cs (m_destroyMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MoveEvents (Ptr<Scheduler> from, Ptr<Scheduler> to)
+{
+  while (!from->IsEmpty ())
+    {
+      to->Insert (from->RemoveNext ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+  if (m_global->events != 0)
+    {
+      MoveEvents (m_global->events, scheduler);
+    }
+  m_global->events = scheduler;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      scheduler = schedulerFactory.Create<Scheduler> ();
+      MoveEvents ((*i)->events, scheduler);
+      (*i)->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  if (m_distributed)
+    {
+      return m_partitions.size ();
+    }
+  if (m_nThreads != 0)
+    {
+      return m_nThreads;
+    }
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  return n > 0 ? n : 1;
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (!m_distributed, "Partitions must be set before Simulator::Run is called");
+  NS_ASSERT_MSG (partition < GetNPartitions (), "Invalid partition " << partition);
+  if (context >= m_partitionOf.size ())
+    {
+      m_partitionOf.resize (context + 1, NO_CONTEXT);
+    }
+  m_partitionOf[context] = partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_partitionOf.size () && m_partitionOf[context] != NO_CONTEXT)
+    {
+      return m_partitionOf[context];
+    }
+  return context % GetNPartitions ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return TimeStep (m_lookahead);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  Partition *partition = static_cast<Partition *> (pthread_getspecific (m_sync->key));
+  return partition != 0 ? partition : m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  if (context == NO_CONTEXT || !m_distributed)
+    {
+      return m_global;
+    }
+  return m_partitions[GetPartition (context)];
+}
+
+uint64_t
+MultithreadedSimulatorImpl::ComputeLookahead (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t lookahead = MAX_TS;
+  std::vector<uint32_t> partitions (NodeList::GetNNodes ());
+  for (uint32_t i = 0; i < partitions.size (); i++)
+    {
+      partitions[i] = GetPartition (i);
+    }
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      // only the delays between devices of different partitions matter
+      int64_t delay = channel->GetMinimumDelayBetweenGroups (partitions).GetTimeStep ();
+      lookahead = std::min (lookahead, static_cast<uint64_t> (std::max (delay, (int64_t)0)));
+      NS_LOG_LOGIC ("lookahead " << lookahead << " after channel " << channel->GetId ());
+    }
+  return lookahead;
+}
+
+void
+MultithreadedSimulatorImpl::Distribute (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = GetNPartitions ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Partition *partition = new Partition ();
+      partition->index = i;
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      partition->currentTs = m_global->currentTs;
+      partition->currentContext = NO_CONTEXT;
+      partition->currentUid = 0;
+      // the uids of the events moved below stay unique
+      partition->uid = m_global->uid;
+      partition->unscheduledEvents = 0;
+      m_partitions.push_back (partition);
+    }
+  m_global->index = n;
+  m_distributed = true;
+
+  Ptr<Scheduler> global = m_schedulerFactory.Create<Scheduler> ();
+  while (!m_global->events->IsEmpty ())
+    {
+      Scheduler::Event ev = m_global->events->RemoveNext ();
+      Partition *partition = GetPartitionOf (ev.key.m_context);
+      if (partition != m_global)
+        {
+          partition->events->Insert (ev);
+          partition->unscheduledEvents++;
+          m_global->unscheduledEvents--;
+        }
+      else
+        {
+          global->Insert (ev);
+        }
+    }
+  m_global->events = global;
+
+  m_lookahead = ComputeLookahead ();
+  NS_LOG_INFO (n << " partitions, lookahead " << m_lookahead);
+  if (n > 1 && m_lookahead > 0)
+    {
+      for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+        {
+          (*i)->PrepareParallelRun ();
+        }
+      for (uint32_t i = 1; i < n; i++)
+        {
+          Ptr<SystemThread> thread =
+            Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::RunWorker, this));
+          thread->Start ();
+          m_threads.push_back (thread);
+        }
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::InboxEventLess (const InboxEvent &a, const InboxEvent &b)
+{
+  if (a.ev.key.m_ts != b.ev.key.m_ts)
+    {
+      return a.ev.key.m_ts < b.ev.key.m_ts;
+    }
+  if (a.source != b.source)
+    {
+      return a.source < b.source;
+    }
+  return a.ev.key.m_uid < b.ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::MergeInboxes (void)
+{
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *partition = i < m_partitions.size () ? m_partitions[i] : m_global;
+      std::vector<InboxEvent> inbox;
+      {
+        CriticalSection cs (partition->inboxMutex);
+        partition->inbox.swap (inbox);
+      }
+      std::sort (inbox.begin (), inbox.end (), &MultithreadedSimulatorImpl::InboxEventLess);
+      for (std::vector<InboxEvent>::iterator j = inbox.begin (); j != inbox.end (); ++j)
+        {
+          Scheduler::Event ev = j->ev;
+          ev.key.m_uid = partition->uid;
+          partition->uid++;
+          partition->unscheduledEvents++;
+          partition->events->Insert (ev);
+        }
+    }
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Partition *current = GetCurrentPartition ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  if (m_parallel && partition != current)
+    {
+      if (ts < m_windowEnd)
+        {
+          NS_FATAL_ERROR ("Event for context " << context << " at " << ts <<
+                          " scheduled by another partition before the end of the window at " <<
+                          m_windowEnd << ": a channel delay is less than its minimum delay");
+        }
+      ev.key.m_uid = current->uid;
+      current->uid++;
+      InboxEvent inboxEvent;
+      inboxEvent.ev = ev;
+      inboxEvent.source = current->index;
+      CriticalSection cs (partition->inboxMutex);
+      partition->inbox.push_back (inboxEvent);
+    }
+  else
+    {
+      ev.key.m_uid = partition->uid;
+      partition->uid++;
+      partition->unscheduledEvents++;
+      partition->events->Insert (ev);
+    }
+  return ev.key;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::NextTs (Partition *partition)
+{
+  if (partition->events->IsEmpty ())
+    {
+      return MAX_TS;
+    }
+  return partition->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessPartition (Partition *partition, uint64_t end)
+{
+  pthread_setspecific (m_sync->key, partition);
+  while (true)
+    {
+      uint64_t next = NextTs (partition);
+      // without threads, the partitions may schedule events without
+      // context before the end of the window: these run first
+      if (next >= end || (!m_parallel && next >= NextTs (m_global)))
+        {
+          break;
+        }
+      ProcessOneEvent (partition);
+    }
+  pthread_setspecific (m_sync->key, 0);
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (void)
+{
+  uint64_t generation = 0;
+  pthread_mutex_lock (&m_sync->mutex);
+  Partition *partition = m_partitions[m_sync->nextWorker];
+  m_sync->nextWorker++;
+  while (true)
+    {
+      while (m_sync->generation == generation && !m_sync->exit)
+        {
+          pthread_cond_wait (&m_sync->start, &m_sync->mutex);
+        }
+      if (m_sync->exit)
+        {
+          break;
+        }
+      generation = m_sync->generation;
+      uint64_t end = m_sync->end;
+      pthread_mutex_unlock (&m_sync->mutex);
+
+      ProcessPartition (partition, end);
+
+      pthread_mutex_lock (&m_sync->mutex);
+      m_sync->running--;
+      if (m_sync->running == 0)
+        {
+          pthread_cond_signal (&m_sync->done);
+        }
+    }
+  pthread_mutex_unlock (&m_sync->mutex);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (uint64_t end)
+{
+  if (m_threads.empty ())
+    {
+      for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          ProcessPartition (*i, end);
+        }
+      return;
+    }
+
+  m_windowEnd = end;
+  m_parallel = true;
+  pthread_mutex_lock (&m_sync->mutex);
+  m_sync->end = end;
+  m_sync->running = m_threads.size ();
+  m_sync->generation++;
+  pthread_cond_broadcast (&m_sync->start);
+  pthread_mutex_unlock (&m_sync->mutex);
+
+  ProcessPartition (m_partitions[0], end);
+
+  pthread_mutex_lock (&m_sync->mutex);
+  while (m_sync->running > 0)
+    {
+      pthread_cond_wait (&m_sync->done, &m_sync->mutex);
+    }
+  pthread_mutex_unlock (&m_sync->mutex);
+  m_parallel = false;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  if (!m_global->events->IsEmpty () || !m_global->inbox.empty ())
+    {
+      return false;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty () || !(*i)->inbox.empty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_distributed)
+    {
+      Distribute ();
+    }
+  m_stop = false;
+  if (!m_threads.empty ())
+    {
+      Buffer::EnableFreeList (false);
+      PacketMetadata::EnableFreeList (false);
+      ByteTagList::EnableFreeList (false);
+      Channel::EnableDeepCopy (true);
+    }
+
+  while (true)
+    {
+      MergeInboxes ();
+      if (m_stop)
+        {
+          break;
+        }
+      uint64_t next = MAX_TS;
+      for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, NextTs (*i));
+        }
+      uint64_t nextGlobal = NextTs (m_global);
+      if (nextGlobal == MAX_TS && next == MAX_TS)
+        {
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          // events without context run alone, before the events of the
+          // partitions at the same time
+          ProcessOneEvent (m_global);
+          continue;
+        }
+      uint64_t end;
+      if (m_lookahead == 0)
+        {
+          end = next + 1;
+        }
+      else
+        {
+          end = m_lookahead > MAX_TS - next ? MAX_TS : next + m_lookahead;
+        }
+      ProcessWindow (std::min (end, nextGlobal));
+    }
+
+  if (!m_threads.empty ())
+    {
+      Buffer::EnableFreeList (true);
+      PacketMetadata::EnableFreeList (true);
+      ByteTagList::EnableFreeList (true);
+      Channel::EnableDeepCopy (false);
+    }
+  // after Run, Now() is the time of the last event
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, (*i)->currentTs);
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (m_stop || (*i)->unscheduledEvents == 0);
+    }
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      (*i)->currentTs = m_global->currentTs;
+    }
+  NS_ASSERT (m_stop || m_global->unscheduledEvents == 0);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  pthread_mutex_lock (&m_sync->mutex);
+  m_stop = true;
+  pthread_mutex_unlock (&m_sync->mutex);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t ts = GetCurrentPartition ()->currentTs + delay.GetTimeStep ();
+  if (m_parallel && ts < m_windowEnd)
+    {
+      // the other partitions may already be past ts
+      ts = m_windowEnd;
+    }
+  Insert (m_global, ts, NO_CONTEXT, MakeEvent (&Simulator::Stop));
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  Partition *current = GetCurrentPartition ();
+  Time tAbsolute = delay + TimeStep (current->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  Scheduler::EventKey key = Insert (current, tAbsolute.GetTimeStep (), current->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *current = GetCurrentPartition ();
+  Time tAbsolute = delay + TimeStep (current->currentTs);
+
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  Insert (GetPartitionOf (context), tAbsolute.GetTimeStep (), context, event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *current = GetCurrentPartition ();
+  Scheduler::EventKey key = Insert (current, current->currentTs, current->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->currentTs, NO_CONTEXT, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (std::list<EventId>::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartitionOf (id.GetContext ());
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (std::list<EventId>::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // the event is in the queue of the partition of its context
+  const Partition *partition = GetPartitionOf (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+} // namespace ns3
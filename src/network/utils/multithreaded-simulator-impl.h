@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include <vector>
+#include <list>
+#include <stdint.h>
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-id.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-thread.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A conservative parallel simulator running the nodes of a
+ * single process on several threads.
+ *
+ * Each thread owns a partition of the nodes, and an event queue for the
+ * events whose context is the id of one of these nodes.  Nodes are
+ * assigned to partitions by SetPartition(), or else by their id modulo
+ * the number of partitions.  Events without a context, i.e., those
+ * scheduled from the main program, run alone, with all the partitions
+ * stopped at their timestamp.
+ *
+ * The partitions run in windows of simulated time.  Each window starts
+ * at the earliest pending event, and lasts for the lookahead: the
+ * smallest Channel::GetMinimumDelayBetweenGroups() the devices of nodes in
+ * different partitions, e.g., the propagation delay between distant
+ * Wi-Fi BSSs.  An event scheduled by one partition for
+ * another is then always beyond the end of the window, and the
+ * partitions can run their events in the window independently.  Such
+ * events are handed over at the end of the window.  If no such channel
+ * exists, the partitions only synchronize for events without context.
+ * If the lookahead is zero, e.g., because a channel does not provide a
+ * minimum delay, like the spectrum channels, the partitions run one
+ * timestamp at a time in the main thread.
+ *
+ * The partitions, and the lookahead, are computed when Run() is first
+ * called: the topology must not change afterwards.
+ *
+ * Models only run concurrently in different partitions, so they must
+ * not share objects across partitions except through events scheduled
+ * with Simulator::ScheduleWithContext, with at least the lookahead as
+ * delay.  A model scheduling such an event with a shorter delay is
+ * a fatal error.  Note that reference counts are not atomic: while the
+ * threads run, the channels hand over deep copies of the packets, see
+ * Channel::EnableDeepCopy(), and the free lists of Buffer,
+ * PacketMetadata and ByteTagList are disabled.  Before the threads
+ * start, the channels look up what they need of the receiving devices,
+ * see Channel::PrepareParallelRun().  The YansWifiChannels serialize
+ * the transmissions of all the partitions, and so the calls to their
+ * loss and delay models and the references to the mobility models of
+ * their PHYs: while the threads run, these mobility models must not be
+ * otherwise referenced, e.g., by Object::GetObject() or by course
+ * change callbacks, and loss models using random variables draw them
+ * in an order which varies from run to run.  Simulator::Stop() without
+ * delay, called from a partition, stops the simulation at the end of
+ * the window.
+ *
+ * This simulator is only available when ns-3 is built with thread
+ * support.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \returns the number of partitions, i.e., of threads.
+   */
+  uint32_t GetNPartitions (void) const;
+  /**
+   * Assign a node to a partition.  This must be done before Run() is
+   * first called.
+   *
+   * \param context the node id
+   * \param partition the partition, less than GetNPartitions()
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param context a node id
+   * \returns the partition of the node
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * \returns the lookahead between partitions, computed when Run() is
+   * first called, or GetMaximumSimulationTime() if the partitions are
+   * not connected by any channel.
+   */
+  Time GetLookahead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event handed over by another partition. */
+  struct InboxEvent
+  {
+    Scheduler::Event ev;  //!< The event, with the uid of the source partition.
+    uint32_t source;      //!< Index of the source partition.
+  };
+
+  /**
+   * Order the events handed over to a partition, so that the order in
+   * which they were handed over by concurrent threads does not matter.
+   * \param a an event
+   * \param b another event
+   * \returns true if \p a must run before \p b at the same time
+   */
+  static bool InboxEventLess (const InboxEvent &a, const InboxEvent &b);
+
+  /** The events of a partition. */
+  struct Partition
+  {
+    uint32_t index;                //!< Index of the partition.
+    Ptr<Scheduler> events;         //!< The event queue.
+    uint64_t currentTs;            //!< Timestamp of the current event.
+    uint32_t currentContext;       //!< Context of the current event.
+    uint32_t currentUid;           //!< Uid of the current event.
+    uint32_t uid;                  //!< Next event uid.
+    int unscheduledEvents;         //!< Number of events in the queue.
+    SystemMutex inboxMutex;        //!< Protects inbox.
+    std::vector<InboxEvent> inbox; //!< Events from other partitions.
+  };
+
+  /**
+   * \returns the partition of the calling thread.
+   */
+  Partition *GetCurrentPartition (void) const;
+  /**
+   * \param context a context
+   * \returns the partition running the events with this context.
+   */
+  Partition *GetPartitionOf (uint32_t context) const;
+  /**
+   * \param partition a partition
+   * \returns the timestamp of the next event of the partition, or
+   * GetMaximumSimulationTime() if there are none.
+   */
+  static uint64_t NextTs (Partition *partition);
+  /**
+   * Insert an event in the queue of a partition, or hand it over to the
+   * partition if it belongs to another thread.
+   * \param partition the partition
+   * \param ts the timestamp of the event
+   * \param context the context of the event
+   * \param event the event
+   * \returns the event key
+   */
+  Scheduler::EventKey Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Create the partitions, move the events to their queue and compute
+   * the lookahead.
+   */
+  void Distribute (void);
+  /**
+   * \returns the smallest minimum delay between the devices of nodes
+   * in different partitions, in time steps.
+   */
+  uint64_t ComputeLookahead (void) const;
+  /**
+   * Move the events handed over by other partitions to the event queues.
+   */
+  void MergeInboxes (void);
+  /**
+   * Run the next event of a partition.
+   * \param partition the partition
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Run the events of a partition up to a time.
+   * \param partition the partition
+   * \param end the end of the window, excluded
+   */
+  void ProcessPartition (Partition *partition, uint64_t end);
+  /**
+   * Run the events of all the partitions up to a time.
+   * \param end the end of the window, excluded
+   */
+  void ProcessWindow (uint64_t end);
+  /**
+   * Move all the events of a scheduler to another one.
+   * \param from the scheduler to empty
+   * \param to the scheduler receiving the events
+   */
+  static void MoveEvents (Ptr<Scheduler> from, Ptr<Scheduler> to);
+  /**
+   * Unref all the events of a partition.
+   * \param partition the partition
+   */
+  static void ClearEvents (Partition *partition);
+  /**
+   * The main loop of the threads running partitions 1 and above.
+   */
+  void RunWorker (void);
+
+  /** Synchronization of the threads, defined by the implementation. */
+  struct Sync;
+
+  uint32_t m_nThreads;                     //!< The Threads attribute.
+  ObjectFactory m_schedulerFactory;        //!< Creates the event queues.
+  Partition *m_global;                     //!< Events without context.
+  std::vector<Partition *> m_partitions;   //!< The partitions.
+  std::vector<uint32_t> m_partitionOf;     //!< Partition of each context.
+  bool m_distributed;                      //!< true once the events are in the partitions.
+  bool m_parallel;                         //!< true if the window runs on threads.
+  bool m_stop;                             //!< Stop at the end of the window.
+  uint64_t m_lookahead;                    //!< The lookahead, in time steps.
+  uint64_t m_windowEnd;                    //!< End of the current window.
+  mutable SystemMutex m_destroyMutex;      //!< Protects m_destroyEvents.
+  std::list<EventId> m_destroyEvents;      //!< The destroy events.
+  Sync *m_sync;                            //!< Thread synchronization.
+  std::vector<Ptr<SystemThread> > m_threads; //!< The worker threads.
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -27,7 +27,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_buffer (0),
+    m_destroyable (true)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
   std::ofstream* os = new std::ofstream ();
@@ -39,19 +40,30 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_buffer (0), m_destroyable (false)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (m_ostream->good (), "Output stream is not vaild for writing.");
 }
 
+OutputStreamWrapper::OutputStreamWrapper (std::streambuf* buffer)
+  : m_buffer (buffer), m_destroyable (true)
+{
+  NS_LOG_FUNCTION (this << buffer);
+  m_ostream = new std::ostream (buffer);
+  FatalImpl::RegisterStream (m_ostream);
+}
+
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
+  // the stream buffer outlives the stream using it
+  delete m_buffer;
+  m_buffer = 0;
 }
 
 std::ostream *
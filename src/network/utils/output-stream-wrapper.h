@@ -81,6 +81,15 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor
+   *
+   * The wrapper writes to a new stream over \p buffer, and takes
+   * ownership of \p buffer.
+   *
+   * \param buffer stream buffer
+   */
+  OutputStreamWrapper (std::streambuf* buffer);
   ~OutputStreamWrapper ();
 
   /**
@@ -94,6 +103,7 @@ public:
 
 private:
   std::ostream *m_ostream; //!< The output stream
+  std::streambuf *m_buffer; //!< The owned stream buffer, if any
   bool m_destroyable; //!< Can be destroyed
 };
 
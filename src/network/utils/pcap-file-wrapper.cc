@@ -90,6 +90,13 @@ PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
   m_file.Open (filename, mode);
 }
 
+void
+PcapFileWrapper::OpenAsync (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.OpenAsync (filename);
+}
+
 void
 PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrection)
 {
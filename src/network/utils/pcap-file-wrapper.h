@@ -77,6 +77,14 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Create a new pcap file which is written from a background thread,
+   * see PcapFile::OpenAsync.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void OpenAsync (std::string const &filename);
+
   /**
    * Close the underlying pcap file.
    */
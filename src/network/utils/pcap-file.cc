@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "async-trace-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -49,8 +50,10 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 
 PcapFile::PcapFile ()
   : m_file (),
+    m_writer (0),
     m_swapMode (false)
 {
+  m_out = &m_file;
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file);
 }
@@ -67,7 +70,7 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_file.fail ();
+  return m_out->fail ();
 }
 bool 
 PcapFile::Eof (void) const
@@ -79,7 +82,7 @@ void
 PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
-  m_file.clear ();
+  m_out->clear ();
 }
 
 
@@ -87,6 +90,13 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      delete m_out;
+      delete m_writer;
+      m_writer = 0;
+      m_out = &m_file;
+    }
   m_file.close ();
 }
 
@@ -198,7 +208,7 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
-  m_file.seekp (0, std::ios::beg);
+  m_out->seekp (0, std::ios::beg);
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -226,13 +236,13 @@ PcapFile::WriteFileHeader (void)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  m_out->write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
+  m_out->write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
+  m_out->write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
+  m_out->write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
+  m_out->write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
+  m_out->write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
+  m_out->write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
 }
 
 void
@@ -326,6 +336,20 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
     }
 }
 
+void
+PcapFile::OpenAsync (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT (m_writer == 0);
+  NS_ASSERT (!m_out->fail ());
+  m_writer = new AsyncTraceWriter (filename, std::ios::out | std::ios::binary);
+  m_out = new std::ostream (m_writer);
+  if (!m_writer->IsOpen ())
+    {
+      m_out->setstate (std::ios::failbit);
+    }
+}
+
 void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode)
 {
@@ -375,7 +399,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_out->good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -394,11 +418,11 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  m_out->write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
+  m_out->write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
+  m_out->write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
+  m_out->write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  NS_BUILD_DEBUG(m_out->flush());
   return inclLen;
 }
 
@@ -407,8 +431,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  m_out->write ((const char *)data, inclLen);
+  NS_BUILD_DEBUG(m_out->flush());
 }
 
 void 
@@ -416,8 +440,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  p->CopyData (m_out, inclLen);
+  NS_BUILD_DEBUG(m_out->flush());
 }
 
 void 
@@ -432,9 +456,9 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (m_out, toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (m_out, inclLen);
 }
 
 void
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncTraceWriter;
 
 
 /**
@@ -80,6 +81,18 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Create a new pcap file, written from a background thread.
+   *
+   * The file is only open for writing: records are copied into large
+   * blocks which an AsyncTraceWriter writes to disk, so the caller
+   * does not wait for file I/O.  The file contents are the same as
+   * with Open().
+   *
+   * \param filename String containing the name of the file.
+   */
+  void OpenAsync (std::string const &filename);
+
   /**
    * Close the underlying file.
    */
@@ -355,6 +368,8 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  AsyncTraceWriter *m_writer;   //!< background writer, if opened with OpenAsync
+  std::ostream   *m_out;        //!< stream written to: m_file, or over m_writer
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
 };
@@ -59,7 +59,7 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
   NS_LOG_FUNCTION (this << p << protocol << to << from << sender);
   for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
     {
-      Ptr<SimpleNetDevice> tmp = *i;
+      const Ptr<SimpleNetDevice> &tmp = *i;
       if (tmp == sender)
         {
           continue;
@@ -72,8 +72,10 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
               continue;
             }
         }
+      // the receiver may run on another thread, see Channel::IsDeepCopyEnabled
+      Ptr<Packet> copy = IsDeepCopyEnabled () ? p->CreateDeepCopy () : p->Copy ();
       Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
-                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                      &SimpleNetDevice::Receive, PeekPointer (tmp), copy, protocol, to, from);
     }
 }
 
@@ -98,6 +100,13 @@ SimpleChannel::GetDevice (uint32_t i) const
   return m_devices[i];
 }
 
+Time
+SimpleChannel::GetMinimumDelay (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_delay;
+}
+
 void
 SimpleChannel::BlackList (Ptr<SimpleNetDevice> from, Ptr<SimpleNetDevice> to)
 {
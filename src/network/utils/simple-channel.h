@@ -96,6 +96,7 @@ public:
   // inherited from ns3::Channel
   virtual uint32_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
+  virtual Time GetMinimumDelay (void) const;
 
 private:
   Time m_delay; //!< The assigned speed-of-light delay of the channel
@@ -97,9 +97,11 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  // the receiver may run on another thread, see Channel::IsDeepCopyEnabled
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+                                  PeekPointer (m_link[wire].m_dst),
+                                  IsDeepCopyEnabled () ? p->CreateDeepCopy () : p);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
@@ -128,6 +130,13 @@ PointToPointChannel::GetDevice (uint32_t i) const
   return GetPointToPointDevice (i);
 }
 
+Time
+PointToPointChannel::GetMinimumDelay (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_delay;
+}
+
 Time
 PointToPointChannel::GetDelay (void) const
 {
@@ -100,6 +100,13 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
+  /**
+   * \brief Get the minimum delay between a transmission and its
+   * reception, i.e., the propagation delay
+   * \returns Time delay
+   */
+  virtual Time GetMinimumDelay (void) const;
+
 protected:
   /**
    * \brief Get the delay associated with this channel
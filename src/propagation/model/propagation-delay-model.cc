@@ -19,9 +19,12 @@
  */
 #include "propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -41,6 +44,42 @@ PropagationDelayModel::~PropagationDelayModel ()
 {
 }
 
+Time
+PropagationDelayModel::GetMinimumDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  return Seconds (0);
+}
+
+Time
+PropagationDelayModel::GetMinimumDelayBetweenGroups (const std::vector<Ptr<MobilityModel> > &mobility,
+                                                     const std::vector<uint32_t> &groups) const
+{
+  NS_ASSERT (mobility.size () == groups.size ());
+  Time delay = Time::Max ();
+  for (uint32_t i = 0; i < mobility.size (); i++)
+    {
+      for (uint32_t j = i + 1; j < mobility.size (); j++)
+        {
+          if (groups[i] == groups[j])
+            {
+              continue;
+            }
+          if (mobility[i] == 0 || mobility[j] == 0)
+            {
+              return Seconds (0);
+            }
+          // the delay may not be symmetric
+          delay = std::min (delay, std::min (GetMinimumDelay (mobility[i], mobility[j]),
+                                             GetMinimumDelay (mobility[j], mobility[i])));
+          if (delay.IsZero ())
+            {
+              return delay;
+            }
+        }
+    }
+  return delay;
+}
+
 int64_t
 PropagationDelayModel::AssignStreams (int64_t stream)
 {
@@ -113,6 +152,68 @@ ConstantSpeedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<Mobility
   double seconds = distance / m_speed;
   return Seconds (seconds);
 }
+Time
+ConstantSpeedPropagationDelayModel::GetMinimumDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  // other mobility models may bring the nodes arbitrarily close
+  if (DynamicCast<ConstantPositionMobilityModel> (a) == 0
+      || DynamicCast<ConstantPositionMobilityModel> (b) == 0)
+    {
+      return Seconds (0);
+    }
+  return GetDelay (a, b);
+}
+Time
+ConstantSpeedPropagationDelayModel::GetMinimumDelayBetweenGroups (const std::vector<Ptr<MobilityModel> > &mobility,
+                                                                  const std::vector<uint32_t> &groups) const
+{
+  NS_ASSERT (mobility.size () == groups.size ());
+  // cache the positions of the fixed nodes
+  std::vector<Vector> positions;
+  std::vector<uint32_t> positionGroups;
+  bool moving = false;
+  bool severalGroups = false;
+  for (uint32_t i = 0; i < mobility.size (); i++)
+    {
+      severalGroups = severalGroups || groups[i] != groups[0];
+      if (DynamicCast<ConstantPositionMobilityModel> (mobility[i]) == 0)
+        {
+          moving = true;
+          continue;
+        }
+      positions.push_back (mobility[i]->GetPosition ());
+      positionGroups.push_back (groups[i]);
+    }
+  if (!severalGroups)
+    {
+      return Time::Max ();
+    }
+  if (moving)
+    {
+      // a node may come arbitrarily close to a node of another group
+      return Seconds (0);
+    }
+  double minDistanceSquared = -1;
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      for (uint32_t j = i + 1; j < positions.size (); j++)
+        {
+          if (positionGroups[i] == positionGroups[j])
+            {
+              continue;
+            }
+          double dx = positions[i].x - positions[j].x;
+          double dy = positions[i].y - positions[j].y;
+          double dz = positions[i].z - positions[j].z;
+          double distanceSquared = dx * dx + dy * dy + dz * dz;
+          if (minDistanceSquared < 0 || distanceSquared < minDistanceSquared)
+            {
+              minDistanceSquared = distanceSquared;
+            }
+        }
+    }
+  return Seconds (std::sqrt (minDistanceSquared) / m_speed);
+}
 void
 ConstantSpeedPropagationDelayModel::SetSpeed (double speed)
 {
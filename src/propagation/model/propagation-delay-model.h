@@ -20,6 +20,7 @@
 #ifndef PROPAGATION_DELAY_MODEL_H
 #define PROPAGATION_DELAY_MODEL_H
 
+#include <vector>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
@@ -52,6 +53,31 @@ public:
    * source and destination.
    */
   virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const = 0;
+  /**
+   * \param a the source
+   * \param b the destination
+   * \returns a lower bound of the propagation delay between the
+   * specified source and destination for the rest of the simulation
+   *
+   * Channels use this bound as the lookahead between nodes simulated
+   * in parallel.  The default, zero, is always safe.
+   */
+  virtual Time GetMinimumDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \param mobility the mobility models of a set of nodes, null for the
+   * nodes without mobility model
+   * \param groups the group of each node
+   * \returns a lower bound of the propagation delay between nodes of
+   * different groups for the rest of the simulation, or Time::Max () if
+   * all the nodes are in the same group
+   *
+   * Channels use this bound as the lookahead between groups of nodes
+   * simulated in parallel.  The default returns the smallest
+   * GetMinimumDelay (a, b) between the nodes of different groups, and
+   * zero for the nodes without mobility model.
+   */
+  virtual Time GetMinimumDelayBetweenGroups (const std::vector<Ptr<MobilityModel> > &mobility,
+                                             const std::vector<uint32_t> &groups) const;
   /**
    * If this delay model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -114,6 +140,28 @@ public:
    */
   ConstantSpeedPropagationDelayModel ();
   virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \param a the source
+   * \param b the destination
+   * \returns the propagation delay if both nodes have a
+   * ConstantPositionMobilityModel, zero otherwise.
+   *
+   * The positions of the nodes with a ConstantPositionMobilityModel
+   * must not be changed during the simulation.
+   */
+  virtual Time GetMinimumDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \param mobility the mobility models of a set of nodes
+   * \param groups the group of each node
+   * \returns the propagation delay over the smallest distance between
+   * nodes of different groups with a ConstantPositionMobilityModel, or
+   * zero if a node of another group has another mobility model.
+   *
+   * The positions are read once, so the cost is dominated by the
+   * distance computations between the pairs of nodes.
+   */
+  virtual Time GetMinimumDelayBetweenGroups (const std::vector<Ptr<MobilityModel> > &mobility,
+                                             const std::vector<uint32_t> &groups) const;
   /**
    * \param speed the new speed (m/s)
    */
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/simulator.h"
+#include <vector>
+
+using namespace ns3;
+
+class ConstantSpeedPropagationDelayModelTestCase : public TestCase
+{
+public:
+  ConstantSpeedPropagationDelayModelTestCase ();
+  virtual ~ConstantSpeedPropagationDelayModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ConstantSpeedPropagationDelayModelTestCase::ConstantSpeedPropagationDelayModelTestCase ()
+  : TestCase ("Test ConstantSpeedPropagationDelayModel minimum delay")
+{
+}
+
+ConstantSpeedPropagationDelayModelTestCase::~ConstantSpeedPropagationDelayModelTestCase ()
+{
+}
+
+void
+ConstantSpeedPropagationDelayModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0,0,0));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (3000,0,0));
+  Ptr<ConstantVelocityMobilityModel> c = CreateObject<ConstantVelocityMobilityModel> ();
+  c->SetPosition (Vector (3000,0,0));
+
+  Ptr<ConstantSpeedPropagationDelayModel> delayModel = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  delayModel->SetSpeed (3e8);
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetDelay (a, b), MicroSeconds (10), "Got unexpected delay");
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetMinimumDelay (a, b), MicroSeconds (10),
+                         "Got unexpected minimum delay between fixed nodes");
+  // a moving node may come arbitrarily close
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetDelay (a, c), MicroSeconds (10), "Got unexpected delay");
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetMinimumDelay (a, c), Seconds (0),
+                         "Got unexpected minimum delay to a moving node");
+
+  // the closest nodes of different groups are b and d
+  Ptr<MobilityModel> d = CreateObject<ConstantPositionMobilityModel> ();
+  d->SetPosition (Vector (1000,0,0));
+  std::vector<Ptr<MobilityModel> > mobility;
+  std::vector<uint32_t> groups;
+  mobility.push_back (a);
+  groups.push_back (0);
+  mobility.push_back (b);
+  groups.push_back (1);
+  mobility.push_back (d);
+  groups.push_back (0);
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetMinimumDelayBetweenGroups (mobility, groups),
+                         delayModel->GetDelay (b, d), "Got unexpected minimum delay between groups");
+  groups[1] = 0;
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetMinimumDelayBetweenGroups (mobility, groups), Time::Max (),
+                         "Got unexpected minimum delay within a group");
+  mobility.push_back (c);
+  groups.push_back (1);
+  NS_TEST_EXPECT_MSG_EQ (delayModel->GetMinimumDelayBetweenGroups (mobility, groups), Seconds (0),
+                         "Got unexpected minimum delay to a moving node of another group");
+  Simulator::Destroy ();
+}
+
+class PropagationDelayModelsTestSuite : public TestSuite
+{
+public:
+  PropagationDelayModelsTestSuite ();
+};
+
+PropagationDelayModelsTestSuite::PropagationDelayModelsTestSuite ()
+  : TestSuite ("propagation-delay-model", UNIT)
+{
+  AddTestCase (new ConstantSpeedPropagationDelayModelTestCase, TestCase::QUICK);
+}
+
+static PropagationDelayModelsTestSuite propagationDelayModelsTestSuite;
@@ -96,6 +96,13 @@ FriisSpectrumPropagationLossModel::CalculateLoss (double f, double d) const
 }
 
 
+bool
+FriisSpectrumPropagationLossModel::DoIsStatic (void) const
+{
+  return true;
+}
+
+
 
 
 
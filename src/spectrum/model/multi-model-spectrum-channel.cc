@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -76,6 +77,7 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_spectrumGainCacheEnabled (true)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -89,6 +91,14 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  for (std::set<Ptr<MobilityModel> >::iterator it = m_trackedMobilitySet.begin ();
+       it != m_trackedMobilitySet.end ();
+       ++it)
+    {
+      (*it)->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  m_trackedMobilitySet.clear ();
+  m_spectrumGainCache.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -113,6 +123,17 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SpectrumGainCache",
+                   "If true, the gains per band of the "
+                   "SpectrumPropagationLossModel are computed only once "
+                   "for the links between two mobility models which do "
+                   "not move, when the model is static.  The gains are "
+                   "computed again after a course change of either "
+                   "mobility model.  The cache is not used while the "
+                   "channels hand over deep copies to parallel partitions.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_spectrumGainCacheEnabled),
+                   MakeBooleanChecker ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -340,7 +361,15 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
                   if (m_spectrumPropagationLoss)
                     {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+                      Ptr<const SpectrumValue> gain = GetSpectrumGain (txMobility, receiverMobility, rxInfoIterator->second.m_rxSpectrumModel);
+                      if (gain != 0)
+                        {
+                          *(rxParams->psd) *= *gain;
+                        }
+                      else
+                        {
+                          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+                        }
                     }
 
                   if (m_propagationDelay)
@@ -377,6 +406,70 @@ MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<Sp
   receiver->StartRx (params);
 }
 
+Ptr<const SpectrumValue>
+MultiModelSpectrumChannel::GetSpectrumGain (Ptr<MobilityModel> txMobility,
+                                            Ptr<MobilityModel> rxMobility,
+                                            Ptr<const SpectrumModel> rxSpectrumModel)
+{
+  NS_LOG_FUNCTION (this << txMobility << rxMobility << rxSpectrumModel);
+  // while the channels hand over deep copies, the partitions of a
+  // parallel simulator may transmit concurrently: the cache, and the
+  // gains it shares, must not be used
+  if (!m_spectrumGainCacheEnabled || IsDeepCopyEnabled () || !m_spectrumPropagationLoss->IsStatic ())
+    {
+      return 0;
+    }
+  // a moving node changes position without notifying a course change
+  Vector txVelocity = txMobility->GetVelocity ();
+  Vector rxVelocity = rxMobility->GetVelocity ();
+  if (txVelocity.x != 0 || txVelocity.y != 0 || txVelocity.z != 0
+      || rxVelocity.x != 0 || rxVelocity.y != 0 || rxVelocity.z != 0)
+    {
+      return 0;
+    }
+  std::pair<Ptr<const MobilityModel>, SpectrumModelUid_t> key (rxMobility, rxSpectrumModel->GetUid ());
+  SpectrumGainMap_t &gainMap = m_spectrumGainCache[txMobility];
+  SpectrumGainMap_t::const_iterator it = gainMap.find (key);
+  if (it != gainMap.end ())
+    {
+      return it->second;
+    }
+  NS_LOG_LOGIC ("computing the gains between " << txMobility << " and " << rxMobility);
+  Ptr<SpectrumValue> unit = Create<SpectrumValue> (rxSpectrumModel);
+  *unit = 1.0;
+  Ptr<const SpectrumValue> gain = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (unit, txMobility, rxMobility);
+  gainMap.insert (std::make_pair (key, gain));
+  if (m_trackedMobilitySet.insert (txMobility).second)
+    {
+      txMobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  if (m_trackedMobilitySet.insert (rxMobility).second)
+    {
+      rxMobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  return gain;
+}
+
+void
+MultiModelSpectrumChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  m_spectrumGainCache.erase (mobility);
+  for (SpectrumGainCache_t::iterator it = m_spectrumGainCache.begin ();
+       it != m_spectrumGainCache.end ();
+       ++it)
+    {
+      SpectrumGainMap_t &gainMap = it->second;
+      SpectrumGainMap_t::iterator first = gainMap.lower_bound (std::make_pair (mobility, SpectrumModelUid_t (0)));
+      SpectrumGainMap_t::iterator last = first;
+      while (last != gainMap.end () && last->first.first == mobility)
+        {
+          ++last;
+        }
+      gainMap.erase (first, last);
+    }
+}
+
 
 
 uint32_t
@@ -389,6 +482,13 @@ MultiModelSpectrumChannel::GetNDevices (void) const
 
 Ptr<NetDevice>
 MultiModelSpectrumChannel::GetDevice (uint32_t i) const
+{
+  return GetRxPhy (i)->GetDevice ();
+}
+
+
+Ptr<SpectrumPhy>
+MultiModelSpectrumChannel::GetRxPhy (uint32_t i) const
 {
   NS_ASSERT (i < m_numDevices);
   // this method implementation is computationally intensive. This
@@ -410,7 +510,7 @@ MultiModelSpectrumChannel::GetDevice (uint32_t i) const
         {
           if (j == i)
             {
-              return (*phyIt)->GetDevice ();
+              return *phyIt;
             }
           j++;
         }
@@ -420,7 +520,6 @@ MultiModelSpectrumChannel::GetDevice (uint32_t i) const
 }
 
 
-
 void
 MultiModelSpectrumChannel::AddPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -443,6 +542,13 @@ MultiModelSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel>
   m_propagationDelay = delay;
 }
 
+Ptr<PropagationLossModel>
+MultiModelSpectrumChannel::GetPropagationLossModel (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_propagationLoss;
+}
+
 Ptr<SpectrumPropagationLossModel>
 MultiModelSpectrumChannel::GetSpectrumPropagationLossModel (void)
 {
@@ -68,6 +68,24 @@ public:
 typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap_t;
 
 
+/**
+ * \ingroup spectrum
+ *
+ * The gains per band of the SpectrumPropagationLossModel from a
+ * transmitter, indexed by the mobility model of the receiver and by
+ * the RX SpectrumModel.
+ */
+typedef std::map<std::pair<Ptr<const MobilityModel>, SpectrumModelUid_t>, Ptr<const SpectrumValue> > SpectrumGainMap_t;
+
+/**
+ * \ingroup spectrum
+ *
+ * The gains per band of the static links, indexed by the mobility
+ * model of the transmitter.
+ */
+typedef std::map<Ptr<const MobilityModel>, SpectrumGainMap_t> SpectrumGainCache_t;
+
+
 
 
 /**
@@ -82,6 +100,13 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * When the SpectrumPropagationLossModel is static (see
+ * SpectrumPropagationLossModel::IsStatic), the gains per band between
+ * two mobility models which do not move are computed once and kept
+ * until one of them notifies a course change.  The cache is not used
+ * while Channel::IsDeepCopyEnabled(), since the partitions of a
+ * parallel simulator may then transmit concurrently.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -103,6 +128,7 @@ public:
   virtual uint32_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
+  virtual Ptr<PropagationLossModel> GetPropagationLossModel (void);
   virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void);
 
 
@@ -112,6 +138,12 @@ protected:
 
 
 private:
+  /**
+   * @param i the index of a receiving SpectrumPhy
+   * @return the SpectrumPhy, in the order of GetDevice
+   */
+  Ptr<SpectrumPhy> GetRxPhy (uint32_t i) const;
+
   /**
    * this method checks if m_rxSpectrumModelInfoMap contains an entry
    * for the given TX SpectrumModel. If such entry exists, it returns
@@ -132,6 +164,28 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Look up, or compute and cache, the gains per band of the
+   * SpectrumPropagationLossModel between two mobility models.
+   *
+   * @param txMobility the mobility model of the transmitter
+   * @param rxMobility the mobility model of the receiver
+   * @param rxSpectrumModel the RX SpectrumModel
+   *
+   * @return the gains, or 0 if the link cannot be cached or if
+   * Channel::IsDeepCopyEnabled()
+   */
+  Ptr<const SpectrumValue> GetSpectrumGain (Ptr<MobilityModel> txMobility,
+                                            Ptr<MobilityModel> rxMobility,
+                                            Ptr<const SpectrumModel> rxSpectrumModel);
+
+  /**
+   * Drop the cached gains of the links of a mobility model.
+   *
+   * @param mobility the mobility model whose course changed
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+
 
 
   /**
@@ -169,6 +223,20 @@ private:
    */
   RxSpectrumModelInfoMap_t m_rxSpectrumModelInfoMap;
 
+  /**
+   * the gains per band of the static links
+   *
+   */
+  SpectrumGainCache_t m_spectrumGainCache;
+
+  /**
+   * the mobility models whose course changes are tracked
+   *
+   */
+  std::set<Ptr<MobilityModel> > m_trackedMobilitySet;
+
+  bool m_spectrumGainCacheEnabled;
+
   uint32_t m_numDevices;
 
   double m_maxLossDb;
@@ -231,7 +231,7 @@ Ptr<NetDevice>
 SingleModelSpectrumChannel::GetDevice (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  return m_phyList.at (i)->GetDevice ()->GetObject<NetDevice> ();
+  return m_phyList.at (i)->GetDevice ();
 }
 
 
@@ -261,6 +261,13 @@ SingleModelSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel>
 }
 
 
+Ptr<PropagationLossModel>
+SingleModelSpectrumChannel::GetPropagationLossModel (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_propagationLoss;
+}
+
 Ptr<SpectrumPropagationLossModel>
 SingleModelSpectrumChannel::GetSpectrumPropagationLossModel (void)
 {
@@ -42,6 +42,13 @@ class PropagationDelayModel;
  *
  * Defines the interface for spectrum-aware channel implementations
  *
+ * The spectrum channels do not bound the delay between their devices,
+ * see Channel::GetMinimumDelayBetweenGroups: parallel simulators do
+ * not run devices of the same spectrum channel concurrently.  The
+ * signal parameters handed over to the receivers reference the
+ * transmitting SpectrumPhy and AntennaModel, and the PSDs share their
+ * SpectrumModel with all the devices, whose reference counts are not
+ * atomic.
  */
 class SpectrumChannel : public Channel
 {
@@ -70,6 +77,18 @@ public:
    */
   virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay) = 0;
 
+  /**
+   * \return the single-frequency propagation loss model of the channel,
+   * or 0 if none was set
+   */
+  virtual Ptr<PropagationLossModel> GetPropagationLossModel (void) = 0;
+
+  /**
+   * \return the frequency-dependent propagation loss model of the channel,
+   * or 0 if none was set
+   */
+  virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void) = 0;
+
 
   /**
    * Used by attached PHY instances to transmit signals on the channel
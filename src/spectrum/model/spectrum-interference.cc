@@ -35,6 +35,8 @@ SpectrumInterference::SpectrumInterference ()
     m_rxSignal (0),
     m_allSignals (0),
     m_noise (0),
+    m_interf (0),
+    m_sinr (0),
     m_errorModel (0)
 {
   NS_LOG_FUNCTION (this);
@@ -63,6 +65,8 @@ SpectrumInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_interf = 0;
+  m_sinr = 0;
   m_errorModel = 0;
   Object::DoDispose ();
 }
@@ -74,6 +78,7 @@ SpectrumInterference::StartRx (Ptr<const Packet> p, Ptr<const SpectrumValue> rxP
   m_rxSignal = rxPsd;
   m_lastChangeTime = Now ();
   m_receiving = true;
+  UpdateSinr (0);
   m_errorModel->StartRx (p);
 }
 
@@ -108,6 +113,10 @@ SpectrumInterference::DoAddSignal  (Ptr<const SpectrumValue> spd)
   NS_LOG_FUNCTION (this << *spd);
   ConditionallyEvaluateChunk ();
   (*m_allSignals) += (*spd);
+  if (m_receiving)
+    {
+      UpdateSinr (spd);
+    }
   m_lastChangeTime = Now ();
 }
 
@@ -117,6 +126,10 @@ SpectrumInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd)
   NS_LOG_FUNCTION (this << *spd);
   ConditionallyEvaluateChunk ();
   (*m_allSignals) -= (*spd);
+  if (m_receiving)
+    {
+      UpdateSinr (spd);
+    }
   m_lastChangeTime = Now ();
 }
 
@@ -131,10 +144,9 @@ SpectrumInterference::ConditionallyEvaluateChunk ()
   NS_LOG_LOGIC ("if condition: " << condition);
   if (condition)
     {
-      SpectrumValue sinr = (*m_rxSignal) / ((*m_allSignals) - (*m_rxSignal) + (*m_noise));
       Time duration = Now () - m_lastChangeTime;
       NS_LOG_LOGIC ("calling m_errorModel->EvaluateChunk (sinr, duration)");
-      m_errorModel->EvaluateChunk (sinr, duration);
+      m_errorModel->EvaluateChunk (*m_sinr, duration);
     }
 }
 
@@ -148,6 +160,44 @@ SpectrumInterference::SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noi
   // we'll now create a zeroed SpectrumValue using the same
   // SpectrumModel which is being specified for the noise.
   m_allSignals = Create<SpectrumValue> (noisePsd->GetSpectrumModel ());
+  if (m_receiving)
+    {
+      UpdateSinr (0);
+    }
+}
+
+void
+SpectrumInterference::UpdateSinr (Ptr<const SpectrumValue> spd)
+{
+  NS_LOG_FUNCTION (this);
+  if (spd == 0)
+    {
+      m_interf = m_allSignals->Copy ();
+      (*m_interf) -= (*m_rxSignal);
+      (*m_interf) += (*m_noise);
+      m_sinr = m_rxSignal->Copy ();
+      (*m_sinr) /= (*m_interf);
+      return;
+    }
+  // same operations as above, restricted to the bands of the signal
+  NS_ASSERT (spd->GetSpectrumModel () == m_interf->GetSpectrumModel ());
+  Values::const_iterator signal = spd->ConstValuesBegin ();
+  Values::const_iterator all = m_allSignals->ConstValuesBegin ();
+  Values::const_iterator rx = m_rxSignal->ConstValuesBegin ();
+  Values::const_iterator noise = m_noise->ConstValuesBegin ();
+  Values::iterator interf = m_interf->ValuesBegin ();
+  Values::iterator sinr = m_sinr->ValuesBegin ();
+  for (; signal != spd->ConstValuesEnd (); ++signal, ++all, ++rx, ++noise, ++interf, ++sinr)
+    {
+      if (*signal != 0)
+        {
+          double value = *all;
+          value -= *rx;
+          value += *noise;
+          *interf = value;
+          *sinr = *rx / value;
+        }
+    }
 }
 
 void
@@ -42,6 +42,10 @@ class SpectrumErrorModel;
  * This class implements a gaussian interference model, i.e., all
  * incoming signals are added to the total interference.
  *
+ * During a RX attempt, the interference and the SINR are kept up to
+ * date incrementally: a new or ending signal only updates the bands
+ * where its power spectral density is not zero.
+ *
  */
 class SpectrumInterference : public Object
 {
@@ -115,6 +119,13 @@ private:
   void ConditionallyEvaluateChunk ();
   void DoAddSignal  (Ptr<const SpectrumValue> spd);
   void DoSubtractSignal  (Ptr<const SpectrumValue> spd);
+  /**
+   * Compute again the interference and the SINR of the RX attempt.
+   *
+   * @param spd if not 0, the interference and the SINR are only
+   * computed at the bands where spd is not zero
+   */
+  void UpdateSinr (Ptr<const SpectrumValue> spd);
 
 
 
@@ -132,6 +143,13 @@ private:
 
   Ptr<const SpectrumValue> m_noise;
 
+  Ptr<SpectrumValue> m_interf; /**< stores the power spectral density of
+                                * the interference plus noise perceived
+                                * by the signal being RX
+                                */
+
+  Ptr<SpectrumValue> m_sinr; /**< stores the SINR of the signal being RX */
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
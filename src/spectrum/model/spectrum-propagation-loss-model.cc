@@ -73,4 +73,16 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+bool
+SpectrumPropagationLossModel::IsStatic (void) const
+{
+  return DoIsStatic () && (m_next == 0 || m_next->IsStatic ());
+}
+
+bool
+SpectrumPropagationLossModel::DoIsStatic (void) const
+{
+  return false;
+}
+
 } // namespace ns3
@@ -75,6 +75,17 @@ public:
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const;
 
+  /**
+   * A SpectrumChannel may compute the received PSD of the static links
+   * only once, as the product of the transmitted PSD by a gain per
+   * band, if the loss models allow it.
+   *
+   * @return true if this model and the chained models are static, i.e.,
+   * the received PSD is the transmitted PSD multiplied by a gain per
+   * band which depends only on the positions of the two mobility models
+   */
+  bool IsStatic (void) const;
+
 protected:
   virtual void DoDispose ();
 
@@ -95,6 +106,12 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * @return true if this model is static, see IsStatic. The default
+   * implementation returns false.
+   */
+  virtual bool DoIsStatic (void) const;
+
   Ptr<SpectrumPropagationLossModel> m_next;
 };
 
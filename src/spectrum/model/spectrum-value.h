@@ -53,6 +53,12 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * Every binary operator returns a new SpectrumValue. In a chain of
+ * operations evaluated often, such as a SINR computation, prefer the
+ * compound assignment operators on a single copy: they update the
+ * values in place, in a single loop per operation, without allocating
+ * the temporaries.
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
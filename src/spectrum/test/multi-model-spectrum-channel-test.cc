@@ -0,0 +1,422 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/core-config.h>
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/object-factory.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/net-device.h>
+#include <ns3/node-container.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/simple-net-device-helper.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/friis-spectrum-propagation-loss.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/multithreaded-simulator-impl.h>
+#endif /* HAVE_PTHREAD_H */
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum
+ *
+ * A SpectrumPhy which records the PSD of the received signals.
+ */
+class RecordingSpectrumPhy : public SpectrumPhy
+{
+public:
+  RecordingSpectrumPhy (Ptr<const SpectrumModel> model);
+
+  virtual void SetDevice (Ptr<NetDevice> d);
+  virtual Ptr<NetDevice> GetDevice () const;
+  virtual void SetMobility (Ptr<MobilityModel> m);
+  virtual Ptr<MobilityModel> GetMobility ();
+  virtual void SetChannel (Ptr<SpectrumChannel> c);
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  virtual Ptr<AntennaModel> GetRxAntenna ();
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params);
+
+  /// the PSD of the last received signal
+  Ptr<const SpectrumValue> m_rxPsd;
+  /// the number of received signals
+  uint32_t m_nRx;
+
+private:
+  Ptr<const SpectrumModel> m_model;
+  Ptr<MobilityModel> m_mobility;
+  Ptr<NetDevice> m_device;
+};
+
+RecordingSpectrumPhy::RecordingSpectrumPhy (Ptr<const SpectrumModel> model)
+  : m_nRx (0),
+    m_model (model)
+{
+}
+
+void
+RecordingSpectrumPhy::SetDevice (Ptr<NetDevice> d)
+{
+  m_device = d;
+}
+
+Ptr<NetDevice>
+RecordingSpectrumPhy::GetDevice () const
+{
+  return m_device;
+}
+
+void
+RecordingSpectrumPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+RecordingSpectrumPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+RecordingSpectrumPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+RecordingSpectrumPhy::GetRxSpectrumModel () const
+{
+  return m_model;
+}
+
+Ptr<AntennaModel>
+RecordingSpectrumPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+RecordingSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  m_rxPsd = params->psd;
+  m_nRx++;
+}
+
+/**
+ * \returns the spectrum model of the tests: 25 bands of 180 kHz at 2.1 GHz
+ */
+static Ptr<SpectrumModel>
+CreateTestSpectrumModel (void)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < 25; i++)
+    {
+      freqs.push_back (2.1e9 + 180e3 * i);
+    }
+  return Create<SpectrumModel> (freqs);
+}
+
+/**
+ * \param model the spectrum model of the signal
+ * \param txPhy the transmitter
+ * \returns a signal with a different PSD in each band
+ */
+static Ptr<SpectrumSignalParameters>
+CreateTestSignal (Ptr<const SpectrumModel> model, Ptr<SpectrumPhy> txPhy)
+{
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->txPhy = txPhy;
+  params->duration = MilliSeconds (1);
+  params->psd = Create<SpectrumValue> (model);
+  for (uint32_t i = 0; i < model->GetNumBands (); i++)
+    {
+      (*params->psd)[i] = 1e-3 * (i + 1);
+    }
+  return params;
+}
+
+
+/**
+ * \ingroup spectrum
+ *
+ * Check that the PSD received through a MultiModelSpectrumChannel with
+ * a Friis model matches the Friis loss at the current distance, with
+ * the gains cached or not, and after the receiver moved.
+ */
+class MultiModelSpectrumChannelGainTestCase : public TestCase
+{
+public:
+  /**
+   * \param cache whether the channel caches the gains of the static links
+   * \param moving whether the receiver has a constant, non-zero velocity
+   */
+  MultiModelSpectrumChannelGainTestCase (bool cache, bool moving);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Transmit a signal and check the received PSD.
+   * \param distance the distance between the transmitter and the receiver
+   */
+  void CheckRx (double distance);
+
+  bool m_cache;
+  bool m_moving;
+  Ptr<SpectrumModel> m_model;
+  Ptr<MultiModelSpectrumChannel> m_channel;
+  Ptr<RecordingSpectrumPhy> m_txPhy;
+  Ptr<RecordingSpectrumPhy> m_rxPhy;
+};
+
+MultiModelSpectrumChannelGainTestCase::MultiModelSpectrumChannelGainTestCase (bool cache, bool moving)
+  : TestCase (std::string ("Friis gains, cache: ") + (cache ? "on" : "off")
+              + (moving ? ", moving receiver" : ", static receiver")),
+    m_cache (cache),
+    m_moving (moving)
+{
+}
+
+void
+MultiModelSpectrumChannelGainTestCase::CheckRx (double distance)
+{
+  Ptr<SpectrumSignalParameters> params = CreateTestSignal (m_model, m_txPhy);
+  m_rxPhy->m_rxPsd = 0;
+  m_channel->StartTx (params);
+  Simulator::Stop (Seconds (0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_NE (m_rxPhy->m_rxPsd, 0, "no signal received");
+
+  Ptr<FriisSpectrumPropagationLossModel> friis = CreateObject<FriisSpectrumPropagationLossModel> ();
+  Bands::const_iterator band = m_model->Begin ();
+  for (uint32_t i = 0; i < m_model->GetNumBands (); i++, band++)
+    {
+      double expected = (*params->psd)[i] / friis->CalculateLoss (band->fc, distance);
+      double rx = (*m_rxPhy->m_rxPsd)[i];
+      NS_TEST_ASSERT_MSG_EQ_TOL (rx, expected, expected * 1e-9, "wrong received PSD in band " << i);
+    }
+}
+
+void
+MultiModelSpectrumChannelGainTestCase::DoRun (void)
+{
+  m_model = CreateTestSpectrumModel ();
+
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+  m_channel->SetAttribute ("SpectrumGainCache", BooleanValue (m_cache));
+  m_channel->AddSpectrumPropagationLossModel (CreateObject<FriisSpectrumPropagationLossModel> ());
+
+  Ptr<MobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txMobility->SetPosition (Vector (0, 0, 0));
+  Ptr<MobilityModel> rxMobility;
+  if (m_moving)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (100, 0, 0));
+      mobility->SetVelocity (Vector (10, 0, 0));
+      rxMobility = mobility;
+    }
+  else
+    {
+      rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+      rxMobility->SetPosition (Vector (100, 0, 0));
+    }
+
+  m_txPhy = CreateObject<RecordingSpectrumPhy> (m_model);
+  m_txPhy->SetMobility (txMobility);
+  m_rxPhy = CreateObject<RecordingSpectrumPhy> (m_model);
+  m_rxPhy->SetMobility (rxMobility);
+  m_channel->AddRx (m_txPhy);
+  m_channel->AddRx (m_rxPhy);
+
+  CheckRx (100);
+  CheckRx (100);
+  if (m_moving)
+    {
+      // the position changes without course change
+      Simulator::Stop (Seconds (5));
+      Simulator::Run ();
+      CheckRx (150);
+    }
+  else
+    {
+      rxMobility->SetPosition (Vector (300, 0, 0));
+      CheckRx (300);
+      txMobility->SetPosition (Vector (200, 0, 0));
+      CheckRx (100);
+    }
+
+  m_channel->Dispose ();
+  m_txPhy = 0;
+  m_rxPhy = 0;
+  Simulator::Destroy ();
+}
+
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup spectrum
+ *
+ * Check the PSD received through a MultiModelSpectrumChannel which
+ * caches the gains, with the nodes simulated by a
+ * MultithreadedSimulatorImpl with two partitions: either one node in
+ * each partition, in which case the channel gives no lookahead and the
+ * partitions run on the main thread, or both nodes in the same
+ * partition, run by a worker thread while the channels hand over deep
+ * copies.
+ */
+class MultiModelSpectrumChannelPartitionsTestCase : public TestCase
+{
+public:
+  /**
+   * \param samePartition whether both nodes are in the same partition
+   */
+  MultiModelSpectrumChannelPartitionsTestCase (bool samePartition);
+  virtual void DoRun (void);
+
+private:
+  /// Transmit a signal from the first node.
+  void Transmit (void);
+
+  static const uint32_t N_SIGNALS = 10; //!< number of signals transmitted
+
+  bool m_samePartition;
+  Ptr<SpectrumModel> m_model;
+  Ptr<MultiModelSpectrumChannel> m_channel;
+  Ptr<RecordingSpectrumPhy> m_txPhy;
+  Ptr<RecordingSpectrumPhy> m_rxPhy;
+};
+
+MultiModelSpectrumChannelPartitionsTestCase::MultiModelSpectrumChannelPartitionsTestCase (bool samePartition)
+  : TestCase (samePartition ? "Friis gains cached, nodes in the same partition" :
+              "Friis gains cached, nodes in different partitions"),
+    m_samePartition (samePartition)
+{
+}
+
+void
+MultiModelSpectrumChannelPartitionsTestCase::Transmit (void)
+{
+  m_channel->StartTx (CreateTestSignal (m_model, m_txPhy));
+}
+
+void
+MultiModelSpectrumChannelPartitionsTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("Threads", UintegerValue (2));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  m_model = CreateTestSpectrumModel ();
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+  m_channel->SetAttribute ("SpectrumGainCache", BooleanValue (true));
+  m_channel->AddSpectrumPropagationLossModel (CreateObject<FriisSpectrumPropagationLossModel> ());
+  m_channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<RecordingSpectrumPhy> phys[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      nodes.Get (i)->AddDevice (device);
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (100.0 * i, 0, 0));
+      phys[i] = CreateObject<RecordingSpectrumPhy> (m_model);
+      phys[i]->SetDevice (device);
+      phys[i]->SetMobility (mobility);
+      m_channel->AddRx (phys[i]);
+      impl->SetPartition (nodes.Get (i)->GetId (), m_samePartition ? 1 : i);
+    }
+  m_txPhy = phys[0];
+  m_rxPhy = phys[1];
+
+  NodeContainer others;
+  if (m_samePartition)
+    {
+      // two other nodes, connected across the partitions, so that the
+      // partitions run on their own thread
+      others.Create (2);
+      SimpleNetDeviceHelper helper;
+      helper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      helper.Install (others);
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          impl->SetPartition (others.Get (i)->GetId (), i);
+        }
+    }
+
+  for (uint32_t i = 0; i < N_SIGNALS; i++)
+    {
+      Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), MicroSeconds (100 * (i + 1)),
+                                      &MultiModelSpectrumChannelPartitionsTestCase::Transmit, this);
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), m_samePartition ? MilliSeconds (1) : Seconds (0),
+                         "Unexpected lookahead");
+  NS_TEST_ASSERT_MSG_EQ (m_rxPhy->m_nRx, N_SIGNALS, "Unexpected number of signals received");
+  Ptr<SpectrumSignalParameters> params = CreateTestSignal (m_model, m_txPhy);
+  Ptr<FriisSpectrumPropagationLossModel> friis = CreateObject<FriisSpectrumPropagationLossModel> ();
+  Bands::const_iterator band = m_model->Begin ();
+  for (uint32_t i = 0; i < m_model->GetNumBands (); i++, band++)
+    {
+      double expected = (*params->psd)[i] / friis->CalculateLoss (band->fc, 100);
+      double rx = (*m_rxPhy->m_rxPsd)[i];
+      NS_TEST_ASSERT_MSG_EQ_TOL (rx, expected, expected * 1e-9, "wrong received PSD in band " << i);
+    }
+
+  m_channel->Dispose ();
+  m_txPhy = 0;
+  m_rxPhy = 0;
+  Simulator::Destroy ();
+}
+#endif /* HAVE_PTHREAD_H */
+
+
+/**
+ * \ingroup spectrum
+ *
+ * MultiModelSpectrumChannel test suite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumChannelGainTestCase (false, false), TestCase::QUICK);
+  AddTestCase (new MultiModelSpectrumChannelGainTestCase (true, false), TestCase::QUICK);
+  AddTestCase (new MultiModelSpectrumChannelGainTestCase (true, true), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new MultiModelSpectrumChannelPartitionsTestCase (false), TestCase::QUICK);
+  AddTestCase (new MultiModelSpectrumChannelPartitionsTestCase (true), TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
+}
+
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite;
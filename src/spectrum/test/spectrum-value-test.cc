@@ -25,6 +25,7 @@
 #include <ns3/test.h>
 #include <iostream>
 #include <cmath>
+#include <ctime>
 
 #include "spectrum-test.h"
 
@@ -336,6 +337,85 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 
 
 
+class SpectrumValueSinrTimeTestCase : public TestCase
+{
+public:
+  /**
+   * \param bands the number of bands of the values
+   */
+  SpectrumValueSinrTimeTestCase (uint32_t bands);
+  virtual void DoRun (void);
+
+private:
+  uint32_t m_bands;
+};
+
+SpectrumValueSinrTimeTestCase::SpectrumValueSinrTimeTestCase (uint32_t bands)
+  : TestCase ("Measure the SINR computation time with operators and compound assignments"),
+    m_bands (bands)
+{
+}
+
+void
+SpectrumValueSinrTimeTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < m_bands; i++)
+    {
+      freqs.push_back (2.1e9 + 180e3 * i);
+    }
+  Ptr<SpectrumModel> sm = Create<SpectrumModel> (freqs);
+  SpectrumValue signal (sm), all (sm), noise (sm);
+  for (uint32_t i = 0; i < m_bands; i++)
+    {
+      signal[i] = 1e-15 * (i + 1);
+      all[i] = 3e-15 * (i + 1);
+      noise[i] = 1e-17;
+    }
+
+  const uint32_t iterations = 100000;
+  double check = 0;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      SpectrumValue sinr = signal / (all - signal + noise);
+      check += sinr[0];
+    }
+  clock_t middle = clock ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      SpectrumValue interf = all;
+      interf -= signal;
+      interf += noise;
+      SpectrumValue sinr = signal;
+      sinr /= interf;
+      check -= sinr[0];
+    }
+  clock_t stop = clock ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (check, 0, TOLERANCE, "Different SINR");
+
+  std::cout << "SpectrumValue SINR time: bands: " << m_bands
+            << " operators: " << 1e6 * (middle - start) / CLOCKS_PER_SEC / iterations << " us"
+            << " compound assignments: " << 1e6 * (stop - middle) / CLOCKS_PER_SEC / iterations << " us"
+            << std::endl;
+}
+
+class SpectrumValuePerformanceTestSuite : public TestSuite
+{
+public:
+  SpectrumValuePerformanceTestSuite ();
+};
+
+SpectrumValuePerformanceTestSuite::SpectrumValuePerformanceTestSuite ()
+  : TestSuite ("spectrum-value-perf", PERFORMANCE)
+{
+  AddTestCase (new SpectrumValueSinrTimeTestCase (6), TestCase::QUICK);
+  AddTestCase (new SpectrumValueSinrTimeTestCase (100), TestCase::QUICK);
+}
+
+
+
 // static instance of test suites
 static SpectrumValueTestSuite g_SpectrumValueTestSuite;
 static SpectrumConverterTestSuite g_SpectrumConverterTestSuite;
+static SpectrumValuePerformanceTestSuite g_SpectrumValuePerformanceTestSuite;
@@ -27,6 +27,7 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/ampdu-subframe-header.h"
+#include "ns3/wifi-mac-header.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/radiotap-header.h"
 #include "ns3/pcap-file-wrapper.h"
@@ -50,7 +51,7 @@ AsciiPhyTransmitSinkWithContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << context << p << mode << preamble << txLevel);
-  *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 static void
@@ -62,7 +63,7 @@ AsciiPhyTransmitSinkWithoutContext (
   uint8_t txLevel)
 {
   NS_LOG_FUNCTION (stream << p << mode << preamble << txLevel);
-  *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 static void
@@ -75,7 +76,7 @@ AsciiPhyReceiveSinkWithContext (
   enum WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << context << p << snr << mode << preamble);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << '\n';
 }
 
 static void
@@ -87,7 +88,7 @@ AsciiPhyReceiveSinkWithoutContext (
   enum WifiPreamble preamble)
 {
   NS_LOG_FUNCTION (stream << p << snr << mode << preamble);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << '\n';
 }
 
 YansWifiChannelHelper::YansWifiChannelHelper ()
@@ -182,7 +183,8 @@ YansWifiChannelHelper::AssignStreams (Ptr<YansWifiChannel> c, int64_t stream)
 
 YansWifiPhyHelper::YansWifiPhyHelper ()
   : m_channel (0),
-    m_pcapDlt (PcapHelper::DLT_IEEE802_11)
+    m_pcapDlt (PcapHelper::DLT_IEEE802_11),
+    m_pcapCaptureSize (std::numeric_limits<uint32_t>::max ())
 {
   m_phy.SetTypeId ("ns3::YansWifiPhy");
 }
@@ -248,9 +250,79 @@ YansWifiPhyHelper::Create (Ptr<Node> node, Ptr<NetDevice> device) const
   return phy;
 }
 
+/**
+ * \brief A pcap file of a wifi device, with the filter deciding which
+ * frames are written to it.
+ */
+class WifiPcapSink : public SimpleRefCount<WifiPcapSink>
+{
+public:
+  /**
+   * \param file the pcap file
+   * \param filter the filter, or a null callback to write all frames
+   * \param nodeId the id of the node of the traced device
+   */
+  WifiPcapSink (Ptr<PcapFileWrapper> file,
+                YansWifiPhyHelper::PcapFilterCallback filter,
+                uint32_t nodeId);
+  /**
+   * Evaluate the filter on a frame, before anything is serialized.
+   *
+   * \param packet the frame
+   * \param aggregated true if the frame starts with an A-MPDU subframe header
+   * \returns true if the frame must be written to the file
+   */
+  bool Accept (Ptr<const Packet> packet, bool aggregated) const;
+  /**
+   * \returns the pcap file
+   */
+  Ptr<PcapFileWrapper> GetFile (void) const;
+
+private:
+  Ptr<PcapFileWrapper> m_file;                   //!< the pcap file
+  YansWifiPhyHelper::PcapFilterCallback m_filter; //!< the frame filter
+  uint32_t m_nodeId;                             //!< the node id passed to the filter
+};
+
+WifiPcapSink::WifiPcapSink (Ptr<PcapFileWrapper> file,
+                            YansWifiPhyHelper::PcapFilterCallback filter,
+                            uint32_t nodeId)
+  : m_file (file),
+    m_filter (filter),
+    m_nodeId (nodeId)
+{
+}
+
+bool
+WifiPcapSink::Accept (Ptr<const Packet> packet, bool aggregated) const
+{
+  if (m_filter.IsNull ())
+    {
+      return true;
+    }
+  WifiMacHeader hdr;
+  if (aggregated)
+    {
+      AmpduSubframeHeader subframeHdr;
+      uint32_t size = packet->PeekHeader (subframeHdr);
+      packet->CreateFragment (size, packet->GetSize () - size)->PeekHeader (hdr);
+    }
+  else
+    {
+      packet->PeekHeader (hdr);
+    }
+  return m_filter (m_nodeId, hdr);
+}
+
+Ptr<PcapFileWrapper>
+WifiPcapSink::GetFile (void) const
+{
+  return m_file;
+}
+
 static void
 PcapSniffTxEvent (
-  Ptr<PcapFileWrapper> file,
+  Ptr<WifiPcapSink>    sink,
   Ptr<const Packet>    packet,
   uint16_t             channelFreqMhz,
   uint16_t             channelNumber,
@@ -259,6 +331,11 @@ PcapSniffTxEvent (
   WifiTxVector         txVector,
   struct mpduInfo      aMpdu)
 {
+  if (!sink->Accept (packet, txVector.IsAggregation ()))
+    {
+      return;
+    }
+  Ptr<PcapFileWrapper> file = sink->GetFile ();
   uint32_t dlt = file->GetDataLinkType ();
 
   switch (dlt)
@@ -273,7 +350,12 @@ PcapSniffTxEvent (
       }
     case PcapHelper::DLT_IEEE802_11_RADIO:
       {
-        Ptr<Packet> p = packet->Copy ();
+        //
+        // The radiotap header is written in front of the frame by the
+        // pcap file, which only copies the captured bytes of the frame:
+        // the frame itself is never copied to add the header.
+        //
+        Ptr<const Packet> p = packet;
         RadiotapHeader header;
         uint8_t frameFlags = RadiotapHeader::FRAME_FLAG_NONE;
         header.SetTsft (Simulator::Now ().GetMicroSeconds ());
@@ -376,9 +458,9 @@ PcapSniffTxEvent (
             /* For PCAP file, MPDU Delimiter and Padding should be removed by the MAC Driver */
             AmpduSubframeHeader hdr;
             uint32_t extractedLength;
-            p->RemoveHeader (hdr);
+            uint32_t hdrSize = p->PeekHeader (hdr);
             extractedLength = hdr.GetLength ();
-            p = p->CreateFragment (0, static_cast<uint32_t> (extractedLength));
+            p = p->CreateFragment (hdrSize, static_cast<uint32_t> (extractedLength));
             if (aMpdu.packetType == 2 || (hdr.GetEof () == true && hdr.GetLength () > 0))
               {
                 ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST;
@@ -432,8 +514,7 @@ PcapSniffTxEvent (
             header.SetVhtFields (vhtKnown, vhtFlags, vhtBandwidth, vhtMcsNss, vhtCoding, vhtGroupId, vhtPartialAid);
           }
 
-        p->AddHeader (header);
-        file->Write (Simulator::Now (), p);
+        file->Write (Simulator::Now (), header, p);
         return;
       }
     default:
@@ -443,7 +524,7 @@ PcapSniffTxEvent (
 
 static void
 PcapSniffRxEvent (
-  Ptr<PcapFileWrapper>  file,
+  Ptr<WifiPcapSink>     sink,
   Ptr<const Packet>     packet,
   uint16_t              channelFreqMhz,
   uint16_t              channelNumber,
@@ -453,6 +534,11 @@ PcapSniffRxEvent (
   struct mpduInfo       aMpdu,
   struct signalNoiseDbm signalNoise)
 {
+  if (!sink->Accept (packet, txVector.IsAggregation ()))
+    {
+      return;
+    }
+  Ptr<PcapFileWrapper> file = sink->GetFile ();
   uint32_t dlt = file->GetDataLinkType ();
 
   switch (dlt)
@@ -467,7 +553,12 @@ PcapSniffRxEvent (
       }
     case PcapHelper::DLT_IEEE802_11_RADIO:
       {
-        Ptr<Packet> p = packet->Copy ();
+        //
+        // The radiotap header is written in front of the frame by the
+        // pcap file, which only copies the captured bytes of the frame:
+        // the frame itself is never copied to add the header.
+        //
+        Ptr<const Packet> p = packet;
         RadiotapHeader header;
         uint8_t frameFlags = RadiotapHeader::FRAME_FLAG_NONE;
         header.SetTsft (Simulator::Now ().GetMicroSeconds ());
@@ -573,9 +664,9 @@ PcapSniffRxEvent (
             /* For PCAP file, MPDU Delimiter and Padding should be removed by the MAC Driver */
             AmpduSubframeHeader hdr;
             uint32_t extractedLength;
-            p->RemoveHeader (hdr);
+            uint32_t hdrSize = p->PeekHeader (hdr);
             extractedLength = hdr.GetLength ();
-            p = p->CreateFragment (0, static_cast<uint32_t> (extractedLength));
+            p = p->CreateFragment (hdrSize, static_cast<uint32_t> (extractedLength));
             if (aMpdu.packetType == 2 || (hdr.GetEof () == true && hdr.GetLength () > 0))
               {
                 ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST;
@@ -629,8 +720,7 @@ PcapSniffRxEvent (
             header.SetVhtFields (vhtKnown, vhtFlags, vhtBandwidth, vhtMcsNss, vhtCoding, vhtGroupId, vhtPartialAid);
           }
 
-        p->AddHeader (header);
-        file->Write (Simulator::Now (), p);
+        file->Write (Simulator::Now (), header, p);
         return;
       }
     default:
@@ -663,6 +753,18 @@ YansWifiPhyHelper::GetPcapDataLinkType (void) const
   return m_pcapDlt;
 }
 
+void
+YansWifiPhyHelper::SetPcapCaptureSize (uint32_t snapLen)
+{
+  m_pcapCaptureSize = snapLen;
+}
+
+void
+YansWifiPhyHelper::SetPcapFilter (PcapFilterCallback filter)
+{
+  m_pcapFilter = filter;
+}
+
 void
 YansWifiPhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -691,10 +793,11 @@ YansWifiPhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bo
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
-  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, m_pcapDlt);
+  Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, m_pcapDlt, m_pcapCaptureSize);
+  Ptr<WifiPcapSink> sink = ns3::Create<WifiPcapSink> (file, m_pcapFilter, device->GetNode ()->GetId ());
 
-  phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&PcapSniffTxEvent, file));
-  phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&PcapSniffRxEvent, file));
+  phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&PcapSniffTxEvent, sink));
+  phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&PcapSniffRxEvent, sink));
 }
 
 void
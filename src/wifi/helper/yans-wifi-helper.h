@@ -24,6 +24,8 @@
 #include "wifi-helper.h"
 #include "ns3/trace-helper.h"
 #include "ns3/yans-wifi-channel.h"
+#include "ns3/wifi-mac-header.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -255,6 +257,49 @@ public:
    */
   uint32_t GetPcapDataLinkType (void) const;
 
+  /**
+   * Set the maximum number of bytes of each frame written to PCAP
+   * traces (the pcap snaplen).  With DLT_IEEE802_11_RADIO, the radiotap
+   * header counts towards this size.  Only the captured bytes are
+   * copied out of the frame.  This function has to be called before
+   * EnablePcap().  By default, the ns3::PcapFileWrapper::CaptureSize
+   * attribute is used.
+   *
+   * @param snapLen The maximum number of bytes written per frame
+   */
+  void SetPcapCaptureSize (uint32_t snapLen);
+
+  /**
+   * Callback deciding whether a frame is written to a PCAP trace.
+   * Its arguments are the id of the node of the traced device and
+   * the MAC header of the frame; it returns true if the frame must
+   * be written.
+   */
+  typedef Callback<bool, uint32_t, const WifiMacHeader &> PcapFilterCallback;
+
+  /**
+   * Set a filter deciding which frames are written to PCAP traces.
+   * The filter is evaluated before any serialization, so frames it
+   * rejects cost only a peek at their MAC header.  For example, to only
+   * trace management frames of node 0:
+   *
+   * \code
+   *   static bool
+   *   Node0Management (uint32_t nodeId, const WifiMacHeader &hdr)
+   *   {
+   *     return nodeId == 0 && hdr.IsMgt ();
+   *   }
+   *   ...
+   *   phy.SetPcapFilter (MakeCallback (&Node0Management));
+   * \endcode
+   *
+   * This function has to be called before EnablePcap().  By default,
+   * all frames are written.
+   *
+   * @param filter The filter
+   */
+  void SetPcapFilter (PcapFilterCallback filter);
+
 private:
   /**
    * \param node the node on which we wish to create a wifi PHY
@@ -301,6 +346,8 @@ private:
   ObjectFactory m_errorRateModel;
   Ptr<YansWifiChannel> m_channel;
   uint32_t m_pcapDlt;
+  uint32_t m_pcapCaptureSize;
+  PcapFilterCallback m_pcapFilter;
 };
 
 } //namespace ns3
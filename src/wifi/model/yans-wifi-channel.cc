@@ -26,6 +26,10 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
@@ -36,6 +40,15 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+#ifdef HAVE_PTHREAD_H
+/**
+ * Serializes the transmissions of all the YansWifiChannels while the
+ * partitions of a parallel simulator transmit concurrently: the
+ * channels may share loss and delay models.
+ */
+static SystemMutex g_sendMutex;
+#endif /* HAVE_PTHREAD_H */
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -63,6 +76,7 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_phyList.clear ();
+  m_receivers.clear ();
 }
 
 void
@@ -81,6 +95,24 @@ void
 YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
                        WifiTxVector txVector, WifiPreamble preamble, struct mpduInfo aMpdu, Time duration) const
 {
+#ifdef HAVE_PTHREAD_H
+  if (IsDeepCopyEnabled ())
+    {
+      CriticalSection cs (g_sendMutex);
+      DoSend (sender, packet, txPowerDbm, txVector, preamble, aMpdu, duration);
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  DoSend (sender, packet, txPowerDbm, txVector, preamble, aMpdu, duration);
+}
+
+void
+YansWifiChannel::DoSend (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+                         WifiTxVector txVector, WifiPreamble preamble, struct mpduInfo aMpdu, Time duration) const
+{
+  // the receiving PHYs may run on other threads, see Channel::IsDeepCopyEnabled
+  bool parallel = IsDeepCopyEnabled ();
+  NS_ASSERT (!parallel || m_receivers.size () == m_phyList.size ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
   uint32_t j = 0;
@@ -94,21 +126,28 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = parallel ? m_receivers[j].mobility : (*i)->GetMobility ()->GetObject<MobilityModel> ();
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+          Ptr<Packet> copy = parallel ? packet->CreateDeepCopy () : packet->Copy ();
           uint32_t dstNode;
-          if (dstNetDevice == 0)
+          if (parallel)
             {
-              dstNode = 0xffffffff;
+              dstNode = m_receivers[j].node;
             }
           else
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+              if (dstNetDevice == 0)
+                {
+                  dstNode = 0xffffffff;
+                }
+              else
+                {
+                  dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+                }
             }
 
           struct Parameters parameters;
@@ -143,6 +182,40 @@ YansWifiChannel::GetDevice (uint32_t i) const
   return m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
 }
 
+Time
+YansWifiChannel::GetMinimumDelayBetweenGroups (const std::vector<uint32_t> &groups) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ptr<MobilityModel> > mobility;
+  std::vector<uint32_t> phyGroups;
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); ++i)
+    {
+      Ptr<Object> device = (*i)->GetDevice ();
+      if (device == 0 || device->GetObject<NetDevice> ()->GetNode () == 0)
+        {
+          continue;
+        }
+      mobility.push_back ((*i)->GetMobility ());
+      phyGroups.push_back (groups.at (device->GetObject<NetDevice> ()->GetNode ()->GetId ()));
+    }
+  return m_delay->GetMinimumDelayBetweenGroups (mobility, phyGroups);
+}
+
+void
+YansWifiChannel::PrepareParallelRun (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_receivers.clear ();
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); ++i)
+    {
+      Receiver receiver;
+      Ptr<NetDevice> device = (*i)->GetDevice ();
+      receiver.node = (device == 0) ? 0xffffffff : device->GetNode ()->GetId ();
+      receiver.mobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+      m_receivers.push_back (receiver);
+    }
+}
+
 void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
@@ -34,6 +34,7 @@
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 
@@ -57,6 +58,12 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * While Channel::IsDeepCopyEnabled(), the PHYs may transmit from
+ * several threads: the transmissions of all the YansWifiChannels are
+ * then serialized, since they share the loss and delay models and
+ * reference the mobility models of the PHYs, and the node and the
+ * mobility model of each PHY are those found by PrepareParallelRun().
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -69,6 +76,19 @@ public:
   //inherited from Channel.
   virtual uint32_t GetNDevices (void) const;
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
+  /**
+   * \param groups the group of each node, indexed by node id
+   * \returns the minimum propagation delay between the devices of
+   * different groups, see
+   * PropagationDelayModel::GetMinimumDelayBetweenGroups.  A PHY is
+   * notified of a transmission as soon as it arrives.
+   */
+  virtual Time GetMinimumDelayBetweenGroups (const std::vector<uint32_t> &groups) const;
+  /**
+   * Look up the node id and the mobility model of each PHY, which Send
+   * uses instead of the PHY while Channel::IsDeepCopyEnabled().
+   */
+  virtual void PrepareParallelRun (void);
 
   /**
    * Adds the given YansWifiPhy to the PHY list
@@ -122,6 +142,31 @@ private:
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
 
+  /**
+   * What Send needs of a receiving PHY while the partitions of a
+   * parallel simulator transmit concurrently.
+   */
+  struct Receiver
+  {
+    uint32_t node;                  //!< The node id, or 0xffffffff without device
+    Ptr<MobilityModel> mobility;    //!< The mobility model
+  };
+
+  /**
+   * Send the packet to all the PHYs on the channel of the sender, see
+   * Send.
+   *
+   * \param sender the device from which the packet is originating.
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet
+   * \param txVector the TXVECTOR associated to the packet
+   * \param preamble the preamble associated to the packet
+   * \param aMpdu the type of the packet and the A-MPDU reference number
+   * \param duration the transmission duration associated to the packet
+   */
+  void DoSend (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+               WifiTxVector txVector, WifiPreamble preamble, struct mpduInfo aMpdu, Time duration) const;
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
@@ -138,6 +183,7 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  std::vector<Receiver> m_receivers;   //!< The receiving PHYs, see PrepareParallelRun
 };
 
 } //namespace ns3
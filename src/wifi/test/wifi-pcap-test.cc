@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/nqos-wifi-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/string.h"
+#include "ns3/pcap-file.h"
+#include <cstdio>
+
+using namespace ns3;
+
+/**
+ * Filter of the test: only data frames.
+ *
+ * \param nodeId the id of the node of the traced device
+ * \param hdr the MAC header of the frame
+ * \returns true if the frame is a data frame
+ */
+static bool
+DataFramesOnly (uint32_t nodeId, const WifiMacHeader &hdr)
+{
+  return hdr.IsData ();
+}
+
+/**
+ * Check that YansWifiPhyHelper::SetPcapCaptureSize sets the snaplen of
+ * the pcap files and truncates the frames, and that the frames
+ * rejected by YansWifiPhyHelper::SetPcapFilter are not written.
+ */
+class WifiPcapCaptureTest : public TestCase
+{
+public:
+  WifiPcapCaptureTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Send a frame.
+   * \param dev the sending device
+   * \param dest the destination
+   */
+  void SendOnePacket (Ptr<NetDevice> dev, Address dest);
+
+  /**
+   * Check the records of a pcap file.
+   * \param filename the pcap file
+   */
+  void CheckFile (std::string filename);
+
+  static const uint32_t N_FRAMES = 5;        //!< number of frames of each kind
+  static const uint32_t PAYLOAD_SIZE = 200;  //!< size of the payload of the frames
+  static const uint32_t CAPTURE_SIZE = 64;   //!< capture size of the pcap files
+};
+
+WifiPcapCaptureTest::WifiPcapCaptureTest ()
+  : TestCase ("Check the capture size and the frame filter of the wifi pcap traces")
+{
+}
+
+void
+WifiPcapCaptureTest::SendOnePacket (Ptr<NetDevice> dev, Address dest)
+{
+  dev->Send (Create<Packet> (PAYLOAD_SIZE), dest, 1);
+}
+
+void
+WifiPcapCaptureTest::CheckFile (std::string filename)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Unable to open " << filename);
+  NS_TEST_EXPECT_MSG_EQ (f.GetSnapLen (), CAPTURE_SIZE, "Wrong snaplen in " << filename);
+  NS_TEST_EXPECT_MSG_EQ (f.GetDataLinkType (), PcapHelper::DLT_IEEE802_11, "Wrong data link type in " << filename);
+
+  uint8_t data[1500];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  uint32_t records = 0;
+  while (true)
+    {
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (f.Eof ())
+        {
+          break;
+        }
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Unable to read a record of " << filename);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, CAPTURE_SIZE, "Frame not truncated to the capture size");
+      NS_TEST_EXPECT_MSG_EQ (readLen, CAPTURE_SIZE, "Record longer than the capture size");
+      NS_TEST_EXPECT_MSG_GT (origLen, PAYLOAD_SIZE, "Wrong original length of the frame");
+      // type field of the frame control: 2 for data frames (1 for the
+      // acknowledgments, which the filter rejects)
+      uint32_t type = (data[0] >> 2) & 0x3;
+      NS_TEST_EXPECT_MSG_EQ (type, 2, "Frame rejected by the filter found in " << filename);
+      ++records;
+    }
+  // the unicast and the broadcast frames, but not the acknowledgments
+  NS_TEST_EXPECT_MSG_EQ (records, 2 * N_FRAMES, "Wrong number of records in " << filename);
+  f.Close ();
+}
+
+void
+WifiPcapCaptureTest::DoRun (void)
+{
+  std::string filenames[2];
+  filenames[0] = CreateTempDirFilename ("wifi-pcap-0.pcap");
+  filenames[1] = CreateTempDirFilename ("wifi-pcap-1.pcap");
+  {
+    NodeContainer nodes;
+    nodes.Create (2);
+
+    WifiHelper wifi = WifiHelper::Default ();
+    wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+    wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                  "DataMode", StringValue ("OfdmRate6Mbps"),
+                                  "ControlMode", StringValue ("OfdmRate6Mbps"));
+    NqosWifiMacHelper mac = NqosWifiMacHelper::Default ();
+    mac.SetType ("ns3::AdhocWifiMac");
+    YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+    YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+    phy.SetChannel (channel.Create ());
+    NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+    positions->Add (Vector (0.0, 0.0, 0.0));
+    positions->Add (Vector (5.0, 0.0, 0.0));
+    mobility.SetPositionAllocator (positions);
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (nodes);
+
+    phy.SetPcapDataLinkType (YansWifiPhyHelper::DLT_IEEE802_11);
+    phy.SetPcapCaptureSize (CAPTURE_SIZE);
+    phy.SetPcapFilter (MakeCallback (&DataFramesOnly));
+    phy.EnablePcap (filenames[0], devices.Get (0), false, true);
+    phy.EnablePcap (filenames[1], devices.Get (1), false, true);
+
+    // acknowledged unicast frames, then broadcast frames
+    for (uint32_t i = 0; i < N_FRAMES; ++i)
+      {
+        Simulator::Schedule (MilliSeconds (10 * (i + 1)), &WifiPcapCaptureTest::SendOnePacket, this,
+                             devices.Get (0), devices.Get (1)->GetAddress ());
+        Simulator::Schedule (MilliSeconds (10 * (i + 1 + N_FRAMES)), &WifiPcapCaptureTest::SendOnePacket, this,
+                             devices.Get (0), devices.Get (0)->GetBroadcast ());
+      }
+    Simulator::Stop (Seconds (1.0));
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+  // the devices, and thus the pcap files, are released here
+
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      CheckFile (filenames[i]);
+      std::remove (filenames[i].c_str ());
+    }
+}
+
+/**
+ * Wifi pcap trace test suite.
+ */
+class WifiPcapTestSuite : public TestSuite
+{
+public:
+  WifiPcapTestSuite ();
+};
+
+WifiPcapTestSuite::WifiPcapTestSuite ()
+  : TestSuite ("wifi-pcap", UNIT)
+{
+  AddTestCase (new WifiPcapCaptureTest, TestCase::QUICK);
+}
+
+static WifiPcapTestSuite g_wifiPcapTestSuite;
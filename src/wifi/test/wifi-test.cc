@@ -30,6 +30,7 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/adhoc-wifi-mac.h"
+#include "ns3/constant-rate-wifi-manager.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
@@ -40,6 +41,11 @@
 #include "ns3/config.h"
 #include "ns3/boolean.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 
 using namespace ns3;
 
@@ -622,6 +628,123 @@ Bug730TestCase::DoRun (void)
 }
 
 
+#ifdef HAVE_PTHREAD_H
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that two pairs of stations sharing a YansWifiChannel, far
+ * enough from each other to be simulated by two threads of a
+ * MultithreadedSimulatorImpl, receive all the packets sent within each
+ * pair.
+ */
+
+class WifiPartitionsTestCase : public TestCase
+{
+public:
+  WifiPartitionsTestCase ();
+
+  virtual void DoRun (void);
+
+
+private:
+  Ptr<WifiNetDevice> CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t *nRx);
+  static void SendOnePacket (Ptr<WifiNetDevice> dev);
+  static void CountRx (uint32_t *nRx, Ptr<const Packet> p);
+
+  static const uint32_t N_PACKETS = 10; //!< number of packets sent by each pair
+};
+
+WifiPartitionsTestCase::WifiPartitionsTestCase ()
+  : TestCase ("Wifi stations in two partitions")
+{
+}
+
+void
+WifiPartitionsTestCase::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+WifiPartitionsTestCase::CountRx (uint32_t *nRx, Ptr<const Packet> p)
+{
+  (*nRx)++;
+}
+
+Ptr<WifiNetDevice>
+WifiPartitionsTestCase::CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t *nRx)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  // each counter is only updated by the partition of its station
+  phy->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&WifiPartitionsTestCase::CountRx, nRx));
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (CreateObject<ConstantRateWifiManager> ());
+  node->AddDevice (dev);
+  return dev;
+}
+
+void
+WifiPartitionsTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("Threads", UintegerValue (2));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+
+  // the pairs do not hear each other, but are only 33 us apart
+  uint32_t nRx[4] = { 0, 0, 0, 0 };
+  Ptr<WifiNetDevice> devs[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Vector pos = Vector (10000.0 * (i / 2) + 5.0 * (i % 2), 0.0, 0.0);
+      devs[i] = CreateOne (pos, channel, &nRx[i]);
+      impl->SetPartition (devs[i]->GetNode ()->GetId (), i / 2);
+    }
+
+  for (uint32_t i = 0; i < N_PACKETS; i++)
+    {
+      for (uint32_t j = 0; j < 4; j += 2)
+        {
+          Simulator::ScheduleWithContext (devs[j]->GetNode ()->GetId (), Seconds (1.0) + MilliSeconds (10 * i),
+                                          &WifiPartitionsTestCase::SendOnePacket, devs[j]);
+        }
+    }
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_GT (impl->GetLookahead (), Seconds (0), "The partitions did not run on several threads");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (nRx[1], N_PACKETS, "Packets lost in the first partition");
+  NS_TEST_ASSERT_MSG_EQ (nRx[3], N_PACKETS, "Packets lost in the second partition");
+  NS_TEST_ASSERT_MSG_EQ (nRx[0] + nRx[2], 0, "Packets received from the other pair");
+}
+#endif /* HAVE_PTHREAD_H */
+
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -637,6 +760,9 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); //Bug 555
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new WifiPartitionsTestCase, TestCase::QUICK);
+#endif
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -410,13 +410,13 @@ void WimaxHelper::AsciiRxEvent (Ptr<OutputStreamWrapper> stream,
                                 const Mac48Address &source)
 {
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " from: " << source << " ";
-  *stream->GetStream () << path << std::endl;
+  *stream->GetStream () << path << '\n';
 }
 
 void WimaxHelper::AsciiTxEvent (Ptr<OutputStreamWrapper> stream, std::string path, Ptr<const Packet> packet, const Mac48Address &dest)
 {
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " to: " << dest << " ";
-  *stream->GetStream () << path << std::endl;
+  *stream->GetStream () << path << '\n';
 }
 
 ServiceFlow WimaxHelper::CreateServiceFlow (ServiceFlow::Direction direction,